@@ -367,12 +367,20 @@ static void print_db_env_struct (void) {
         const char *extra[]={
                              "int (*checkpointing_set_period)             (DB_ENV*, uint32_t) /* Change the delay between automatic checkpoints.  0 means disabled. */",
                              "int (*checkpointing_get_period)             (DB_ENV*, uint32_t*) /* Retrieve the delay between automatic checkpoints.  0 means disabled. */",
+                             "int (*checkpointing_set_paced)              (DB_ENV*, bool) /* Spread the writes of automatic checkpoints over the checkpoint period. */",
+                             "int (*checkpointing_get_paced)              (DB_ENV*, bool*) /* Retrieve whether automatic checkpoints spread their writes over the checkpoint period. */",
                              "int (*cleaner_set_period)                   (DB_ENV*, uint32_t) /* Change the delay between automatic cleaner attempts.  0 means disabled. */",
                              "int (*cleaner_get_period)                   (DB_ENV*, uint32_t*) /* Retrieve the delay between automatic cleaner attempts.  0 means disabled. */",
                              "int (*cleaner_set_iterations)               (DB_ENV*, uint32_t) /* Change the number of attempts on each cleaner invocation.  0 means disabled. */",
                              "int (*cleaner_get_iterations)               (DB_ENV*, uint32_t*) /* Retrieve the number of attempts on each cleaner invocation.  0 means disabled. */",
+                             "int (*cleaner_set_adaptive)                 (DB_ENV*, bool) /* Size each cleaner invocation by the bytes of messages buffered in the cachetable. */",
+                             "int (*cleaner_get_adaptive)                 (DB_ENV*, bool*) /* Retrieve whether cleaner invocations are sized by the bytes of messages buffered. */",
+                             "int (*cleaner_set_max_threads)              (DB_ENV*, uint32_t) /* Change the number of threads an adaptive cleaner invocation may use. */",
+                             "int (*cleaner_get_max_threads)              (DB_ENV*, uint32_t*) /* Retrieve the number of threads an adaptive cleaner invocation may use. */",
                              "int (*evictor_set_enable_partial_eviction)  (DB_ENV*, bool) /* Enables or disabled partial eviction of nodes from cachetable. */",
                              "int (*evictor_get_enable_partial_eviction)  (DB_ENV*, bool*) /* Retrieve the status of partial eviction of nodes from cachetable. */",
+                             "int (*evictor_set_replacement_policy)       (DB_ENV*, toku_cachetable_policy) /* Change the policy used to pick nodes to evict from cachetable. */",
+                             "int (*evictor_get_replacement_policy)       (DB_ENV*, toku_cachetable_policy*) /* Retrieve the policy used to pick nodes to evict from cachetable. */",
                              "int (*checkpointing_postpone)               (DB_ENV*) /* Use for 'rename table' or any other operation that must be disjoint from a checkpoint */",
                              "int (*checkpointing_resume)                 (DB_ENV*) /* Alert tokuft that 'postpone' is no longer necessary */",
                              "int (*checkpointing_begin_atomic_operation) (DB_ENV*) /* Begin a set of operations (that must be atomic as far as checkpoints are concerned). i.e. inserting into every index in one table */",
@@ -422,6 +430,7 @@ static void print_db_env_struct (void) {
                              "int (*set_client_pool_threads)(DB_ENV *, uint32_t)",
                              "int (*set_cachetable_pool_threads)(DB_ENV *, uint32_t)",
                              "int (*set_checkpoint_pool_threads)(DB_ENV *, uint32_t)",
+                             "int (*set_cachetable_numa)(DB_ENV *, bool)",
                              "void (*set_check_thp)(DB_ENV *, bool new_val)",
                              "bool (*get_check_thp)(DB_ENV *)",
                              "bool (*set_dir_per_db)(DB_ENV *, bool new_val)",
@@ -676,6 +685,12 @@ int main (int argc, char *const argv[] __attribute__((__unused__))) {
     printf("    TOKU_SMALL_COMPRESSION_METHOD = 3,\n");
     printf("} TOKU_COMPRESSION_METHOD;\n");
 
+    // cachetable replacement policies
+    printf("typedef enum toku_cachetable_policy {\n");
+    printf("    TOKU_CACHETABLE_POLICY_CLOCK = 0,\n");  // every access counts, the default
+    printf("    TOKU_CACHETABLE_POLICY_2Q    = 1,\n");  // scan resistant, nodes must be re-read after eviction to become hot
+    printf("} toku_cachetable_policy;\n");
+
     //bulk loader
     printf("typedef struct __toku_loader DB_LOADER;\n");
     printf("struct __toku_loader_internal;\n");
@@ -810,6 +825,8 @@ int main (int argc, char *const argv[] __attribute__((__unused__))) {
     printf("int toku_close_trace_file (void) %s;\n", VISIBLE);
     printf("void db_env_set_direct_io (bool direct_io_on) %s;\n", VISIBLE);
     printf("void db_env_set_compress_buffers_before_eviction (bool compress_buffers) %s;\n", VISIBLE);
+    printf("void db_env_set_victim_cache_size (uint64_t size) %s;\n", VISIBLE);
+    printf("void db_env_set_io_uring (bool io_uring_on) %s;\n", VISIBLE);
     printf("void db_env_set_func_fsync (int (*)(int)) %s;\n", VISIBLE);
     printf("void db_env_set_func_free (void (*)(void*)) %s;\n", VISIBLE);
     printf("void db_env_set_func_malloc (void *(*)(size_t)) %s;\n", VISIBLE);
@@ -22,6 +22,7 @@ check_include_files(inttypes.h HAVE_INTTYPES_H)
 check_include_files(libkern/OSAtomic.h HAVE_LIBKERN_OSATOMIC_H)
 check_include_files(libkern/OSByteOrder.h HAVE_LIBKERN_OSBYTEORDER_H)
 check_include_files(limits.h HAVE_LIMITS_H)
+check_include_files(linux/io_uring.h HAVE_LINUX_IO_URING_H)
 check_include_files(machine/endian.h HAVE_MACHINE_ENDIAN_H)
 check_include_files(malloc.h HAVE_MALLOC_H)
 check_include_files(malloc/malloc.h HAVE_MALLOC_MALLOC_H)
@@ -112,6 +113,7 @@ check_function_exists(pthread_yield_np HAVE_PTHREAD_YIELD_NP)
 ## check if we have pthread_getthreadid_np() (i.e. freebsd)
 check_function_exists(pthread_getthreadid_np HAVE_PTHREAD_GETTHREADID_NP)
 check_function_exists(sched_getcpu HAVE_SCHED_GETCPU)
+check_function_exists(pthread_setaffinity_np HAVE_PTHREAD_SETAFFINITY_NP)
 
 include(CheckCSourceCompiles)
 
@@ -40,18 +40,32 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <ft/ft-internal.h>
 
 using namespace toku;
+
+static uint32_t basement_bloom_bits_per_key = 0;
+
+void toku_ft_set_basement_bloom_bits_per_key(uint32_t bits_per_key) {
+    toku_unsafe_set(&basement_bloom_bits_per_key, bits_per_key);
+}
+
+uint32_t toku_ft_get_basement_bloom_bits_per_key(void) {
+    return toku_unsafe_fetch(&basement_bloom_bits_per_key);
+}
+
 uint32_t bn_data::klpair_disksize(const uint32_t klpair_len, const klpair_struct *klpair) const {
     return sizeof(*klpair) + keylen_from_klpair_len(klpair_len) + leafentry_disksize(get_le_from_klpair(klpair));
 }
 
 void bn_data::init_zero() {
     toku_mempool_zero(&m_buffer_mempool);
+    toku_mempool_zero(&m_old_shared_mempool);
     m_disksize_of_keys = 0;
+    m_key_filter = nullptr;
 }
 
 void bn_data::initialize_empty() {
     init_zero();
     m_buffer.create();
+    rebuild_key_filter();
 }
 
 void bn_data::add_key(uint32_t keylen) {
@@ -67,6 +81,48 @@ void bn_data::remove_key(uint32_t keylen) {
     m_disksize_of_keys -= sizeof(keylen) + keylen;
 }
 
+static int add_klpair_to_filter(const uint32_t klpair_len, const klpair_struct &klpair, const uint32_t UU(idx), bloom_filter *const filter) {
+    filter->add(klpair.key, keylen_from_klpair_len(klpair_len));
+    return 0;
+}
+
+void bn_data::rebuild_key_filter(void) {
+    if (m_key_filter != nullptr) {
+        m_key_filter->destroy();
+        toku_free(m_key_filter);
+        m_key_filter = nullptr;
+    }
+    const uint32_t bits_per_key = toku_ft_get_basement_bloom_bits_per_key();
+    if (bits_per_key == 0) {
+        return;
+    }
+    // Leave room for the basement node to grow by half before the
+    // filter has to be rebuilt.
+    const uint32_t n = num_klpairs();
+    XMALLOC(m_key_filter);
+    *m_key_filter = bloom_filter();
+    m_key_filter->create(n + n / 2 + 32, bits_per_key);
+    int r = m_buffer.iterate<bloom_filter, add_klpair_to_filter>(m_key_filter);
+    invariant_zero(r);
+}
+
+void bn_data::add_to_key_filter(const void *keyp, uint32_t keylen) {
+    if (m_key_filter == nullptr) {
+        return;
+    }
+    if (m_key_filter->num_keys() >= m_key_filter->capacity()) {
+        // The key is already in the dmt, so the rebuild picks it up.
+        rebuild_key_filter();
+    } else {
+        m_key_filter->add(keyp, keylen);
+    }
+}
+
+bool bn_data::may_contain_key(const DBT *key) const {
+    return m_key_filter == nullptr ||
+           m_key_filter->may_contain(key->data, key->size);
+}
+
 // Deserialize from format optimized for keys being inlined.
 // Currently only supports fixed-length keys.
 void bn_data::initialize_from_separate_keys_and_vals(uint32_t num_entries, struct rbuf *rb, uint32_t data_size, uint32_t version UU(),
@@ -97,6 +153,8 @@ void bn_data::initialize_from_separate_keys_and_vals(uint32_t num_entries, struc
     toku_note_deserialized_basement_node(all_keys_same_length);
 
     invariant(rb->ndone - ndone_before == data_size);
+
+    rebuild_key_filter();
 }
 
 static int
@@ -294,6 +352,8 @@ void bn_data::deserialize_from_rbuf(uint32_t num_entries, struct rbuf *rb, uint3
         invariant_zero(toku_mempool_get_frag_size(&m_buffer_mempool));
         toku_mempool_realloc_larger(&m_buffer_mempool, toku_mempool_get_used_size(&m_buffer_mempool));
     }
+
+    rebuild_key_filter();
 }
 
 uint64_t bn_data::get_memory_size() {
@@ -306,6 +366,9 @@ uint64_t bn_data::get_memory_size() {
     // This one includes not-yet-allocated for nodes (just like old constant-key omt)
     //TODO: Maybe ask for mempool_footprint instead of memory_size.
     retval += m_buffer.memory_size();
+    if (m_key_filter != nullptr) {
+        retval += m_key_filter->memory_size();
+    }
     invariant(retval >= get_disk_size());
     return retval;
 }
@@ -348,7 +411,8 @@ void bn_data::dmt_compress_kvspace(size_t added_size, void **maybe_free, bool fo
     // the caller needs the side effect that all contents are put in sorted order.
     bool do_compress = toku_mempool_get_frag_size(&m_buffer_mempool) > 0 || force_compress;
 
-    void *old_mempool_base = toku_mempool_get_base(&m_buffer_mempool);
+    struct mempool old_kvspace = m_buffer_mempool;
+    void *old_mempool_base = toku_mempool_get_base(&old_kvspace);
     struct mempool new_kvspace;
     if (do_compress) {
         size_t requested_size = force_compress ? total_size_needed : ((total_size_needed * 3) / 2);
@@ -362,10 +426,14 @@ void bn_data::dmt_compress_kvspace(size_t added_size, void **maybe_free, bool fo
         memcpy(new_mempool_base, old_mempool_base, old_offset_limit);
     }
 
-    if (maybe_free) {
-        *maybe_free = old_mempool_base;
+    if (maybe_free == nullptr) {
+        toku_mempool_destroy(&old_kvspace);
+    } else if (toku_mempool_is_shared(&old_kvspace)) {
+        paranoid_invariant_null(toku_mempool_get_base(&m_old_shared_mempool));
+        m_old_shared_mempool = old_kvspace;
     } else {
-        toku_free(old_mempool_base);
+        toku_mempool_unshare(&old_kvspace);
+        *maybe_free = old_mempool_base;
     }
     m_buffer_mempool = new_kvspace;
 }
@@ -375,6 +443,7 @@ void bn_data::dmt_compress_kvspace(size_t added_size, void **maybe_free, bool fo
 //  If MAYBE_FREE is nullptr then free the old mempool's space.
 //  Otherwise, store the old mempool's space in maybe_free.
 LEAFENTRY bn_data::mempool_malloc_and_update_dmt(size_t size, void **maybe_free) {
+    toku_mempool_destroy(&m_old_shared_mempool);
     void *v = toku_mempool_malloc(&m_buffer_mempool, size);
     if (v == nullptr) {
         dmt_compress_kvspace(size, maybe_free, false);
@@ -398,6 +467,8 @@ void bn_data::get_space_for_overwrite(
     *maybe_free = nullptr;
     LEAFENTRY new_le = mempool_malloc_and_update_dmt(new_size, maybe_free);
     toku_mempool_mfree(&m_buffer_mempool, nullptr, old_le_size);
+    // The klpair is updated in place below.
+    m_buffer.unshare();
     klpair_struct* klp = nullptr;
     uint32_t klpair_len;
     int r = m_buffer.fetch(idx, &klpair_len, &klp);
@@ -431,6 +502,7 @@ void bn_data::get_space_for_insert(
 
     klpair_dmtwriter kl(keylen, new_le_offset, keyp);
     m_buffer.insert_at(kl, idx);
+    add_to_key_filter(keyp, keylen);
 
     *new_le_space = new_le;
 }
@@ -536,6 +608,18 @@ void bn_data::split_klpairs(
     toku_mempool_realloc_larger(left_mp, toku_mempool_get_used_size(left_mp));
     paranoid_invariant_zero(toku_mempool_get_frag_size(right_mp));
     toku_mempool_realloc_larger(right_mp, toku_mempool_get_used_size(right_mp));
+
+    rebuild_key_filter();
+    right_bd->rebuild_key_filter();
+}
+
+uint64_t bn_data::get_shared_memory_size(void) {
+    // measured the way get_memory_size() measures it
+    uint64_t retval = m_buffer.shared_memory_size();
+    if (toku_mempool_is_shared(&m_buffer_mempool)) {
+        retval += toku_mempool_footprint(&m_buffer_mempool);
+    }
+    return retval;
 }
 
 uint64_t bn_data::get_disk_size() {
@@ -579,7 +663,13 @@ void bn_data::destroy(void) {
     // The buffer may have been freed already, in some cases.
     m_buffer.destroy();
     toku_mempool_destroy(&m_buffer_mempool);
+    toku_mempool_destroy(&m_old_shared_mempool);
     m_disksize_of_keys = 0;
+    if (m_key_filter != nullptr) {
+        m_key_filter->destroy();
+        toku_free(m_key_filter);
+        m_key_filter = nullptr;
+    }
 }
 
 void bn_data::set_contents_as_clone_of_sorted_array(
@@ -614,6 +704,7 @@ void bn_data::set_contents_as_clone_of_sorted_array(
         add_key(old_keylens[idx]);
     }
     dmt_builder.build(&this->m_buffer);
+    rebuild_key_filter();
 }
 
 LEAFENTRY bn_data::get_le_from_klpair(const klpair_struct *klpair) const {
@@ -668,7 +759,14 @@ int bn_data::fetch_key_and_len(uint32_t idx, uint32_t *len, void** key) {
 
 void bn_data::clone(bn_data* orig_bn_data) {
     toku_mempool_clone(&orig_bn_data->m_buffer_mempool, &m_buffer_mempool);
+    toku_mempool_zero(&m_old_shared_mempool);
     m_buffer.clone(orig_bn_data->m_buffer);
     this->m_disksize_of_keys = orig_bn_data->m_disksize_of_keys;
+    m_key_filter = nullptr;
+    if (orig_bn_data->m_key_filter != nullptr) {
+        XMALLOC(m_key_filter);
+        *m_key_filter = bloom_filter();
+        m_key_filter->clone(*orig_bn_data->m_key_filter);
+    }
 }
 
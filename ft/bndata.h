@@ -37,6 +37,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 
 #pragma once
 
+#include "util/bloom_filter.h"
 #include "util/dmt.h"
 #include "util/mempool.h"
 
@@ -114,6 +115,14 @@ class klpair_dmtwriter {
 }
 
 typedef toku::dmt<klpair_struct, klpair_struct*, toku::klpair_dmtwriter> klpair_dmt_t;
+
+// Bits per key of the bloom filter kept over the keys of each basement node,
+// used to answer point lookups for absent keys without searching the dmt.
+// 0 (the default) keeps no filters.  Basement nodes pick up a change the
+// next time they are built or read in.
+void toku_ft_set_basement_bloom_bits_per_key(uint32_t bits_per_key);
+uint32_t toku_ft_get_basement_bloom_bits_per_key(void);
+
 // This class stores the data associated with a basement node
 class bn_data {
 public:
@@ -136,6 +145,12 @@ public:
     // Get the serialized size of this basement node.
     uint64_t get_disk_size(void);
 
+    // Returns: false if key is certainly not in this basement node,
+    //          true if it may be (or if there is no key filter).
+    // The filter hashes key bytes, so only ask when the dictionary
+    // compares keys with toku_builtin_compare_fun.
+    bool may_contain_key(const DBT *key) const;
+
     // Perform (paranoid) verification that all leafentries are fully contained within the mempool
     void verify_mempool(void);
 
@@ -158,12 +173,13 @@ public:
     }
 
     // find_zero() on key dmt
+    // (a branchless search when all keys are the same length)
     template<typename dmtcmp_t,
              int (*h)(const DBT &, const dmtcmp_t &)>
     int find_zero(const dmtcmp_t &extra, LEAFENTRY *const value, void** key, uint32_t* keylen, uint32_t *const idxp) const {
         klpair_struct* klpair = nullptr;
         uint32_t klpair_len;
-        int r = m_buffer.find_zero< dmtcmp_t, klpair_find_wrapper<dmtcmp_t, h> >(extra, &klpair_len, &klpair, idxp);
+        int r = m_buffer.find_zero_fixed< dmtcmp_t, klpair_find_wrapper<dmtcmp_t, h> >(extra, &klpair_len, &klpair, idxp);
         if (r == 0) {
             if (value) {
                 *value = get_le_from_klpair(klpair);
@@ -237,10 +253,16 @@ public:
         );
 
     // Make this basement node a clone of orig_bn_data.
-    // orig_bn_data still owns all its memory (dmt, mempool)
-    // this basement node will have a new dmt, mempool containing same data.
+    // The two share their memory (dmt, mempool) copy-on-write, so this is O(1).
+    // Leafentries are never written in place, so they stay shared until one
+    // side destroys or compresses its mempool; the dmt is copied by whichever
+    // side first changes it in place.
     void clone(bn_data* orig_bn_data);
 
+    // Get the part of get_memory_size() that is still shared with the
+    // basement node this one was cloned from, or was cloned to.
+    uint64_t get_shared_memory_size(void);
+
     // Delete klpair index idx with provided keylen and old leafentry with size old_le_size
     void delete_leafentry (
         uint32_t idx,
@@ -313,9 +335,23 @@ private:
     // Note that a key was removed (for maintaining disk-size of this basement node)
     void remove_key(uint32_t keylen);
 
+    // (Re)build the key filter from the keys in the dmt, or drop it if
+    // basement bloom filters are turned off.
+    void rebuild_key_filter(void);
+
+    // Add a newly inserted key to the key filter, rebuilding it when it
+    // has taken more keys than it was sized for.
+    void add_to_key_filter(const void *keyp, uint32_t keylen);
+
     klpair_dmt_t m_buffer;                     // pointers to individual leaf entries
     struct mempool m_buffer_mempool;  // storage for all leaf entries
 
+    // The leafentry mempool we moved off of while a clone still shared it.
+    // Callers of get_space_for_*() may still be reading leafentries from it,
+    // so it is let go of at the next allocation instead of handed back to
+    // them in maybe_free.
+    struct mempool m_old_shared_mempool;
+
     friend class bndata_bugfix_test;
 
     // Get the serialized size of a klpair.
@@ -325,6 +361,10 @@ private:
     // The disk/memory size of all keys.  (Note that the size of memory for the leafentries is maintained by m_buffer_mempool)
     size_t m_disksize_of_keys;
 
+    // Bloom filter over the keys, or nullptr.  Deleted keys stay in it
+    // until the next rebuild, which only costs false positives.
+    toku::bloom_filter *m_key_filter;
+
     // Deserialize this basement node from rbuf
     // all keys will be first followed by all leafentries (both in sorted order)
     void initialize_from_separate_keys_and_vals(uint32_t num_entries, struct rbuf *rb, uint32_t data_size, uint32_t version,
@@ -174,6 +174,7 @@ struct ctpair {
     CACHEFILE cachefile;
     CACHEKEY key;
     uint32_t fullhash;
+    uint32_t numa_node; // node of the thread that created the PAIR, 0 unless the pair list is in NUMA mode
     CACHETABLE_FLUSH_CALLBACK flush_callback;
     CACHETABLE_PARTIAL_EVICTION_EST_CALLBACK pe_est_callback;
     CACHETABLE_PARTIAL_EVICTION_CALLBACK pe_callback;
@@ -194,6 +195,7 @@ struct ctpair {
 
     // protected by PAIR->mutex
     uint32_t count;        // clock count
+    bool hot;              // false while the replacement policy ignores pins of the PAIR
     uint32_t refcount; // if > 0, then this PAIR is referenced by
                        // callers to the cachetable, and therefore cannot 
                        // be evicted
@@ -231,7 +233,14 @@ struct ctpair {
     // These variables are protected by the list lock in the pair_list
     //
     // clock_next,clock_prev represent a circular doubly-linked list.
+    // Once a PAIR has been freed, clock_next links it into the pair_list's
+    // list of retired PAIRs.
     PAIR clock_next,clock_prev; // In clock.
+    // evict_next,evict_prev represent the circular doubly-linked list
+    // that makes up the eviction clock of the PAIR's shard.
+    PAIR evict_next,evict_prev;
+    // hash_chain is also read without any lock by optimistic lookups,
+    // so it is only ever updated with a single pointer-sized store.
     PAIR hash_chain;
 
     // pending_next,pending_next represent a non-circular doubly-linked list.
@@ -263,11 +272,41 @@ void pair_init(PAIR p,
     pair_list *list);
 
 
+//
+// Each thread that walks a hash chain without a lock announces itself in
+// one of these slots, chosen by thread id, for the epoch it started in.
+//
+struct pair_lookup_epoch_slot {
+    uint64_t active[2];
+} __attribute__((__aligned__(64)));
+
+const uint32_t PAIR_LOOKUP_EPOCH_SLOTS = 64;
+
+//
+// The eviction clock is split into shards by fullhash, or in NUMA mode by
+// the NUMA node of the PAIR, so that each shard can be run by its own
+// eviction thread. A shard's hand is only
+// moved by that thread while it holds a read lock on the list lock.
+//
+struct pair_clock_shard {
+    PAIR head; // head is the next thing to be up for decrement
+    uint32_t n_pairs; // number of pairs in this shard's clock
+} __attribute__((__aligned__(64)));
+
+const uint32_t EVICTOR_MAX_SHARDS = 8;
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 //  The pair list maintains the set of PAIR's that make up
 //  the cachetable.
 //
+//  Besides the locked lookup in find_pair, read pins of resident PAIRs
+//  may use find_and_read_pin_optimistic, which walks the hash chain with
+//  no lock at all and pins the PAIR through the lock-free read path of
+//  its value_rwlock. Readers on that path are protected by epochs: a freed
+//  PAIR is retired, and its memory is only released once every lookup that
+//  started in an older epoch has finished.
+//
 class pair_list {
 public:
     //
@@ -288,11 +327,20 @@ public:
     // the lists must hold the write list lock. Here is the
     // association between what threads may hold a read lock
     // on the list lock while iterating:
-    //  - clock_head -> eviction thread (evictor)
+    //  - clock_shards[i].head -> eviction thread of shard i (evictor)
     //  - cleaner_head -> cleaner thread (cleaner)
     //  - pending_head -> checkpoint thread (checkpointer)
     //
-    PAIR m_clock_head; // of clock . head is the next thing to be up for decrement. 
+    // m_clock_head anchors the list of all PAIRs, linked through
+    // clock_next, that the cleaner and checkpoint heads walk. Eviction
+    // uses the per-shard clocks, linked through evict_next.
+    //
+    PAIR m_clock_head;
+    uint32_t m_num_clock_shards; // a power of two, fixed at init
+    // in NUMA mode, fixed at init, there is a clock shard per NUMA node
+    bool m_numa;
+    uint32_t m_numa_nodes;
+    pair_clock_shard *m_clock_shards;
     PAIR m_cleaner_head; // for cleaner thread. head is the next thing to look at for possible cleaning.
     PAIR m_checkpoint_head; // for begin checkpoint to iterate over PAIRs and mark as pending_checkpoint
     PAIR m_pending_head; // list of pairs marked with checkpoint_pending
@@ -324,7 +372,25 @@ public:
     //
     toku_pthread_rwlock_t m_pending_lock_expensive;
     toku_pthread_rwlock_t m_pending_lock_cheap;
-    void init();
+
+    // state for optimistic lookups
+    bool m_optimistic_lookup; // true if read pins may try the lock-free path
+    uint64_t m_lookup_epoch;
+    pair_lookup_epoch_slot *m_lookup_slots;
+    // protects the list of retired PAIRs, and serializes grace periods
+    toku_mutex_t m_retire_lock;
+    PAIR m_retired_head;
+    uint32_t m_num_retired;
+
+    // variables for engine status
+    PARTITIONED_COUNTER m_fast_pins;
+    PARTITIONED_COUNTER m_slow_pins;
+    // per clock shard, only created in NUMA mode
+    PARTITIONED_COUNTER m_numa_pins[EVICTOR_MAX_SHARDS];
+    PARTITIONED_COUNTER m_numa_remote_pins[EVICTOR_MAX_SHARDS];
+    PARTITIONED_COUNTER m_numa_misses[EVICTOR_MAX_SHARDS];
+
+    void init(bool numa = false);
     void destroy();
     void evict_completely(PAIR pair);
     void evict_from_cachetable(PAIR pair);
@@ -332,6 +398,11 @@ public:
     void add_to_cachetable_only(PAIR p);
     void put(PAIR pair);
     PAIR find_pair(CACHEFILE file, CACHEKEY key, uint32_t hash);
+    PAIR find_and_read_pin_optimistic(CACHEFILE file, CACHEKEY key, uint32_t hash);
+    void retire_pair(PAIR p);
+    void note_pin(PAIR p, bool fast_path);
+    void note_miss();
+    void fill_engine_status();
     void pending_pairs_remove (PAIR p);
     void verify();
     void get_state(int *num_entries, int *hash_size);
@@ -347,15 +418,24 @@ public:
     void read_pending_cheap_unlock();
     void write_pending_cheap_lock();
     void write_pending_cheap_unlock();
+    uint32_t clock_shard_of(PAIR p) const;
+    uint32_t numa_shard_of(uint32_t numa_node) const;
+    uint32_t current_numa_node() const;
     toku_mutex_t* get_mutex_for_pair(uint32_t fullhash);
     void pair_lock_by_fullhash(uint32_t fullhash);
     void pair_unlock_by_fullhash(uint32_t fullhash);
 
 private:
+    uint64_t lookup_epoch_enter(uint32_t *slot);
+    void lookup_epoch_exit(uint32_t slot, uint64_t epoch);
+    void wait_for_lookups_to_drain();
+    void free_retired_pairs(PAIR head);
     void pair_remove (PAIR p);
     void remove_from_hash_chain(PAIR p);
     void add_to_cf_list (PAIR p);
     void add_to_clock (PAIR p);
+    void add_to_clock_shard (PAIR p);
+    void remove_from_clock_shard (PAIR p);
     void add_to_hash_chain(PAIR p);
 };
 
@@ -412,6 +492,13 @@ public:
     void begin_checkpoint();
     void add_background_job();
     void remove_background_job();
+    void set_write_depth(uint32_t depth);
+    uint32_t get_write_depth();
+    void get_write_progress(uint64_t *pending, uint64_t *processed, uint64_t *writing);
+    void set_paced(bool paced);
+    bool get_paced();
+    bool pace(uint64_t usec, bool (*hurry)(void));
+    void get_pace(uint64_t *bytes_per_sec, uint64_t *sleep_usec);
     void end_checkpoint(void (*testcallback_f)(void*),  void* testextra);
     TOKULOGGER get_logger();
     // used during begin_checkpoint
@@ -431,6 +518,25 @@ private:
     // variable used by the checkpoint thread to know
     // when all work induced by cloning on client threads is done
     BACKGROUND_JOB_MANAGER m_checkpoint_clones_bjm;
+    // the checkpoint thread hands at most m_write_depth cloned pairs
+    // to the checkpointing kibbutz before waiting for one of them to
+    // be written, 0 means it writes every pair itself
+    uint32_t m_write_depth;
+    // protects m_clones_writing, signals m_clone_written when it drops
+    toku_mutex_t m_clones_mutex;
+    toku_cond_t m_clone_written;
+    uint64_t m_clones_writing;
+    // write-out progress for engine status
+    uint64_t m_pairs_pending;
+    uint64_t m_pairs_processed;
+    // pacing of the write-out, m_pace_usec is 0 when it is not paced
+    bool m_paced;
+    uint64_t m_pending_dirty_bytes;
+    uint64_t m_pace_usec;
+    uint64_t m_pace_start;
+    bool (*m_pace_hurry)(void);
+    uint64_t m_pace_rate;
+    uint64_t m_pace_sleep_usec;
     // private methods for begin_checkpoint    
     void update_cachefiles();
     void log_begin_checkpoint();
@@ -438,6 +544,8 @@ private:
     // private methods for end_checkpoint    
     void fill_checkpoint_cfs(CACHEFILE* checkpoint_cfs);
     void checkpoint_pending_pairs();
+    void wait_for_clone_write_slot(uint32_t write_depth);
+    void pace_write_out(uint64_t bytes_written);
     void checkpoint_userdata(CACHEFILE* checkpoint_cfs);
     void log_end_checkpoint();
     void end_checkpoint_userdata(CACHEFILE* checkpoint_cfs);
@@ -453,6 +561,47 @@ private:
 //
 const int EVICTION_PERIOD = 1;
 
+//
+// State of one shard of the evictor. Shard 0 is run by the main
+// eviction thread, every other shard by a worker thread of its own
+// that the main eviction thread wakes up whenever eviction is needed.
+//
+struct evictor_shard {
+    evictor *ev;
+    uint32_t id;
+    toku_pthread_t thread;
+    bool thread_init;
+    // protected by the evictor's ev_thread_lock
+    toku_cond_t cond;
+    bool active; // true from when the shard is asked to run until it is done
+    // used to calculate random numbers
+    struct random_data random_data;
+    char random_statebuf[64];
+    // variables for engine status, only written by the shard's thread
+    uint64_t pairs_examined;
+    uint64_t evictions; // number of full and partial evictions started
+    // in NUMA mode, the sum of the sizes of the PAIRs on the shard's nodes
+    int64_t numa_size;
+};
+
+//
+// A replacement policy decides how pins and the clock hand age PAIRs.
+// pair_added and pair_evicting are called with the PAIR's mutex held,
+// pair_touched may also be called for a PAIR that was pinned without it.
+//
+struct replacement_policy {
+    toku_cachetable_policy type;
+    // a PAIR was added to the cachetable, the list lock is held for writing
+    void (*pair_added)(evictor *ev, PAIR p);
+    // a client pinned the PAIR
+    void (*pair_touched)(PAIR p);
+    // the clock hand is about to evict the PAIR completely
+    void (*pair_evicting)(evictor *ev, PAIR p);
+};
+
+// number of evicted PAIRs the ghost list of the evictor remembers, a power of two
+const uint32_t EVICTOR_GHOST_SLOTS = 1 << 16;
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // The evictor handles the removal of pairs from the pair list/cachetable.
@@ -461,14 +610,15 @@ class evictor {
 public:
     int init(long _size_limit, pair_list* _pl, cachefile_list* _cf_list, KIBBUTZ _kibbutz, uint32_t eviction_period);
     void destroy();
-    void add_pair_attr(PAIR_ATTR attr);
-    void remove_pair_attr(PAIR_ATTR attr);    
-    void change_pair_attr(PAIR_ATTR old_attr, PAIR_ATTR new_attr);
+    void add_pair_attr(PAIR_ATTR attr, uint32_t numa_node);
+    void remove_pair_attr(PAIR_ATTR attr, uint32_t numa_node);
+    void change_pair_attr(PAIR_ATTR old_attr, PAIR_ATTR new_attr, uint32_t numa_node);
     void add_cloned_data_size(long size);
     void remove_cloned_data_size(long size);
     uint64_t reserve_memory(double fraction, uint64_t upper_bound);
     void release_reserved_memory(uint64_t reserved_memory);
     void run_eviction_thread();
+    void run_eviction_shard_thread(evictor_shard *shard);
     void do_partial_eviction(PAIR p);
     void evict_pair(PAIR p, bool checkpoint_pending);
     void wait_for_cache_pressure_to_subside();
@@ -478,18 +628,28 @@ public:
     bool should_client_wake_eviction_thread();
     // function needed for testing
     void get_state(long *size_current_ptr, long *size_limit_ptr);
+    uint64_t get_cache_pressure_size(void);
     void fill_engine_status();
     void set_enable_partial_eviction(bool enabled);
     bool get_enable_partial_eviction(void) const;
+    void set_replacement_policy(toku_cachetable_policy policy);
+    toku_cachetable_policy get_replacement_policy(void) const;
+    void pair_added(PAIR p);
+    void touch_pair(PAIR p);
+    // ghost list, used by replacement policies to recognize re-read PAIRs
+    void remember_evicted_pair(PAIR p);
+    bool forget_evicted_pair(PAIR p);
 private:
     void add_to_size_current(long size);
     void remove_from_size_current(long size);
     void run_eviction();
-    bool run_eviction_on_pair(PAIR p);
+    void run_eviction_on_shard(evictor_shard *shard);
+    bool run_eviction_on_pair(PAIR p, evictor_shard *shard);
     void try_evict_pair(PAIR p);
     void decrease_size_evicting(long size_evicting_estimate);
     bool should_sleeping_clients_wakeup();
     bool eviction_needed();
+    bool shard_over_numa_budget(evictor_shard *shard);
 
     // We have some intentional races with these variables because we're ok with reading something a little bit old.
     // Provide some hooks for reading variables in an unsafe way so that there are function names we can stick in a valgrind suppression.
@@ -512,10 +672,16 @@ private:
     int64_t m_high_size_hysteresis; // if > cachetable size, then sleeping client threads may wake up
 
     bool m_enable_partial_eviction; // true if partial evictions are permitted
+    const replacement_policy *m_policy;
 
-    // used to calculate random numbers
-    struct random_data m_random_data;
-    char m_random_statebuf[64];
+    // keys of recently evicted PAIRs, indexed by fullhash. Slots are read
+    // and written racily, a lost update only costs a missed promotion.
+    uint64_t *m_ghost_keys;
+    uint64_t m_ghost_hits; // protected by the pair list's write lock
+
+    // one per clock shard of the pair list
+    uint32_t m_num_shards;
+    evictor_shard *m_shards;
 
     // mutex that protects fields listed immedietly below
     toku_mutex_t m_ev_thread_lock;
@@ -532,6 +698,8 @@ private:
     bool m_run_thread;
     // bool that states if the eviction thread is currently running
     bool m_ev_thread_is_running;
+    // number of shards that are running, or have been asked to run, eviction
+    uint32_t m_num_shards_running;
     // period which the eviction thread sleeps
     uint32_t m_period_in_seconds;
     // condition variable on which client threads wait on when sleeping
@@ -573,11 +741,27 @@ public:
     void set_iterations(uint32_t new_iterations);
     uint32_t get_period_unlocked(void);
     void set_period(uint32_t new_period);
+    void set_adaptive(bool adaptive);
+    bool get_adaptive(void);
+    void set_max_threads(uint32_t max_threads);
+    uint32_t get_max_threads(void);
+    void fill_engine_status(void);
     int run_cleaner(void);
+    void run_cleaner_iterations(uint32_t num_iterations);
     
 private:
     pair_list* m_pl;
     CACHETABLE m_ct;
+    // serializes picking a PAIR to clean when several threads clean at once
+    toku_mutex_t m_pick_mutex;
+    // when adaptive, the number of threads and iterations of each run of
+    // the cleaner follow the bytes buffered in the cachetable
+    bool m_adaptive;
+    uint32_t m_max_threads;
+    // decisions of the last adaptive run, for engine status
+    uint64_t m_adaptive_threads;
+    uint64_t m_adaptive_iterations;
+    uint64_t m_adaptive_idle_runs;
     struct minicron m_cleaner_cron; // the periodic cleaner thread
     uint32_t m_cleaner_iterations; // how many times to run the cleaner per
                                   // cleaner period (minicron has a
@@ -91,6 +91,10 @@ static uint64_t cachetable_prefetches;    // how many times has a block been pre
 static uint64_t cachetable_evictions;
 static uint64_t cleaner_executions; // number of times the cleaner thread's loop has executed
 
+// number of eviction clock shards for cachetables created from now on,
+// 0 means a number chosen from the number of processors
+static uint32_t cachetable_evictor_shards;
+
 
 // Note, toku_cachetable_get_status() is below, after declaration of cachetable.
 
@@ -181,6 +185,8 @@ toku_cachetable_get_status(CACHETABLE ct, CACHETABLE_STATUS statp) {
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_TOTAL_ITEMS_PROCESSED),
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_TOTAL_EXECUTION_TIME));
     ct->ev.fill_engine_status();
+    ct->list.fill_engine_status();
+    ct->cl.fill_engine_status();
     *statp = ct_status;
 }
 
@@ -243,6 +249,22 @@ uint32_t toku_get_cleaner_iterations_unlocked (CACHETABLE ct) {
     return ct->cl.get_iterations();
 }
 
+void toku_set_cleaner_adaptive (CACHETABLE ct, bool adaptive) {
+    ct->cl.set_adaptive(adaptive);
+}
+
+bool toku_get_cleaner_adaptive (CACHETABLE ct) {
+    return ct->cl.get_adaptive();
+}
+
+void toku_set_cleaner_max_threads (CACHETABLE ct, uint32_t max_threads) {
+    ct->cl.set_max_threads(max_threads);
+}
+
+uint32_t toku_get_cleaner_max_threads (CACHETABLE ct) {
+    return ct->cl.get_max_threads();
+}
+
 void toku_set_enable_partial_eviction (CACHETABLE ct, bool enabled) {
     ct->ev.set_enable_partial_eviction(enabled);
 }
@@ -251,6 +273,50 @@ bool toku_get_enable_partial_eviction (CACHETABLE ct) {
     return ct->ev.get_enable_partial_eviction();
 }
 
+void toku_set_replacement_policy (CACHETABLE ct, toku_cachetable_policy policy) {
+    ct->ev.set_replacement_policy(policy);
+}
+
+toku_cachetable_policy toku_get_replacement_policy (CACHETABLE ct) {
+    return ct->ev.get_replacement_policy();
+}
+
+void toku_cachetable_set_evictor_shards(uint32_t num_shards) {
+    toku_unsafe_set(&cachetable_evictor_shards, num_shards);
+}
+
+void toku_set_enable_optimistic_pair_lookup (CACHETABLE ct, bool enabled) {
+    toku_unsafe_set(&ct->list.m_optimistic_lookup, enabled);
+}
+
+bool toku_get_enable_optimistic_pair_lookup (CACHETABLE ct) {
+    return toku_unsafe_fetch(&ct->list.m_optimistic_lookup);
+}
+
+void toku_set_checkpoint_write_depth (CACHETABLE ct, uint32_t depth) {
+    ct->cp.set_write_depth(depth);
+}
+
+uint32_t toku_get_checkpoint_write_depth (CACHETABLE ct) {
+    return ct->cp.get_write_depth();
+}
+
+void toku_cachetable_get_checkpoint_write_progress (CACHETABLE ct, uint64_t *pending, uint64_t *processed, uint64_t *writing) {
+    ct->cp.get_write_progress(pending, processed, writing);
+}
+
+void toku_set_checkpoint_paced (CACHETABLE ct, bool paced) {
+    ct->cp.set_paced(paced);
+}
+
+bool toku_get_checkpoint_paced (CACHETABLE ct) {
+    return ct->cp.get_paced();
+}
+
+void toku_cachetable_get_checkpoint_pace (CACHETABLE ct, uint64_t *bytes_per_sec, uint64_t *sleep_usec) {
+    ct->cp.get_pace(bytes_per_sec, sleep_usec);
+}
+
 // reserve 25% as "unreservable".  The loader cannot have it.
 #define unreservable_memory(size) ((size)/4)
 
@@ -258,6 +324,7 @@ int toku_cachetable_create_ex(CACHETABLE *ct_result, long size_limit,
                            unsigned long client_pool_threads,
                            unsigned long cachetable_pool_threads,
                            unsigned long checkpoint_pool_threads,
+                           bool numa,
                            LSN UU(initial_lsn), TOKULOGGER logger) {
     int result = 0;
     int r;
@@ -267,25 +334,29 @@ int toku_cachetable_create_ex(CACHETABLE *ct_result, long size_limit,
     }
 
     CACHETABLE XCALLOC(ct);
-    ct->list.init();
+    ct->list.init(numa);
     ct->cf_list.init();
 
     int num_processors = toku_os_get_number_active_processors();
     int checkpointing_nworkers = (num_processors/4) ? num_processors/4 : 1;
-    r = toku_kibbutz_create(client_pool_threads ? client_pool_threads : num_processors,
-                            &ct->client_kibbutz);
+    int (*kibbutz_create)(int, KIBBUTZ *);
+    kibbutz_create = numa ? toku_kibbutz_create_numa : toku_kibbutz_create;
+    r = kibbutz_create(client_pool_threads ? client_pool_threads : num_processors,
+                       &ct->client_kibbutz);
     if (r != 0) {
         result = r;
         goto cleanup;
     }
-    r = toku_kibbutz_create(cachetable_pool_threads ? cachetable_pool_threads : 2*num_processors,
-                            &ct->ct_kibbutz);
+    r = kibbutz_create(cachetable_pool_threads ? cachetable_pool_threads : 2*num_processors,
+                       &ct->ct_kibbutz);
     if (r != 0) {
         result = r;
         goto cleanup;
     }
-    r = toku_kibbutz_create(checkpoint_pool_threads ? checkpoint_pool_threads : checkpointing_nworkers,
-                            &ct->checkpointing_kibbutz);
+    if (checkpoint_pool_threads == 0) {
+        checkpoint_pool_threads = checkpointing_nworkers;
+    }
+    r = kibbutz_create(checkpoint_pool_threads, &ct->checkpointing_kibbutz);
     if (r != 0) {
         result = r;
         goto cleanup;
@@ -301,6 +372,9 @@ int toku_cachetable_create_ex(CACHETABLE *ct_result, long size_limit,
         result = r;
         goto cleanup;
     }
+    // keep every checkpointing thread busy while the checkpoint
+    // thread clones the next pairs
+    ct->cp.set_write_depth(2 * checkpoint_pool_threads);
     r = ct->cl.init(1, &ct->list, ct); // by default, start with one iteration
     if (r != 0) {
         result = r;
@@ -595,7 +669,84 @@ uint32_t toku_cachetable_hash (CACHEFILE cachefile, BLOCKNUM key)
 
 // Requires pair's mutex to be held
 static void pair_touch (PAIR p) {
-    p->count = (p->count < CLOCK_SATURATION) ? p->count+1 : CLOCK_SATURATION;
+    p->ev->touch_pair(p);
+}
+
+// Touches a PAIR that was pinned without its mutex. Racing with the
+// evictor may lose an update, which is harmless for a replacement
+// heuristic, so the policies only access the clock state racily.
+static void pair_touch_unlocked(PAIR p) {
+    p->ev->touch_pair(p);
+}
+
+static void clock_count_increment(PAIR p) {
+    uint32_t count = toku_unsafe_fetch(&p->count);
+    if (count < CLOCK_SATURATION) {
+        toku_unsafe_set(&p->count, count + 1);
+    }
+}
+
+//
+// CLOCK: every pin bumps the clock count of the PAIR.
+//
+static void clock_pair_added(evictor *UU(ev), PAIR p) {
+    p->hot = true;
+}
+
+static void clock_pair_touched(PAIR p) {
+    clock_count_increment(p);
+}
+
+static void clock_pair_evicting(evictor *UU(ev), PAIR UU(p)) {
+}
+
+static const replacement_policy clock_policy = {
+    .type = TOKU_CACHETABLE_POLICY_CLOCK,
+    .pair_added = clock_pair_added,
+    .pair_touched = clock_pair_touched,
+    .pair_evicting = clock_pair_evicting
+};
+
+//
+// 2Q: a PAIR starts out cold, with a clock count of 0, and pins of a
+// cold PAIR are ignored, so the clock hand evicts it the first time it
+// comes around no matter how often a scan pinned it in between. The
+// evictor remembers evicted PAIRs in its ghost list, and a PAIR that is
+// read back in while still remembered is hot and aged like with CLOCK.
+//
+static void two_q_pair_added(evictor *ev, PAIR p) {
+    if (ev->forget_evicted_pair(p)) {
+        p->hot = true;
+    } else {
+        p->hot = false;
+        p->count = 0;
+    }
+}
+
+static void two_q_pair_touched(PAIR p) {
+    if (toku_unsafe_fetch(&p->hot)) {
+        clock_count_increment(p);
+    }
+}
+
+static void two_q_pair_evicting(evictor *ev, PAIR p) {
+    ev->remember_evicted_pair(p);
+}
+
+static const replacement_policy two_q_policy = {
+    .type = TOKU_CACHETABLE_POLICY_2Q,
+    .pair_added = two_q_pair_added,
+    .pair_touched = two_q_pair_touched,
+    .pair_evicting = two_q_pair_evicting
+};
+
+// releases a read pin that was taken by find_and_read_pin_optimistic
+static void pair_release_fast_read_pin(PAIR p) {
+    if (!p->value_rwlock.try_read_unlock_fast()) {
+        pair_lock(p);
+        p->value_rwlock.read_unlock();
+        pair_unlock(p);
+    }
 }
 
 // Remove a pair from the cachetable, requires write list lock to be held and p->mutex to be held
@@ -604,7 +755,7 @@ static void pair_touch (PAIR p) {
 // removed.
 static void cachetable_remove_pair (pair_list* list, evictor* ev, PAIR p) {
     list->evict_completely(p);
-    ev->remove_pair_attr(p->attr);
+    ev->remove_pair_attr(p->attr, p->numa_node);
 }
 
 static void cachetable_free_pair(PAIR p) {
@@ -625,7 +776,9 @@ static void cachetable_free_pair(PAIR p) {
     // pass in NULL and -1, dummy values
     flush_callback(NULL, -1, key, value, &disk_data, write_extraargs, old_attr, &new_attr, false, false, true, false);
     
-    ctpair_destroy(p);
+    // an optimistic lookup may still be looking at p, so the pair_list
+    // destroys it once no such lookup can remain
+    p->list->retire_pair(p);
 }
 
 // assumes value_rwlock and disk_nb_mutex held on entry
@@ -722,7 +875,7 @@ static void cachetable_write_locked_pair(
         //
         if (new_attr.is_valid) {
             p->attr = new_attr;
-            ev->change_pair_attr(old_attr, new_attr);
+            ev->change_pair_attr(old_attr, new_attr, p->numa_node);
         }
     }
     // the pair is no longer dirty once written
@@ -789,6 +942,7 @@ void pair_init(PAIR p,
     p->attr = attr;
     p->dirty = dirty;
     p->fullhash = fullhash;
+    p->numa_node = list->current_numa_node();
 
     p->flush_callback = write_callback.flush_callback;
     p->pe_callback = write_callback.pe_callback;
@@ -799,6 +953,7 @@ void pair_init(PAIR p,
     p->write_extraargs = write_callback.write_extraargs;
 
     p->count = 0;  // <CER> Is zero the correct init value?
+    p->hot = false;
     p->refcount = 0;
     p->num_waiting_on_refs = 0;
     toku_cond_init(*cachetable_p_refcount_wait_key, &p->refcount_wait, nullptr);
@@ -822,6 +977,7 @@ void pair_init(PAIR p,
     p->list = list;
 
     p->clock_next = p->clock_prev = NULL;
+    p->evict_next = p->evict_prev = NULL;
     p->pending_next = p->pending_prev = NULL;
     p->cf_next = p->cf_prev = NULL;
     p->hash_chain = NULL;
@@ -857,7 +1013,8 @@ static PAIR cachetable_insert_at(CACHETABLE ct,
         );
 
     ct->list.put(p);
-    ct->ev.add_pair_attr(attr);
+    ct->ev.pair_added(p);
+    ct->ev.add_pair_attr(attr, p->numa_node);
     return p;
 }
 
@@ -865,7 +1022,8 @@ static PAIR cachetable_insert_at(CACHETABLE ct,
 // the pair's mutex must be held as wel
 static void cachetable_insert_pair_at(CACHETABLE ct, PAIR p, PAIR_ATTR attr) {
     ct->list.put(p);
-    ct->ev.add_pair_attr(attr);
+    ct->ev.pair_added(p);
+    ct->ev.add_pair_attr(attr, p->numa_node);
 }
 
 
@@ -929,7 +1087,7 @@ clone_pair(evictor* ev, PAIR p) {
     p->dirty = CACHETABLE_CLEAN;
     if (new_attr.is_valid) {
         p->attr = new_attr;
-        ev->change_pair_attr(old_attr, new_attr);
+        ev->change_pair_attr(old_attr, new_attr, p->numa_node);
     }
     p->cloned_value_size = clone_size;
     ev->add_cloned_data_size(p->cloned_value_size);
@@ -1004,7 +1162,7 @@ write_locked_pair_for_checkpoint(CACHETABLE ct, PAIR p, bool checkpoint_pending)
 //           Else release write lock
 //
 static void
-write_pair_for_checkpoint_thread (evictor* ev, PAIR p)
+write_pair_for_checkpoint_thread (evictor* ev, PAIR p, bool write_clone_on_writer_thread)
 {
     // Grab an exclusive lock on the pair.
     // If we grab an expensive lock, then other threads will return
@@ -1037,7 +1195,13 @@ write_pair_for_checkpoint_thread (evictor* ev, PAIR p)
         // now release value_rwlock, before we write the PAIR out
         // so that the PAIR is available to client threads
         p->value_rwlock.write_unlock(); // didn't call cachetable_evict_pair so we have to unlock it ourselves.
-        if (p->clone_callback) {
+        if (p->clone_callback && write_clone_on_writer_thread) {
+            // responsibility of writer thread to release disk_nb_mutex
+            CACHETABLE ct = p->cachefile->cachetable;
+            ct->cp.add_background_job();
+            checkpoint_cloned_pair_on_writer_thread(ct, p);
+        }
+        else if (p->clone_callback) {
             // note that pending lock is not needed here because
             // we KNOW we are in the middle of a checkpoint
             // and that a begin_checkpoint cannot happen
@@ -1248,7 +1412,7 @@ do_partial_fetch(
     int r = pf_callback(p->value_data, p->disk_data, read_extraargs, cachefile->fd, &new_attr);
     lazy_assert_zero(r);
     p->attr = new_attr;
-    ct->ev.change_pair_attr(old_attr, new_attr);
+    ct->ev.change_pair_attr(old_attr, new_attr, p->numa_node);
     pair_lock(p);
     nb_mutex_unlock(&p->disk_nb_mutex);
     if (!keep_pair_locked) {
@@ -1358,7 +1522,7 @@ static void cachetable_fetch_pair(
     p->value_data = toku_value;
     p->disk_data = disk_data;
     p->attr = attr;
-    ct->ev.add_pair_attr(attr);
+    ct->ev.add_pair_attr(attr, p->numa_node);
     pair_lock(p);
     nb_mutex_unlock(&p->disk_nb_mutex);
     if (!keep_pair_locked) {
@@ -1588,6 +1752,21 @@ beginning:
         ct->ev.wait_for_cache_pressure_to_subside();
     }
 
+    if (lock_type == PL_READ) {
+        // Try to read pin a resident PAIR without the bucket mutex.
+        // If a partial fetch is required, we need the regular path anyway.
+        PAIR fast_p = ct->list.find_and_read_pin_optimistic(cachefile, key, fullhash);
+        if (fast_p) {
+            if (!pf_req_callback(fast_p->value_data, read_extraargs)) {
+                pair_touch_unlocked(fast_p);
+                ct->list.note_pin(fast_p, true);
+                *value = fast_p->value_data;
+                return 0;
+            }
+            pair_release_fast_read_pin(fast_p);
+        }
+    }
+
     ct->list.pair_lock_by_fullhash(fullhash);
     PAIR p = ct->list.find_pair(cachefile, key, fullhash);
     if (p) {
@@ -1713,6 +1892,7 @@ beginning:
         // fetch because begin_checkpoint will mark as pending any pair that is locked even if it is clean.        
         cachetable_fetch_pair(ct, cachefile, p, fetch_callback, read_extraargs, true);
         cachetable_miss++;
+        ct->list.note_miss();
         cachetable_misstime += get_tnow() - t0;
 
         // If the lock_type requested was a PL_READ, we downgrade to PL_READ,
@@ -1739,6 +1919,7 @@ beginning:
         goto got_value;
     }
 got_value:
+    ct->list.note_pin(p, false);
     *value = p->value_data;
     return 0;
 }
@@ -1892,6 +2073,13 @@ cachetable_unpin_internal(
     CACHETABLE ct = cachefile->cachetable;
     bool added_data_to_cachetable = false;
 
+    // A clean unpin that changes nothing can release a read lock without
+    // the pair's mutex. This always fails for a write lock, because the
+    // lock-free read path is closed while a writer holds the lock.
+    if (!dirty && !attr.is_valid && p->value_rwlock.try_read_unlock_fast()) {
+        return 0;
+    }
+
     // hack for #3969, only exists in case where we run unlockers
     pair_lock(p);
     PAIR_ATTR old_attr = p->attr;
@@ -1910,7 +2098,7 @@ cachetable_unpin_internal(
         if (new_attr.size > old_attr.size) {
             added_data_to_cachetable = true;
         }
-        ct->ev.change_pair_attr(old_attr, new_attr);
+        ct->ev.change_pair_attr(old_attr, new_attr, p->numa_node);
     }
 
     // see comments above this function to understand this code
@@ -2025,6 +2213,19 @@ int toku_cachetable_get_and_pin_nonblocking(
         lock_type == PL_WRITE_EXPENSIVE
         );
 try_again:
+    if (lock_type == PL_READ) {
+        PAIR fast_p = ct->list.find_and_read_pin_optimistic(cf, key, fullhash);
+        if (fast_p) {
+            if (!pf_req_callback(fast_p->value_data, read_extraargs)) {
+                pair_touch_unlocked(fast_p);
+                ct->list.note_pin(fast_p, true);
+                *value = fast_p->value_data;
+                return 0;
+            }
+            pair_release_fast_read_pin(fast_p);
+        }
+    }
+
     ct->list.pair_lock_by_fullhash(fullhash);
     PAIR p = ct->list.find_pair(cf, key, fullhash);
     if (p == NULL) {
@@ -2075,6 +2276,7 @@ try_again:
         uint64_t t0 = get_tnow();
         cachetable_fetch_pair(ct, cf, p, fetch_callback, read_extraargs, false);
         cachetable_miss++;
+        ct->list.note_miss();
         cachetable_misstime += get_tnow() - t0;
 
         if (ct->ev.should_client_thread_sleep()) {
@@ -2147,6 +2349,7 @@ try_again:
             return TOKUDB_TRY_AGAIN;
         }
         else {
+            ct->list.note_pin(p, false);
             *value = p->value_data;
             return 0;    
         }
@@ -2193,25 +2396,27 @@ static void cachetable_partial_reader(void* extra) {
     toku_free(cpargs);
 }
 
-int toku_cachefile_prefetch(CACHEFILE cf, CACHEKEY key, uint32_t fullhash,
-                            CACHETABLE_WRITE_CALLBACK write_callback,
-                            CACHETABLE_FETCH_CALLBACK fetch_callback,
-                            CACHETABLE_PARTIAL_FETCH_REQUIRED_CALLBACK pf_req_callback,
-                            CACHETABLE_PARTIAL_FETCH_CALLBACK pf_callback,
-                            void *read_extraargs,
-                            bool *doing_prefetch)
-// Effect: See the documentation for this function in cachetable/cachetable.h
+enum cachefile_prefetch_kind {
+    CACHEFILE_PREFETCH_NONE = 0,
+    CACHEFILE_PREFETCH_FETCH,
+    CACHEFILE_PREFETCH_PARTIAL_FETCH
+};
+
+// Effect: Finds the pair for key, creating it if it is not in the
+//  cachetable, and decides whether it must be fetched or partially
+//  fetched. If so, the pair is returned in *pp, write locked, and a
+//  background job is added to the cachefile's bjm, both of which the
+//  caller hands to a kibbutz job that does the fetch.
+static enum cachefile_prefetch_kind
+cachefile_prefetch_begin(CACHEFILE cf, CACHEKEY key, uint32_t fullhash,
+                         CACHETABLE_WRITE_CALLBACK write_callback,
+                         CACHETABLE_PARTIAL_FETCH_REQUIRED_CALLBACK pf_req_callback,
+                         void *read_extraargs,
+                         PAIR *pp)
 {
     int r = 0;
     PAIR p = NULL;
-    if (doing_prefetch) {
-        *doing_prefetch = false;
-    }
     CACHETABLE ct = cf->cachetable;
-    // if cachetable has too much data, don't bother prefetching
-    if (ct->ev.should_client_thread_sleep()) {
-        goto exit;
-    }
     ct->list.pair_lock_by_fullhash(fullhash);
     // lookup
     p = ct->list.find_pair(cf, key, fullhash);
@@ -2243,16 +2448,8 @@ int toku_cachefile_prefetch(CACHEFILE cf, CACHEKEY key, uint32_t fullhash,
         p->value_rwlock.write_lock(true);
         pair_unlock(p);
         ct->list.write_list_unlock();
-        
-        struct cachefile_prefetch_args *MALLOC(cpargs);
-        cpargs->p = p;
-        cpargs->fetch_callback = fetch_callback;
-        cpargs->read_extraargs = read_extraargs;
-        toku_kibbutz_enq(ct->ct_kibbutz, cachetable_reader, cpargs);
-        if (doing_prefetch) {
-            *doing_prefetch = true;
-        }
-        goto exit;
+        *pp = p;
+        return CACHEFILE_PREFETCH_FETCH;
     }
 
 found_pair:
@@ -2269,14 +2466,8 @@ found_pair:
         if (partial_fetch_required) {
             r = bjm_add_background_job(cf->bjm);
             assert_zero(r);
-            struct cachefile_partial_prefetch_args *MALLOC(cpargs);
-            cpargs->p = p;
-            cpargs->pf_callback = pf_callback;
-            cpargs->read_extraargs = read_extraargs;
-            toku_kibbutz_enq(ct->ct_kibbutz, cachetable_partial_reader, cpargs);
-            if (doing_prefetch) {
-                *doing_prefetch = true;
-            }
+            *pp = p;
+            return CACHEFILE_PREFETCH_PARTIAL_FETCH;
         }
         else {
             pair_lock(p);
@@ -2288,7 +2479,182 @@ found_pair:
         // Couldn't get the write lock cheaply
         pair_unlock(p);
     }
-exit:
+    return CACHEFILE_PREFETCH_NONE;
+}
+
+int toku_cachefile_prefetch(CACHEFILE cf, CACHEKEY key, uint32_t fullhash,
+                            CACHETABLE_WRITE_CALLBACK write_callback,
+                            CACHETABLE_FETCH_CALLBACK fetch_callback,
+                            CACHETABLE_PARTIAL_FETCH_REQUIRED_CALLBACK pf_req_callback,
+                            CACHETABLE_PARTIAL_FETCH_CALLBACK pf_callback,
+                            void *read_extraargs,
+                            bool *doing_prefetch)
+// Effect: See the documentation for this function in cachetable/cachetable.h
+{
+    PAIR p = NULL;
+    if (doing_prefetch) {
+        *doing_prefetch = false;
+    }
+    CACHETABLE ct = cf->cachetable;
+    // if cachetable has too much data, don't bother prefetching
+    if (ct->ev.should_client_thread_sleep()) {
+        return 0;
+    }
+    switch (cachefile_prefetch_begin(cf, key, fullhash, write_callback, pf_req_callback, read_extraargs, &p)) {
+    case CACHEFILE_PREFETCH_FETCH: {
+        struct cachefile_prefetch_args *MALLOC(cpargs);
+        cpargs->p = p;
+        cpargs->fetch_callback = fetch_callback;
+        cpargs->read_extraargs = read_extraargs;
+        toku_kibbutz_enq(ct->ct_kibbutz, cachetable_reader, cpargs);
+        break;
+    }
+    case CACHEFILE_PREFETCH_PARTIAL_FETCH: {
+        struct cachefile_partial_prefetch_args *MALLOC(cpargs);
+        cpargs->p = p;
+        cpargs->pf_callback = pf_callback;
+        cpargs->read_extraargs = read_extraargs;
+        toku_kibbutz_enq(ct->ct_kibbutz, cachetable_partial_reader, cpargs);
+        break;
+    }
+    case CACHEFILE_PREFETCH_NONE:
+        return 0;
+    }
+    if (doing_prefetch) {
+        *doing_prefetch = true;
+    }
+    return 0;
+}
+
+struct cachefile_batch_prefetch_args {
+    CACHEFILE cf;
+    CACHETABLE_FETCH_CALLBACK fetch_callback;
+    CACHETABLE_PARTIAL_FETCH_CALLBACK pf_callback;
+    CACHETABLE_PREFETCH_READ_CALLBACK read_callback;
+    CACHETABLE_PREFETCH_DONE_CALLBACK done_callback;
+    void *batch_extra;
+    // the pairs to fetch, sorted by key, and their read_extraargs
+    int n_fetch;
+    PAIR *fetch_pairs;
+    void **fetch_extraargs;
+    // the pairs to partially fetch, and their read_extraargs
+    int n_partial;
+    PAIR *partial_pairs;
+    void **partial_extraargs;
+};
+
+// Worker thread function to bring a batch of pairs into memory
+static void cachetable_batch_reader(void *extra) {
+    struct cachefile_batch_prefetch_args *cpargs = (struct cachefile_batch_prefetch_args *) extra;
+    CACHEFILE cf = cpargs->cf;
+    CACHETABLE ct = cf->cachetable;
+    if (cpargs->read_callback && cpargs->n_fetch > 0) {
+        CACHEKEY *XMALLOC_N(cpargs->n_fetch, keys);
+        for (int i = 0; i < cpargs->n_fetch; i++) {
+            keys[i] = cpargs->fetch_pairs[i]->key;
+        }
+        cpargs->read_callback(cf->fd, cpargs->n_fetch, keys, cpargs->fetch_extraargs, cpargs->batch_extra);
+        toku_free(keys);
+    }
+    for (int i = 0; i < cpargs->n_fetch; i++) {
+        cachetable_fetch_pair(ct, cf, cpargs->fetch_pairs[i], cpargs->fetch_callback, cpargs->fetch_extraargs[i], false);
+    }
+    for (int i = 0; i < cpargs->n_partial; i++) {
+        do_partial_fetch(ct, cf, cpargs->partial_pairs[i], cpargs->pf_callback, cpargs->partial_extraargs[i], false);
+    }
+    if (cpargs->done_callback) {
+        cpargs->done_callback(cpargs->batch_extra);
+    }
+    // each pair of the batch added a background job when it was write locked
+    for (int i = 0; i < cpargs->n_fetch + cpargs->n_partial; i++) {
+        bjm_remove_background_job(cf->bjm);
+    }
+    toku_free(cpargs->fetch_pairs);
+    toku_free(cpargs->fetch_extraargs);
+    toku_free(cpargs->partial_pairs);
+    toku_free(cpargs->partial_extraargs);
+    toku_free(cpargs);
+}
+
+int toku_cachefile_prefetch_batch(CACHEFILE cf, int n, CACHEKEY *keys, uint32_t *fullhashes,
+                                  CACHETABLE_WRITE_CALLBACK write_callback,
+                                  CACHETABLE_FETCH_CALLBACK fetch_callback,
+                                  CACHETABLE_PARTIAL_FETCH_REQUIRED_CALLBACK pf_req_callback,
+                                  CACHETABLE_PARTIAL_FETCH_CALLBACK pf_callback,
+                                  CACHETABLE_PREFETCH_READ_CALLBACK read_callback,
+                                  CACHETABLE_PREFETCH_DONE_CALLBACK done_callback,
+                                  void **read_extraargs,
+                                  void *batch_extra,
+                                  bool *doing_prefetch)
+// Effect: See the documentation for this function in cachetable/cachetable.h
+{
+    for (int i = 0; i < n; i++) {
+        doing_prefetch[i] = false;
+    }
+    CACHETABLE ct = cf->cachetable;
+    // if cachetable has too much data, don't bother prefetching
+    if (n == 0 || ct->ev.should_client_thread_sleep()) {
+        goto no_job;
+    }
+    {
+        // visit the keys in increasing order, so that the pairs
+        // to fetch end up sorted
+        int *XMALLOC_N(n, order);
+        for (int i = 0; i < n; i++) {
+            int j = i;
+            for (; j > 0 && keys[order[j - 1]].b > keys[i].b; j--) {
+                order[j] = order[j - 1];
+            }
+            order[j] = i;
+        }
+
+        struct cachefile_batch_prefetch_args *XCALLOC(cpargs);
+        cpargs->cf = cf;
+        cpargs->fetch_callback = fetch_callback;
+        cpargs->pf_callback = pf_callback;
+        cpargs->read_callback = read_callback;
+        cpargs->done_callback = done_callback;
+        cpargs->batch_extra = batch_extra;
+        XMALLOC_N(n, cpargs->fetch_pairs);
+        XMALLOC_N(n, cpargs->fetch_extraargs);
+        XMALLOC_N(n, cpargs->partial_pairs);
+        XMALLOC_N(n, cpargs->partial_extraargs);
+        for (int k = 0; k < n; k++) {
+            const int i = order[k];
+            PAIR p = NULL;
+            switch (cachefile_prefetch_begin(cf, keys[i], fullhashes[i], write_callback, pf_req_callback, read_extraargs[i], &p)) {
+            case CACHEFILE_PREFETCH_FETCH:
+                cpargs->fetch_pairs[cpargs->n_fetch] = p;
+                cpargs->fetch_extraargs[cpargs->n_fetch] = read_extraargs[i];
+                cpargs->n_fetch++;
+                doing_prefetch[i] = true;
+                break;
+            case CACHEFILE_PREFETCH_PARTIAL_FETCH:
+                cpargs->partial_pairs[cpargs->n_partial] = p;
+                cpargs->partial_extraargs[cpargs->n_partial] = read_extraargs[i];
+                cpargs->n_partial++;
+                doing_prefetch[i] = true;
+                break;
+            case CACHEFILE_PREFETCH_NONE:
+                break;
+            }
+        }
+        toku_free(order);
+
+        if (cpargs->n_fetch + cpargs->n_partial > 0) {
+            toku_kibbutz_enq(ct->ct_kibbutz, cachetable_batch_reader, cpargs);
+            return 0;
+        }
+        toku_free(cpargs->fetch_pairs);
+        toku_free(cpargs->fetch_extraargs);
+        toku_free(cpargs->partial_pairs);
+        toku_free(cpargs->partial_extraargs);
+        toku_free(cpargs);
+    }
+no_job:
+    if (done_callback) {
+        done_callback(batch_extra);
+    }
     return 0;
 }
 
@@ -2769,6 +3135,14 @@ cleanup:
 //             Use the begin_checkpoint callback to take necessary snapshots (header, btt)
 //             Mark every dirty node as "pending."  ("Pending" means that the node must be
 //                                                    written to disk before it can be modified.)
+uint32_t toku_cachetable_get_paced_checkpoint_period(CHECKPOINTER cp) {
+    return cp->get_paced() ? cp->get_checkpoint_period() : 0;
+}
+
+bool toku_cachetable_pace_checkpoint(CHECKPOINTER cp, uint64_t usec, bool (*hurry)(void)) {
+    return cp->pace(usec, hurry);
+}
+
 void toku_cachetable_begin_checkpoint (CHECKPOINTER cp, TOKULOGGER UU(logger)) {    
     cp->begin_checkpoint();
 }
@@ -3008,6 +3382,11 @@ cleaner_thread_rate_pair(PAIR p)
 }
 
 static int const CLEANER_N_TO_CHECK = 8;
+// an adaptive cleaner uses one more thread for every this percentage
+// of the cachetable's size that is buffered messages
+static uint64_t const CLEANER_PRESSURE_PERCENT_PER_THREAD = 5;
+// and at most this many times the cleaner iterations on each thread
+static uint64_t const CLEANER_MAX_ITERATIONS_SCALE = 4;
 
 int toku_cleaner_thread_for_test (CACHETABLE ct) {
     return ct->cl.run_cleaner();
@@ -3036,6 +3415,13 @@ int cleaner::init(uint32_t _cleaner_iterations, pair_list* _pl, CACHETABLE _ct)
     m_cleaner_iterations = _cleaner_iterations;
     m_pl = _pl;
     m_ct = _ct;
+    toku_mutex_init(toku_uninstrumented, &m_pick_mutex, nullptr);
+    m_adaptive = false;
+    int num_processors = toku_os_get_number_active_processors();
+    m_max_threads = (num_processors/4) ? num_processors/4 : 1;
+    m_adaptive_threads = 0;
+    m_adaptive_iterations = 0;
+    m_adaptive_idle_runs = 0;
     m_cleaner_init = true;
     return r;
 }
@@ -3050,6 +3436,8 @@ void cleaner::destroy(void) {
         int r = toku_minicron_shutdown(&m_cleaner_cron);
         assert(r==0);
     }
+    toku_mutex_destroy(&m_pick_mutex);
+    m_cleaner_init = false;
 }
 
 uint32_t cleaner::get_iterations(void) {
@@ -3071,6 +3459,99 @@ void cleaner::set_period(uint32_t new_period) {
     toku_minicron_change_period(&m_cleaner_cron, new_period*1000);
 }
 
+void cleaner::set_adaptive(bool adaptive) {
+    toku_unsafe_set(&m_adaptive, adaptive);
+}
+
+bool cleaner::get_adaptive(void) {
+    return toku_unsafe_fetch(&m_adaptive);
+}
+
+void cleaner::set_max_threads(uint32_t max_threads) {
+    toku_unsafe_set(&m_max_threads, max_threads ? max_threads : 1);
+}
+
+uint32_t cleaner::get_max_threads(void) {
+    return toku_unsafe_fetch(&m_max_threads);
+}
+
+void cleaner::fill_engine_status(void) {
+    CT_STATUS_VAL(CT_CLEANER_ADAPTIVE) = this->get_adaptive();
+    CT_STATUS_VAL(CT_CLEANER_ADAPTIVE_THREADS) = toku_unsafe_fetch(&m_adaptive_threads);
+    CT_STATUS_VAL(CT_CLEANER_ADAPTIVE_ITERATIONS) = toku_unsafe_fetch(&m_adaptive_iterations);
+    CT_STATUS_VAL(CT_CLEANER_ADAPTIVE_IDLE) = toku_unsafe_fetch(&m_adaptive_idle_runs);
+}
+
+struct cleaner_thread_extra {
+    cleaner *cl;
+    uint32_t num_iterations;
+    BACKGROUND_JOB_MANAGER bjm;
+};
+
+static void cleaner_thread_on_kibbutz(void *extra) {
+    struct cleaner_thread_extra *CAST_FROM_VOIDP(e, extra);
+    toku::context cleaner_ctx(CTX_CLEANER);
+    e->cl->run_cleaner_iterations(e->num_iterations);
+    bjm_remove_background_job(e->bjm);
+}
+
+// Effect: runs the cleaner for the configured number of iterations or,
+// when adaptive, sizes the run by the bytes buffered in the cachetable.
+//
+// An adaptive run does nothing if no messages are buffered. Otherwise it
+// does the cleaner iterations once for every CLEANER_PRESSURE_PERCENT_PER_THREAD
+// of the cachetable that is buffered, spread over up to m_max_threads
+// threads: the cleaner thread and jobs on the cachetable's kibbutz.
+int cleaner::run_cleaner(void) {
+    toku::context cleaner_ctx(CTX_CLEANER);
+
+    uint32_t num_iterations = this->get_iterations();
+    if (!this->get_adaptive()) {
+        this->run_cleaner_iterations(num_iterations);
+        return 0;
+    }
+
+    uint64_t buffered = m_ct->ev.get_cache_pressure_size();
+    if (buffered == 0 || num_iterations == 0) {
+        toku_unsafe_set(&m_adaptive_threads, (uint64_t) 0);
+        toku_unsafe_set(&m_adaptive_iterations, (uint64_t) 0);
+        toku_unsafe_set(&m_adaptive_idle_runs, m_adaptive_idle_runs + 1);
+        return 0;
+    }
+    long size_limit;
+    m_ct->ev.get_state(nullptr, &size_limit);
+    uint64_t bytes_per_thread = size_limit * CLEANER_PRESSURE_PERCENT_PER_THREAD / 100;
+    if (bytes_per_thread == 0) {
+        bytes_per_thread = 1;
+    }
+    // total iterations of this run, in proportion to the bytes buffered
+    uint64_t budget = (uint64_t) ((double) num_iterations * buffered / bytes_per_thread);
+    uint64_t max_threads = this->get_max_threads();
+    uint64_t wanted = (buffered + bytes_per_thread - 1) / bytes_per_thread;
+    uint64_t num_threads = wanted < max_threads ? wanted : max_threads;
+    uint64_t iterations = (budget + num_threads - 1) / num_threads;
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    if (iterations > num_iterations * CLEANER_MAX_ITERATIONS_SCALE) {
+        iterations = num_iterations * CLEANER_MAX_ITERATIONS_SCALE;
+    }
+    toku_unsafe_set(&m_adaptive_threads, num_threads);
+    toku_unsafe_set(&m_adaptive_iterations, iterations);
+
+    struct cleaner_thread_extra extra = { .cl = this, .num_iterations = (uint32_t) iterations, .bjm = nullptr };
+    bjm_init(&extra.bjm);
+    for (uint64_t i = 1; i < num_threads; i++) {
+        int r = bjm_add_background_job(extra.bjm);
+        assert_zero(r);
+        toku_kibbutz_enq(m_ct->ct_kibbutz, cleaner_thread_on_kibbutz, &extra);
+    }
+    this->run_cleaner_iterations(extra.num_iterations);
+    bjm_wait_for_jobs_to_finish(extra.bjm);
+    bjm_destroy(extra.bjm);
+    return 0;
+}
+
 // Effect:  runs a cleaner.
 //
 // We look through some number of nodes, the first N that we see which are
@@ -3081,13 +3562,11 @@ void cleaner::set_period(uint32_t new_period) {
 // cachefile that we're doing some background work (so a flush won't
 // start).  At this point, we can safely unlock the cachetable, do the
 // work (callback), and unlock/release our claim to the cachefile.
-int cleaner::run_cleaner(void) {
-    toku::context cleaner_ctx(CTX_CLEANER);
-
+void cleaner::run_cleaner_iterations(uint32_t num_iterations) {
     int r;
-    uint32_t num_iterations = this->get_iterations();
     for (uint32_t i = 0; i < num_iterations; ++i) {
-        cleaner_executions++;
+        toku_sync_fetch_and_add(&cleaner_executions, 1);
+        toku_mutex_lock(&m_pick_mutex);
         m_pl->read_list_lock();
         PAIR best_pair = NULL;
         int n_seen = 0;
@@ -3096,6 +3575,7 @@ int cleaner::run_cleaner(void) {
         if (first_pair == NULL) {
             // nothing in the cachetable, just get out now
             m_pl->read_list_unlock();
+            toku_mutex_unlock(&m_pick_mutex);
             break;
         }
         // here we select a PAIR for cleaning
@@ -3118,6 +3598,7 @@ int cleaner::run_cleaner(void) {
                 // Advance the cleaner head.
                 long score = 0;
                 // only bother with this pair if it has no current users
+                m_pl->m_cleaner_head->value_rwlock.close_fast_path();
                 if (m_pl->m_cleaner_head->value_rwlock.users() == 0) {
                     score = cleaner_thread_rate_pair(m_pl->m_cleaner_head);
                     if (score > best_score) {
@@ -3129,6 +3610,9 @@ int cleaner::run_cleaner(void) {
                 continue;
             }
             pair_lock(m_pl->m_cleaner_head);
+            // close the lock-free read path, so that users() stays exact
+            // for as long as we hold the pair's mutex
+            m_pl->m_cleaner_head->value_rwlock.close_fast_path();
             if (m_pl->m_cleaner_head->value_rwlock.users() > 0) {
                 pair_unlock(m_pl->m_cleaner_head);
             }
@@ -3152,6 +3636,14 @@ int cleaner::run_cleaner(void) {
             // Advance the cleaner head.
             m_pl->m_cleaner_head = m_pl->m_cleaner_head->clock_next;
         } while (m_pl->m_cleaner_head != first_pair && n_seen < CLEANER_N_TO_CHECK);
+        // In adaptive mode the next pick starts right after this one, so
+        // that the pairs this scan passed over are looked at again by the
+        // next iteration, on this or another cleaner thread, instead of
+        // waiting for the clock to come around.  The default cleaner keeps
+        // scanning on from where this scan stopped.
+        if (best_pair && this->get_adaptive()) {
+            m_pl->m_cleaner_head = best_pair->clock_next;
+        }
         m_pl->read_list_unlock();
 
         //
@@ -3170,10 +3662,13 @@ int cleaner::run_cleaner(void) {
             r = bjm_add_background_job(cf->bjm);
             if (r) {
                 pair_unlock(best_pair);
+                toku_mutex_unlock(&m_pick_mutex);
                 continue;
             }
             best_pair->value_rwlock.write_lock(true);
             pair_unlock(best_pair);
+            // once we hold its write lock, no other cleaner thread picks it
+            toku_mutex_unlock(&m_pick_mutex);
             // verify a key assumption.
             assert(cleaner_thread_rate_pair(best_pair) > 0);
             // check the checkpoint_pending bit
@@ -3214,6 +3709,7 @@ int cleaner::run_cleaner(void) {
             bjm_remove_background_job(cf->bjm);
         }
         else {
+            toku_mutex_unlock(&m_pick_mutex);
             // If we didn't find anything this time around the cachetable,
             // we probably won't find anything if we run around again, so
             // just break out from the for-loop now and 
@@ -3221,7 +3717,6 @@ int cleaner::run_cleaner(void) {
             break;
         }
     }
-    return 0;
 }
 
 static_assert(std::is_pod<pair_list>::value, "pair_list isn't POD");
@@ -3250,7 +3745,7 @@ static void evict_pair_from_cachefile(PAIR p) {
 
 // Allocates the hash table of pairs inside this pair list.
 //
-void pair_list::init() {
+void pair_list::init(bool numa) {
     m_table_size = INITIAL_PAIR_LIST_SIZE;
     m_num_locks = PAIR_LOCK_SIZE;
     m_n_in_table = 0;
@@ -3259,6 +3754,29 @@ void pair_list::init() {
     m_checkpoint_head = NULL;
     m_pending_head = NULL;
     m_table = NULL;
+
+    m_numa = numa;
+    m_numa_nodes = numa ? toku_os_numa_num_nodes() : 0;
+    m_num_clock_shards = 1;
+    if (m_numa) {
+        // one clock shard per NUMA node, rounded up to a power of two,
+        // nodes beyond EVICTOR_MAX_SHARDS share shards
+        while (m_num_clock_shards < m_numa_nodes &&
+               m_num_clock_shards < EVICTOR_MAX_SHARDS) {
+            m_num_clock_shards *= 2;
+        }
+    } else {
+        // one clock shard per 8 processors, rounded down to a power of two
+        uint32_t shards_wanted = toku_unsafe_fetch(&cachetable_evictor_shards);
+        if (shards_wanted == 0) {
+            shards_wanted = toku_os_get_number_active_processors() / 8;
+        }
+        while (m_num_clock_shards * 2 <= shards_wanted &&
+               m_num_clock_shards * 2 <= EVICTOR_MAX_SHARDS) {
+            m_num_clock_shards *= 2;
+        }
+    }
+    XCALLOC_N(m_num_clock_shards, m_clock_shards);
     
 
     pthread_rwlockattr_t attr;
@@ -3287,6 +3805,20 @@ void pair_list::init() {
             &m_mutexes[i].aligned_mutex,
             nullptr);
     }
+
+    m_optimistic_lookup = true;
+    m_lookup_epoch = 0;
+    XCALLOC_N(PAIR_LOOKUP_EPOCH_SLOTS, m_lookup_slots);
+    toku_mutex_init(toku_uninstrumented, &m_retire_lock, nullptr);
+    m_retired_head = NULL;
+    m_num_retired = 0;
+    m_fast_pins = create_partitioned_counter();
+    m_slow_pins = create_partitioned_counter();
+    for (uint32_t i = 0; m_numa && i < m_num_clock_shards; i++) {
+        m_numa_pins[i] = create_partitioned_counter();
+        m_numa_remote_pins[i] = create_partitioned_counter();
+        m_numa_misses[i] = create_partitioned_counter();
+    }
 }
 
 // Frees the pair_list hash table.  It is expected to be empty by
@@ -3297,6 +3829,22 @@ void pair_list::destroy() {
     for (uint32_t i = 0; i < m_table_size; ++i) {
         invariant_null(m_table[i]);
     }
+    toku_mutex_lock(&m_retire_lock);
+    this->wait_for_lookups_to_drain();
+    PAIR retired = m_retired_head;
+    m_retired_head = NULL;
+    m_num_retired = 0;
+    toku_mutex_unlock(&m_retire_lock);
+    this->free_retired_pairs(retired);
+    toku_mutex_destroy(&m_retire_lock);
+    toku_free(m_lookup_slots);
+    destroy_partitioned_counter(m_fast_pins);
+    destroy_partitioned_counter(m_slow_pins);
+    for (uint32_t i = 0; m_numa && i < m_num_clock_shards; i++) {
+        destroy_partitioned_counter(m_numa_pins[i]);
+        destroy_partitioned_counter(m_numa_remote_pins[i]);
+        destroy_partitioned_counter(m_numa_misses[i]);
+    }
     for (uint64_t i = 0; i < m_num_locks; i++) {
         toku_mutex_destroy(&m_mutexes[i].aligned_mutex);
     }
@@ -3305,6 +3853,7 @@ void pair_list::destroy() {
     toku_pthread_rwlock_destroy(&m_pending_lock_cheap);    
     toku_free(m_table);
     toku_free(m_mutexes);
+    toku_free(m_clock_shards);
 }
 
 // adds a PAIR to the cachetable's structures,
@@ -3342,6 +3891,8 @@ void pair_list::evict_completely(PAIR p) {
 // Removes the PAIR from the cachetable's lists,
 // but does NOT impact the list maintained by the cachefile
 void pair_list::evict_from_cachetable(PAIR p) {
+    // no new reader may pin p without its mutex from here on
+    p->value_rwlock.close_fast_path();
     this->pair_remove(p);
     this->pending_pairs_remove(p);
     this->remove_from_hash_chain(p);
@@ -3385,6 +3936,31 @@ void pair_list::pair_remove (PAIR p) {
         p->clock_next->clock_prev = p->clock_prev;
     }
     p->clock_prev = p->clock_next = NULL;
+    this->remove_from_clock_shard(p);
+}
+
+//
+// Remove pair from the eviction clock of its shard
+//
+// requires caller to have grabbed write lock on list.
+//
+void pair_list::remove_from_clock_shard(PAIR p) {
+    pair_clock_shard *shard = &m_clock_shards[this->clock_shard_of(p)];
+    if (p->evict_prev == p) {
+        invariant(shard->head == p);
+        invariant(p->evict_next == p);
+        shard->head = NULL;
+    }
+    else {
+        if (p == shard->head) {
+            shard->head = shard->head->evict_next;
+        }
+        p->evict_prev->evict_next = p->evict_next;
+        p->evict_next->evict_prev = p->evict_prev;
+    }
+    p->evict_prev = p->evict_next = NULL;
+    invariant(shard->n_pairs > 0);
+    shard->n_pairs--;
 }
 
 //Remove a pair from the list of pairs that were marked with the
@@ -3410,8 +3986,10 @@ void pair_list::remove_from_hash_chain(PAIR p) {
     // Remove it from the hash chain.
     unsigned int h = p->fullhash&(m_table_size - 1);
     paranoid_invariant(m_table[h] != NULL);
+    // optimistic lookups may be walking this chain concurrently. They
+    // either still see p or skip it, and p stays valid until retired.
     if (m_table[h] == p) {
-        m_table[h] = p->hash_chain;
+        toku_unsafe_set(&m_table[h], p->hash_chain);
     }
     else {
         PAIR curr = m_table[h];
@@ -3419,9 +3997,9 @@ void pair_list::remove_from_hash_chain(PAIR p) {
             curr = curr->hash_chain;
         }
         // remove p from the singular linked list
-        curr->hash_chain = p->hash_chain;
+        toku_unsafe_set(&curr->hash_chain, p->hash_chain);
     }
-    p->hash_chain = NULL;
+    toku_unsafe_set(&p->hash_chain, static_cast<PAIR>(NULL));
 }
 
 // Returns a pair from the pair list, using the given 
@@ -3441,6 +4019,144 @@ PAIR pair_list::find_pair(CACHEFILE file, CACHEKEY key, uint32_t fullhash) {
     return found_pair;
 }
 
+// Finds a PAIR and read locks it without the bucket's mutex or the list
+// lock. Returns NULL if the PAIR is not found, or if its value_rwlock
+// cannot be read locked on the lock-free path, in which case the caller
+// falls back to the regular path.
+PAIR pair_list::find_and_read_pin_optimistic(CACHEFILE file, CACHEKEY key, uint32_t fullhash) {
+    if (!toku_unsafe_fetch(&m_optimistic_lookup)) {
+        return NULL;
+    }
+    PAIR found_pair = nullptr;
+    uint32_t slot;
+    uint64_t epoch = this->lookup_epoch_enter(&slot);
+    for (PAIR p = toku_unsafe_fetch(&m_table[fullhash&(m_table_size - 1)]);
+         p;
+         p = toku_unsafe_fetch(&p->hash_chain)) {
+        if (p->key.b == key.b && p->cachefile == file) {
+            if (p->value_rwlock.try_read_lock_fast()) {
+                found_pair = p;
+            }
+            break;
+        }
+    }
+    this->lookup_epoch_exit(slot, epoch);
+    return found_pair;
+}
+
+static uint32_t pair_lookup_slot(void) {
+    static __thread uint32_t slot = UINT32_MAX;
+    if (slot == UINT32_MAX) {
+        slot = static_cast<uint32_t>(toku_os_gettid()) % PAIR_LOOKUP_EPOCH_SLOTS;
+    }
+    return slot;
+}
+
+// Marks this thread as inside an optimistic lookup. Returns the epoch
+// the lookup belongs to, to be passed to lookup_epoch_exit.
+uint64_t pair_list::lookup_epoch_enter(uint32_t *slot) {
+    *slot = pair_lookup_slot();
+    while (true) {
+        uint64_t epoch = toku_unsafe_fetch(&m_lookup_epoch);
+        uint64_t *active = &m_lookup_slots[*slot].active[epoch & 1];
+        // the increment is a full barrier, so if the epoch has not moved
+        // since, any grace period that starts later waits for us
+        toku_sync_fetch_and_add(active, 1);
+        if (toku_unsafe_fetch(&m_lookup_epoch) == epoch) {
+            return epoch;
+        }
+        toku_sync_fetch_and_sub(active, 1);
+    }
+}
+
+void pair_list::lookup_epoch_exit(uint32_t slot, uint64_t epoch) {
+    toku_sync_fetch_and_sub(&m_lookup_slots[slot].active[epoch & 1], 1);
+}
+
+// Waits until every optimistic lookup that started before this call
+// has finished. Those are the only lookups that may still reference a
+// PAIR that was removed from the hash table before this call.
+//
+// requires caller to hold m_retire_lock
+void pair_list::wait_for_lookups_to_drain() {
+    uint64_t old_epoch = toku_sync_fetch_and_add(&m_lookup_epoch, 1);
+    for (uint32_t i = 0; i < PAIR_LOOKUP_EPOCH_SLOTS; i++) {
+        while (toku_unsafe_fetch(&m_lookup_slots[i].active[old_epoch & 1]) > 0) {
+            toku_pthread_yield();
+        }
+    }
+}
+
+void pair_list::free_retired_pairs(PAIR head) {
+    while (head) {
+        PAIR next = head->clock_next;
+        ctpair_destroy(head);
+        head = next;
+    }
+}
+
+// Number of removed PAIRs that are destroyed together, after a single
+// grace period.
+static const uint32_t PAIR_RETIRE_BATCH = 32;
+
+// Destroys a PAIR that has been removed from the cachetable, once no
+// optimistic lookup can still reference it.
+void pair_list::retire_pair(PAIR p) {
+    PAIR to_free = NULL;
+    toku_mutex_lock(&m_retire_lock);
+    p->clock_next = m_retired_head;
+    m_retired_head = p;
+    if (++m_num_retired >= PAIR_RETIRE_BATCH) {
+        this->wait_for_lookups_to_drain();
+        to_free = m_retired_head;
+        m_retired_head = NULL;
+        m_num_retired = 0;
+    }
+    toku_mutex_unlock(&m_retire_lock);
+    this->free_retired_pairs(to_free);
+}
+
+void pair_list::note_pin(PAIR p, bool fast_path) {
+    increment_partitioned_counter(fast_path ? m_fast_pins : m_slow_pins, 1);
+    if (m_numa) {
+        uint32_t shard = this->numa_shard_of(p->numa_node);
+        increment_partitioned_counter(m_numa_pins[shard], 1);
+        if (p->numa_node != this->current_numa_node()) {
+            increment_partitioned_counter(m_numa_remote_pins[shard], 1);
+        }
+    }
+}
+
+// Counts a cache miss against the NUMA node of the thread that took it.
+void pair_list::note_miss() {
+    if (m_numa) {
+        uint32_t shard = this->numa_shard_of(this->current_numa_node());
+        increment_partitioned_counter(m_numa_misses[shard], 1);
+    }
+}
+
+void pair_list::fill_engine_status() {
+    CT_STATUS_VAL(CT_PIN_FAST_PATH) = read_partitioned_counter(m_fast_pins);
+    CT_STATUS_VAL(CT_PIN_SLOW_PATH) = read_partitioned_counter(m_slow_pins);
+
+    static_assert(CACHETABLE_STATUS_S::CT_NUMA_NODE_7_MISSES -
+                  CACHETABLE_STATUS_S::CT_NUMA_NODE_0_SIZE + 1 == 4 * EVICTOR_MAX_SHARDS,
+                  "need four status rows per NUMA node");
+    CT_STATUS_VAL(CT_NUMA_NODES) = m_numa_nodes;
+    for (uint32_t i = 0; i < EVICTOR_MAX_SHARDS; i++) {
+        uint64_t pins = 0, remote_pins = 0, misses = 0;
+        if (m_numa && i < m_num_clock_shards) {
+            pins = read_partitioned_counter(m_numa_pins[i]);
+            remote_pins = read_partitioned_counter(m_numa_remote_pins[i]);
+            misses = read_partitioned_counter(m_numa_misses[i]);
+        }
+        int row = CACHETABLE_STATUS_S::CT_NUMA_NODE_0_SIZE + 4 * i;
+        ct_status.status[row + 1].value.num = pins;
+        ct_status.status[row + 2].value.num = remote_pins;
+        ct_status.status[row + 3].value.num = misses;
+    }
+}
+
 // Add PAIR to linked list shared by cleaner thread and clock
 //
 // requires caller to have grabbed write lock on list.
@@ -3470,6 +4186,42 @@ void pair_list::add_to_clock (PAIR p) {
         m_cleaner_head = p;
         m_checkpoint_head = p;
     }
+    this->add_to_clock_shard(p);
+}
+
+// Add PAIR to the eviction clock of its shard, right before the hand
+//
+// requires caller to have grabbed write lock on list.
+//
+void pair_list::add_to_clock_shard(PAIR p) {
+    pair_clock_shard *shard = &m_clock_shards[this->clock_shard_of(p)];
+    if (shard->head) {
+        p->evict_next = shard->head;
+        p->evict_prev = shard->head->evict_prev;
+        p->evict_prev->evict_next = p;
+        p->evict_next->evict_prev = p;
+    }
+    else {
+        shard->head = p;
+        p->evict_next = p->evict_prev = p;
+    }
+    shard->n_pairs++;
+}
+
+uint32_t pair_list::clock_shard_of(PAIR p) const {
+    if (m_numa) {
+        return this->numa_shard_of(p->numa_node);
+    }
+    return p->fullhash & (m_num_clock_shards - 1);
+}
+
+uint32_t pair_list::numa_shard_of(uint32_t numa_node) const {
+    return numa_node & (m_num_clock_shards - 1);
+}
+
+// The NUMA node new PAIRs of the calling thread belong to.
+uint32_t pair_list::current_numa_node() const {
+    return m_numa ? toku_os_numa_current_node() : 0;
 }
 
 // add the pair to the linked list that of PAIRs belonging 
@@ -3493,7 +4245,10 @@ void pair_list::add_to_cf_list(PAIR p) {
 void pair_list::add_to_hash_chain(PAIR p) {
     uint32_t h = p->fullhash & (m_table_size - 1);
     p->hash_chain = m_table[h];
-    m_table[h] = p;
+    // publish p with a full barrier, so an optimistic lookup that finds
+    // p also sees it fully initialized
+    bool published = toku_sync_bool_compare_and_swap(&m_table[h], p->hash_chain, p);
+    invariant(published);
 }
 
 // test function
@@ -3538,6 +4293,23 @@ void pair_list::verify() {
         }
         assert (num_found == m_n_in_table);
     }
+    // Every PAIR must also be in the eviction clock of its shard.
+    num_found = 0;
+    for (uint32_t i = 0; i < m_num_clock_shards; i++) {
+        PAIR head = m_clock_shards[i].head;
+        uint32_t n = 0;
+        if (head) {
+            PAIR p = head;
+            do {
+                assert(this->clock_shard_of(p) == i);
+                n++;
+                p = p->evict_next;
+            } while (p != head);
+        }
+        assert(n == m_clock_shards[i].n_pairs);
+        num_found += n;
+    }
+    assert(num_found == m_n_in_table);
     this->write_list_unlock();
 }
 
@@ -3630,6 +4402,16 @@ static void *eviction_thread(void *evictor_v) {
     return toku_pthread_done(evictor_v);
 }
 
+//
+// This is the function that runs eviction for one of the shards
+// other than shard 0, on its own thread.
+//
+static void *eviction_shard_thread(void *shard_v) {
+    evictor_shard *CAST_FROM_VOIDP(shard, shard_v);
+    shard->ev->run_eviction_shard_thread(shard);
+    return toku_pthread_done(shard_v);
+}
+
 //
 // Starts the eviction thread, assigns external object references,
 // and initializes all counters and condition variables.
@@ -3659,6 +4441,9 @@ int evictor::init(long _size_limit, pair_list* _pl, cachefile_list* _cf_list, KI
     }
     
     m_enable_partial_eviction = true;
+    m_policy = &clock_policy;
+    XCALLOC_N(EVICTOR_GHOST_SLOTS, m_ghost_keys);
+    m_ghost_hits = 0;
 
     m_size_reserved = unreservable_memory(_size_limit);
     m_size_current = 0;
@@ -3685,13 +4470,28 @@ int evictor::init(long _size_limit, pair_list* _pl, cachefile_list* _cf_list, KI
         *cachetable_m_ev_thread_cond_key, &m_ev_thread_cond, nullptr);
     m_num_sleepers = 0;
     m_ev_thread_is_running = false;
+    m_num_shards_running = 0;
     m_period_in_seconds = eviction_period;
 
+    // one shard for each clock shard of the pair list
+    m_num_shards = m_pl->m_num_clock_shards;
+    XCALLOC_N(m_num_shards, m_shards);
     unsigned int seed = (unsigned int) time(NULL);
-    int r = myinitstate_r(seed, m_random_statebuf, sizeof m_random_statebuf, &m_random_data);
-    assert_zero(r);
+    int r = 0;
+    for (uint32_t i = 0; i < m_num_shards; i++) {
+        evictor_shard *shard = &m_shards[i];
+        shard->ev = this;
+        shard->id = i;
+        shard->thread_init = false;
+        shard->active = false;
+        shard->numa_size = 0;
+        toku_cond_init(*cachetable_m_ev_thread_cond_key, &shard->cond, nullptr);
+        r = myinitstate_r(seed + i, shard->random_statebuf,
+                          sizeof shard->random_statebuf, &shard->random_data);
+        assert_zero(r);
+    }
 
-    // start the background thread
+    // start the background threads
     m_run_thread = true;
     m_num_eviction_thread_runs = 0;
     m_ev_thread_init = false;
@@ -3700,6 +4500,14 @@ int evictor::init(long _size_limit, pair_list* _pl, cachefile_list* _cf_list, KI
     if (r == 0) {
         m_ev_thread_init = true;
     }
+    for (uint32_t i = 1; r == 0 && i < m_num_shards; i++) {
+        evictor_shard *shard = &m_shards[i];
+        r = toku_pthread_create(*eviction_thread_key, &shard->thread, nullptr,
+                                eviction_shard_thread, shard);
+        if (r == 0) {
+            shard->thread_init = true;
+        }
+    }
     m_evictor_init = true;
     return r;
 }
@@ -3720,17 +4528,35 @@ void evictor::destroy() {
     //
     //assert(m_size_current == 0);
 
-    // Stop the eviction thread.
+    // Stop the eviction threads.
+    toku_mutex_lock(&m_ev_thread_lock);
+    m_run_thread = false;
+    this->signal_eviction_thread_locked();
+    for (uint32_t i = 1; i < m_num_shards; i++) {
+        toku_cond_signal(&m_shards[i].cond);
+    }
+    toku_mutex_unlock(&m_ev_thread_lock);
     if (m_ev_thread_init) {
-        toku_mutex_lock(&m_ev_thread_lock);
-        m_run_thread = false;
-        this->signal_eviction_thread_locked();
-        toku_mutex_unlock(&m_ev_thread_lock);
         void *ret;
         int r = toku_pthread_join(m_ev_thread, &ret); 
         assert_zero(r);
         assert(!m_ev_thread_is_running);
     }
+    for (uint32_t i = 1; i < m_num_shards; i++) {
+        if (m_shards[i].thread_init) {
+            void *ret;
+            int r = toku_pthread_join(m_shards[i].thread, &ret);
+            assert_zero(r);
+        }
+    }
+    assert(m_num_shards_running == 0);
+    for (uint32_t i = 0; i < m_num_shards; i++) {
+        toku_cond_destroy(&m_shards[i].cond);
+    }
+    toku_free(m_shards);
+    m_shards = NULL;
+    toku_free(m_ghost_keys);
+    m_ghost_keys = NULL;
     destroy_partitioned_counter(m_size_nonleaf);
     m_size_nonleaf = NULL;
     destroy_partitioned_counter(m_size_leaf);
@@ -3754,9 +4580,13 @@ void evictor::destroy() {
 // Increases status variables and the current size variable
 // of the evictor based on the given pair attribute.
 //
-void evictor::add_pair_attr(PAIR_ATTR attr) {
+void evictor::add_pair_attr(PAIR_ATTR attr, uint32_t numa_node) {
     assert(attr.is_valid);
     add_to_size_current(attr.size);
+    if (m_pl->m_numa) {
+        evictor_shard *shard = &m_shards[m_pl->numa_shard_of(numa_node)];
+        (void) toku_sync_fetch_and_add(&shard->numa_size, attr.size);
+    }
     increment_partitioned_counter(m_size_nonleaf, attr.nonleaf_size);
     increment_partitioned_counter(m_size_leaf, attr.leaf_size);
     increment_partitioned_counter(m_size_rollback, attr.rollback_size);
@@ -3767,9 +4597,13 @@ void evictor::add_pair_attr(PAIR_ATTR attr) {
 // Decreases status variables and the current size variable
 // of the evictor based on the given pair attribute.
 //
-void evictor::remove_pair_attr(PAIR_ATTR attr) {
+void evictor::remove_pair_attr(PAIR_ATTR attr, uint32_t numa_node) {
     assert(attr.is_valid);
     remove_from_size_current(attr.size);
+    if (m_pl->m_numa) {
+        evictor_shard *shard = &m_shards[m_pl->numa_shard_of(numa_node)];
+        (void) toku_sync_fetch_and_sub(&shard->numa_size, attr.size);
+    }
     increment_partitioned_counter(m_size_nonleaf, 0 - attr.nonleaf_size);
     increment_partitioned_counter(m_size_leaf, 0 - attr.leaf_size);
     increment_partitioned_counter(m_size_rollback, 0 - attr.rollback_size);
@@ -3780,9 +4614,9 @@ void evictor::remove_pair_attr(PAIR_ATTR attr) {
 // Updates this evictor's stats to match the "new" pair attribute given
 // while also removing the given "old" pair attribute. 
 //
-void evictor::change_pair_attr(PAIR_ATTR old_attr, PAIR_ATTR new_attr) {
-    this->add_pair_attr(new_attr);
-    this->remove_pair_attr(old_attr);
+void evictor::change_pair_attr(PAIR_ATTR old_attr, PAIR_ATTR new_attr, uint32_t numa_node) {
+    this->add_pair_attr(new_attr, numa_node);
+    this->remove_pair_attr(old_attr, numa_node);
 }
 
 //
@@ -3860,6 +4694,9 @@ void evictor::release_reserved_memory(uint64_t reserved_memory){
 // by waiting on m_ev_thread_cond.
 //
 void evictor::run_eviction_thread(){
+    if (m_pl->m_numa) {
+        (void) toku_os_numa_bind_thread(0);
+    }
     toku_mutex_lock(&m_ev_thread_lock);
     while (m_run_thread) {
         m_num_eviction_thread_runs++; // for test purposes only
@@ -3898,31 +4735,92 @@ void evictor::run_eviction_thread(){
     toku_mutex_unlock(&m_ev_thread_lock);
 }
 
+//
+// This function is the eviction thread of a shard other than shard 0.
+// It runs for the lifetime of the evictor, and sleeps until the main
+// eviction thread asks it to run.
+//
+void evictor::run_eviction_shard_thread(evictor_shard *shard) {
+    if (m_pl->m_numa) {
+        // evict, and free memory, from the node whose PAIRs the shard holds
+        (void) toku_os_numa_bind_thread(shard->id);
+    }
+    toku_mutex_lock(&m_ev_thread_lock);
+    while (m_run_thread) {
+        if (shard->active) {
+            this->run_eviction_on_shard(shard);
+            shard->active = false;
+            m_num_shards_running--;
+        } else {
+            toku_cond_wait(&shard->cond, &m_ev_thread_lock);
+        }
+    }
+    if (shard->active) {
+        shard->active = false;
+        m_num_shards_running--;
+    }
+    toku_mutex_unlock(&m_ev_thread_lock);
+}
+
 //
 // runs eviction.
 // on entry, ev_thread_lock is grabbed, on exit, ev_thread_lock must still be grabbed
-// it is the responsibility of this function to release and reacquire ev_thread_lock as it sees fit.
 //
 void evictor::run_eviction(){
+    // the other shards run their clocks on their own threads, alongside
+    // this thread running the clock of shard 0
+    if (this->eviction_needed()) {
+        for (uint32_t i = 1; i < m_num_shards; i++) {
+            if (!m_shards[i].active) {
+                m_shards[i].active = true;
+                m_num_shards_running++;
+                toku_cond_signal(&m_shards[i].cond);
+            }
+        }
+    }
+    m_shards[0].active = true;
+    m_num_shards_running++;
+    this->run_eviction_on_shard(&m_shards[0]);
+    m_shards[0].active = false;
+    m_num_shards_running--;
+}
+
+//
+// runs eviction on the clock of the given shard.
+// on entry, ev_thread_lock is grabbed, on exit, ev_thread_lock must still be grabbed
+// it is the responsibility of this function to release and reacquire ev_thread_lock as it sees fit.
+//
+void evictor::run_eviction_on_shard(evictor_shard *shard){
     //
     // These variables will help us detect if everything in the clock is currently being accessed.
     // We must detect this case otherwise we will end up in an infinite loop below.
     //
     bool exited_early = false;
     uint32_t num_pairs_examined_without_evicting = 0;
+    pair_clock_shard *clock = &m_pl->m_clock_shards[shard->id];
+    // shard 0 keeps going while it finds stale pairs, whatever its node holds
+    bool evicted_stale_pair = shard->id == 0;
     
-    while (this->eviction_needed()) {
+    while (this->eviction_needed() &&
+           (evicted_stale_pair || this->shard_over_numa_budget(shard))) {
         if (m_num_sleepers > 0 && this->should_sleeping_clients_wakeup()) {
             toku_cond_broadcast(&m_flow_control_cond);
         }
         // release ev_thread_lock so that eviction may run without holding mutex
         toku_mutex_unlock(&m_ev_thread_lock);
 
-        // first try to do an eviction from stale cachefiles
-        bool some_eviction_ran = m_cf_list->evict_some_stale_pair(this);
-        if (!some_eviction_ran) {
+        // first try to do an eviction from stale cachefiles. Only shard 0
+        // does this, because the last pair of a stale cachefile destroys
+        // the cachefile, which must not happen while another thread is
+        // still freeing an earlier pair of that cachefile.
+        bool some_eviction_ran = shard->id == 0 && m_cf_list->evict_some_stale_pair(this);
+        evicted_stale_pair = some_eviction_ran;
+        if (some_eviction_ran) {
+            shard->evictions++;
+        }
+        else {
             m_pl->read_list_lock();
-            PAIR curr_in_clock = m_pl->m_clock_head;
+            PAIR curr_in_clock = clock->head;
             // if nothing to evict, we need to exit
             if (!curr_in_clock) {
                 m_pl->read_list_unlock();
@@ -3930,7 +4828,7 @@ void evictor::run_eviction(){
                 exited_early = true;
                 goto exit;
             }
-            if (num_pairs_examined_without_evicting > m_pl->m_n_in_table) {
+            if (num_pairs_examined_without_evicting > clock->n_pairs) {
                 // we have a cycle where everything in the clock is in use
                 // do not return an error
                 // just let memory be overfull
@@ -3939,7 +4837,7 @@ void evictor::run_eviction(){
                 exited_early = true;
                 goto exit;
             }
-            bool eviction_run = run_eviction_on_pair(curr_in_clock);
+            bool eviction_run = run_eviction_on_pair(curr_in_clock, shard);
             if (eviction_run) {
                 // reset the count
                 num_pairs_examined_without_evicting = 0;
@@ -3948,11 +4846,11 @@ void evictor::run_eviction(){
                 num_pairs_examined_without_evicting++;
             }
             // at this point, either curr_in_clock is still in the list because it has not been fully evicted,
-            // and we need to move ct->m_clock_head over. Otherwise, curr_in_clock has been fully evicted
-            // and we do NOT need to move ct->m_clock_head, as the removal of curr_in_clock
-            // modified ct->m_clock_head
-            if (m_pl->m_clock_head && (m_pl->m_clock_head == curr_in_clock)) {
-                m_pl->m_clock_head = m_pl->m_clock_head->clock_next;
+            // and we need to move the shard's hand over. Otherwise, curr_in_clock has been fully evicted
+            // and we do NOT need to move the hand, as the removal of curr_in_clock
+            // modified it
+            if (clock->head && (clock->head == curr_in_clock)) {
+                clock->head = clock->head->evict_next;
             }
             m_pl->read_list_unlock();
         }
@@ -3960,7 +4858,10 @@ void evictor::run_eviction(){
     }
 
 exit:
-    if (m_num_sleepers > 0 && (exited_early || this->should_sleeping_clients_wakeup())) {
+    // a shard giving up early only lets sleeping clients through
+    // if no other shard is still making progress
+    if (m_num_sleepers > 0 &&
+        ((exited_early && m_num_shards_running == 1) || this->should_sleeping_clients_wakeup())) {
         toku_cond_broadcast(&m_flow_control_cond);
     }
     return;
@@ -3975,17 +4876,21 @@ exit:
 // IS held
 // on exit, the same conditions must apply
 //
-bool evictor::run_eviction_on_pair(PAIR curr_in_clock) {
+bool evictor::run_eviction_on_pair(PAIR curr_in_clock, evictor_shard *shard) {
     uint32_t n_in_table;
     int64_t size_current;
     bool ret_val = false;
     // function meant to be called on PAIR that is not being accessed right now
     CACHEFILE cf = curr_in_clock->cachefile;
+    shard->pairs_examined++;
     int r = bjm_add_background_job(cf->bjm);
     if (r) {
         goto exit;
     }
     pair_lock(curr_in_clock);
+    // readers on the lock-free path do not take the pair's mutex, so close
+    // that path before deciding whether the pair is in use
+    curr_in_clock->value_rwlock.close_fast_path();
     // these are the circumstances under which we don't run eviction on a pair: 
     //  - if other users are waiting on the lock 
     //  - if the PAIR is referenced by users 
@@ -4021,7 +4926,7 @@ bool evictor::run_eviction_on_pair(PAIR curr_in_clock) {
         } else {
             // generate a random number between 0 and 2^16
             assert(size_current <= (INT64_MAX / ((1<<16)-1))); // to protect against possible overflows
-            int32_t rnd = myrandom_r(&m_random_data) % (1<<16);
+            int32_t rnd = myrandom_r(&shard->random_data) % (1<<16);
             // The if-statement below will be true with probability of
             // curr_size/(average size of PAIR in cachetable)
             // Here is how the math is done:
@@ -4055,6 +4960,7 @@ bool evictor::run_eviction_on_pair(PAIR curr_in_clock) {
                                            &bytes_freed_estimate, &cost,
                                            write_extraargs);
             if (cost == PE_CHEAP) {
+                shard->evictions++;
                 pair_unlock(curr_in_clock);
                 curr_in_clock->size_evicting_estimate = 0;
                 this->do_partial_eviction(curr_in_clock);
@@ -4063,6 +4969,7 @@ bool evictor::run_eviction_on_pair(PAIR curr_in_clock) {
                 // only bother running an expensive partial eviction
                 // if it is expected to free space
                 if (bytes_freed_estimate > 0) {
+                    shard->evictions++;
                     pair_unlock(curr_in_clock);
                     curr_in_clock->size_evicting_estimate = bytes_freed_estimate;
                     toku_mutex_lock(&m_ev_thread_lock);
@@ -4087,6 +4994,8 @@ bool evictor::run_eviction_on_pair(PAIR curr_in_clock) {
 
         // responsibility of try_evict_pair to eventually remove background job
         // pair's mutex is still grabbed here
+        toku_unsafe_fetch(&m_policy)->pair_evicting(this, curr_in_clock);
+        shard->evictions++;
         this->try_evict_pair(curr_in_clock);
     }
     // regrab the read list lock, because the caller assumes
@@ -4111,7 +5020,7 @@ static void pair_unpin_with_new_attr(PAIR_ATTR new_attr, void *extra) {
     evictor *ev = info->ev;
 
     // change the attr in the evictor, then update the value in the pair
-    ev->change_pair_attr(p->attr, new_attr);
+    ev->change_pair_attr(p->attr, new_attr, p->numa_node);
     p->attr = new_attr;
 
     // unpin
@@ -4295,6 +5204,11 @@ void evictor::wait_for_cache_pressure_to_subside() {
 // Get the status of the current estimated size of the cachetable,
 // and the evictor's set limit. 
 //
+// the bytes of messages buffered and work done in the cachetable's nodes
+uint64_t evictor::get_cache_pressure_size(void) {
+    return read_partitioned_counter(m_size_cachepressure);
+}
+
 void evictor::get_state(long *size_current_ptr, long *size_limit_ptr) {
     if (size_current_ptr) {
         *size_current_ptr = m_size_current;
@@ -4370,6 +5284,27 @@ bool evictor::eviction_needed() {
     return (m_size_current - m_size_evicting) > m_low_size_watermark;
 }
 
+//
+// In NUMA mode, a shard only evicts while the PAIRs of its node take more
+// than the node's share of the cachetable, so that each node is kept
+// within its budget by the eviction thread running on it. When the
+// nodes are all within budget, and memory reserved or cloned outside of
+// any node is what needs eviction, the nodes holding more than the
+// average are evicted from.
+//
+bool evictor::shard_over_numa_budget(evictor_shard *shard) {
+    if (!m_pl->m_numa) {
+        return true;
+    }
+    int64_t num_nodes = m_pl->m_numa_nodes < m_num_shards ? m_pl->m_numa_nodes : m_num_shards;
+    int64_t total = 0;
+    for (uint32_t i = 0; i < m_num_shards; i++) {
+        total += toku_unsafe_fetch(&m_shards[i].numa_size);
+    }
+    int64_t budget = total < m_low_size_watermark ? total : m_low_size_watermark;
+    return toku_unsafe_fetch(&shard->numa_size) * num_nodes >= budget;
+}
+
 inline int64_t evictor::unsafe_read_size_current(void) const {
     return m_size_current;
 }
@@ -4387,6 +5322,26 @@ void evictor::fill_engine_status() {
     CT_STATUS_VAL(CT_WAIT_PRESSURE_TIME) = read_partitioned_counter(m_wait_pressure_time);
     CT_STATUS_VAL(CT_LONG_WAIT_PRESSURE_COUNT) = read_partitioned_counter(m_long_wait_pressure_count);
     CT_STATUS_VAL(CT_LONG_WAIT_PRESSURE_TIME) = read_partitioned_counter(m_long_wait_pressure_time);
+
+    static_assert(CACHETABLE_STATUS_S::CT_EVICTOR_SHARD_7_EVICTIONS -
+                  CACHETABLE_STATUS_S::CT_EVICTOR_SHARD_0_EVICTIONS + 1 == EVICTOR_MAX_SHARDS,
+                  "need one status row per evictor shard");
+    CT_STATUS_VAL(CT_EVICTOR_SHARDS) = m_num_shards;
+    for (uint32_t i = 0; i < EVICTOR_MAX_SHARDS; i++) {
+        uint64_t evictions = 0;
+        if (i < m_num_shards) {
+            evictions = toku_unsafe_fetch(&m_shards[i].evictions);
+        }
+        ct_status.status[CACHETABLE_STATUS_S::CT_EVICTOR_SHARD_0_EVICTIONS + i].value.num = evictions;
+    }
+    CT_STATUS_VAL(CT_EVICTOR_GHOST_HITS) = m_ghost_hits;
+    for (uint32_t i = 0; i < EVICTOR_MAX_SHARDS; i++) {
+        int64_t numa_size = 0;
+        if (m_pl->m_numa && i < m_num_shards) {
+            numa_size = toku_unsafe_fetch(&m_shards[i].numa_size);
+        }
+        ct_status.status[CACHETABLE_STATUS_S::CT_NUMA_NODE_0_SIZE + 4 * i].value.num = numa_size;
+    }
 }
 
 void evictor::set_enable_partial_eviction(bool enabled) {
@@ -4397,6 +5352,54 @@ bool evictor::get_enable_partial_eviction(void) const {
     return m_enable_partial_eviction;
 }
 
+void evictor::set_replacement_policy(toku_cachetable_policy policy) {
+    switch (policy) {
+    case TOKU_CACHETABLE_POLICY_CLOCK:
+        toku_unsafe_set(&m_policy, &clock_policy);
+        break;
+    case TOKU_CACHETABLE_POLICY_2Q:
+        toku_unsafe_set(&m_policy, &two_q_policy);
+        break;
+    default:
+        abort();
+    }
+}
+
+toku_cachetable_policy evictor::get_replacement_policy(void) const {
+    return toku_unsafe_fetch(&m_policy)->type;
+}
+
+// requires the pair list's write lock and the PAIR's mutex to be held
+void evictor::pair_added(PAIR p) {
+    toku_unsafe_fetch(&m_policy)->pair_added(this, p);
+}
+
+void evictor::touch_pair(PAIR p) {
+    toku_unsafe_fetch(&m_policy)->pair_touched(p);
+}
+
+static uint64_t ghost_key(PAIR p) {
+    return (((uint64_t) p->cachefile->hash_id) << 32) | (uint32_t) p->key.b;
+}
+
+void evictor::remember_evicted_pair(PAIR p) {
+    toku_unsafe_set(&m_ghost_keys[p->fullhash & (EVICTOR_GHOST_SLOTS - 1)], ghost_key(p));
+}
+
+// Returns true if the PAIR was evicted recently enough to be remembered
+// by the ghost list, and forgets it.
+// requires the pair list's write lock to be held
+bool evictor::forget_evicted_pair(PAIR p) {
+    uint64_t *slot = &m_ghost_keys[p->fullhash & (EVICTOR_GHOST_SLOTS - 1)];
+    uint64_t key = toku_unsafe_fetch(slot);
+    if (key == 0 || key != ghost_key(p)) {
+        return false;
+    }
+    toku_unsafe_set(slot, (uint64_t) 0);
+    m_ghost_hits++;
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 ENSURE_POD(checkpointer);
@@ -4413,6 +5416,19 @@ int checkpointer::init(pair_list *_pl,
     m_ev = _ev;
     m_cf_list = files;
     bjm_init(&m_checkpoint_clones_bjm);
+    m_write_depth = 0;
+    toku_mutex_init(toku_uninstrumented, &m_clones_mutex, nullptr);
+    toku_cond_init(toku_uninstrumented, &m_clone_written, nullptr);
+    m_clones_writing = 0;
+    m_pairs_pending = 0;
+    m_pairs_processed = 0;
+    m_paced = false;
+    m_pending_dirty_bytes = 0;
+    m_pace_usec = 0;
+    m_pace_start = 0;
+    m_pace_hurry = nullptr;
+    m_pace_rate = 0;
+    m_pace_sleep_usec = 0;
     
     // Default is no checkpointing.
     m_checkpointer_cron_init = false;
@@ -4434,6 +5450,51 @@ void checkpointer::destroy() {
         assert(r == 0);
     }
     bjm_destroy(m_checkpoint_clones_bjm);
+    toku_cond_destroy(&m_clone_written);
+    toku_mutex_destroy(&m_clones_mutex);
+}
+
+void checkpointer::set_write_depth(uint32_t depth) {
+    toku_unsafe_set(&m_write_depth, depth);
+}
+
+uint32_t checkpointer::get_write_depth() {
+    return toku_unsafe_fetch(&m_write_depth);
+}
+
+void checkpointer::get_write_progress(uint64_t *pending, uint64_t *processed, uint64_t *writing) {
+    *pending = toku_unsafe_fetch(&m_pairs_pending);
+    *processed = toku_unsafe_fetch(&m_pairs_processed);
+    *writing = toku_unsafe_fetch(&m_clones_writing);
+}
+
+void checkpointer::set_paced(bool paced) {
+    toku_unsafe_set(&m_paced, paced);
+}
+
+bool checkpointer::get_paced() {
+    return toku_unsafe_fetch(&m_paced);
+}
+
+//
+// Called between begin_checkpoint and end_checkpoint, spreads the
+// write-out of the dirty pairs pending over the next usec microseconds.
+// A checkpoint with no dirty pairs pending is not paced.
+//
+bool checkpointer::pace(uint64_t usec, bool (*hurry)(void)) {
+    if (usec == 0 || m_pending_dirty_bytes == 0) {
+        return false;
+    }
+    m_pace_hurry = hurry;
+    m_pace_start = toku_current_time_microsec();
+    toku_unsafe_set(&m_pace_rate, (uint64_t) ((double) m_pending_dirty_bytes * 1000000 / usec));
+    toku_unsafe_set(&m_pace_usec, usec);
+    return true;
+}
+
+void checkpointer::get_pace(uint64_t *bytes_per_sec, uint64_t *sleep_usec) {
+    *bytes_per_sec = toku_unsafe_fetch(&m_pace_rate);
+    *sleep_usec = toku_unsafe_fetch(&m_pace_sleep_usec);
 }
 
 //
@@ -4454,6 +5515,8 @@ uint32_t checkpointer::get_checkpoint_period() {
 // Stops the checkpoint thread.
 //
 int checkpointer::shutdown() {
+    // do not make the shutdown wait for a paced checkpoint
+    toku_unsafe_set(&m_pace_usec, (uint64_t) 0);
     return toku_minicron_shutdown(&m_checkpointer_cron);
 }
 
@@ -4592,6 +5655,8 @@ void checkpointer::log_begin_checkpoint() {
 void checkpointer::turn_on_pending_bits() {
     PAIR p = NULL;
     uint32_t i;
+    uint64_t n_pending = 0;
+    uint64_t dirty_bytes = 0;
     for (i = 0, p = m_list->m_checkpoint_head; i < m_list->m_n_in_table; i++, p = p->clock_next) {
         assert(!p->checkpoint_pending);
         //Only include pairs belonging to cachefiles in the checkpoint
@@ -4614,18 +5679,73 @@ void checkpointer::turn_on_pending_bits() {
         p->pending_next = m_list->m_pending_head;
         p->pending_prev = NULL;
         m_list->m_pending_head = p;
+        n_pending++;
+        if (p->dirty) {
+            dirty_bytes += p->attr.size;
+        }
     }
     invariant(p == m_list->m_checkpoint_head);
+    toku_unsafe_set(&m_pairs_processed, (uint64_t) 0);
+    toku_unsafe_set(&m_pairs_pending, n_pending);
+    m_pending_dirty_bytes = dirty_bytes;
+    // pacing is turned on separately for each checkpoint
+    toku_unsafe_set(&m_pace_usec, (uint64_t) 0);
 }
 
 void checkpointer::add_background_job() {
     int r = bjm_add_background_job(m_checkpoint_clones_bjm);
     assert_zero(r);
+    toku_mutex_lock(&m_clones_mutex);
+    m_clones_writing++;
+    toku_mutex_unlock(&m_clones_mutex);
 }
 void checkpointer::remove_background_job() {
+    // must be done before the job is removed, end_checkpoint
+    // may destroy the cachetable once the last one is gone
+    toku_mutex_lock(&m_clones_mutex);
+    m_clones_writing--;
+    toku_cond_signal(&m_clone_written);
+    toku_mutex_unlock(&m_clones_mutex);
     bjm_remove_background_job(m_checkpoint_clones_bjm);
 }
 
+// Waits until fewer than write_depth cloned pairs are queued or being
+// written, so the memory held by clones of the checkpoint stays bounded.
+void checkpointer::wait_for_clone_write_slot(uint32_t write_depth) {
+    toku_mutex_lock(&m_clones_mutex);
+    while (m_clones_writing >= write_depth) {
+        toku_cond_wait(&m_clone_written, &m_clones_mutex);
+    }
+    toku_mutex_unlock(&m_clones_mutex);
+}
+
+// Sleeps while the write-out is ahead of a schedule that writes the dirty
+// pairs pending at begin_checkpoint evenly over m_pace_usec. Sleeps in
+// short steps so that a change of m_pace_usec is noticed quickly.
+void checkpointer::pace_write_out(uint64_t bytes_written) {
+    if (m_pending_dirty_bytes == 0) {
+        return;
+    }
+    while (true) {
+        uint64_t usec = toku_unsafe_fetch(&m_pace_usec);
+        if (usec == 0) {
+            return;
+        }
+        if (m_pace_hurry && m_pace_hurry()) {
+            toku_unsafe_set(&m_pace_usec, (uint64_t) 0);
+            return;
+        }
+        uint64_t due = (uint64_t) ((double) bytes_written * usec / m_pending_dirty_bytes);
+        uint64_t elapsed = toku_current_time_microsec() - m_pace_start;
+        if (elapsed >= due) {
+            return;
+        }
+        uint64_t sleep_usec = due - elapsed < 100000 ? due - elapsed : 100000;
+        usleep(sleep_usec);
+        toku_unsafe_set(&m_pace_sleep_usec, m_pace_sleep_usec + sleep_usec);
+    }
+}
+
 void checkpointer::end_checkpoint(void (*testcallback_f)(void*),  void* testextra) {
     toku::scoped_malloc checkpoint_cfs_buf(m_checkpoint_num_files * sizeof(CACHEFILE));
     CACHEFILE *checkpoint_cfs = reinterpret_cast<CACHEFILE *>(checkpoint_cfs_buf.get());
@@ -4670,8 +5790,15 @@ void checkpointer::fill_checkpoint_cfs(CACHEFILE* checkpoint_cfs) {
     m_cf_list->read_unlock();
 }
 
+//
+// Writes out every pair still pending. Cloneable pairs are cloned on the
+// checkpoint thread and serialized, compressed and written by the threads
+// of the checkpointing kibbutz, up to m_write_depth of them at a time.
+//
 void checkpointer::checkpoint_pending_pairs() {
     PAIR p;
+    const uint32_t write_depth = toku_unsafe_fetch(&m_write_depth);
+    uint64_t dirty_bytes_written = 0;
     m_list->read_list_lock();
     while ((p = m_list->m_pending_head)!=0) {
         // <CER> TODO: Investigate why we move pending head outisde of the pending_pairs_remove() call.
@@ -4680,8 +5807,16 @@ void checkpointer::checkpoint_pending_pairs() {
         // if still pending, clear the pending bit and write out the node
         pair_lock(p);
         m_list->read_list_unlock();
-        write_pair_for_checkpoint_thread(m_ev, p);
+        if (p->dirty && p->checkpoint_pending) {
+            dirty_bytes_written += p->attr.size;
+        }
+        write_pair_for_checkpoint_thread(m_ev, p, write_depth > 0);
         pair_unlock(p);
+        toku_unsafe_set(&m_pairs_processed, m_pairs_processed + 1);
+        if (write_depth > 0) {
+            wait_for_clone_write_slot(write_depth);
+        }
+        pace_write_out(dirty_bytes_written);
         m_list->read_list_lock();
     }
     assert(!m_list->m_pending_head);
@@ -4965,7 +6100,7 @@ bool cachefile_list::evict_some_stale_pair(evictor* ev) {
 
     write_unlock();
     
-    ev->remove_pair_attr(p->attr);
+    ev->remove_pair_attr(p->attr, p->numa_node);
     cachetable_free_pair(p);
     if (destroy_cf) {
         cachefile_destroy(stale_cf);
@@ -4986,7 +6121,7 @@ void cachefile_list::free_stale_data(evictor* ev) {
         paranoid_invariant(p != NULL);
         
         evict_pair_from_cachefile(p);
-        ev->remove_pair_attr(p->attr);
+        ev->remove_pair_attr(p->attr, p->numa_node);
         cachetable_free_pair(p);
         
         // now that we have evicted something,
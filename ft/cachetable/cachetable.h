@@ -102,22 +102,61 @@ uint32_t toku_get_cleaner_period_unlocked (CACHETABLE ct);
 void toku_set_cleaner_iterations (CACHETABLE ct, uint32_t new_iterations);
 uint32_t toku_get_cleaner_iterations (CACHETABLE ct);
 uint32_t toku_get_cleaner_iterations_unlocked (CACHETABLE ct);
+// When adaptive, every run of the cleaner sizes its work by the bytes of
+// messages buffered in the cachetable: nothing when none are buffered, and
+// more iterations on up to max_threads threads as the buffers fill up.
+void toku_set_cleaner_adaptive (CACHETABLE ct, bool adaptive);
+bool toku_get_cleaner_adaptive (CACHETABLE ct);
+void toku_set_cleaner_max_threads (CACHETABLE ct, uint32_t max_threads);
+uint32_t toku_get_cleaner_max_threads (CACHETABLE ct);
 void toku_set_enable_partial_eviction (CACHETABLE ct, bool enabled);
 bool toku_get_enable_partial_eviction (CACHETABLE ct);
+// Selects how the evictor picks PAIRs to evict. With TOKU_CACHETABLE_POLICY_2Q
+// a PAIR starts out cold and pins do not keep it in the cachetable until it has
+// been evicted once and read back in, so a single scan cannot push out hot nodes.
+void toku_set_replacement_policy (CACHETABLE ct, toku_cachetable_policy policy);
+toku_cachetable_policy toku_get_replacement_policy (CACHETABLE ct);
+// Sets the number of shards, each with its own clock hand and eviction
+// thread, for cachetables created from now on. Rounded down to a power
+// of two, at most 8. 0 picks one shard per 8 processors.
+void toku_cachetable_set_evictor_shards(uint32_t num_shards);
+// Enables or disables read pins of resident PAIRs without the bucket mutex.
+void toku_set_enable_optimistic_pair_lookup (CACHETABLE ct, bool enabled);
+bool toku_get_enable_optimistic_pair_lookup (CACHETABLE ct);
+// Sets how many cloned PAIRs end_checkpoint keeps queued or being written
+// on the checkpoint pool at once. 0 writes each PAIR on the checkpoint thread.
+void toku_set_checkpoint_write_depth (CACHETABLE ct, uint32_t depth);
+uint32_t toku_get_checkpoint_write_depth (CACHETABLE ct);
+// Progress of the write-out of the checkpoint in progress, or of the last one:
+// how many PAIRs were pending, how many of them were processed, and how
+// many cloned PAIRs are waiting for or being written by the checkpoint pool.
+void toku_cachetable_get_checkpoint_write_progress (CACHETABLE ct, uint64_t *pending, uint64_t *processed, uint64_t *writing);
+// When enabled, scheduled checkpoints spread the write-out of their dirty
+// pairs over the checkpoint period instead of writing them in a burst.
+void toku_set_checkpoint_paced (CACHETABLE ct, bool paced);
+bool toku_get_checkpoint_paced (CACHETABLE ct);
+// Target write rate in bytes/sec of the last paced checkpoint, and the
+// time in microseconds paced checkpoints have slept so far.
+void toku_cachetable_get_checkpoint_pace (CACHETABLE ct, uint64_t *bytes_per_sec, uint64_t *sleep_usec);
 
 // cachetable operations
 
 // create and initialize a cache table
 // size_limit is the upper limit on the size of the size of the values in the table
 // pass 0 if you want the default
+// numa partitions the cachetable over the NUMA nodes of the machine: every
+// node gets its own eviction clock, eviction thread and share of size_limit,
+// PAIRs belong to the node of the thread that created them, and the worker
+// threads of the cachetable are bound to the nodes round-robin
 int toku_cachetable_create_ex(CACHETABLE *result, long size_limit,
                            unsigned long client_pool_threads,
                            unsigned long cachetable_pool_threads,
                            unsigned long checkpoint_pool_threads,
+                           bool numa,
                            LSN initial_lsn, struct tokulogger *logger);
 
 #define toku_cachetable_create(r, s, l, o) \
-    toku_cachetable_create_ex(r, s, 0, 0, 0, l, o);
+    toku_cachetable_create_ex(r, s, 0, 0, 0, false, l, o);
 
 // Create a new cachetable.
 // Effects: a new cachetable is created and initialized.
@@ -144,6 +183,15 @@ char *toku_cachefile_fname_in_cwd (CACHEFILE cf);
 
 void toku_cachetable_begin_checkpoint (CHECKPOINTER cp, struct tokulogger *logger);
 
+// Returns the checkpoint period in seconds if scheduled checkpoints are paced, 0 otherwise.
+uint32_t toku_cachetable_get_paced_checkpoint_period(CHECKPOINTER cp);
+
+// Paces the end of the checkpoint begun with cp, so that the dirty pairs
+// pending at begin are written evenly over about usec microseconds.
+// The write-out stops pacing as soon as hurry returns true.
+// Returns false, and does not pace, if no dirty pairs are pending.
+bool toku_cachetable_pace_checkpoint(CHECKPOINTER cp, uint64_t usec, bool (*hurry)(void));
+
 void toku_cachetable_end_checkpoint(CHECKPOINTER cp, struct tokulogger *logger, 
                                    void (*testcallback_f)(void*),  void * testextra);
 
@@ -263,6 +311,16 @@ typedef void (*CACHETABLE_CLONE_CALLBACK)(void* value_data, void** cloned_value_
 
 typedef void (*CACHETABLE_CHECKPOINT_COMPLETE_CALLBACK)(void *value_data);
 
+// The cachetable calls the prefetch read callback for a batch of prefetches, on a background thread,
+// before fetching any of the PAIRs of the batch that were not in memory. keys holds their keys in
+// increasing order and read_extraargs the corresponding read_extraargs. This gives the client a chance
+// to read the data of all of them with fewer, larger I/Os.
+// Can access fd (fd is protected by a readlock during call)
+typedef void (*CACHETABLE_PREFETCH_READ_CALLBACK)(int fd, int n, CACHEKEY *keys, void **read_extraargs, void *batch_extra);
+
+// The cachetable calls the prefetch done callback once every fetch started by a batch of prefetches is done.
+typedef void (*CACHETABLE_PREFETCH_DONE_CALLBACK)(void *batch_extra);
+
 typedef struct {
     CACHETABLE_FLUSH_CALLBACK flush_callback;
     CACHETABLE_PARTIAL_EVICTION_EST_CALLBACK pe_est_callback;
@@ -428,7 +486,8 @@ int toku_cachetable_maybe_get_and_pin_clean (CACHEFILE, CACHEKEY, uint32_t /*ful
 int toku_cachetable_get_attr(CACHEFILE, CACHEKEY, uint32_t /*fullhash*/, PAIR_ATTR *);
 // Effect: get the attributes for cachekey
 // Returns: 0 if success, non-zero if cachekey is not cached
-// Notes: this function exists for tests
+// Notes: this function exists for tests, and for the cleaner to check
+//  whether a node is in memory
 
 int toku_cachetable_unpin(CACHEFILE, PAIR, enum cachetable_dirty dirty, PAIR_ATTR size);
 // Effect: Unpin a memory object
@@ -480,6 +539,26 @@ int toku_cachefile_prefetch(CACHEFILE cf, CACHEKEY key, uint32_t fullhash,
 //      b) Unlock the cache table.
 //      c) The enqueue'd job later locks the cachetable, and calls cachetable_fetch_pair (doing the steps in A1 above).
 
+int toku_cachefile_prefetch_batch(CACHEFILE cf, int n, CACHEKEY *keys, uint32_t *fullhashes,
+                                  CACHETABLE_WRITE_CALLBACK write_callback,
+                                  CACHETABLE_FETCH_CALLBACK fetch_callback,
+                                  CACHETABLE_PARTIAL_FETCH_REQUIRED_CALLBACK pf_req_callback,
+                                  CACHETABLE_PARTIAL_FETCH_CALLBACK pf_callback,
+                                  CACHETABLE_PREFETCH_READ_CALLBACK read_callback,
+                                  CACHETABLE_PREFETCH_DONE_CALLBACK done_callback,
+                                  void **read_extraargs, // parameters for fetch_callback, pf_req_callback, and pf_callback, one per key
+                                  void *batch_extra, // parameter for read_callback and done_callback
+                                  bool *doing_prefetch);
+// Effect: Prefetch the memory objects for n keys into the cachetable, like n calls to
+//  toku_cachefile_prefetch, but with a single background job that fetches them in key order.
+//  read_callback, which may be NULL, is called before the fetches, with the keys that
+//  were not in memory. doing_prefetch[i] is set if read_extraargs[i] is handed to the job.
+//  done_callback, which may be NULL, is called exactly once, after the job is done, or
+//  before returning if no job was started.
+// Precondition: The cachetable mutex is NOT held.
+// Postcondition: The cachetable mutex is NOT held.
+// Returns: 0 if success
+
 int toku_cachetable_assert_all_unpinned (CACHETABLE);
 
 int toku_cachefile_count_pinned (CACHEFILE, int /*printthem*/ );
@@ -98,6 +98,13 @@ toku_instr_key *rwlock_wait_write_key;
 void toku_checkpoint_get_status(CACHETABLE ct, CHECKPOINT_STATUS statp) {
     cp_status.init();
     CP_STATUS_VAL(CP_PERIOD) = toku_get_checkpoint_period_unlocked(ct);
+    toku_cachetable_get_checkpoint_write_progress(ct,
+                                                  &CP_STATUS_VAL(CP_WRITE_OUT_PENDING),
+                                                  &CP_STATUS_VAL(CP_WRITE_OUT_PROCESSED),
+                                                  &CP_STATUS_VAL(CP_WRITE_OUT_WRITING));
+    toku_cachetable_get_checkpoint_pace(ct,
+                                        &CP_STATUS_VAL(CP_PACED_RATE),
+                                        &CP_STATUS_VAL(CP_PACED_SLEEP_TIME));
     *statp = cp_status;
 }
 
@@ -113,6 +120,8 @@ static volatile bool locked_mo = false;       // true when the multi_operation w
 static volatile bool locked_cs = false;       // true when the checkpoint_safe write lock is held (by checkpoint)
 static volatile uint64_t toku_checkpoint_begin_long_threshold = 1000000; // 1 second
 static volatile uint64_t toku_checkpoint_end_long_threshold = 1000000 * 60; // 1 minute
+// a paced checkpoint aims to be written out after this percentage of the checkpoint period
+static const uint64_t paced_checkpoint_percent = 90;
 
 // Note following static functions are called from checkpoint internal logic only,
 // and use the "writer" calls for locking and unlocking.
@@ -190,6 +199,17 @@ checkpoint_safe_checkpoint_unlock(void) {
     toku_mutex_unlock(&checkpoint_safe_mutex);
 }
 
+// A paced checkpoint stops pacing as soon as anyone waits for the
+// checkpoint_safe lock, so neither a client nor another checkpoint
+// waits for the rest of the period.
+static bool
+checkpoint_safe_lock_has_waiters(void) {
+    toku_mutex_lock(&checkpoint_safe_mutex);
+    bool waiters = checkpoint_safe_lock.blocked_users() > 0;
+    toku_mutex_unlock(&checkpoint_safe_mutex);
+    return waiters;
+}
+
 // toku_xxx_client_(un)lock() functions are only called from client code,
 // never from checkpoint code, and use the "reader" interface to the lock functions.
 
@@ -286,6 +306,18 @@ toku_checkpoint(CHECKPOINTER cp, TOKULOGGER logger,
     }
 
     uint64_t t_checkpoint_end_start = toku_current_time_microsec();
+    if (caller_id == SCHEDULED_CHECKPOINT) {
+        // The pairs dirtied since the last checkpoint are written at the
+        // rate they were dirtied, so that this checkpoint is done just
+        // before the next one begins instead of writing them in a burst.
+        uint32_t period = toku_cachetable_get_paced_checkpoint_period(cp);
+        uint64_t budget = period * 1000000ULL * paced_checkpoint_percent / 100;
+        uint64_t begin_time = t_checkpoint_end_start - t_checkpoint_begin_start;
+        if (budget > begin_time &&
+            toku_cachetable_pace_checkpoint(cp, budget - begin_time, checkpoint_safe_lock_has_waiters)) {
+            CP_STATUS_VAL(CP_PACED_COUNT)++;
+        }
+    }
     toku_cachetable_end_checkpoint(cp, logger, callback2_f, extra2);
     uint64_t t_checkpoint_end_end = toku_current_time_microsec();
 
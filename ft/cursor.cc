@@ -61,6 +61,7 @@ int toku_ft_cursor_create(FT_HANDLE ft_handle, FT_CURSOR cursor, TOKUTXN ttxn,
     cursor->read_type = read_type;
     cursor->disable_prefetching = disable_prefetching;
     cursor->is_temporary = is_temporary;
+    toku_init_dbt_flags(&cursor->value_log_buf, DB_DBT_REALLOC);
     return 0;
 }
 
@@ -69,6 +70,7 @@ void toku_ft_cursor_destroy(FT_CURSOR cursor) {
     toku_destroy_dbt(&cursor->val);
     toku_destroy_dbt(&cursor->range_lock_left_key);
     toku_destroy_dbt(&cursor->range_lock_right_key);
+    toku_destroy_dbt(&cursor->value_log_buf);
 }
 
 // deprecated, should only be used by tests
@@ -253,6 +255,14 @@ int toku_ft_cursor_check_restricted_range(FT_CURSOR c, const void *key, uint32_t
     return 0;
 }
 
+int toku_ft_cursor_decode_value(FT_CURSOR cursor, uint32_t *vallen, void **val) {
+    value_log *vlog = cursor->ft_handle->ft->vlog;
+    if (vlog == nullptr || toku_ft_cursor_is_leaf_mode(cursor)) {
+        return 0;
+    }
+    return vlog->decode(vallen, val, &cursor->value_log_buf);
+}
+
 int toku_ft_cursor_shortcut(FT_CURSOR cursor, int direction, uint32_t index, bn_data *bd,
                             FT_GET_CALLBACK_FUNCTION getf, void *getf_v,
                             uint32_t *keylen, void **key, uint32_t *vallen, void **val) {
@@ -292,6 +302,11 @@ int toku_ft_cursor_shortcut(FT_CURSOR cursor, int direction, uint32_t index, bn_
                 r = 0;
                 break;
             }
+            // only rows that are handed to getf are read from the value log
+            r = toku_ft_cursor_decode_value(cursor, vallen, val);
+            if (r != 0) {
+                break;
+            }
             r = getf(*keylen, *key, *vallen, *val, getf_v, false);
             if (r == TOKUDB_CURSOR_CONTINUE) {
                 continue;
@@ -368,6 +383,7 @@ int toku_ft_cursor_set(FT_CURSOR cursor, DBT *key, FT_GET_CALLBACK_FUNCTION getf
     cursor->direction = 0;
     ft_search search; 
     ft_search_init(&search, toku_ft_cursor_compare_set_range, FT_SEARCH_LEFT, key, nullptr, cursor->ft_handle);
+    search.exact = true;
     int r = ft_cursor_search_eq_k_x(cursor, &search, getf, getf_v);
     ft_search_finish(&search);
     return r;
@@ -57,6 +57,7 @@ struct ft_cursor {
     TOKUTXN ttxn;
     FT_CHECK_INTERRUPT_CALLBACK interrupt_cb;
     void *interrupt_cb_extra;
+    DBT value_log_buf;        // holds the last value read from the value log
 };
 typedef struct ft_cursor *FT_CURSOR;
 
@@ -104,6 +105,10 @@ struct ft_search {
     //   way out with a DB_NOTFOUND we ought to unpin those nodes.  See #3528.
     DBT pivot_bound;
     const DBT *k_bound;
+
+    // True when only a key equal to k will do (DB_SET), so a basement node
+    // whose key filter rules k out can answer without being searched.
+    bool exact;
 };
 
 /* initialize the search compare object */
@@ -116,6 +121,7 @@ static inline ft_search *ft_search_init(ft_search *search, ft_search_compare_fun
     search->context = context;
     toku_init_dbt(&search->pivot_bound);
     search->k_bound = k_bound;
+    search->exact = false;
     return search;
 }
 
@@ -171,6 +177,12 @@ void toku_ft_cursor_peek(FT_CURSOR cursor, const DBT **pkey, const DBT **pval);
 
 int toku_ft_cursor_check_restricted_range(FT_CURSOR cursor, const void *key, uint32_t keylen);
 
+// Effect: If the cursor's dictionary has a value log, turns the stored value
+//  at *val into the user's value, reading it from the value log if it is a
+//  reference.  It stays valid until the cursor decodes another value.  Leaf
+//  mode cursors see stored values as they are.
+int toku_ft_cursor_decode_value(FT_CURSOR cursor, uint32_t *vallen, void **val);
+
 int toku_ft_cursor_shortcut(FT_CURSOR cursor, int direction, uint32_t index, bn_data *bd,
                             FT_GET_CALLBACK_FUNCTION getf, void *getf_v,
                             uint32_t *keylen, void **key, uint32_t *vallen, void **val);
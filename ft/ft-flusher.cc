@@ -75,6 +75,35 @@ static void call_flusher_thread_callback(int flt_state) {
     }
 }
 
+static bool lazy_broadcast = false;
+
+void toku_ft_set_lazy_broadcast(bool enabled) {
+    toku_unsafe_set(&lazy_broadcast, enabled);
+}
+
+bool toku_ft_get_lazy_broadcast(void) {
+    return toku_unsafe_fetch(&lazy_broadcast);
+}
+
+// Returns true if the child's buffer holds only broadcast messages and the
+// child is not in memory, so that flushing the buffer would read and
+// rewrite the child for nothing but the broadcasts.  In lazy broadcast
+// mode the cleaner leaves such buffers pending in the parent: a read
+// applies them on the fly, and the next flush that has to bring the child
+// in anyway, or the hot flusher, takes them down.
+static bool
+child_has_only_cold_broadcasts(FT ft, FTNODE node, int childnum)
+{
+    NONLEAF_CHILDINFO bnc = BNC(node, childnum);
+    const int n_entries = toku_bnc_n_entries(bnc);
+    if (n_entries == 0 || bnc->broadcast_list.size() != (uint32_t) n_entries) {
+        return false;
+    }
+    BLOCKNUM blocknum = BP_BLOCKNUM(node, childnum);
+    PAIR_ATTR attr;
+    return toku_cachetable_get_attr(ft->cf, blocknum, toku_cachetable_hash(ft->cf, blocknum), &attr) != 0;
+}
+
 static int
 find_heaviest_child(FTNODE node)
 {
@@ -413,13 +442,58 @@ ct_update_status(FTNODE child,
     fste->cascades++;
 }
 
+// Like find_heaviest_child, but in lazy broadcast mode it skips the
+// children whose buffers hold only broadcasts for a child that is not in
+// memory, and marks them deferred so they stop counting toward the node's
+// cache pressure.  Returns -1 if there is no child worth flushing.
+static int
+find_heaviest_child_to_clean(FT ft, FTNODE node, bool *deferred)
+{
+    const bool lazy = toku_ft_get_lazy_broadcast();
+    int max_child = -1;
+    uint64_t max_weight = 0;
+    *deferred = false;
+    for (int i = 0; i < node->n_children; i++) {
+        uint64_t this_weight = toku_bnc_nbytesinbuf(BNC(node, i)) + BP_WORKDONE(node, i);
+        if (this_weight == 0) {
+            continue;
+        }
+        if (lazy && child_has_only_cold_broadcasts(ft, node, i)) {
+            BNC(node, i)->broadcasts_deferred = true;
+            *deferred = true;
+            continue;
+        }
+        if (max_child < 0 || max_weight < this_weight) {
+            max_child = i;
+            max_weight = this_weight;
+        }
+    }
+    return max_child;
+}
+
+static int
+ct_pick_child(FT ft,
+              FTNODE parent,
+              void* UU(extra))
+{
+    bool deferred;
+    int childnum = find_heaviest_child_to_clean(ft, parent, &deferred);
+    // The child we meant to flush may have been evicted since the cleaner
+    // callback looked, in which case we flush it anyway.
+    if (childnum < 0) {
+        childnum = find_heaviest_child(parent);
+    }
+    paranoid_invariant(toku_bnc_n_entries(BNC(parent, childnum))>0);
+    return childnum;
+}
+
 static void
 ct_flusher_advice_init(struct flusher_advice *fa, struct flush_status_update_extra* fste, uint32_t nodesize)
 {
     fste->cascades = 0;
     fste->nodesize = nodesize;
     flusher_advice_init(fa,
-                        pick_heaviest_child,
+                        ct_pick_child,
                         do_destroy_basement_nodes,
                         recurse_if_child_is_gorged,
                         ct_maybe_merge_child,
@@ -481,15 +555,17 @@ handle_split_of_child(
 
     node->dirty = 1;
 
-    XREALLOC_N(node->n_children+1, node->bp);
+    toku_ftnode_realloc_partitions(node, node->n_children+1);
     // Slide the children over.
     // suppose n_children is 10 and childnum is 5, meaning node->childnum[5] just got split
     // this moves node->bp[6] through node->bp[9] over to
     // node->bp[7] through node->bp[10]
     for (int cnum=node->n_children; cnum>childnum+1; cnum--) {
         node->bp[cnum] = node->bp[cnum-1];
+        node->bp_meta[cnum] = node->bp_meta[cnum-1];
     }
     memset(&node->bp[childnum+1],0,sizeof(node->bp[0]));
+    memset(&node->bp_meta[childnum+1],0,sizeof(node->bp_meta[0]));
     node->n_children++;
 
     paranoid_invariant(BP_BLOCKNUM(node, childnum).b==childa->blocknum.b); // use the same child
@@ -778,7 +854,7 @@ ftleaf_split(
         }
         else {
             B = *nodeb;
-            REALLOC_N(num_children_in_b,   B->bp);
+            toku_ftnode_realloc_partitions(B, num_children_in_b);
             B->n_children = num_children_in_b;
             for (int i = 0; i < num_children_in_b; i++) {
                 BP_BLOCKNUM(B,i).b = 0;
@@ -817,6 +893,7 @@ ftleaf_split(
             destroy_basement_node(BLB(B, curr_dest_bn_index));
             set_BNULL(B, curr_dest_bn_index);
             B->bp[curr_dest_bn_index] = node->bp[curr_src_bn_index];
+            B->bp_meta[curr_dest_bn_index] = node->bp_meta[curr_src_bn_index];
         }
         if (curr_dest_bn_index < B->n_children) {
             // B already has an empty basement node here.
@@ -843,7 +920,7 @@ ftleaf_split(
         }
 
         node->n_children = num_children_in_node;
-        REALLOC_N(num_children_in_node, node->bp);
+        toku_ftnode_realloc_partitions(node, num_children_in_node);
     }
 
     ftnode_finalize_split(node, B, max_msn_applied_to_node);
@@ -887,7 +964,9 @@ ft_nonleaf_split(
             destroy_nonleaf_childinfo(BNC(B, targchild));
             // now move the bp over
             B->bp[targchild] = node->bp[i];
+            B->bp_meta[targchild] = node->bp_meta[i];
             memset(&node->bp[i], 0, sizeof(node->bp[0]));
+            memset(&node->bp_meta[i], 0, sizeof(node->bp_meta[0]));
         }
 
         // the split key for our parent is the rightmost pivot key in node
@@ -896,7 +975,7 @@ ft_nonleaf_split(
         node->pivotkeys.delete_at(n_children_in_a - 1);
 
         node->n_children = n_children_in_a;
-        REALLOC_N(node->n_children, node->bp);
+        toku_ftnode_realloc_partitions(node, node->n_children);
     }
 
     ftnode_finalize_split(node, B, max_msn_applied_to_node);
@@ -1068,13 +1147,15 @@ merge_leaf_nodes(FTNODE a, FTNODE b)
     }
 
     // realloc basement nodes in `a'
-    REALLOC_N(num_children, a->bp);
+    toku_ftnode_realloc_partitions(a, num_children);
 
     // move each basement node from b to a
     uint32_t offset = a_has_tail ? a->n_children : a->n_children - 1;
     for (int i = 0; i < b->n_children; i++) {
         a->bp[i + offset] = b->bp[i];
+        a->bp_meta[i + offset] = b->bp_meta[i];
         memset(&b->bp[i], 0, sizeof(b->bp[0]));
+        memset(&b->bp_meta[i], 0, sizeof(b->bp_meta[0]));
     }
 
     // append b's pivots to a's pivots
@@ -1157,9 +1238,11 @@ maybe_merge_pinned_nonleaf_nodes(
     int old_n_children = a->n_children;
     int new_n_children = old_n_children + b->n_children;
 
-    XREALLOC_N(new_n_children, a->bp);
+    toku_ftnode_realloc_partitions(a, new_n_children);
     memcpy(a->bp + old_n_children, b->bp, b->n_children * sizeof(b->bp[0]));
+    memcpy(a->bp_meta + old_n_children, b->bp_meta, b->n_children * sizeof(b->bp_meta[0]));
     memset(b->bp, 0, b->n_children * sizeof(b->bp[0]));
+    memset(b->bp_meta, 0, b->n_children * sizeof(b->bp_meta[0]));
 
     a->pivotkeys.insert_at(parent_splitk, old_n_children - 1);
     a->pivotkeys.append(b->pivotkeys);
@@ -1322,7 +1405,10 @@ ft_merge_child(
             memmove(&node->bp[childnumb],
                     &node->bp[childnumb+1],
                     (node->n_children-childnumb)*sizeof(node->bp[0]));
-            REALLOC_N(node->n_children, node->bp);
+            memmove(&node->bp_meta[childnumb],
+                    &node->bp_meta[childnumb+1],
+                    (node->n_children-childnumb)*sizeof(node->bp_meta[0]));
+            toku_ftnode_realloc_partitions(node, node->n_children);
             node->pivotkeys.delete_at(childnuma);
 
             // Handle a merge of the rightmost leaf node.
@@ -1744,11 +1830,15 @@ toku_ftnode_cleaner_callback(
     invariant(node->height > 0);   // we should never pick a leaf node (for now at least)
     FT ft = (FT) extraargs;
     bring_node_fully_into_memory(node, ft);
-    int childnum = find_heaviest_child(node);
-    update_cleaner_status(node, childnum);
+    bool deferred;
+    int childnum = find_heaviest_child_to_clean(ft, node, &deferred);
+    if (deferred) {
+        FL_STATUS_VAL(FT_FLUSHER_CLEANER_BROADCASTS_DEFERRED)++;
+    }
+    update_cleaner_status(node, childnum >= 0 ? childnum : find_heaviest_child(node));
 
     // Either toku_ft_flush_some_child will unlock the node, or we do it here.
-    if (toku_bnc_nbytesinbuf(BNC(node, childnum)) > 0) {
+    if (childnum >= 0 && toku_bnc_nbytesinbuf(BNC(node, childnum)) > 0) {
         struct flusher_advice fa;
         struct flush_status_update_extra fste;
         ct_flusher_advice_init(&fa, &fste, ft->h->nodesize);
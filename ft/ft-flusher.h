@@ -54,6 +54,16 @@ toku_flusher_thread_set_callback(
     void* extra
     );
 
+/**
+ * In lazy broadcast mode the cleaner thread does not flush a buffer that
+ * holds only broadcast messages into a child that is not in memory, so a
+ * broadcast update does not make it read and rewrite every node.  The
+ * broadcasts stay pending in the parent until a read, a flush that brings
+ * the child in anyway, or the hot flusher applies them.  Off by default.
+ */
+void toku_ft_set_lazy_broadcast(bool enabled);
+bool toku_ft_get_lazy_broadcast(void);
+
 /**
  * Puts a workitem on the flusher thread queue, scheduling the node to be
  * flushed by toku_ft_flush_some_child.
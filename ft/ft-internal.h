@@ -48,6 +48,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/ft-ops.h"
 #include "ft/node.h"
 #include "ft/serialize/block_table.h"
+#include "ft/serialize/value_log.h"
 #include "ft/txn/rollback.h"
 #include "ft/ft-status.h"
 
@@ -147,6 +148,12 @@ struct ft_header {
     // This represents the balance of inserts - deletes and should be
     // closer to a logical representation of the number of records in an index
     uint64_t on_disk_logical_rows;
+
+    // values longer than this are kept in the value log, 0 if the
+    // dictionary has none.  Set when the dictionary is created.
+    const uint32_t value_log_threshold;
+    // no reference points below this offset in the value log
+    uint64_t value_log_tail;
 };
 typedef struct ft_header *FT_HEADER;
 
@@ -178,6 +185,9 @@ struct ft {
     // protected by blocktable lock
     block_table blocktable;
 
+    // the value log, if the header has a value log threshold
+    value_log *vlog;
+
     // protected by atomic builtins
     STAT64INFO_S in_memory_stats;
     uint64_t in_memory_logical_rows;
@@ -233,6 +243,7 @@ struct ft_options {
     uint8_t memcmp_magic;
     ft_compare_func compare_fun;
     ft_update_func update_fun;
+    uint32_t value_log_threshold;
 };
 
 struct ft_handle {
@@ -327,6 +338,13 @@ public:
     // then we'll treat it as normal and only decompress the needed partitions etc.
     bool read_all_partitions;
 
+    // set by a batched prefetch that read the node's block off disk along
+    // with the blocks next to it, so that fetching the node does not read it again.
+    // points into a buffer owned by the prefetch
+    uint8_t *prefetched_block;
+    DISKOFF prefetched_offset;
+    DISKOFF prefetched_size;
+
     // Accounting: How many bytes were read, and how much time did we spend doing I/O?
     uint64_t bytes_read;
     tokutime_t io_time;
@@ -411,6 +429,11 @@ void toku_pin_node_with_min_bfe(FTNODE* node, BLOCKNUM b, FT_HANDLE t);
 
 void toku_ft_root_put_msg(FT ft, const ft_msg &msg, txn_gc_info *gc_info);
 
+// Effect: put the messages (type, keys[i], vals[i], xids) into the ft,
+//         sorted by key, pinning the root once for as many as it can take.
+// Requires: type applies to a single key
+void toku_ft_root_put_msgs(FT ft, int n_msgs, const DBT keys[], const DBT vals[], enum ft_msg_type type, XIDS xids, txn_gc_info *gc_info);
+
 // TODO: Rename
 void toku_get_node_for_verify(BLOCKNUM blocknum, FT_HANDLE ft_h, FTNODE* nodep);
 
@@ -446,6 +469,8 @@ void toku_ft_status_update_serialize_times(FTNODE node, tokutime_t serialize_tim
 void toku_ft_status_update_deserialize_times(FTNODE node, tokutime_t deserialize_time, tokutime_t decompress_time);
 void toku_ft_status_note_msn_discard(void);
 void toku_ft_status_note_update(bool broadcast);
+void toku_ft_status_note_ancestors_applied(tokutime_t apply_time, bool parallel);
+void toku_ft_status_note_msg_buffer_compaction(int n_dropped, size_t bytes_dropped);
 void toku_ft_status_note_msg_bytes_out(size_t buffsize);
 void toku_ft_status_note_ftnode(int height, bool created); // created = false means destroyed
 
@@ -162,6 +162,7 @@ basement nodes, bulk fetch,  and partial fetch:
 #include "ft/serialize/ft_layout_version.h"
 #include "ft/serialize/ft_node-serialize.h"
 #include "ft/serialize/sub_block.h"
+#include "ft/serialize/victim_cache.h"
 #include "ft/txn/txn_manager.h"
 #include "ft/txn/xids.h"
 #include "ft/ule.h"
@@ -241,6 +242,7 @@ void toku_ft_get_status(FT_STATUS s) {
             = (uncompressed_leaf_bytes + uncompressed_nonleaf_bytes) /
               (compressed_leaf_bytes + compressed_nonleaf_bytes);
     }
+    s->status[FT_STATUS_S::FT_VICTIM_CACHE_SIZE].value.num = toku_victim_cache_get_size();
 }
 
 void toku_note_deserialized_basement_node(bool fixed_key_size) {
@@ -334,6 +336,9 @@ static long ftnode_cachepressure_size(FTNODE node) {
                 retval += sb->compressed_size;
             }
             else if (BP_STATE(node,i) == PT_AVAIL) {
+                if (BNC(node, i)->broadcasts_deferred) {
+                    continue;
+                }
                 totally_empty = totally_empty && (toku_bnc_n_entries(BNC(node, i)) == 0);
                 retval += get_avail_internal_node_partition_size(node, i);
                 retval += BP_WORKDONE(node, i);
@@ -357,8 +362,9 @@ ftnode_memory_size (FTNODE node)
     long retval = 0;
     int n_children = node->n_children;
     retval += sizeof(*node);
-    retval += (n_children)*(sizeof(node->bp[0]));
+    retval += (n_children)*(sizeof(node->bp[0]) + sizeof(node->bp_meta[0]));
     retval += node->pivotkeys.total_size();
+    retval += node->pivotkeys.eytzinger_index_size();
 
     // now calculate the sizes of the partitions
     for (int i = 0; i < n_children; i++) {
@@ -440,6 +446,10 @@ void ftnode_fetch_extra::_create_internal(FT ft_) {
     disable_prefetching = false;
     read_all_partitions = false;
 
+    prefetched_block = nullptr;
+    prefetched_offset = 0;
+    prefetched_size = 0;
+
     bytes_read = 0;
     io_time = 0;
     deserialize_time = 0;
@@ -659,7 +669,7 @@ void toku_ftnode_clone_callback(void *value_data,
     cloned_node->fullhash = node->fullhash;
     cloned_node->n_children = node->n_children;
 
-    XMALLOC_N(node->n_children, cloned_node->bp);
+    toku_ftnode_alloc_partitions(cloned_node, node->n_children);
     // clone pivots
     cloned_node->pivotkeys.create_from_pivot_keys(node->pivotkeys);
     if (node->height > 0) {
@@ -687,6 +697,13 @@ void toku_ftnode_clone_callback(void *value_data,
         new_attr->is_valid = false;
     }
     *clone_size = ftnode_memory_size(cloned_node);
+    if (node->height == 0) {
+        // cloned basement nodes share their memory with node's until one
+        // side changes it, so only count what is not shared
+        for (int i = 0; i < cloned_node->n_children; i++) {
+            *clone_size -= BLB_DATA(cloned_node, i)->get_shared_memory_size();
+        }
+    }
     *cloned_value_data = cloned_node;
 }
 
@@ -755,6 +772,7 @@ void toku_ftnode_flush_callback(CACHEFILE UU(cachefile),
                 FT_STATUS_INC(FT_FULL_EVICTIONS_NONLEAF, 1);
                 FT_STATUS_INC(FT_FULL_EVICTIONS_NONLEAF_BYTES, node_size);
             }
+            toku_victim_cache_note_evicted(ft, blocknum);
             toku_free(*disk_data);
         } else {
             if (ftnode->height == 0) {
@@ -1082,7 +1100,7 @@ exit:
 // We need a function to have something a drd suppression can reference
 // see src/tests/drd.suppressions (unsafe_touch_clock)
 static void unsafe_touch_clock(FTNODE node, int i) {
-    toku_unsafe_set(&node->bp[i].clock_count, static_cast<unsigned char>(1));
+    toku_unsafe_set(&node->bp_meta[i].clock_count, static_cast<unsigned char>(1));
 }
 
 // Callback that states if a partial fetch of the node is necessary
@@ -1277,6 +1295,20 @@ void toku_ft_status_note_msn_discard(void) {
     FT_STATUS_INC(FT_MSN_DISCARDS, 1);
 }
 
+void toku_ft_status_note_ancestors_applied(tokutime_t apply_time, bool parallel) {
+    FT_STATUS_INC(FT_ANCESTORS_APPLIED_TOKUTIME, apply_time);
+    if (parallel) {
+        FT_STATUS_INC(FT_ANCESTORS_APPLIED_PARALLEL, 1);
+    }
+}
+
+void toku_ft_status_note_msg_buffer_compaction(int n_dropped, size_t bytes_dropped) {
+    FT_STATUS_INC(FT_MSG_BUFFER_COMPACTIONS, 1);
+    FT_STATUS_INC(FT_MSG_BUFFER_COMPACTED_MSGS, n_dropped);
+    FT_STATUS_INC(FT_MSG_BUFFER_COMPACTED_BYTES, bytes_dropped);
+    FT_STATUS_INC(FT_MSG_BYTES_CURR, -bytes_dropped);
+}
+
 void toku_ft_status_note_update(bool broadcast) {
     if (broadcast) {
         FT_STATUS_INC(FT_UPDATES_BROADCAST, 1);
@@ -1432,14 +1464,16 @@ ft_init_new_root(FT ft, FTNODE oldroot, FTNODE *newrootp)
         );
 }
 
-static void inject_message_in_locked_node(
-    FT ft, 
-    FTNODE node, 
-    int childnum, 
-    const ft_msg &msg, 
+static void put_msg_in_locked_node(
+    FT ft,
+    FTNODE node,
+    int childnum,
+    const ft_msg &msg,
     size_t flow_deltas[],
     txn_gc_info *gc_info
-    ) 
+    )
+// Effect:
+//  Assign msg an MSN from ft->h and put it in node, which stays pinned.
 {
     // No guarantee that we're the writer, but oh well.
     // TODO(leif): Implement "do I have the lock or is it someone else?"
@@ -1502,7 +1536,13 @@ static void inject_message_in_locked_node(
 
     // verify that msn of latest message was captured in root node
     paranoid_invariant(msg_with_msn.msn().msn == node->max_msn_applied_to_node_on_disk.msn);
+}
 
+static void unpin_node_after_injection(FT ft, FTNODE node)
+// Effect:
+//  Account for where messages were just injected and unpin node,
+//  or hand it to a background flush if its buffers are gorged.
+{
     if (node->blocknum.b == ft->rightmost_blocknum.b) {
         if (toku_unsafe_fetch(&ft->seqinsert_score) < FT_SEQINSERT_SCORE_THRESHOLD) {
             // we promoted to the rightmost leaf node and the seqinsert score has not yet saturated.
@@ -1523,6 +1563,19 @@ static void inject_message_in_locked_node(
     }
 }
 
+static void inject_message_in_locked_node(
+    FT ft, 
+    FTNODE node, 
+    int childnum, 
+    const ft_msg &msg, 
+    size_t flow_deltas[],
+    txn_gc_info *gc_info
+    ) 
+{
+    put_msg_in_locked_node(ft, node, childnum, msg, flow_deltas, gc_info);
+    unpin_node_after_injection(ft, node);
+}
+
 // seqinsert_loc is a bitmask.
 // The root counts as being both on the "left extreme" and on the "right extreme".
 // Therefore, at the root, you're at LEFT_EXTREME | RIGHT_EXTREME.
@@ -2015,6 +2068,113 @@ void toku_ft_root_put_msg(
     }
 }
 
+struct root_put_msgs_sort_extra {
+    const toku::comparator &cmp;
+    const DBT *keys;
+};
+
+static int root_put_msgs_key_cmp(root_put_msgs_sort_extra &extra, const int &a, const int &b) {
+    int c = extra.cmp(&extra.keys[a], &extra.keys[b]);
+    // ties keep their order in the batch, so a later message for the
+    // same key still gets the larger MSN
+    return c != 0 ? c : (a < b ? -1 : (a > b ? 1 : 0));
+}
+
+static bool root_full_for_batch(FT ft, FTNODE node)
+// Returns: true if the batch should let go of the root before injecting
+//  more: a nonleaf root whose buffers need flushing, or a leaf root that
+//  needs to be split.
+{
+    if (node->height > 0) {
+        return toku_ftnode_nonleaf_is_gorged(node, ft->h->nodesize);
+    }
+    return toku_ftnode_get_reactivity(ft, node) == RE_FISSIBLE;
+}
+
+void toku_ft_root_put_msgs(
+    FT ft,
+    int n_msgs,
+    const DBT keys[],
+    const DBT vals[],
+    enum ft_msg_type type,
+    XIDS xids,
+    txn_gc_info *gc_info
+    )
+// Effect:
+//  Put the messages (type, keys[i], vals[i], xids) into the ft, as
+//  toku_ft_root_put_msg does for one message, but with a single write
+//  lock on the root for as many of them as the root can take.
+//
+//  The messages are sorted by key and injected straight into the root's
+//  buffers (or its basement nodes, when the root is a leaf).  Sorted
+//  keys route to children in one pass over the pivots instead of one
+//  search per message.  Messages for the same key keep their order.
+//  When the root's buffers fill up it goes to a background flush, as it
+//  would for a single message, and the rest of the batch pins it again.
+//  Batched messages are never promoted.
+{
+    toku::context promo_ctx(CTX_PROMO);
+
+    // blackhole fractal trees drop all messages, so do nothing.
+    if (ft->blackhole || n_msgs == 0) {
+        return;
+    }
+    paranoid_invariant(ft_msg_type_applies_once(type));
+
+    toku::scoped_malloc order_buf(n_msgs * sizeof(int));
+    int *order = reinterpret_cast<int *>(order_buf.get());
+    for (int i = 0; i < n_msgs; i++) {
+        order[i] = i;
+    }
+    root_put_msgs_sort_extra sort_extra = { ft->cmp, keys };
+    toku::sort<int, root_put_msgs_sort_extra, root_put_msgs_key_cmp>::mergesort_r(order, n_msgs, sort_extra);
+
+    uint32_t fullhash;
+    CACHEKEY root_key;
+    toku_calculate_root_offset_pointer(ft, &root_key, &fullhash);
+
+    int i = 0;
+    while (i < n_msgs) {
+        FTNODE node;
+        ftnode_fetch_extra bfe;
+        bfe.create_for_full_read(ft);
+        {
+            toku::context inject_ctx(CTX_MESSAGE_INJECTION);
+            toku_pin_ftnode(ft, root_key, fullhash, &bfe, PL_WRITE_CHEAP, &node, true);
+        }
+        toku_ftnode_assert_fully_in_memory(node);
+        paranoid_invariant(node->fullhash==fullhash);
+        ft_verify_flags(ft, node);
+        if (toku_ftnode_get_reactivity(ft, node) == RE_FISSIBLE) {
+            // ft_init_new_root leaves the new root pinned for write
+            ft_init_new_root(ft, node, &node);
+            FT_STATUS_INC(FT_PRO_NUM_ROOT_SPLIT, 1);
+        }
+        FT_STATUS_INC(FT_PRO_NUM_ROOT_BATCH_PINS, 1);
+
+        const int first = i;
+        int childnum = 0;
+        do {
+            const DBT *key = &keys[order[i]];
+            while (childnum < node->n_children - 1) {
+                DBT pivot;
+                if (ft->cmp(key, node->pivotkeys.fill_pivot(childnum, &pivot)) <= 0) {
+                    break;
+                }
+                childnum++;
+            }
+            ft_msg msg(key, &vals[order[i]], type, ZERO_MSN, xids);
+            size_t flow_deltas[] = { message_buffer::msg_memsize_in_buffer(msg), 0 };
+            put_msg_in_locked_node(ft, node, childnum, msg, flow_deltas, gc_info);
+            i++;
+        } while (i < n_msgs && !root_full_for_batch(ft, node));
+
+        FT_STATUS_INC(FT_PRO_NUM_INJECT_DEPTH_0, i - first);
+        FT_STATUS_INC(FT_PRO_NUM_ROOT_BATCH_INJECT, i - first);
+        unpin_node_after_injection(ft, node);
+    }
+}
+
 // TODO: Remove me, I'm boring.
 static int ft_compare_keys(FT ft, const DBT *a, const DBT *b)
 // Effect: Compare two keys using the given fractal tree's comparator/descriptor
@@ -2236,6 +2396,18 @@ cleanup:
  
 static void ft_txn_log_insert(FT ft, DBT *key, DBT *val, TOKUTXN txn, bool do_logging, enum ft_msg_type type);
 
+// Effect: If ft has a value log, encodes val into stored in the form
+//  leafentries keep, appending it to the value log if it is large.  The
+//  recovery log keeps val itself, so this is done after logging.
+// Returns: the value to put in the message.
+static DBT *ft_value_for_msg(FT ft, DBT *val, DBT *stored) {
+    if (ft->vlog == nullptr) {
+        return val;
+    }
+    ft->vlog->encode(val, ft->h->value_log_threshold, stored);
+    return stored;
+}
+
 int toku_ft_insert_unique(FT_HANDLE ft_h, DBT *key, DBT *val, TOKUTXN txn, bool do_logging) {
 // Effect: Insert a unique key-val pair into the fractal tree.
 // Return: 0 on success, DB_KEYEXIST if the overwrite constraint failed
@@ -2250,18 +2422,22 @@ int toku_ft_insert_unique(FT_HANDLE ft_h, DBT *key, DBT *val, TOKUTXN txn, bool
                         // no messages above us, we can implicitly promote uxrs based on this xid
                         oldest_referenced_xid_estimate,
                         true);
-    int r = ft_maybe_insert_into_rightmost_leaf(ft_h->ft, key, val, message_xids, FT_INSERT, &gc_info, true);
+    DBT stored;
+    toku_init_dbt_flags(&stored, DB_DBT_REALLOC);
+    DBT *msg_val = ft_value_for_msg(ft_h->ft, val, &stored);
+    int r = ft_maybe_insert_into_rightmost_leaf(ft_h->ft, key, msg_val, message_xids, FT_INSERT, &gc_info, true);
     if (r != 0 && r != DB_KEYEXIST) {
         // Default to a regular unique check + insert algorithm if we couldn't
         // do it based on the rightmost leaf alone.
         int lookup_r = toku_ft_lookup(ft_h, key, getf_nothing, nullptr);
         if (lookup_r == DB_NOTFOUND) {
-            toku_ft_send_insert(ft_h, key, val, message_xids, FT_INSERT, &gc_info);
+            toku_ft_send_insert(ft_h, key, msg_val, message_xids, FT_INSERT, &gc_info);
             r = 0;
         } else {
             r = DB_KEYEXIST;
         }
     }
+    toku_destroy_dbt(&stored);
 
     if (r == 0) {
         ft_txn_log_insert(ft_h->ft, key, val, txn, do_logging, FT_INSERT);
@@ -2437,14 +2613,56 @@ void toku_ft_maybe_insert (FT_HANDLE ft_h, DBT *key, DBT *val, TOKUTXN txn, bool
                             // no messages above us, we can implicitly promote uxrs based on this xid
                             oldest_referenced_xid_estimate,
                             txn != nullptr ? !txn->for_recovery : false);
-        int r = ft_maybe_insert_into_rightmost_leaf(ft_h->ft, key, val, message_xids, FT_INSERT, &gc_info, false);
+        DBT stored;
+        toku_init_dbt_flags(&stored, DB_DBT_REALLOC);
+        DBT *msg_val = ft_value_for_msg(ft_h->ft, val, &stored);
+        int r = ft_maybe_insert_into_rightmost_leaf(ft_h->ft, key, msg_val, message_xids, FT_INSERT, &gc_info, false);
         if (r != 0) {
-            toku_ft_send_insert(ft_h, key, val, message_xids, type, &gc_info);
+            toku_ft_send_insert(ft_h, key, msg_val, message_xids, type, &gc_info);
         }
+        toku_destroy_dbt(&stored);
         toku_ft_adjust_logical_row_count(ft_h->ft, 1);
     }
 }
 
+void toku_ft_maybe_insert_batch (FT_HANDLE ft_h, int n, DBT keys[], DBT vals[], TOKUTXN txn, bool oplsn_valid, LSN oplsn, bool do_logging, enum ft_msg_type type) {
+    for (int i = 0; i < n; i++) {
+        ft_txn_log_insert(ft_h->ft, &keys[i], &vals[i], txn, do_logging, type);
+    }
+
+    LSN treelsn;
+    if (oplsn_valid && oplsn.lsn <= (treelsn = toku_ft_checkpoint_lsn(ft_h->ft)).lsn) {
+        // do nothing
+    } else {
+        XIDS message_xids = txn ? toku_txn_get_xids(txn) : toku_xids_get_root_xids();
+
+        TXN_MANAGER txn_manager = toku_ft_get_txn_manager(ft_h);
+        txn_manager_state txn_state_for_gc(txn_manager);
+
+        TXNID oldest_referenced_xid_estimate = toku_ft_get_oldest_referenced_xid_estimate(ft_h);
+        txn_gc_info gc_info(&txn_state_for_gc,
+                            oldest_referenced_xid_estimate,
+                            // no messages above us, we can implicitly promote uxrs based on this xid
+                            oldest_referenced_xid_estimate,
+                            txn != nullptr ? !txn->for_recovery : false);
+        if (ft_h->ft->vlog != nullptr) {
+            DBT *XMALLOC_N(n, stored);
+            for (int i = 0; i < n; i++) {
+                toku_init_dbt_flags(&stored[i], DB_DBT_REALLOC);
+                ft_value_for_msg(ft_h->ft, &vals[i], &stored[i]);
+            }
+            toku_ft_root_put_msgs(ft_h->ft, n, keys, stored, type, message_xids, &gc_info);
+            for (int i = 0; i < n; i++) {
+                toku_destroy_dbt(&stored[i]);
+            }
+            toku_free(stored);
+        } else {
+            toku_ft_root_put_msgs(ft_h->ft, n, keys, vals, type, message_xids, &gc_info);
+        }
+        toku_ft_adjust_logical_row_count(ft_h->ft, n);
+    }
+}
+
 static void ft_insert_directly_into_leaf(FT ft, FTNODE leaf, int target_childnum, DBT *key, DBT *val,
                                          XIDS message_xids, enum ft_msg_type type, txn_gc_info *gc_info)
 // Effect: Insert directly into a leaf node a fractal tree. Does not do any logging.
@@ -2479,6 +2697,8 @@ void toku_ft_maybe_update(FT_HANDLE ft_h,
                           bool oplsn_valid,
                           LSN oplsn,
                           bool do_logging) {
+    // handles with an update function cannot open a value log dictionary
+    paranoid_invariant(ft_h->ft->vlog == nullptr);
     TXNID_PAIR xid = toku_txn_get_txnid(txn);
     if (txn) {
         BYTESTRING keybs = {key->size, (char *)key->data};
@@ -2522,6 +2742,7 @@ void toku_ft_maybe_update(FT_HANDLE ft_h,
 void toku_ft_maybe_update_broadcast(FT_HANDLE ft_h, const DBT *update_function_extra,
                                 TOKUTXN txn, bool oplsn_valid, LSN oplsn,
                                 bool do_logging, bool is_resetting_op) {
+    paranoid_invariant(ft_h->ft->vlog == nullptr);
     TXNID_PAIR xid = toku_txn_get_txnid(txn);
     uint8_t  resetting = is_resetting_op ? 1 : 0;
     if (txn) {
@@ -2636,6 +2857,48 @@ void toku_ft_send_delete(FT_HANDLE ft_handle, DBT *key, XIDS xids, txn_gc_info *
     toku_ft_root_put_msg(ft_handle->ft, msg, gc_info);
 }
 
+void toku_ft_delete_range(FT_HANDLE ft_handle, DBT *min_key, DBT *max_key, TOKUTXN txn) {
+    toku_ft_maybe_delete_range(ft_handle, min_key, max_key, txn, false, ZERO_LSN, true);
+}
+
+void toku_ft_maybe_delete_range(FT_HANDLE ft_h, DBT *min_key, DBT *max_key, TOKUTXN txn, bool oplsn_valid, LSN oplsn, bool do_logging) {
+    XIDS message_xids = toku_xids_get_root_xids(); //By default use committed messages
+    TXNID_PAIR xid = toku_txn_get_txnid(txn);
+    if (txn) {
+        // The deletes are spread over every leaf the range reaches, so
+        // they are committed or aborted the way a broadcast update is:
+        // with a broadcast for this transaction's xids.
+        toku_logger_save_rollback_cmdupdatebroadcast(txn, toku_cachefile_filenum(ft_h->ft->cf), false);
+        toku_txn_maybe_note_ft(txn, ft_h->ft);
+        message_xids = toku_txn_get_xids(txn);
+    }
+    TOKULOGGER logger = toku_txn_logger(txn);
+    if (do_logging && logger) {
+        BYTESTRING minbs = {.len=min_key->size, .data=(char *) min_key->data};
+        BYTESTRING maxbs = {.len=max_key->size, .data=(char *) max_key->data};
+        toku_log_enq_deleterange(logger, (LSN*)0, 0, txn, toku_cachefile_filenum(ft_h->ft->cf), xid, minbs, maxbs);
+    }
+
+    LSN treelsn;
+    if (oplsn_valid && oplsn.lsn <= (treelsn = toku_ft_checkpoint_lsn(ft_h->ft)).lsn) {
+        // do nothing
+    } else {
+        TXN_MANAGER txn_manager = toku_ft_get_txn_manager(ft_h);
+        txn_manager_state txn_state_for_gc(txn_manager);
+
+        TXNID oldest_referenced_xid_estimate = toku_ft_get_oldest_referenced_xid_estimate(ft_h);
+        txn_gc_info gc_info(&txn_state_for_gc,
+                            oldest_referenced_xid_estimate,
+                            // no messages above us, we can implicitly promote uxrs based on this xid
+                            oldest_referenced_xid_estimate,
+                            txn != nullptr ? !txn->for_recovery : false);
+        // The number of rows deleted is not known until the message
+        // reaches the leaves, so the logical row count is adjusted there.
+        ft_msg msg(min_key, max_key, FT_DELETE_RANGE, ZERO_MSN, message_xids);
+        toku_ft_root_put_msg(ft_h->ft, msg, &gc_info);
+    }
+}
+
 /* ******************** open,close and create  ********************** */
 
 // Test only function (not used in running system). This one has no env
@@ -2856,6 +3119,24 @@ toku_ft_handle_get_fanout(FT_HANDLE ft_handle, unsigned int *fanout)
     }
 }
 
+void
+toku_ft_handle_set_value_log_threshold(FT_HANDLE ft_handle, uint32_t threshold)
+{
+    // only dictionaries created by this handle take it
+    ft_handle->options.value_log_threshold = threshold;
+}
+
+void
+toku_ft_handle_get_value_log_threshold(FT_HANDLE ft_handle, uint32_t *threshold)
+{
+    if (ft_handle->ft) {
+        *threshold = ft_handle->ft->h->value_log_threshold;
+    }
+    else {
+        *threshold = ft_handle->options.value_log_threshold;
+    }
+}
+
 // The memcmp magic byte may be set on a per fractal tree basis to communicate
 // that if two keys begin with this byte, they may be compared with the builtin
 // key comparison function. This greatly optimizes certain in-memory workloads,
@@ -2944,7 +3225,8 @@ toku_ft_handle_inherit_options(FT_HANDLE t, FT ft) {
         .flags = ft->h->flags,
         .memcmp_magic = ft->cmp.get_memcmp_magic(),
         .compare_fun = ft->cmp.get_compare_func(),
-        .update_fun = ft->update_fun
+        .update_fun = ft->update_fun,
+        .value_log_threshold = ft->h->value_log_threshold
     };
     t->options = options;
     t->did_set_flags = true;
@@ -2988,7 +3270,7 @@ ft_handle_open(FT_HANDLE ft_h, const char *fname_in_env, int is_create, int only
                 toku_logger_save_rollback_fcreate(txn, reserved_filenum, &bs); // bs is a copy of the fname relative to the environment
             }
             txn_created = (bool)(txn!=NULL);
-            toku_logger_log_fcreate(txn, fname_in_env, reserved_filenum, file_mode, ft_h->options.flags, ft_h->options.nodesize, ft_h->options.basementnodesize, ft_h->options.compression_method);
+            toku_logger_log_fcreate(txn, fname_in_env, reserved_filenum, file_mode, ft_h->options.flags, ft_h->options.nodesize, ft_h->options.basementnodesize, ft_h->options.compression_method, ft_h->options.value_log_threshold);
             r = ft_create_file(ft_h, fname_in_cwd, &fd);
             if (r) { goto exit; }
         }
@@ -3000,7 +3282,8 @@ ft_handle_open(FT_HANDLE ft_h, const char *fname_in_env, int is_create, int only
     if (is_create) {
         r = toku_read_ft_and_store_in_cachefile(ft_h, cf, max_acceptable_lsn, &ft);
         if (r==TOKUDB_DICTIONARY_NO_HEADER) {
-            toku_ft_create(&ft, &ft_h->options, cf, txn);
+            r = toku_ft_create(&ft, &ft_h->options, cf, txn);
+            if (r) { goto exit; }
         }
         else if (r!=0) {
             goto exit;
@@ -3032,6 +3315,11 @@ ft_handle_open(FT_HANDLE ft_h, const char *fname_in_env, int is_create, int only
         r = EINVAL;
         goto exit;
     }
+    // update functions would see stored values, not the user's
+    if (ft->vlog != nullptr && ft_h->options.update_fun != nullptr) {
+        r = EINVAL;
+        goto exit;
+    }
     toku_ft_handle_inherit_options(ft_h, ft);
 
     if (!was_already_open) {
@@ -3355,6 +3643,18 @@ ft_search_basement_node(
     }
     return EINVAL;  // This return and the goto are a hack to get both compile-time and run-time checking on enum
 ok: ;
+    if (search->exact && toku_ft_get_basement_bloom_bits_per_key() > 0 &&
+        ftcursor->ft_handle->ft->cmp.get_compare_func() == toku_builtin_compare_fun) {
+        FT_STATUS_INC(FT_BASEMENT_BLOOM_CHECKS, 1);
+        if (!bn->data_buffer.may_contain_key(search->k)) {
+            // Messages have been applied and k falls in this basement
+            // node's range, so k is nowhere in the tree.  Finish the way a
+            // search that landed on the next key up would have.
+            FT_STATUS_INC(FT_BASEMENT_BLOOM_NEGATIVES, 1);
+            int r = getf(0, nullptr, 0, nullptr, getf_v, false);
+            return r == 0 ? TOKUDB_FOUND_BUT_REJECTED : r;
+        }
+    }
     uint32_t idx = 0;
     LEAFENTRY le;
     uint32_t keylen;
@@ -3419,6 +3719,9 @@ got_a_good_value:
                        ftcursor->read_type, ftcursor->ttxn,
                        &vallen, &val);
         r = toku_ft_cursor_check_restricted_range(ftcursor, key, keylen);
+        if (r == 0) {
+            r = toku_ft_cursor_decode_value(ftcursor, &vallen, &val);
+        }
         if (r == 0) {
             r = getf(keylen, key, vallen, val, getf_v, false);
         }
@@ -3495,35 +3798,74 @@ CACHETABLE_WRITE_CALLBACK get_write_callbacks_for_node(FT ft) {
     return wc;
 }
 
+// the most nodes a cursor prefetches at once
+static const int max_nodes_to_prefetch = 4;
+
+struct ftnode_prefetch_batch {
+    FT ft;
+    int n_bufs;
+    uint8_t *bufs[max_nodes_to_prefetch];
+};
+
 static void
-ft_node_maybe_prefetch(FT_HANDLE ft_handle, FTNODE node, int childnum, FT_CURSOR ftcursor, bool *doprefetch) {
-    // the number of nodes to prefetch
-    const int num_nodes_to_prefetch = 1;
+ftnode_prefetch_read_callback(int fd, int n, CACHEKEY *keys, void **read_extraargs, void *batch_extra) {
+    struct ftnode_prefetch_batch *CAST_FROM_VOIDP(batch, batch_extra);
+    ftnode_fetch_extra **bfes = reinterpret_cast<ftnode_fetch_extra **>(read_extraargs);
+    batch->n_bufs = toku_ftnode_prefetch_read_blocks(fd, batch->ft, n, keys, bfes, batch->bufs);
+}
 
+static void
+ftnode_prefetch_done_callback(void *batch_extra) {
+    struct ftnode_prefetch_batch *CAST_FROM_VOIDP(batch, batch_extra);
+    for (int i = 0; i < batch->n_bufs; i++) {
+        toku_free(batch->bufs[i]);
+    }
+    toku_free(batch);
+}
+
+static void
+ft_node_maybe_prefetch(FT_HANDLE ft_handle, FTNODE node, int childnum, FT_CURSOR ftcursor, bool *doprefetch) {
     // if we want to prefetch in the tree
-    // then prefetch the next children if there are any
+    // then prefetch the next children if there are any, in one batch
     if (*doprefetch && toku_ft_cursor_prefetching(ftcursor) && !ftcursor->disable_prefetching) {
         int rc = ft_cursor_rightmost_child_wanted(ftcursor, ft_handle, node);
-        for (int i = childnum + 1; (i <= childnum + num_nodes_to_prefetch) && (i <= rc); i++) {
-            BLOCKNUM nextchildblocknum = BP_BLOCKNUM(node, i);
-            uint32_t nextfullhash = compute_child_fullhash(ft_handle->ft->cf, node, i);
+        BLOCKNUM blocknums[max_nodes_to_prefetch];
+        uint32_t fullhashes[max_nodes_to_prefetch];
+        void *bfes[max_nodes_to_prefetch];
+        bool doing_prefetch[max_nodes_to_prefetch];
+        int n = 0;
+        for (int i = childnum + 1; (i <= childnum + max_nodes_to_prefetch) && (i <= rc); i++) {
+            blocknums[n] = BP_BLOCKNUM(node, i);
+            fullhashes[n] = compute_child_fullhash(ft_handle->ft->cf, node, i);
             ftnode_fetch_extra *XCALLOC(bfe);
             bfe->create_for_prefetch(ft_handle->ft, ftcursor);
-            bool doing_prefetch = false;
-            toku_cachefile_prefetch(
+            bfes[n] = bfe;
+            n++;
+        }
+        if (n > 0) {
+            struct ftnode_prefetch_batch *XCALLOC(batch);
+            batch->ft = ft_handle->ft;
+            toku_cachefile_prefetch_batch(
                 ft_handle->ft->cf,
-                nextchildblocknum,
-                nextfullhash,
+                n,
+                blocknums,
+                fullhashes,
                 get_write_callbacks_for_node(ft_handle->ft),
                 ftnode_fetch_callback_and_free_bfe,
                 toku_ftnode_pf_req_callback,
                 ftnode_pf_callback_and_free_bfe,
-                bfe,
-                &doing_prefetch
+                ftnode_prefetch_read_callback,
+                ftnode_prefetch_done_callback,
+                bfes,
+                batch,
+                doing_prefetch
                 );
-            if (!doing_prefetch) {
-                bfe->destroy();
-                toku_free(bfe);
+            for (int i = 0; i < n; i++) {
+                if (!doing_prefetch[i]) {
+                    ftnode_fetch_extra *CAST_FROM_VOIDP(bfe, bfes[i]);
+                    bfe->destroy();
+                    toku_free(bfe);
+                }
             }
             *doprefetch = false;
         }
@@ -3647,6 +3989,14 @@ toku_ft_search_which_child(const toku::comparator &cmp, FTNODE node, ft_search *
     int lo = 0;
     int hi = node->n_children - 1;
     int mi;
+    // a point query or set range looks for the first pivot >= its key,
+    // which the pivots can find without the comparator if it is a memcmp
+    if (search->compare == toku_ft_cursor_compare_set_range &&
+        search->direction == FT_SEARCH_LEFT &&
+        (node->pivotkeys.eytzinger_lower_bound(cmp, search->k, &mi) ||
+         node->pivotkeys.memcmp_lower_bound(cmp, search->k, &mi))) {
+        lo = hi = mi;
+    }
     while (lo < hi) {
         mi = (lo + hi) / 2;
         node->pivotkeys.fill_pivot(mi, &pivotkey);
@@ -4710,6 +5060,9 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
     block_table_mutex_key = new toku_instr_key(
         toku_instr_object_type::mutex, toku_instr_group_name,
         "block_table_mutex");
+    victim_cache_mutex_key = new toku_instr_key(
+        toku_instr_object_type::mutex, toku_instr_group_name,
+        "victim_cache_mutex");
     rollback_log_node_cache_mutex_key = new toku_instr_key(
         toku_instr_object_type::mutex, toku_instr_group_name,
         "rollback_log_node_cache_mutex");
@@ -4902,6 +5255,7 @@ static void toku_pfs_keys_destroy(void) {
     delete loader_out_mutex_key;
     delete result_output_condition_lock_mutex_key;
     delete block_table_mutex_key;
+    delete victim_cache_mutex_key;
     delete rollback_log_node_cache_mutex_key;
     delete txn_lock_mutex_key;
     delete txn_state_lock_mutex_key;
@@ -4989,6 +5343,7 @@ int toku_ft_layer_init(void) {
     toku_context_status_init();
     toku_checkpoint_init();
     toku_ft_serialize_layer_init();
+    toku_victim_cache_init();
     toku_mutex_init(
         *ft_open_close_lock_mutex_key, &ft_open_close_lock, nullptr);
     toku_scoped_malloc_init();
@@ -4998,6 +5353,7 @@ exit:
 
 void toku_ft_layer_destroy(void) {
     toku_mutex_destroy(&ft_open_close_lock);
+    toku_victim_cache_destroy();
     toku_ft_serialize_layer_destroy();
     toku_checkpoint_destroy();
     toku_context_status_destroy();
@@ -5110,6 +5466,9 @@ int toku_ft_rename_iname(DB_TXN *txn,
     if (!toku_create_subdirs_if_needed(new_iname_full.get()))
         return get_error_errno();
     r = toku_os_rename(old_iname_full.get(), new_iname_full.get());
+    if (r != 0)
+        return r;
+    r = value_log::rename_with_dictionary(old_iname_full.get(), new_iname_full.get());
     if (r != 0)
         return r;
     r = toku_fsync_directory(new_iname_full.get());
@@ -5130,6 +5489,110 @@ int toku_ft_get_fragmentation(FT_HANDLE ft_handle, TOKU_DB_FRAGMENTATION report)
     return r;
 }
 
+struct value_log_gc_extra {
+    // the part of the value log being emptied
+    uint64_t tail;
+    uint64_t limit;
+    // set when the current row refers into it and can be moved
+    bool move;
+    DBT key;
+    uint64_t offset;
+    uint32_t vallen;
+    // set when a row with more than one version refers into it
+    bool busy;
+};
+
+static int
+value_log_gc_getf(uint32_t keylen, const void *key, uint32_t UU(vallen), const void *val, void *extra, bool lock_only) {
+    if (lock_only || key == nullptr) {
+        return 0;
+    }
+    struct value_log_gc_extra *CAST_FROM_VOIDP(info, extra);
+    // a leaf mode cursor gets whole leafentries
+    LEAFENTRY CAST_FROM_VOIDP(le, const_cast<void *>(val));
+    ULEHANDLE ule = toku_ule_create(le);
+    const uint64_t num_uxrs = ule_num_uxrs(ule);
+    for (uint64_t i = 0; i < num_uxrs; i++) {
+        UXRHANDLE uxr = ule_get_uxr(ule, i);
+        uint64_t offset;
+        uint32_t ref_vallen;
+        if (uxr_is_insert(uxr) &&
+            value_log::decode_ref(uxr_get_val(uxr), uxr_get_vallen(uxr), &offset, &ref_vallen) &&
+            offset >= info->tail && offset < info->limit) {
+            if (num_uxrs == 1 && ule_is_committed(ule, i)) {
+                info->move = true;
+                toku_memdup_dbt(&info->key, key, keylen);
+                info->offset = offset;
+                info->vallen = ref_vallen;
+            } else {
+                // moving it would lose the other versions
+                info->busy = true;
+            }
+        }
+    }
+    toku_ule_free(ule);
+    return 0;
+}
+
+int toku_ft_value_log_gc(FT_HANDLE ft_handle, uint64_t gc_bytes) {
+    FT ft = ft_handle->ft;
+    if (ft->vlog == nullptr) {
+        return 0;
+    }
+    struct value_log_gc_extra info;
+    toku_ft_lock(ft);
+    info.tail = ft->h->value_log_tail;
+    toku_ft_unlock(ft);
+    const uint64_t end = ft->vlog->end();
+    info.limit = gc_bytes < end - info.tail ? info.tail + gc_bytes : end;
+    info.busy = false;
+    toku_init_dbt(&info.key);
+    DBT buf;
+    toku_init_dbt_flags(&buf, DB_DBT_REALLOC);
+
+    ft_cursor cursor;
+    int r = toku_ft_cursor_create(ft_handle, &cursor, nullptr, C_READ_ANY, false, false);
+    if (r != 0) {
+        return r;
+    }
+    toku_ft_cursor_set_leaf_mode(&cursor);
+    info.move = false;
+    r = toku_ft_cursor_first(&cursor, value_log_gc_getf, &info);
+    while (r == 0) {
+        if (info.move) {
+            // Insert the value again, which appends it to the end of the
+            // value log.  The cursor looks for the next row by key, so it
+            // does not mind the tree changing under it.
+            void *valp;
+            r = ft->vlog->read(info.offset, info.vallen, &buf, &valp);
+            if (r != 0) {
+                break;
+            }
+            DBT val;
+            toku_ft_insert(ft_handle, &info.key, toku_fill_dbt(&val, valp, info.vallen), nullptr);
+            toku_destroy_dbt(&info.key);
+            info.move = false;
+        }
+        r = toku_ft_cursor_next(&cursor, value_log_gc_getf, &info);
+    }
+    toku_ft_cursor_destroy(&cursor);
+    toku_destroy_dbt(&info.key);
+    toku_destroy_dbt(&buf);
+    if (r == DB_NOTFOUND) {
+        r = info.busy ? TOKUDB_TRY_AGAIN : 0;
+    }
+    if (r == 0) {
+        // the next checkpoint makes this durable and gives the space back
+        toku_ft_lock(ft);
+        if (info.limit > ft->h->value_log_tail) {
+            ft->h->value_log_tail = info.limit;
+            ft->h->dirty = 1;
+        }
+        toku_ft_unlock(ft);
+    }
+    return r;
+}
+
 static bool is_empty_fast_iter (FT_HANDLE ft_handle, FTNODE node) {
     if (node->height > 0) {
         for (int childnum=0; childnum<node->n_children; childnum++) {
@@ -75,6 +75,13 @@ void toku_ft_handle_set_compression_method(FT_HANDLE, enum toku_compression_meth
 void toku_ft_handle_get_compression_method(FT_HANDLE, enum toku_compression_method *);
 void toku_ft_handle_set_fanout(FT_HANDLE, unsigned int fanout);
 void toku_ft_handle_get_fanout(FT_HANDLE, unsigned int *fanout);
+// Values longer than the threshold are kept in a value log next to the
+// dictionary (see ft/serialize/value_log.h).  It only applies to a
+// dictionary the handle creates; 0, the default, means no value log.
+// Dictionaries with a value log do not support update messages: opening
+// one with a handle that has an update function fails with EINVAL.
+void toku_ft_handle_set_value_log_threshold(FT_HANDLE, uint32_t threshold);
+void toku_ft_handle_get_value_log_threshold(FT_HANDLE, uint32_t *threshold);
 int toku_ft_handle_set_memcmp_magic(FT_HANDLE, uint8_t magic);
 
 void toku_ft_set_bt_compare(FT_HANDLE ft_handle, ft_compare_func cmp_func);
@@ -168,6 +175,9 @@ void toku_ft_optimize (FT_HANDLE ft_h);
 
 // Effect: Insert a key and data pair into an ft if the oplsn is newer than the ft's lsn.  This function is called during recovery.
 void toku_ft_maybe_insert (FT_HANDLE ft_h, DBT *k, DBT *v, TOKUTXN txn, bool oplsn_valid, LSN oplsn, bool do_logging, enum ft_msg_type type);
+// Effect: Insert the n rows (keys[i], vals[i]) as toku_ft_maybe_insert would,
+//         but put them in the tree with one pass through the root.
+void toku_ft_maybe_insert_batch (FT_HANDLE ft_h, int n, DBT keys[], DBT vals[], TOKUTXN txn, bool oplsn_valid, LSN oplsn, bool do_logging, enum ft_msg_type type);
 
 // Effect: Send an update message into an ft.  This function is called
 // during recovery.
@@ -193,6 +203,13 @@ void toku_ft_delete (FT_HANDLE ft_h, DBT *k, TOKUTXN txn);
 // Effect: Delete a key from an ft if the oplsn is newer than the ft lsn.  This function is called during recovery.
 void toku_ft_maybe_delete (FT_HANDLE ft_h, DBT *k, TOKUTXN txn, bool oplsn_valid, LSN oplsn, bool do_logging);
 
+// Effect: Delete every key in [min_key, max_key] from an ft with one message.
+//  The keys are removed lazily, as the message is flushed down to the leaves.
+void toku_ft_delete_range(FT_HANDLE ft_h, DBT *min_key, DBT *max_key, TOKUTXN txn);
+
+// Effect: Delete every key in [min_key, max_key] from an ft if the oplsn is newer than the ft lsn.  This function is called during recovery.
+void toku_ft_maybe_delete_range(FT_HANDLE ft_h, DBT *min_key, DBT *max_key, TOKUTXN txn, bool oplsn_valid, LSN oplsn, bool do_logging);
+
 TXNID toku_ft_get_oldest_referenced_xid_estimate(FT_HANDLE ft_h);
 struct txn_manager *toku_ft_get_txn_manager(FT_HANDLE ft_h);
 
@@ -272,6 +289,15 @@ void toku_maybe_preallocate_in_file (int fd, int64_t size, int64_t expected_size
 
 int toku_ft_get_fragmentation(FT_HANDLE ft_h, TOKU_DB_FRAGMENTATION report) __attribute__ ((warn_unused_result));
 
+int toku_ft_value_log_gc(FT_HANDLE ft_h, uint64_t gc_bytes) __attribute__ ((warn_unused_result));
+// Effect: Moves the rows that refer to the oldest gc_bytes of the value log to
+//  the end of it, by inserting their values again, then advances the value
+//  log's tail past that part.  The next checkpoint gives its space back.
+//  toku_ft_get_value_log_garbage() tells how much of the log is garbage.
+// Requires: No other thread writes to the dictionary.
+// Returns: 0 on success, TOKUDB_TRY_AGAIN if a row with uncommitted or older
+//  versions refers to that part, in which case the tail stays where it was.
+
 bool toku_ft_is_empty_fast (FT_HANDLE ft_h) __attribute__ ((warn_unused_result));
 // Effect: Return true if there are no messages or leaf entries in the tree.  If so, it's empty.  If there are messages  or leaf entries, we say it's not empty
 // even though if we were to optimize the tree it might turn out that they are empty.
@@ -91,6 +91,12 @@ void CHECKPOINT_STATUS_S::init(void) {
     CP_STATUS_INIT(CP_END_TIME,                             CHECKPOINT_END_TIME,            UINT64,     "checkpoint end time");
     CP_STATUS_INIT(CP_LONG_END_COUNT,                       CHECKPOINT_LONG_END_COUNT,      UINT64,     "long checkpoint end count");
     CP_STATUS_INIT(CP_LONG_END_TIME,                        CHECKPOINT_LONG_END_TIME,       UINT64,     "long checkpoint end time");
+    CP_STATUS_INIT(CP_WRITE_OUT_PENDING,                    CHECKPOINT_WRITE_OUT_PENDING,   UINT64,     "pairs pending write-out");
+    CP_STATUS_INIT(CP_WRITE_OUT_PROCESSED,                  CHECKPOINT_WRITE_OUT_PROCESSED, UINT64,     "pairs processed by write-out");
+    CP_STATUS_INIT(CP_WRITE_OUT_WRITING,                    CHECKPOINT_WRITE_OUT_WRITING,   UINT64,     "cloned pairs being written");
+    CP_STATUS_INIT(CP_PACED_COUNT,                          CHECKPOINT_PACED_COUNT,         UINT64,     "paced checkpoints");
+    CP_STATUS_INIT(CP_PACED_RATE,                           CHECKPOINT_PACED_RATE,          UINT64,     "paced write-out rate (bytes/sec)");
+    CP_STATUS_INIT(CP_PACED_SLEEP_TIME,                     CHECKPOINT_PACED_SLEEP_TIME,    UINT64,     "paced write-out sleep time (usec)");
 
     m_initialized = true;
 #undef CP_STATUS_INIT
@@ -127,6 +133,55 @@ void CACHETABLE_STATUS_S::init() {
     CT_STATUS_INIT(CT_WAIT_PRESSURE_TIME,       CACHETABLE_WAIT_PRESSURE_TIME,          UINT64, "time waiting on cache pressure");
     CT_STATUS_INIT(CT_LONG_WAIT_PRESSURE_COUNT, CACHETABLE_LONG_WAIT_PRESSURE_COUNT,    UINT64, "number of long waits on cache pressure");
     CT_STATUS_INIT(CT_LONG_WAIT_PRESSURE_TIME,  CACHETABLE_LONG_WAIT_PRESSURE_TIME,     UINT64, "long time waiting on cache pressure");
+    CT_STATUS_INIT(CT_PIN_FAST_PATH,            CACHETABLE_PIN_FAST_PATH,               UINT64, "pins: fast path");
+    CT_STATUS_INIT(CT_PIN_SLOW_PATH,            CACHETABLE_PIN_SLOW_PATH,               UINT64, "pins: slow path");
+    CT_STATUS_INIT(CT_EVICTOR_SHARDS,           CACHETABLE_EVICTOR_SHARDS,              UINT64, "evictor: number of clock shards");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_0_EVICTIONS, CACHETABLE_EVICTOR_SHARD_0_EVICTIONS,  UINT64, "evictor shard 0: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_1_EVICTIONS, CACHETABLE_EVICTOR_SHARD_1_EVICTIONS,  UINT64, "evictor shard 1: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_2_EVICTIONS, CACHETABLE_EVICTOR_SHARD_2_EVICTIONS,  UINT64, "evictor shard 2: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_3_EVICTIONS, CACHETABLE_EVICTOR_SHARD_3_EVICTIONS,  UINT64, "evictor shard 3: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_4_EVICTIONS, CACHETABLE_EVICTOR_SHARD_4_EVICTIONS,  UINT64, "evictor shard 4: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_5_EVICTIONS, CACHETABLE_EVICTOR_SHARD_5_EVICTIONS,  UINT64, "evictor shard 5: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_6_EVICTIONS, CACHETABLE_EVICTOR_SHARD_6_EVICTIONS,  UINT64, "evictor shard 6: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_SHARD_7_EVICTIONS, CACHETABLE_EVICTOR_SHARD_7_EVICTIONS,  UINT64, "evictor shard 7: evictions");
+    CT_STATUS_INIT(CT_EVICTOR_GHOST_HITS,        CACHETABLE_EVICTOR_GHOST_HITS,         UINT64, "evictor: ghost list hits");
+    CT_STATUS_INIT(CT_CLEANER_ADAPTIVE,          CACHETABLE_CLEANER_ADAPTIVE,           UINT64, "cleaner adaptive");
+    CT_STATUS_INIT(CT_CLEANER_ADAPTIVE_THREADS,  CACHETABLE_CLEANER_ADAPTIVE_THREADS,   UINT64, "cleaner adaptive threads");
+    CT_STATUS_INIT(CT_CLEANER_ADAPTIVE_ITERATIONS, CACHETABLE_CLEANER_ADAPTIVE_ITERATIONS, UINT64, "cleaner adaptive iterations per thread");
+    CT_STATUS_INIT(CT_CLEANER_ADAPTIVE_IDLE,     CACHETABLE_CLEANER_ADAPTIVE_IDLE,      UINT64, "cleaner adaptive idle runs");
+    CT_STATUS_INIT(CT_NUMA_NODES,                CACHETABLE_NUMA_NODES,                 UINT64, "numa: number of nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_0_SIZE, CACHETABLE_NUMA_NODE_0_SIZE, UINT64, "numa node 0: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_0_PINS, CACHETABLE_NUMA_NODE_0_PINS, UINT64, "numa node 0: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_0_REMOTE_PINS, CACHETABLE_NUMA_NODE_0_REMOTE_PINS, UINT64, "numa node 0: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_0_MISSES, CACHETABLE_NUMA_NODE_0_MISSES, UINT64, "numa node 0: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_1_SIZE, CACHETABLE_NUMA_NODE_1_SIZE, UINT64, "numa node 1: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_1_PINS, CACHETABLE_NUMA_NODE_1_PINS, UINT64, "numa node 1: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_1_REMOTE_PINS, CACHETABLE_NUMA_NODE_1_REMOTE_PINS, UINT64, "numa node 1: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_1_MISSES, CACHETABLE_NUMA_NODE_1_MISSES, UINT64, "numa node 1: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_2_SIZE, CACHETABLE_NUMA_NODE_2_SIZE, UINT64, "numa node 2: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_2_PINS, CACHETABLE_NUMA_NODE_2_PINS, UINT64, "numa node 2: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_2_REMOTE_PINS, CACHETABLE_NUMA_NODE_2_REMOTE_PINS, UINT64, "numa node 2: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_2_MISSES, CACHETABLE_NUMA_NODE_2_MISSES, UINT64, "numa node 2: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_3_SIZE, CACHETABLE_NUMA_NODE_3_SIZE, UINT64, "numa node 3: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_3_PINS, CACHETABLE_NUMA_NODE_3_PINS, UINT64, "numa node 3: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_3_REMOTE_PINS, CACHETABLE_NUMA_NODE_3_REMOTE_PINS, UINT64, "numa node 3: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_3_MISSES, CACHETABLE_NUMA_NODE_3_MISSES, UINT64, "numa node 3: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_4_SIZE, CACHETABLE_NUMA_NODE_4_SIZE, UINT64, "numa node 4: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_4_PINS, CACHETABLE_NUMA_NODE_4_PINS, UINT64, "numa node 4: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_4_REMOTE_PINS, CACHETABLE_NUMA_NODE_4_REMOTE_PINS, UINT64, "numa node 4: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_4_MISSES, CACHETABLE_NUMA_NODE_4_MISSES, UINT64, "numa node 4: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_5_SIZE, CACHETABLE_NUMA_NODE_5_SIZE, UINT64, "numa node 5: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_5_PINS, CACHETABLE_NUMA_NODE_5_PINS, UINT64, "numa node 5: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_5_REMOTE_PINS, CACHETABLE_NUMA_NODE_5_REMOTE_PINS, UINT64, "numa node 5: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_5_MISSES, CACHETABLE_NUMA_NODE_5_MISSES, UINT64, "numa node 5: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_6_SIZE, CACHETABLE_NUMA_NODE_6_SIZE, UINT64, "numa node 6: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_6_PINS, CACHETABLE_NUMA_NODE_6_PINS, UINT64, "numa node 6: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_6_REMOTE_PINS, CACHETABLE_NUMA_NODE_6_REMOTE_PINS, UINT64, "numa node 6: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_6_MISSES, CACHETABLE_NUMA_NODE_6_MISSES, UINT64, "numa node 6: misses");
+    CT_STATUS_INIT(CT_NUMA_NODE_7_SIZE, CACHETABLE_NUMA_NODE_7_SIZE, UINT64, "numa node 7: size");
+    CT_STATUS_INIT(CT_NUMA_NODE_7_PINS, CACHETABLE_NUMA_NODE_7_PINS, UINT64, "numa node 7: pins");
+    CT_STATUS_INIT(CT_NUMA_NODE_7_REMOTE_PINS, CACHETABLE_NUMA_NODE_7_REMOTE_PINS, UINT64, "numa node 7: pins from other nodes");
+    CT_STATUS_INIT(CT_NUMA_NODE_7_MISSES, CACHETABLE_NUMA_NODE_7_MISSES, UINT64, "numa node 7: misses");
     
     CT_STATUS_INIT(CT_POOL_CLIENT_NUM_THREADS,                  CACHETABLE_POOL_CLIENT_NUM_THREADS,                 UINT64, "client pool: number of threads in pool");
     CT_STATUS_INIT(CT_POOL_CLIENT_NUM_THREADS_ACTIVE,           CACHETABLE_POOL_CLIENT_NUM_THREADS_ACTIVE,          UINT64, "client pool: number of currently active threads in pool");
@@ -316,6 +371,8 @@ void FT_STATUS_S::init() {
     FT_STATUS_INIT(FT_PRO_NUM_ROOT_SPLIT,                     PROMOTION_ROOTS_SPLIT,                PARCOUNT, "promotion: roots split");
     FT_STATUS_INIT(FT_PRO_NUM_ROOT_H0_INJECT,                 PROMOTION_LEAF_ROOTS_INJECTED_INTO,   PARCOUNT, "promotion: leaf roots injected into");
     FT_STATUS_INIT(FT_PRO_NUM_ROOT_H1_INJECT,                 PROMOTION_H1_ROOTS_INJECTED_INTO,     PARCOUNT, "promotion: h1 roots injected into");
+    FT_STATUS_INIT(FT_PRO_NUM_ROOT_BATCH_PINS,                PROMOTION_ROOT_BATCH_PINS,            PARCOUNT, "promotion: roots pinned for a batch of messages");
+    FT_STATUS_INIT(FT_PRO_NUM_ROOT_BATCH_INJECT,              PROMOTION_ROOT_BATCH_INJECTED,        PARCOUNT, "promotion: messages injected into roots in a batch");
     FT_STATUS_INIT(FT_PRO_NUM_INJECT_DEPTH_0,                 PROMOTION_INJECTIONS_AT_DEPTH_0,      PARCOUNT, "promotion: injections at depth 0");
     FT_STATUS_INIT(FT_PRO_NUM_INJECT_DEPTH_1,                 PROMOTION_INJECTIONS_AT_DEPTH_1,      PARCOUNT, "promotion: injections at depth 1");
     FT_STATUS_INIT(FT_PRO_NUM_INJECT_DEPTH_2,                 PROMOTION_INJECTIONS_AT_DEPTH_2,      PARCOUNT, "promotion: injections at depth 2");
@@ -333,6 +390,19 @@ void FT_STATUS_S::init() {
     FT_STATUS_INIT(FT_PRO_RIGHTMOST_LEAF_SHORTCUT_FAIL_REACTIVE,RIGHTMOST_LEAF_SHORTCUT_FAIL_REACTIVE, PARCOUNT, "promotion: tried the rightmost leaf shorcut but failed (child reactive)");
 
     FT_STATUS_INIT(FT_CURSOR_SKIP_DELETED_LEAF_ENTRY,         CURSOR_SKIP_DELETED_LEAF_ENTRY,       PARCOUNT, "cursor skipped deleted leaf entries");
+    FT_STATUS_INIT(FT_BASEMENT_BLOOM_CHECKS,                  BASEMENT_BLOOM_CHECKS,                PARCOUNT, "basement bloom filter: point lookups checked");
+    FT_STATUS_INIT(FT_BASEMENT_BLOOM_NEGATIVES,               BASEMENT_BLOOM_NEGATIVES,             PARCOUNT, "basement bloom filter: point lookups answered without a search");
+    FT_STATUS_INIT(FT_ANCESTORS_APPLIED_TOKUTIME,             ANCESTORS_APPLIED_SECONDS,            TOKUTIME, "ancestors' messages applied to leaves (seconds)");
+    FT_STATUS_INIT(FT_ANCESTORS_APPLIED_PARALLEL,             ANCESTORS_APPLIED_PARALLEL,           PARCOUNT, "leaves with ancestors' messages applied in parallel");
+    FT_STATUS_INIT(FT_MSG_BUFFER_COMPACTIONS,                 MESSAGE_BUFFER_COMPACTIONS,           PARCOUNT, "message buffer compaction: buffers compacted");
+    FT_STATUS_INIT(FT_MSG_BUFFER_COMPACTED_MSGS,              MESSAGE_BUFFER_COMPACTED_MESSAGES,    PARCOUNT, "message buffer compaction: superseded messages dropped");
+    FT_STATUS_INIT(FT_MSG_BUFFER_COMPACTED_BYTES,             MESSAGE_BUFFER_COMPACTED_BYTES,       PARCOUNT, "message buffer compaction: bytes dropped");
+
+    FT_STATUS_INIT(FT_VICTIM_CACHE_HITS,                      VICTIM_CACHE_HITS,                    PARCOUNT, "victim cache: reads served from memory");
+    FT_STATUS_INIT(FT_VICTIM_CACHE_MISSES,                    VICTIM_CACHE_MISSES,                  PARCOUNT, "victim cache: reads that went to disk");
+    FT_STATUS_INIT(FT_VICTIM_CACHE_SIZE,                      VICTIM_CACHE_SIZE,                    UINT64,   "victim cache: size (bytes)");
+    FT_STATUS_INIT(FT_PREFETCH_COALESCED_READS,               PREFETCH_COALESCED_READS,             PARCOUNT, "prefetch: coalesced reads");
+    FT_STATUS_INIT(FT_PREFETCH_COALESCED_NODES,               PREFETCH_COALESCED_NODES,             PARCOUNT, "prefetch: nodes read by coalesced reads");
 
     m_initialized = true;
 #undef FT_STATUS_INIT
@@ -367,6 +437,7 @@ void FT_FLUSHER_STATUS_S::init() {
     FL_STATUS_INIT(FT_FLUSHER_CLEANER_NUM_LEAF_MERGES_RUNNING,     FLUSHER_CLEANER_NUM_LEAF_MERGES_RUNNING,     UINT64, "cleaner thread leaf merges in progress");
     FL_STATUS_INIT(FT_FLUSHER_CLEANER_NUM_LEAF_MERGES_COMPLETED,   FLUSHER_CLEANER_NUM_LEAF_MERGES_COMPLETED,   UINT64, "cleaner thread leaf merges successful");
     FL_STATUS_INIT(FT_FLUSHER_CLEANER_NUM_DIRTIED_FOR_LEAF_MERGE,  FLUSHER_CLEANER_NUM_DIRTIED_FOR_LEAF_MERGE,  UINT64, "nodes dirtied by cleaner thread leaf merges");
+    FL_STATUS_INIT(FT_FLUSHER_CLEANER_BROADCASTS_DEFERRED,         FLUSHER_CLEANER_BROADCASTS_DEFERRED,         UINT64, "times cleaner thread left broadcasts pending for a child not in memory");
     FL_STATUS_INIT(FT_FLUSHER_FLUSH_TOTAL,                         FLUSHER_FLUSH_TOTAL,                         UINT64, "total number of flushes done by flusher threads or cleaner threads");
     FL_STATUS_INIT(FT_FLUSHER_FLUSH_IN_MEMORY,                     FLUSHER_FLUSH_IN_MEMORY,                     UINT64, "number of in memory flushes");
     FL_STATUS_INIT(FT_FLUSHER_FLUSH_NEEDED_IO,                     FLUSHER_FLUSH_NEEDED_IO,                     UINT64, "number of flushes that read something off disk");
@@ -113,6 +113,12 @@ public:
         CP_END_TIME,
         CP_LONG_END_TIME,
         CP_LONG_END_COUNT,
+        CP_WRITE_OUT_PENDING,    // pairs pending when the last checkpoint began
+        CP_WRITE_OUT_PROCESSED,  // how many of them the checkpoint thread has processed
+        CP_WRITE_OUT_WRITING,    // cloned pairs queued or being written by the checkpoint pool
+        CP_PACED_COUNT,          // how many checkpoints spread their write-out over the period
+        CP_PACED_RATE,           // target write rate in bytes/sec of the last paced checkpoint
+        CP_PACED_SLEEP_TIME,     // time paced checkpoints waited to keep to their write rate
         CP_STATUS_NUM_ROWS       // number of rows in this status array.  must be last.
     };
 
@@ -156,6 +162,55 @@ public:
         CT_WAIT_PRESSURE_TIME,
         CT_LONG_WAIT_PRESSURE_COUNT,
         CT_LONG_WAIT_PRESSURE_TIME,
+        CT_PIN_FAST_PATH,          // number of read pins taken without the pair's mutex
+        CT_PIN_SLOW_PATH,          // number of pins that went through the pair's mutex
+        CT_EVICTOR_SHARDS,         // number of shards the eviction clock is split into
+        CT_EVICTOR_SHARD_0_EVICTIONS, // evictions started by each shard of the evictor
+        CT_EVICTOR_SHARD_1_EVICTIONS,
+        CT_EVICTOR_SHARD_2_EVICTIONS,
+        CT_EVICTOR_SHARD_3_EVICTIONS,
+        CT_EVICTOR_SHARD_4_EVICTIONS,
+        CT_EVICTOR_SHARD_5_EVICTIONS,
+        CT_EVICTOR_SHARD_6_EVICTIONS,
+        CT_EVICTOR_SHARD_7_EVICTIONS,
+        CT_EVICTOR_GHOST_HITS,     // number of PAIRs read back in while remembered by the ghost list
+        CT_CLEANER_ADAPTIVE,       // whether the cleaner sizes its work by the bytes buffered
+        CT_CLEANER_ADAPTIVE_THREADS,    // threads used by the last adaptive cleaner run
+        CT_CLEANER_ADAPTIVE_ITERATIONS, // iterations per thread of the last adaptive cleaner run
+        CT_CLEANER_ADAPTIVE_IDLE,  // adaptive cleaner runs skipped because nothing was buffered
+        CT_NUMA_NODES,             // number of NUMA nodes the cachetable is partitioned over, 0 if not in NUMA mode
+        CT_NUMA_NODE_0_SIZE, // size of the PAIRs, pins, pins from threads on another node and misses of each NUMA node
+        CT_NUMA_NODE_0_PINS,
+        CT_NUMA_NODE_0_REMOTE_PINS,
+        CT_NUMA_NODE_0_MISSES,
+        CT_NUMA_NODE_1_SIZE,
+        CT_NUMA_NODE_1_PINS,
+        CT_NUMA_NODE_1_REMOTE_PINS,
+        CT_NUMA_NODE_1_MISSES,
+        CT_NUMA_NODE_2_SIZE,
+        CT_NUMA_NODE_2_PINS,
+        CT_NUMA_NODE_2_REMOTE_PINS,
+        CT_NUMA_NODE_2_MISSES,
+        CT_NUMA_NODE_3_SIZE,
+        CT_NUMA_NODE_3_PINS,
+        CT_NUMA_NODE_3_REMOTE_PINS,
+        CT_NUMA_NODE_3_MISSES,
+        CT_NUMA_NODE_4_SIZE,
+        CT_NUMA_NODE_4_PINS,
+        CT_NUMA_NODE_4_REMOTE_PINS,
+        CT_NUMA_NODE_4_MISSES,
+        CT_NUMA_NODE_5_SIZE,
+        CT_NUMA_NODE_5_PINS,
+        CT_NUMA_NODE_5_REMOTE_PINS,
+        CT_NUMA_NODE_5_MISSES,
+        CT_NUMA_NODE_6_SIZE,
+        CT_NUMA_NODE_6_PINS,
+        CT_NUMA_NODE_6_REMOTE_PINS,
+        CT_NUMA_NODE_6_MISSES,
+        CT_NUMA_NODE_7_SIZE,
+        CT_NUMA_NODE_7_PINS,
+        CT_NUMA_NODE_7_REMOTE_PINS,
+        CT_NUMA_NODE_7_MISSES,
 
         CT_POOL_CLIENT_NUM_THREADS,
         CT_POOL_CLIENT_NUM_THREADS_ACTIVE,
@@ -337,6 +392,8 @@ public:
         FT_PRO_NUM_ROOT_SPLIT,
         FT_PRO_NUM_ROOT_H0_INJECT,
         FT_PRO_NUM_ROOT_H1_INJECT,
+        FT_PRO_NUM_ROOT_BATCH_PINS,   // how many times a batch of messages pinned the root
+        FT_PRO_NUM_ROOT_BATCH_INJECT, // how many messages were injected in those batches
         FT_PRO_NUM_INJECT_DEPTH_0,
         FT_PRO_NUM_INJECT_DEPTH_1,
         FT_PRO_NUM_INJECT_DEPTH_2,
@@ -353,6 +410,18 @@ public:
         FT_PRO_RIGHTMOST_LEAF_SHORTCUT_FAIL_POS,
         FT_PRO_RIGHTMOST_LEAF_SHORTCUT_FAIL_REACTIVE,
         FT_CURSOR_SKIP_DELETED_LEAF_ENTRY, // how many deleted leaf entries were skipped by a cursor
+        FT_BASEMENT_BLOOM_CHECKS,    // how many point lookups consulted a basement node's key filter
+        FT_BASEMENT_BLOOM_NEGATIVES, // how many of those the filter answered without searching the basement node
+        FT_ANCESTORS_APPLIED_TOKUTIME, // seconds spent applying ancestors' messages to leaves
+        FT_ANCESTORS_APPLIED_PARALLEL, // how many leaves had ancestors' messages applied in parallel
+        FT_MSG_BUFFER_COMPACTIONS,     // how many child buffers were compacted
+        FT_MSG_BUFFER_COMPACTED_MSGS,  // how many superseded messages those compactions dropped
+        FT_MSG_BUFFER_COMPACTED_BYTES, // how many bytes of messages those compactions dropped
+        FT_VICTIM_CACHE_HITS,      // how many node and partition reads were served by the victim cache
+        FT_VICTIM_CACHE_MISSES,    // how many node and partition reads had to go to disk while the victim cache was in use
+        FT_VICTIM_CACHE_SIZE,      // bytes of node images in the victim cache
+        FT_PREFETCH_COALESCED_READS, // how many reads of a batched prefetch read more than one node
+        FT_PREFETCH_COALESCED_NODES, // how many nodes were read by those reads
         FT_STATUS_NUM_ROWS
     };
 
@@ -404,6 +473,7 @@ public:
         FT_FLUSHER_CLEANER_NUM_LEAF_MERGES_RUNNING,     // number of cleaner thread leaf merges in progress
         FT_FLUSHER_CLEANER_NUM_LEAF_MERGES_COMPLETED,   // number of times cleaner thread successfully merges a leaf
         FT_FLUSHER_CLEANER_NUM_DIRTIED_FOR_LEAF_MERGE,  // nodes dirtied by the "flush from root" process to merge a leaf node
+        FT_FLUSHER_CLEANER_BROADCASTS_DEFERRED, // number of times cleaner thread left broadcasts pending for a child not in memory
         FT_FLUSHER_FLUSH_TOTAL,                 // total number of flushes done by flusher threads or cleaner threads
         FT_FLUSHER_FLUSH_IN_MEMORY,             // number of in memory flushes
         FT_FLUSHER_FLUSH_NEEDED_IO,             // number of flushes that had to read a child (or part) off disk
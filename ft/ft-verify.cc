@@ -62,12 +62,12 @@ compare_pair_to_key (FT_HANDLE ft_handle, const DBT *a, const void *key, uint32_
 }
 
 static int
-verify_msg_in_child_buffer(FT_HANDLE ft_handle, enum ft_msg_type type, MSN msn, const void *key, uint32_t keylen, const void *UU(data), uint32_t UU(datalen), XIDS UU(xids), const DBT *lesser_pivot, const DBT *greatereq_pivot)
+verify_msg_in_child_buffer(FT_HANDLE ft_handle, enum ft_msg_type type, MSN msn, const void *key, uint32_t keylen, const void *data, uint32_t datalen, XIDS UU(xids), const DBT *lesser_pivot, const DBT *greatereq_pivot)
     __attribute__((warn_unused_result));
 
 UU()
 static int
-verify_msg_in_child_buffer(FT_HANDLE ft_handle, enum ft_msg_type type, MSN msn, const void *key, uint32_t keylen, const void *UU(data), uint32_t UU(datalen), XIDS UU(xids), const DBT *lesser_pivot, const DBT *greatereq_pivot) {
+verify_msg_in_child_buffer(FT_HANDLE ft_handle, enum ft_msg_type type, MSN msn, const void *key, uint32_t keylen, const void *data, uint32_t datalen, XIDS UU(xids), const DBT *lesser_pivot, const DBT *greatereq_pivot) {
     int result = 0;
     if (msn.msn == ZERO_MSN.msn)
         result = EINVAL;
@@ -91,6 +91,19 @@ verify_msg_in_child_buffer(FT_HANDLE ft_handle, enum ft_msg_type type, MSN msn,
                 result = EINVAL;
         }
         break;
+    case FT_DELETE_RANGE:
+        // verify the range [key, data] intersects the child's bounds
+        if (lesser_pivot) {
+            int compare = compare_pair_to_key(ft_handle, lesser_pivot, data, datalen);
+            if (compare >= 0)
+                result = EINVAL;
+        }
+        if (result == 0 && greatereq_pivot) {
+            int compare = compare_pair_to_key(ft_handle, greatereq_pivot, key, keylen);
+            if (compare < 0)
+                result = EINVAL;
+        }
+        break;
     }
     return result;
 }
@@ -157,7 +170,7 @@ int verify_message_tree(const int32_t &offset, const uint32_t UU(idx), struct ve
     ft_msg msg = e->msg_buffer->get_message(offset, &k, &v);
     bool is_fresh = e->msg_buffer->get_freshness(offset);
     if (e->broadcast) {
-        VERIFY_ASSERTION(ft_msg_type_applies_all((enum ft_msg_type) msg.type()) || ft_msg_type_does_nothing((enum ft_msg_type) msg.type()),
+        VERIFY_ASSERTION(ft_msg_type_applies_all((enum ft_msg_type) msg.type()) || ft_msg_type_applies_range((enum ft_msg_type) msg.type()) || ft_msg_type_does_nothing((enum ft_msg_type) msg.type()),
                          e->i, "message found in broadcast list that is not a broadcast");
     } else {
         VERIFY_ASSERTION(ft_msg_type_applies_once((enum ft_msg_type) msg.type()),
@@ -312,7 +325,7 @@ struct verify_msg_fn {
             VERIFY_ASSERTION(total_count <= 1, msg_i, "a message was found in both message trees (or more than once in a single tree)");
             VERIFY_ASSERTION(total_count >= 1, msg_i, "a message was not found in either message tree");
         } else {
-            VERIFY_ASSERTION(ft_msg_type_applies_all(type) || ft_msg_type_does_nothing(type), msg_i, "a message was found that does not apply either to all or to only one key");
+            VERIFY_ASSERTION(ft_msg_type_applies_all(type) || ft_msg_type_applies_range(type) || ft_msg_type_does_nothing(type), msg_i, "a message was found that does not apply to all keys, to a range of keys or to only one key");
             struct count_msgs_extra extra = { .count = 0, .msn = msn, .msg_buffer = &bnc->msg_buffer };
             bnc->broadcast_list.iterate<struct count_msgs_extra, count_msgs>(&extra);
             VERIFY_ASSERTION(extra.count == 1, msg_i, "a broadcast message was not found in the broadcast list");
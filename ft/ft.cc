@@ -45,6 +45,8 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/node.h"
 #include "ft/serialize/ft-serialize.h"
 #include "ft/serialize/ft_node-serialize.h"
+#include "ft/serialize/victim_cache.h"
+#include "ft/ule.h"
 
 #include <memory.h>
 #include <toku_assert.h>
@@ -74,9 +76,43 @@ ft_destroy(FT ft) {
     toku_destroy_dbt(&ft->descriptor.dbt);
     toku_destroy_dbt(&ft->cmp_descriptor.dbt);
     toku_ft_destroy_reflock(ft);
+    if (ft->vlog != nullptr) {
+        ft->vlog->close();
+        toku_free(ft->vlog);
+    }
     toku_free(ft->h);
 }
 
+// Returns: the name of the value log of the dictionary in cf, which is the
+//  dictionary's file name with ".vlog" appended.
+static char *ft_value_log_fname(CACHEFILE cf) {
+    char *fname_in_cwd = toku_cachetable_get_fname_in_cwd(toku_cachefile_get_cachetable(cf),
+                                                          toku_cachefile_fname_in_env(cf));
+    char *fname = value_log::fname_of(fname_in_cwd);
+    toku_free(fname_in_cwd);
+    return fname;
+}
+
+// Effect: Opens ft's value log if its header has a value log threshold,
+//  creating the file if the dictionary is new.
+// Returns: 0 on success, an errno otherwise.  An existing dictionary
+//  whose value log is missing fails with ENOENT.
+static int ft_open_value_log(FT ft, bool create) {
+    if (ft->h->value_log_threshold == 0) {
+        return 0;
+    }
+    char *fname = ft_value_log_fname(ft->cf);
+    value_log *XMALLOC(vlog);
+    int r = vlog->open(fname, create);
+    if (r == 0) {
+        ft->vlog = vlog;
+    } else {
+        toku_free(vlog);
+    }
+    toku_free(fname);
+    return r;
+}
+
 // Make a copy of the header for the purpose of a checkpoint
 // Not reentrant for a single FT.
 // See ft_checkpoint for explanation of why
@@ -97,6 +133,7 @@ ft_copy_for_checkpoint_unlocked(FT ft, LSN checkpoint_lsn) {
 
 void
 toku_ft_free (FT ft) {
+    toku_victim_cache_remove_ft(ft);
     ft_destroy(ft);
     toku_free(ft);
 }
@@ -197,6 +234,12 @@ static void ft_checkpoint (CACHEFILE cf, int fd, void *header_v) {
         ft_hack_highest_unused_msn_for_upgrade_for_checkpoint(ft);
         ch->on_disk_logical_rows =
             ft->h->on_disk_logical_rows = ft->in_memory_logical_rows;
+
+        // every value the checkpointed nodes refer to must be on disk
+        // before the header that makes them the dictionary's contents
+        if (ft->vlog != nullptr) {
+            ft->vlog->fsync();
+        }
                                                              
         // write translation and header to disk (or at least to OS internal buffer)
         toku_serialize_ft_to(fd, ch, &ft->blocktable, ft->cf);
@@ -219,6 +262,11 @@ static void ft_end_checkpoint(CACHEFILE UU(cf), int fd, void *header_v) {
     FT ft = (FT) header_v;
     assert(ft->h->type == FT_CURRENT);
     ft->blocktable.note_end_checkpoint(fd);
+    if (ft->vlog != nullptr) {
+        // like the blocks freed above, no checkpoint refers to the value
+        // log below the tail the new header was written with
+        ft->vlog->reclaim(ft->checkpoint_header->value_log_tail);
+    }
     toku_free(ft->checkpoint_header);
     ft->checkpoint_header = nullptr;
 }
@@ -232,6 +280,12 @@ static void ft_close(CACHEFILE cachefile, int fd, void *header_v, bool oplsn_val
     // This should already never fail.
     invariant(!toku_ft_needed_unlocked(ft));
     assert(ft->cf == cachefile);
+    if (ft->vlog != nullptr && toku_cachefile_is_unlink_on_close(cachefile)) {
+        // the dictionary may have been renamed since the value log was opened
+        char *vlog_fname = ft_value_log_fname(cachefile);
+        ft->vlog->unlink_on_close(vlog_fname);
+        toku_free(vlog_fname);
+    }
     TOKULOGGER logger = toku_cachefile_logger(cachefile);
     LSN lsn = ZERO_LSN;
     //Get LSN
@@ -331,7 +385,9 @@ static void setup_initial_ft_root_node(FT ft, BLOCKNUM blocknum) {
     toku_unpin_ftnode(ft, node);
 }
 
-static void ft_init(FT ft, FT_OPTIONS options, CACHEFILE cf) {
+// Returns: 0 on success, or the error from opening the value log, in which
+//  case nothing has been put in the cachefile.
+static int ft_init(FT ft, FT_OPTIONS options, CACHEFILE cf) {
     // fake, prevent unnecessary upgrade logic
     ft->layout_version_read_from_disk = FT_LAYOUT_VERSION;
     ft->checkpoint_header = NULL;
@@ -347,6 +403,10 @@ static void ft_init(FT ft, FT_OPTIONS options, CACHEFILE cf) {
     }
     ft->cf = cf;
     ft->in_memory_stats = ZEROSTATS;
+    int r = ft_open_value_log(ft, true);
+    if (r != 0) {
+        return r;
+    }
 
     setup_initial_ft_root_node(ft, ft->h->root_blocknum);
     toku_cachefile_set_userdata(ft->cf,
@@ -361,6 +421,7 @@ static void ft_init(FT ft, FT_OPTIONS options, CACHEFILE cf) {
                                 ft_note_unpin_by_checkpoint);
 
     ft->blocktable.verify_no_free_blocknums();
+    return 0;
 }
 
 
@@ -395,13 +456,15 @@ ft_header_create(FT_OPTIONS options, BLOCKNUM root_blocknum, TXNID root_xid_that
         .count_of_optimize_in_progress_read_from_disk = 0,
         .msn_at_start_of_last_completed_optimize = ZERO_MSN,
         .on_disk_stats = ZEROSTATS,
-        .on_disk_logical_rows = 0
+        .on_disk_logical_rows = 0,
+        .value_log_threshold = options->value_log_threshold,
+        .value_log_tail = 0
     };
     return (FT_HEADER) toku_xmemdup(&h, sizeof h);
 }
 
 // allocate and initialize a fractal tree.
-void toku_ft_create(FT *ftp, FT_OPTIONS options, CACHEFILE cf, TOKUTXN txn) {
+int toku_ft_create(FT *ftp, FT_OPTIONS options, CACHEFILE cf, TOKUTXN txn) {
     invariant(ftp);
 
     FT XCALLOC(ft);
@@ -413,9 +476,14 @@ void toku_ft_create(FT *ftp, FT_OPTIONS options, CACHEFILE cf, TOKUTXN txn) {
     ft->blocktable.create();
     ft->blocktable.allocate_blocknum(&ft->h->root_blocknum, ft);
 
-    ft_init(ft, options, cf);
+    int r = ft_init(ft, options, cf);
+    if (r != 0) {
+        toku_ft_free(ft);
+        return r;
+    }
 
     *ftp = ft;
+    return 0;
 }
 
 // TODO: (Zardosht) get rid of ft parameter
@@ -446,6 +514,11 @@ int toku_read_ft_and_store_in_cachefile (FT_HANDLE ft_handle, CACHEFILE cf, LSN
     ft->cmp.create(ft_handle->options.compare_fun, &ft->cmp_descriptor, ft_handle->options.memcmp_magic);
     ft->update_fun = ft_handle->options.update_fun;
     ft->cf = cf;
+    r = ft_open_value_log(ft, false);
+    if (r != 0) {
+        toku_ft_free(ft);
+        return r;
+    }
     toku_cachefile_set_userdata(cf,
                                 reinterpret_cast<void *>(ft),
                                 ft_log_fassociate_during_checkpoint,
@@ -570,7 +643,8 @@ toku_ft_init(FT ft,
         .flags = 0,
         .memcmp_magic = 0,
         .compare_fun = NULL,
-        .update_fun = NULL
+        .update_fun = NULL,
+        .value_log_threshold = 0
     };
     ft->h = ft_header_create(&options, root_blocknum_on_disk, root_xid_that_created);
     ft->h->checkpoint_count = 1;
@@ -1078,6 +1152,72 @@ void toku_ft_get_garbage(FT ft, uint64_t *total_space, uint64_t *used_space) {
     *used_space = info.used_space;
 }
 
+static int
+value_log_garbage_leafentry_helper(const void* key UU(), const uint32_t UU(keylen), const LEAFENTRY & le, uint32_t UU(idx), struct garbage_helper_extra * const info) {
+    // every version of the row, committed or not, keeps its record alive
+    ULEHANDLE ule = toku_ule_create(le);
+    for (uint64_t i = 0; i < ule_num_uxrs(ule); i++) {
+        UXRHANDLE uxr = ule_get_uxr(ule, i);
+        uint64_t offset;
+        uint32_t vallen;
+        if (uxr_is_insert(uxr) &&
+            value_log::decode_ref(uxr_get_val(uxr), uxr_get_vallen(uxr), &offset, &vallen)) {
+            info->used_space += value_log::record_size(vallen);
+        }
+    }
+    toku_ule_free(ule);
+    return 0;
+}
+
+static int
+value_log_garbage_helper(BLOCKNUM blocknum, int64_t UU(size), int64_t UU(address), void *extra) {
+    struct garbage_helper_extra *CAST_FROM_VOIDP(info, extra);
+    FTNODE node;
+    FTNODE_DISK_DATA ndd;
+    ftnode_fetch_extra bfe;
+    bfe.create_for_full_read(info->ft);
+    int fd = toku_cachefile_get_fd(info->ft->cf);
+    int r = toku_deserialize_ftnode_from(fd, blocknum, 0, &node, &ndd, &bfe);
+    if (r != 0) {
+        return r;
+    }
+    if (node->height == 0) {
+        for (int i = 0; i < node->n_children; ++i) {
+            r = BLB_DATA(node, i)->iterate<struct garbage_helper_extra, value_log_garbage_leafentry_helper>(info);
+            if (r != 0) {
+                break;
+            }
+        }
+    }
+    toku_ftnode_free(&node);
+    toku_free(ndd);
+    return r;
+}
+
+void toku_ft_get_value_log_garbage(FT ft, uint64_t *total_space, uint64_t *used_space) {
+// Note: Like toku_ft_get_garbage(), this only looks at the leaves of the last
+//       checkpoint, so references in newer leaves and in message buffers are
+//       not counted.
+    invariant_notnull(total_space);
+    invariant_notnull(used_space);
+    *total_space = 0;
+    *used_space = 0;
+    if (ft->vlog == nullptr) {
+        return;
+    }
+    struct garbage_helper_extra info = {
+        .ft = ft,
+        .total_space = 0,
+        .used_space = 0
+    };
+    ft->blocktable.iterate(block_table::TRANSLATION_CHECKPOINTED, value_log_garbage_helper, &info, true, true);
+    toku_ft_lock(ft);
+    const uint64_t tail = ft->h->value_log_tail;
+    toku_ft_unlock(ft);
+    *total_space = ft->vlog->end() - tail;
+    *used_space = info.used_space;
+}
+
 
 #if !defined(TOKUDB_REVISION)
 #error
@@ -67,7 +67,7 @@ void toku_ft_release_reflock(FT ft);
 void toku_ft_lock(struct ft *ft);
 void toku_ft_unlock(struct ft *ft);
 
-void toku_ft_create(FT *ftp, FT_OPTIONS options, CACHEFILE cf, TOKUTXN txn);
+int toku_ft_create(FT *ftp, FT_OPTIONS options, CACHEFILE cf, TOKUTXN txn);
 void toku_ft_free (FT ft);
 
 int toku_read_ft_and_store_in_cachefile (FT_HANDLE ft_h, CACHEFILE cf, LSN max_acceptable_lsn, FT *header);
@@ -165,6 +165,10 @@ void toku_ft_set_blackhole(FT_HANDLE ft_handle);
 // Effect: Calculates the total space and used space for a FT's leaf data.
 //         The difference between the two is MVCC garbage.
 void toku_ft_get_garbage(FT ft, uint64_t *total_space, uint64_t *used_space);
+// Effect: Like toku_ft_get_garbage(), for the value log: total_space is the
+//  size of the part of the value log that has not been given back, and
+//  used_space the size of the records the checkpointed leaves refer to.
+void toku_ft_get_value_log_garbage(FT ft, uint64_t *total_space, uint64_t *used_space);
 
 // TODO: Should be in portability
 int get_num_cores(void);
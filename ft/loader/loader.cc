@@ -3286,7 +3286,7 @@ static void write_nonleaf_node (FTLOADER bl, struct dbout *out, int64_t blocknum
     }
     toku_free(pivots);
     // TODO: Should be using toku_destroy_ftnode_internals, which should be renamed to toku_ftnode_destroy
-    toku_free(node->bp);
+    toku_ftnode_free_partitions(node);
     node->pivotkeys.destroy();
     toku_free(node);
     toku_free(ndd);
@@ -185,6 +185,7 @@ const struct logtype logtypes[] = {
                         {"uint32_t", "nodesize", 0},
                         {"uint32_t", "basementnodesize", 0},
                         {"uint32_t", "compression_method", 0},
+                        {"uint32_t", "value_log_threshold", 0},
                         NULLFIELD}, SHOULD_LOG_BEGIN},
     //TODO: #2037 Add dname
     {"fopen",   'O', FA{{"BYTESTRING", "iname", 0},
@@ -268,6 +269,11 @@ const struct logtype logtypes[] = {
                                     {"BYTESTRING", "extra", 0},
                                     {"bool",       "is_resetting_op", 0},
                                     NULLFIELD}, SHOULD_LOG_BEGIN},
+    {"enq_deleterange", 'K', FA{{"FILENUM",    "filenum", 0},
+                                {"TXNID_PAIR",      "xid", 0},
+                                {"BYTESTRING", "min_key", 0},
+                                {"BYTESTRING", "max_key", 0},
+                                NULLFIELD}, SHOULD_LOG_BEGIN},
     {"change_fdescriptor", 'D', FA{{"FILENUM",    "filenum", 0},
                             {"TXNID_PAIR",      "xid", 0},
                             {"BYTESTRING", "old_descriptor", 0},
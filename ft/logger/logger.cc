@@ -878,12 +878,13 @@ int toku_logger_restart(TOKULOGGER logger, LSN lastlsn)
 // fname is the iname
 void toku_logger_log_fcreate (TOKUTXN txn, const char *fname, FILENUM filenum, uint32_t mode,
         uint32_t treeflags, uint32_t nodesize, uint32_t basementnodesize,
-        enum toku_compression_method compression_method) {
+        enum toku_compression_method compression_method, uint32_t value_log_threshold) {
     if (txn) {
         BYTESTRING bs_fname = { .len = (uint32_t) strlen(fname), .data = (char *) fname };
         // fsync log on fcreate
         toku_log_fcreate (txn->logger, (LSN*)0, 1, txn, toku_txn_get_txnid(txn), filenum,
-                bs_fname, mode, treeflags, nodesize, basementnodesize, compression_method);
+                bs_fname, mode, treeflags, nodesize, basementnodesize, compression_method,
+                value_log_threshold);
     }
 }
 
@@ -55,6 +55,8 @@ enum {
     TOKU_LOG_VERSION_27 = 27, // no change from 26
     TOKU_LOG_VERSION_28 = 28, // no change from 27
     TOKU_LOG_VERSION_29 = 29, // no change from 28
+    TOKU_LOG_VERSION_30 = 30, // add enq_deleterange log entry
+    TOKU_LOG_VERSION_31 = 31, // no change from 30
     TOKU_LOG_VERSION   = FT_LAYOUT_VERSION, 
     TOKU_LOG_MIN_SUPPORTED_VERSION = FT_LAYOUT_MIN_SUPPORTED_VERSION,
 };
@@ -105,7 +107,7 @@ struct FILENUMS {
     FILENUM *filenums;
 };
 
-void toku_logger_log_fcreate(TOKUTXN txn, const char *fname, FILENUM filenum, uint32_t mode, uint32_t flags, uint32_t nodesize, uint32_t basementnodesize, enum toku_compression_method compression_method);
+void toku_logger_log_fcreate(TOKUTXN txn, const char *fname, FILENUM filenum, uint32_t mode, uint32_t flags, uint32_t nodesize, uint32_t basementnodesize, enum toku_compression_method compression_method, uint32_t value_log_threshold);
 void toku_logger_log_fdelete(TOKUTXN txn, FILENUM filenum);
 void toku_logger_log_fopen(TOKUTXN txn, const char * fname, FILENUM filenum, uint32_t treeflags);
 
@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/logger/log-internal.h"
 #include "ft/logger/logcursor.h"
 #include "ft/txn/txn_manager.h"
+#include "ft/serialize/value_log.h"
 #include "util/omt.h"
 
 int tokuft_recovery_trace = 0;                    // turn on recovery tracing, default off.
@@ -300,7 +301,8 @@ static const char *recover_state(RECOVER_ENV renv) {
 
 // Open the file if it is not already open.  If it is already open, then do nothing.
 static int internal_recover_fopen_or_fcreate (RECOVER_ENV renv, bool must_create, int UU(mode), BYTESTRING *bs_iname, FILENUM filenum, uint32_t treeflags,
-                                              TOKUTXN txn, uint32_t nodesize, uint32_t basementnodesize, enum toku_compression_method compression_method, LSN max_acceptable_lsn) {
+                                              TOKUTXN txn, uint32_t nodesize, uint32_t basementnodesize, enum toku_compression_method compression_method,
+                                              uint32_t value_log_threshold, LSN max_acceptable_lsn) {
     int r = 0;
     FT_HANDLE ft_handle = NULL;
     char *iname = fixup_fname(bs_iname);
@@ -320,6 +322,10 @@ static int internal_recover_fopen_or_fcreate (RECOVER_ENV renv, bool must_create
         toku_ft_handle_set_compression_method(ft_handle, compression_method);
     }
 
+    if (value_log_threshold != 0) {
+        toku_ft_handle_set_value_log_threshold(ft_handle, value_log_threshold);
+    }
+
     // set the key compare functions
     if (!(treeflags & TOKU_DB_KEYCMP_BUILTIN) && renv->bt_compare) {
         toku_ft_set_bt_compare(ft_handle, renv->bt_compare);
@@ -467,7 +473,7 @@ static int toku_recover_fassociate (struct logtype_fassociate *l, RECOVER_ENV re
                 renv->logger->rollback_cachefile = t->ft->cf;
                 toku_logger_initialize_rollback_cache(renv->logger, t->ft);
             } else {
-                r = internal_recover_fopen_or_fcreate(renv, false, 0, &l->iname, l->filenum, l->treeflags, NULL, 0, 0, TOKU_DEFAULT_COMPRESSION_METHOD, max_acceptable_lsn);
+                r = internal_recover_fopen_or_fcreate(renv, false, 0, &l->iname, l->filenum, l->treeflags, NULL, 0, 0, TOKU_DEFAULT_COMPRESSION_METHOD, 0, max_acceptable_lsn);
                 assert(r==0);
             }
         }
@@ -814,12 +820,18 @@ static int toku_recover_fcreate (struct logtype_fcreate *l, RECOVER_ENV renv) {
             return r;
         }
     }
+    r = value_log::unlink_with_dictionary(iname_in_cwd);
+    if (r != 0) {
+        fprintf(stderr, "PerconaFT recovery %s:%d unlink %s.vlog %d\n", __FUNCTION__, __LINE__, iname, r);
+        toku_free(iname);
+        return r;
+    }
     assert(0!=strcmp(iname, toku_product_name_strings.rollback_cachefile)); //Creation of rollback cachefile never gets logged.
     toku_free(iname_in_cwd);
     toku_free(iname);
 
     bool must_create = true;
-    r = internal_recover_fopen_or_fcreate(renv, must_create, l->mode, &l->iname, l->filenum, l->treeflags, txn, l->nodesize, l->basementnodesize, (enum toku_compression_method) l->compression_method, MAX_LSN);
+    r = internal_recover_fopen_or_fcreate(renv, must_create, l->mode, &l->iname, l->filenum, l->treeflags, txn, l->nodesize, l->basementnodesize, (enum toku_compression_method) l->compression_method, l->value_log_threshold, MAX_LSN);
     return r;
 }
 
@@ -843,7 +855,7 @@ static int toku_recover_fopen (struct logtype_fopen *l, RECOVER_ENV renv) {
     char *fname = fixup_fname(&l->iname);
 
     assert(0!=strcmp(fname, toku_product_name_strings.rollback_cachefile)); //Rollback cachefile can be opened only via fassociate.
-    r = internal_recover_fopen_or_fcreate(renv, must_create, 0, &l->iname, l->filenum, l->treeflags, txn, 0, 0, TOKU_DEFAULT_COMPRESSION_METHOD, MAX_LSN);
+    r = internal_recover_fopen_or_fcreate(renv, must_create, 0, &l->iname, l->filenum, l->treeflags, txn, 0, 0, TOKU_DEFAULT_COMPRESSION_METHOD, 0, MAX_LSN);
 
     toku_free(fname);
     return r;
@@ -993,6 +1005,11 @@ static int toku_recover_frename(struct logtype_frename *l, RECOVER_ENV renv) {
          toku_fsync_directory(new_iname_full.get()) == -1))
         return 1;
 
+    // the value log, if there is one, follows the dictionary
+    if (value_log::rename_with_dictionary(old_iname_full.get(),
+                                          new_iname_full.get()) != 0)
+        return 1;
+
     if (file_map_find(&renv->fmap, l->old_filenum, &tuple) != DB_NOTFOUND) {
         if (tuple->iname)
             toku_free(tuple->iname);
@@ -1237,6 +1254,23 @@ static int toku_recover_enq_updatebroadcast(struct logtype_enq_updatebroadcast *
     return 0;
 }
 
+static int toku_recover_enq_deleterange(struct logtype_enq_deleterange *l, RECOVER_ENV renv) {
+    int r;
+    TOKUTXN txn = NULL;
+    toku_txnid2txn(renv->logger, l->xid, &txn);
+    assert(txn != NULL);
+    struct file_map_tuple *tuple = NULL;
+    r = file_map_find(&renv->fmap, l->filenum, &tuple);
+    if (r == 0) {
+        // Maybe do the range delete if we found the cachefile.
+        DBT min_key, max_key;
+        toku_fill_dbt(&min_key, l->min_key.data, l->min_key.len);
+        toku_fill_dbt(&max_key, l->max_key.data, l->max_key.len);
+        toku_ft_maybe_delete_range(tuple->ft_handle, &min_key, &max_key, txn, true, l->lsn, false);
+    }
+    return 0;
+}
+
 static int toku_recover_backward_enq_update(struct logtype_enq_update *UU(l), RECOVER_ENV UU(renv)) {
     // nothing
     return 0;
@@ -1247,6 +1281,11 @@ static int toku_recover_backward_enq_updatebroadcast(struct logtype_enq_updatebr
     return 0;
 }
 
+static int toku_recover_backward_enq_deleterange(struct logtype_enq_deleterange *UU(l), RECOVER_ENV UU(renv)) {
+    // nothing
+    return 0;
+}
+
 static int toku_recover_comment (struct logtype_comment *UU(l), RECOVER_ENV UU(renv)) {
     // nothing
     return 0;
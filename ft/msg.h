@@ -76,7 +76,8 @@ enum ft_msg_type {
     FT_OPTIMIZE = 12,             // Broadcast
     FT_OPTIMIZE_FOR_UPGRADE = 13, // same as FT_OPTIMIZE, but record version number in leafnode
     FT_UPDATE = 14,
-    FT_UPDATE_BROADCAST_ALL = 15
+    FT_UPDATE_BROADCAST_ALL = 15,
+    FT_DELETE_RANGE = 16          // Delete every key in [key, val], both ends inclusive.
 };
 
 static inline bool
@@ -98,6 +99,7 @@ ft_msg_type_applies_once(enum ft_msg_type type)
     case FT_OPTIMIZE:
     case FT_OPTIMIZE_FOR_UPGRADE:
     case FT_UPDATE_BROADCAST_ALL:
+    case FT_DELETE_RANGE:
     case FT_NONE:
         ret_val = false;
         break;
@@ -119,6 +121,7 @@ ft_msg_type_applies_all(enum ft_msg_type type)
     case FT_ABORT_ANY:
     case FT_COMMIT_ANY:
     case FT_UPDATE:
+    case FT_DELETE_RANGE:
         ret_val = false;
         break;
     case FT_COMMIT_BROADCAST_ALL:
@@ -135,6 +138,14 @@ ft_msg_type_applies_all(enum ft_msg_type type)
     return ret_val;
 }
 
+// A range message goes to every child whose key range intersects
+// [kdbt, vdbt], and it is kept with the broadcasts in a child buffer.
+static inline bool
+ft_msg_type_applies_range(enum ft_msg_type type)
+{
+    return (type == FT_DELETE_RANGE);
+}
+
 static inline bool
 ft_msg_type_does_nothing(enum ft_msg_type type)
 {
@@ -40,26 +40,44 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 
 void message_buffer::create() {
     _num_entries = 0;
-    _memory = nullptr;
-    _memory_usable = 0;
-    _memory_size = 0;
+    _arena.create(0);
+    _chunks = nullptr;
+    _num_chunks = 0;
+    _chunks_size = 0;
+    _next_chunk_size = MIN_CHUNK_SIZE;
     _memory_used = 0;
 }
 
 void message_buffer::clone(message_buffer *src) {
     _num_entries = src->_num_entries;
     _memory_used = src->_memory_used;
-    _memory_size = src->_memory_size;
-    XMALLOC_N(_memory_size, _memory);
-    memcpy(_memory, src->_memory, _memory_size);
-    _memory_usable = toku_malloc_usable_size(_memory);
+    _next_chunk_size = src->_next_chunk_size;
+    // the offsets of the messages must not change, so each chunk is
+    // copied to a chunk of its own, all of them in a single allocation
+    _arena.create(_memory_used);
+    _num_chunks = src->_num_chunks;
+    _chunks_size = src->_num_chunks;
+    _chunks = nullptr;
+    if (_num_chunks > 0) {
+        XMALLOC_N(_num_chunks, _chunks);
+    }
+    for (int c = 0; c < _num_chunks; c++) {
+        const struct buffer_chunk *src_chunk = &src->_chunks[c];
+        _chunks[c].buf = (char *) _arena.malloc_from_arena(src_chunk->used);
+        _chunks[c].used = src_chunk->used;
+        _chunks[c].size = src_chunk->used;
+        memcpy(_chunks[c].buf, src_chunk->buf, src_chunk->used);
+    }
 }
 
 void message_buffer::destroy() {
-    if (_memory != nullptr) {
-        toku_free(_memory);
-        _memory_usable = 0;
+    _arena.destroy();
+    if (_chunks != nullptr) {
+        toku_free(_chunks);
+        _chunks = nullptr;
     }
+    _num_chunks = 0;
+    _chunks_size = 0;
 }
 
 void message_buffer::deserialize_from_rbuf(struct rbuf *rb,
@@ -78,7 +96,14 @@ void message_buffer::deserialize_from_rbuf(struct rbuf *rb,
         XMALLOC_N(n_in_this_buffer, *broadcast_offsets);
     }
 
-    _resize(rb->size + 64); // rb->size is a good hint for how big the buffer will be
+    // rb->size is a good hint for how big the buffer will be
+    int64_t size_hint = rb->size + 64;
+    if (size_hint > MAX_CHUNK_SIZE) {
+        size_hint = MAX_CHUNK_SIZE;
+    }
+    if (size_hint > _next_chunk_size) {
+        _next_chunk_size = size_hint;
+    }
 
     // deserialize each message individually, noting whether it was fresh
     // and putting its buffer offset in the appropriate offsets array
@@ -95,7 +120,7 @@ void message_buffer::deserialize_from_rbuf(struct rbuf *rb,
                 dest = stale_offsets ? *stale_offsets + (*nstale)++ : nullptr;
             }
         } else {
-            invariant(ft_msg_type_applies_all(msg.type()) || ft_msg_type_does_nothing(msg.type()));
+            invariant(ft_msg_type_applies_all(msg.type()) || ft_msg_type_applies_range(msg.type()) || ft_msg_type_does_nothing(msg.type()));
             dest = broadcast_offsets ? *broadcast_offsets + (*nbroadcast)++ : nullptr;
         }
 
@@ -151,36 +176,44 @@ MSN message_buffer::deserialize_from_rbuf_v13(struct rbuf *rb,
     return highest_msn_in_this_buffer;
 }
 
-void message_buffer::_resize(size_t new_size) {
-    XREALLOC_N(new_size, _memory);
-    _memory_size = new_size;
-    _memory_usable = toku_malloc_usable_size(_memory);
-}
-
-static int next_power_of_two (int n) {
-    int r = 4096;
-    while (r < n) {
-        r*=2;
-        assert(r>0);
+// Starts a new chunk with room for at least need_space bytes.
+void message_buffer::_add_chunk(int32_t need_space) {
+    // the chunk index must fit in the high bits of a non-negative offset
+    invariant(_num_chunks < (1 << (31 - CHUNK_BITS)));
+    if (_num_chunks == _chunks_size) {
+        _chunks_size = _chunks_size ? 2 * _chunks_size : 4;
+        XREALLOC_N(_chunks_size, _chunks);
+    }
+    int32_t size = _next_chunk_size;
+    if (need_space > size) {
+        // a message bigger than MAX_CHUNK_SIZE fills its chunk exactly,
+        // so that no other message starts past the position bits
+        size = need_space;
+    }
+    struct buffer_chunk *chunk = &_chunks[_num_chunks++];
+    chunk->buf = (char *) _arena.malloc_from_arena(size);
+    chunk->used = 0;
+    chunk->size = size;
+    if (_next_chunk_size < MAX_CHUNK_SIZE) {
+        _next_chunk_size = 2 * _next_chunk_size < MAX_CHUNK_SIZE ? 2 * _next_chunk_size : MAX_CHUNK_SIZE;
     }
-    return r;
 }
 
 struct message_buffer::buffer_entry *message_buffer::get_buffer_entry(int32_t offset) const {
-    return (struct buffer_entry *) (_memory + offset);
+    return (struct buffer_entry *) (_chunks[offset >> CHUNK_BITS].buf + (offset & (MAX_CHUNK_SIZE - 1)));
 }
 
 void message_buffer::enqueue(const ft_msg &msg, bool is_fresh, int32_t *offset) {
     int need_space_here = msg_memsize_in_buffer(msg);
-    int need_space_total = _memory_used + need_space_here;
-    if (_memory == nullptr || need_space_total > _memory_size) {
-        // resize the buffer to the next power of 2 greater than the needed space
-        int next_2 = next_power_of_two(need_space_total);
-        _resize(next_2);
+    if (_num_chunks == 0 ||
+        _chunks[_num_chunks - 1].used + need_space_here > _chunks[_num_chunks - 1].size) {
+        _add_chunk(need_space_here);
     }
+    struct buffer_chunk *chunk = &_chunks[_num_chunks - 1];
+    const int32_t entry_offset = ((_num_chunks - 1) << CHUNK_BITS) | chunk->used;
     uint32_t keylen = msg.kdbt()->size;
     uint32_t datalen = msg.vdbt()->size;
-    struct buffer_entry *entry = get_buffer_entry(_memory_used);
+    struct buffer_entry *entry = (struct buffer_entry *) (chunk->buf + chunk->used);
     entry->type = (unsigned char) msg.type();
     entry->msn = msg.msn();
     toku_xids_cpy(&entry->xids_s, msg.xids());
@@ -191,9 +224,10 @@ void message_buffer::enqueue(const ft_msg &msg, bool is_fresh, int32_t *offset)
     entry->vallen = datalen;
     memcpy(e_key + keylen, msg.vdbt()->data, datalen);
     if (offset) {
-        *offset = _memory_used;
+        *offset = entry_offset;
     }
     _num_entries++;
+    chunk->used += need_space_here;
     _memory_used += need_space_here;
 }
 
@@ -242,22 +276,40 @@ size_t message_buffer::memory_size_in_use() const {
 }
 
 size_t message_buffer::memory_footprint() const {
-#ifdef TOKU_DEBUG_PARANOID
-    // Enable this code if you want to verify that the new way of computing
-    // the memory footprint is the same as the old.
-    // It slows the code down by perhaps 10%.
-    assert(_memory_usable == toku_malloc_usable_size(_memory));
-    size_t fp = toku_memory_footprint(_memory, _memory_used);
-    size_t fpg = toku_memory_footprint_given_usable_size(_memory_used, _memory_usable);
-    if (fp != fpg) printf("ptr=%p mu=%ld fp=%ld fpg=%ld\n", _memory, _memory_usable, fp, fpg);
-    assert(fp  == fpg);
-#endif // TOKU_DEBUG_PARANOID
-    return sizeof(*this) + toku_memory_footprint_given_usable_size(_memory_used, _memory_usable);
+    // the arena's own footprint counts the memarena object, which is part of *this
+    return sizeof(*this) - sizeof(_arena) + _arena.total_footprint() +
+           _chunks_size * sizeof(*_chunks);
 }
 
 bool message_buffer::equals(message_buffer *other) const {
-    return (_memory_used == other->_memory_used &&
-            memcmp(_memory, other->_memory, _memory_used) == 0);
+    if (_memory_used != other->_memory_used || _num_entries != other->_num_entries) {
+        return false;
+    }
+    // the two buffers may split their messages into chunks differently,
+    // so compare them one message at a time
+    int c = 0, other_c = 0;
+    int32_t pos = 0, other_pos = 0;
+    for (int i = 0; i < _num_entries; i++) {
+        while (pos == _chunks[c].used) {
+            c++;
+            pos = 0;
+        }
+        while (other_pos == other->_chunks[other_c].used) {
+            other_c++;
+            other_pos = 0;
+        }
+        DBT k, v, other_k, other_v;
+        const size_t size = msg_memsize_in_buffer(get_message((c << CHUNK_BITS) | pos, &k, &v));
+        const size_t other_size = msg_memsize_in_buffer(
+            other->get_message((other_c << CHUNK_BITS) | other_pos, &other_k, &other_v));
+        if (size != other_size ||
+            memcmp(_chunks[c].buf + pos, other->_chunks[other_c].buf + other_pos, size) != 0) {
+            return false;
+        }
+        pos += size;
+        other_pos += size;
+    }
+    return true;
 }
 
 void message_buffer::serialize_to_wbuf(struct wbuf *wb) const {
@@ -40,6 +40,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/msg.h"
 #include "ft/txn/xids.h"
 #include "util/dbt.h"
+#include "util/memarena.h"
 
 class message_buffer {
 public:
@@ -89,15 +90,18 @@ public:
 
     template <typename F>
     int iterate(F &fn) const {
-        for (int32_t offset = 0; offset < _memory_used; ) {
-            DBT k, v;
-            const ft_msg msg = get_message(offset, &k, &v);
-            bool is_fresh = get_freshness(offset);
-            int r = fn(msg, is_fresh);
-            if (r != 0) {
-                return r;
+        for (int c = 0; c < _num_chunks; c++) {
+            for (int32_t pos = 0; pos < _chunks[c].used; ) {
+                const int32_t offset = (c << CHUNK_BITS) | pos;
+                DBT k, v;
+                const ft_msg msg = get_message(offset, &k, &v);
+                bool is_fresh = get_freshness(offset);
+                int r = fn(msg, is_fresh);
+                if (r != 0) {
+                    return r;
+                }
+                pos += msg_memsize_in_buffer(msg);
             }
-            offset += msg_memsize_in_buffer(msg);
         }
         return 0;
     }
@@ -109,7 +113,22 @@ public:
     static size_t msg_memsize_in_buffer(const ft_msg &msg);
 
 private:
-    void _resize(size_t new_size);
+    // Messages are stored in chunks carved out of _arena, so enqueue never
+    // moves the messages already in the buffer. The offset of a message is
+    // the index of its chunk in the high bits and its position in the chunk
+    // in the low CHUNK_BITS bits. Chunks double in size up to MAX_CHUNK_SIZE,
+    // a message bigger than that gets a chunk of its own.
+    static const int CHUNK_BITS = 20;
+    static const int32_t MIN_CHUNK_SIZE = 4096;
+    static const int32_t MAX_CHUNK_SIZE = 1 << CHUNK_BITS;
+
+    struct buffer_chunk {
+        char   *buf;
+        int32_t used;
+        int32_t size;
+    };
+
+    void _add_chunk(int32_t need_space);
 
     // If this isn't packged, the compiler aligns the xids array and we waste a lot of space
     struct __attribute__((__packed__)) buffer_entry {
@@ -124,8 +143,10 @@ private:
     struct buffer_entry *get_buffer_entry(int32_t offset) const;
 
     int   _num_entries;
-    char *_memory;       // An array of bytes into which buffer entries are embedded.
-    int   _memory_size;  // How big is _memory
-    int   _memory_used;  // How many bytes are in use?
-    size_t _memory_usable; // a cached result of toku_malloc_usable_size(_memory).
+    memarena _arena;             // The memory of the chunks
+    struct buffer_chunk *_chunks; // The chunks, in the order they were filled
+    int   _num_chunks;
+    int   _chunks_size;          // How many chunks fit in _chunks
+    int32_t _next_chunk_size;    // How big the next chunk will be
+    int   _memory_used;          // How many bytes of the chunks are in use?
 };
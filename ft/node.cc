@@ -41,10 +41,29 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/node.h"
 #include "ft/serialize/rbuf.h"
 #include "ft/serialize/wbuf.h"
+#include "ft/serialize/workset.h"
 #include "util/scoped_malloc.h"
 #include "util/sort.h"
+#include "util/threadpool.h"
 
 // Effect: Fill in N as an empty ftnode.
+void toku_ftnode_alloc_partitions(FTNODE node, int n_children) {
+    XCALLOC_N(n_children, node->bp);
+    XCALLOC_N(n_children, node->bp_meta);
+}
+
+void toku_ftnode_realloc_partitions(FTNODE node, int n_children) {
+    XREALLOC_N(n_children, node->bp);
+    XREALLOC_N(n_children, node->bp_meta);
+}
+
+void toku_ftnode_free_partitions(FTNODE node) {
+    toku_free(node->bp);
+    toku_free(node->bp_meta);
+    node->bp = nullptr;
+    node->bp_meta = nullptr;
+}
+
 // TODO: Rename toku_ftnode_create
 void toku_initialize_empty_ftnode(FTNODE n, BLOCKNUM blocknum, int height, int num_children, int layout_version, unsigned int flags) {
     paranoid_invariant(layout_version != 0);
@@ -59,11 +78,12 @@ void toku_initialize_empty_ftnode(FTNODE n, BLOCKNUM blocknum, int height, int n
     n->height = height;
     n->pivotkeys.create_empty();
     n->bp = 0;
+    n->bp_meta = 0;
     n->n_children = num_children;
     n->oldest_referenced_xid_known = TXNID_NONE;
 
     if (num_children > 0) {
-        XMALLOC_N(num_children, n->bp);
+        toku_ftnode_alloc_partitions(n, num_children);
         for (int i = 0; i < num_children; i++) {
             BP_BLOCKNUM(n,i).b=0;
             BP_STATE(n,i) = PT_INVALID;
@@ -105,8 +125,7 @@ void toku_destroy_ftnode_internals(FTNODE node) {
         }
         set_BNULL(node, i);
     }
-    toku_free(node->bp);
-    node->bp = NULL;
+    toku_ftnode_free_partitions(node);
 }
 
 /* Frees a node, including all the stuff in the hash table. */
@@ -566,6 +585,133 @@ apply_ancestors_messages_to_bn(
     curr_bn->stale_ancestor_messages_applied = true;
 }
 
+// When the ancestors of a leaf hold at least this many bytes of
+// messages, its basement nodes are brought up to date in parallel on
+// the ft pool.  Zero means always apply serially.
+static uint64_t parallel_apply_threshold = 1 << 20;
+
+void toku_ft_set_parallel_apply_threshold(uint64_t bytes) {
+    toku_unsafe_set(&parallel_apply_threshold, bytes);
+}
+
+uint64_t toku_ft_get_parallel_apply_threshold(void) {
+    return toku_unsafe_fetch(&parallel_apply_threshold);
+}
+
+static bool
+should_apply_ancestors_messages_in_parallel(FTNODE node, ANCESTORS ancestors) {
+    const uint64_t threshold = toku_ft_get_parallel_apply_threshold();
+    if (threshold == 0 || get_ft_pool() == nullptr) {
+        return false;
+    }
+    int n_avail = 0;
+    for (int i = 0; i < node->n_children; i++) {
+        if (BP_STATE(node, i) == PT_AVAIL) {
+            n_avail++;
+        }
+    }
+    if (n_avail < 2) {
+        return false;
+    }
+    uint64_t pending_bytes = 0;
+    for (ANCESTORS curr_ancestors = ancestors; curr_ancestors; curr_ancestors = curr_ancestors->next) {
+        pending_bytes += toku_bnc_nbytesinbuf(BNC(curr_ancestors->node, curr_ancestors->childnum));
+    }
+    return pending_bytes >= threshold;
+}
+
+struct apply_ancestors_work {
+    struct work base;
+    FT_HANDLE t;
+    FTNODE node;
+    int childnum;
+    ANCESTORS ancestors;
+    const pivot_bounds *bounds;
+    TXNID oldest_referenced_xid_for_simple_gc;
+    bool msgs_applied;
+};
+
+static void *
+apply_ancestors_worker(void *arg) {
+    struct workset *ws = (struct workset *) arg;
+    while (1) {
+        struct apply_ancestors_work *w = (struct apply_ancestors_work *) workset_get(ws);
+        if (w == NULL)
+            break;
+        // The txn manager state is initialized lazily by garbage
+        // collection, so each worker needs its own.
+        txn_manager_state txn_state_for_gc(toku_ft_get_txn_manager(w->t));
+        txn_gc_info gc_info(&txn_state_for_gc,
+                            w->oldest_referenced_xid_for_simple_gc,
+                            w->node->oldest_referenced_xid_known,
+                            true);
+        apply_ancestors_messages_to_bn(
+            w->t,
+            w->node,
+            w->childnum,
+            w->ancestors,
+            *w->bounds,
+            &gc_info,
+            &w->msgs_applied
+            );
+    }
+    workset_release_ref(ws);
+    return arg;
+}
+
+// Bring every available basement node up to date, one basement node per
+// work item.  Basement nodes share no state except the ancestors' message
+// trees, whose marks may already be set concurrently by readers of
+// sibling leaves.
+static void
+apply_ancestors_messages_in_parallel(
+    FT_HANDLE t,
+    FTNODE node,
+    ANCESTORS ancestors,
+    const pivot_bounds &bounds,
+    TXNID oldest_referenced_xid_for_simple_gc,
+    bool* msgs_applied
+    )
+{
+    toku::scoped_malloc work_buf(node->n_children * sizeof(struct apply_ancestors_work));
+    struct apply_ancestors_work *work = reinterpret_cast<struct apply_ancestors_work *>(work_buf.get());
+    struct workset ws;
+    ZERO_STRUCT(ws);
+    workset_init(&ws);
+    int n_work = 0;
+    workset_lock(&ws);
+    for (int i = 0; i < node->n_children; i++) {
+        if (BP_STATE(node, i) != PT_AVAIL) { continue; }
+        work[n_work] = (struct apply_ancestors_work) { .base = {{NULL, NULL}},
+                                                       .t = t,
+                                                       .node = node,
+                                                       .childnum = i,
+                                                       .ancestors = ancestors,
+                                                       .bounds = &bounds,
+                                                       .oldest_referenced_xid_for_simple_gc = oldest_referenced_xid_for_simple_gc,
+                                                       .msgs_applied = false };
+        workset_put_locked(&ws, &work[n_work].base);
+        n_work++;
+    }
+    workset_unlock(&ws);
+    int T = get_num_cores();
+    if (T > n_work)
+        T = n_work;
+    if (T > 0)
+        T = T - 1;
+    toku_thread_pool_run(get_ft_pool(), 0, &T, apply_ancestors_worker, &ws);
+    workset_add_ref(&ws, T);
+    apply_ancestors_worker(&ws);
+    workset_join(&ws);
+    workset_destroy(&ws);
+
+    for (int i = 0; i < n_work; i++) {
+        if (work[i].msgs_applied) {
+            *msgs_applied = true;
+        }
+    }
+}
+
 void
 toku_apply_ancestors_messages_to_node (
     FT_HANDLE t, 
@@ -586,6 +732,8 @@ toku_apply_ancestors_messages_to_node (
 {
     VERIFY_NODE(t, node);
     paranoid_invariant(node->height == 0);
+    tokutime_t t_start = toku_time_now();
+    bool parallel = false;
 
     TXN_MANAGER txn_manager = toku_ft_get_txn_manager(t);
     txn_manager_state txn_state_for_gc(txn_manager);
@@ -614,19 +762,32 @@ toku_apply_ancestors_messages_to_node (
         // flushing on the cleaner thread depends on this. This invariant
         // allows the cleaner thread to just pick an internal node and flush it
         // as opposed to being forced to start from the root.
-        for (int i = 0; i < node->n_children; i++) {
-            if (BP_STATE(node, i) != PT_AVAIL) { continue; }
-            apply_ancestors_messages_to_bn(
+        parallel = should_apply_ancestors_messages_in_parallel(node, ancestors);
+        if (parallel) {
+            apply_ancestors_messages_in_parallel(
                 t,
                 node,
-                i,
                 ancestors,
                 bounds,
-                &gc_info,
+                oldest_referenced_xid_for_simple_gc,
                 msgs_applied
                 );
+        } else {
+            for (int i = 0; i < node->n_children; i++) {
+                if (BP_STATE(node, i) != PT_AVAIL) { continue; }
+                apply_ancestors_messages_to_bn(
+                    t,
+                    node,
+                    i,
+                    ancestors,
+                    bounds,
+                    &gc_info,
+                    msgs_applied
+                    );
+            }
         }
     }
+    toku_ft_status_note_ancestors_applied(toku_time_now() - t_start, parallel);
     VERIFY_NODE(t, node);
 }
 
@@ -769,6 +930,30 @@ void toku_ft_bn_update_max_msn(FTNODE node, MSN max_msn_applied, int child_to_re
     }
 }
 
+// Effect: Insert the message at `offset' into a message tree sorted by
+//   (key, msn).
+// Messages reach a buffer in msn order, and for sequential workloads, or
+// when marked messages are moved to an empty stale tree, in key order as
+// well, so most of them belong at the end of the tree.  Checking that
+// first costs one comparison instead of a search.
+template<typename message_tree_t>
+static void message_tree_insert(message_tree_t &message_tree, int32_t offset, const struct toku_msg_buffer_key_msn_heaviside_extra &extra) {
+    int r;
+    const uint32_t size = message_tree.size();
+    if (size > 0) {
+        int32_t last_offset;
+        r = message_tree.fetch(size - 1, &last_offset);
+        assert_zero(r);
+        if (toku_msg_buffer_key_msn_heaviside(last_offset, extra) < 0) {
+            r = message_tree.insert_at(offset, size);
+            assert_zero(r);
+            return;
+        }
+    }
+    r = message_tree.template insert<struct toku_msg_buffer_key_msn_heaviside_extra, toku_msg_buffer_key_msn_heaviside>(offset, extra, nullptr);
+    assert_zero(r);
+}
+
 struct copy_to_stale_extra {
     FT ft;
     NONLEAF_CHILDINFO bnc;
@@ -781,8 +966,7 @@ int copy_to_stale(const int32_t &offset, const uint32_t UU(idx), struct copy_to_
     DBT key;
     extra->bnc->msg_buffer.get_message_key_msn(offset, &key, &msn);
     struct toku_msg_buffer_key_msn_heaviside_extra heaviside_extra(extra->ft->cmp, &extra->bnc->msg_buffer, &key, msn);
-    int r = extra->bnc->stale_message_tree.insert<struct toku_msg_buffer_key_msn_heaviside_extra, toku_msg_buffer_key_msn_heaviside>(offset, heaviside_extra, nullptr);
-    invariant_zero(r);
+    message_tree_insert(extra->bnc->stale_message_tree, offset, heaviside_extra);
     return 0;
 }
 
@@ -953,7 +1137,7 @@ void toku_ftnode_leaf_rebalance(FTNODE node, unsigned int basementnodesize) {
     invariant(num_children > 0);
 
     node->n_children = num_children;
-    XCALLOC_N(num_children, node->bp);             // allocate pointers to basements (bp)
+    toku_ftnode_alloc_partitions(node, num_children);  // allocate pointers to basements (bp)
     for (int i = 0; i < num_children; i++) {
         set_BLB(node, i, toku_create_empty_bn());  // allocate empty basements and set bp pointers
     }
@@ -1132,7 +1316,7 @@ long toku_bnc_memory_used(NONLEAF_CHILDINFO bnc) {
 void toku_ft_nonleaf_append_child(FTNODE node, FTNODE child, const DBT *pivotkey) {
     int childnum = node->n_children;
     node->n_children++;
-    REALLOC_N(node->n_children, node->bp);
+    toku_ftnode_realloc_partitions(node, node->n_children);
     BP_BLOCKNUM(node,childnum) = child->blocknum;
     BP_STATE(node,childnum) = PT_AVAIL;
     BP_WORKDONE(node, childnum)   = 0;
@@ -1668,6 +1852,56 @@ void toku_ft_bn_apply_msg(
         }
         break;
     }
+    case FT_DELETE_RANGE: {
+        // Apply to the leafentries whose keys are in [msg.kdbt(), msg.vdbt()].
+        uint32_t idx;
+        r = bn->data_buffer.find_zero<decltype(be), toku_msg_leafval_heaviside>(
+            be,
+            &storeddata,
+            &key,
+            &keylen,
+            &idx);
+        invariant(r == 0 || r == DB_NOTFOUND);
+        num_klpairs = bn->data_buffer.num_klpairs();
+        while (idx < num_klpairs) {
+            void* curr_keyp = NULL;
+            uint32_t curr_keylen = 0;
+            r = bn->data_buffer.fetch_klpair(idx, &storeddata, &curr_keylen, &curr_keyp);
+            assert_zero(r);
+            DBT curr_keydbt;
+            toku_fill_dbt(&curr_keydbt, curr_keyp, curr_keylen);
+            if (cmp(&curr_keydbt, msg.vdbt()) > 0) {
+                break;
+            }
+            // As for a broadcast, each leafentry gets a message with its
+            // own key.
+            DBT empty_val;
+            ft_msg curr_msg(
+                &curr_keydbt,
+                toku_init_dbt(&empty_val),
+                msg.type(),
+                msg.msn(),
+                msg.xids());
+            toku_ft_bn_apply_msg_once(
+                bn,
+                curr_msg,
+                idx,
+                curr_keylen,
+                storeddata,
+                gc_info,
+                workdone,
+                stats_to_update,
+                logical_rows_delta);
+            uint32_t new_dmt_size = bn->data_buffer.num_klpairs();
+            if (new_dmt_size != num_klpairs) {
+                paranoid_invariant(new_dmt_size + 1 == num_klpairs);
+                num_klpairs--;
+            } else {
+                idx++;
+            }
+        }
+        break;
+    }
     case FT_NONE: break; // don't do anything
     }
 
@@ -1711,20 +1945,19 @@ static void bnc_insert_msg(NONLEAF_CHILDINFO bnc, const ft_msg &msg, bool is_fre
     int r = 0;
     int32_t offset;
     bnc->msg_buffer.enqueue(msg, is_fresh, &offset);
+    bnc->broadcasts_deferred = false;
     enum ft_msg_type type = msg.type();
     if (ft_msg_type_applies_once(type)) {
         DBT key;
         toku_fill_dbt(&key, msg.kdbt()->data, msg.kdbt()->size);
         struct toku_msg_buffer_key_msn_heaviside_extra extra(cmp, &bnc->msg_buffer, &key, msg.msn());
         if (is_fresh) {
-            r = bnc->fresh_message_tree.insert<struct toku_msg_buffer_key_msn_heaviside_extra, toku_msg_buffer_key_msn_heaviside>(offset, extra, nullptr);
-            assert_zero(r);
+            message_tree_insert(bnc->fresh_message_tree, offset, extra);
         } else {
-            r = bnc->stale_message_tree.insert<struct toku_msg_buffer_key_msn_heaviside_extra, toku_msg_buffer_key_msn_heaviside>(offset, extra, nullptr);
-            assert_zero(r);
+            message_tree_insert(bnc->stale_message_tree, offset, extra);
         }
     } else {
-        invariant(ft_msg_type_applies_all(type) || ft_msg_type_does_nothing(type));
+        invariant(ft_msg_type_applies_all(type) || ft_msg_type_applies_range(type) || ft_msg_type_does_nothing(type));
         const uint32_t idx = bnc->broadcast_list.size();
         r = bnc->broadcast_list.insert_at(offset, idx);
         assert_zero(r);
@@ -1753,17 +1986,132 @@ void toku_ft_append_to_child_buffer(const toku::comparator &cmp, FTNODE node, in
     ft_append_msg_to_child_buffer(cmp, node, childnum, msg, is_fresh);
 }
 
-static void ft_nonleaf_msg_once_to_child(const toku::comparator &cmp, FTNODE node, int target_childnum, const ft_msg &msg, bool is_fresh, size_t flow_deltas[])
+// A child buffer is compacted each time its size crosses a multiple of
+// this many bytes.  Zero disables compaction.
+static uint64_t msg_buffer_compaction_threshold = 1 << 20;
+
+void toku_ft_set_msg_buffer_compaction_threshold(uint64_t bytes) {
+    toku_unsafe_set(&msg_buffer_compaction_threshold, bytes);
+}
+
+uint64_t toku_ft_get_msg_buffer_compaction_threshold(void) {
+    return toku_unsafe_fetch(&msg_buffer_compaction_threshold);
+}
+
+static bool msg_type_replaces_value(enum ft_msg_type type) {
+    return type == FT_INSERT || type == FT_DELETE_ANY;
+}
+
+// Does applying b right after a leave the same leafentry as applying b alone?
+static bool msg_supersedes(const ft_msg &a, const ft_msg &b) {
+    if (!msg_type_replaces_value(a.type()) || !msg_type_replaces_value(b.type())) {
+        return false;
+    }
+    const uint32_t xids_size = toku_xids_get_size(a.xids());
+    if (xids_size != toku_xids_get_size(b.xids()) ||
+        memcmp(a.xids(), b.xids(), xids_size) != 0) {
+        return false;
+    }
+    return a.kdbt()->size == b.kdbt()->size &&
+           memcmp(a.kdbt()->data, b.kdbt()->data, a.kdbt()->size) == 0;
+}
+
+// Effect: Rebuild the buffer for childnum without the inserts and deletes
+//   that are directly followed, for the same key, by an insert or delete
+//   with the same XIDS.  The later message replaces the leafentry's
+//   transaction record for those XIDS (the committed value when the XIDS
+//   are the root XIDS), so the value the earlier message leaves behind is
+//   never visible to any reader, whatever its snapshot.
+//   Each dropped message takes back the row it was counted for when it
+//   was injected, through *logical_rows_delta.
+// Returns: the number of messages dropped.
+static int bnc_compact(const toku::comparator &cmp, FTNODE node, int childnum, int64_t *logical_rows_delta) {
+    NONLEAF_CHILDINFO bnc = BNC(node, childnum);
+    // Broadcast messages apply to every key, so they sit between any two
+    // messages for the same key.  Marked fresh messages are moved to the
+    // stale tree the next time the node is pinned, so leave those alone.
+    if (bnc->broadcast_list.size() > 0 || bnc->fresh_message_tree.has_marks()) {
+        return 0;
+    }
+    const uint32_t n_fresh = bnc->fresh_message_tree.size();
+    const uint32_t n = n_fresh + bnc->stale_message_tree.size();
+    if (n < 2) {
+        return 0;
+    }
+
+    toku::scoped_malloc offsets_buf(n * sizeof(int32_t));
+    int32_t *offsets = reinterpret_cast<int32_t *>(offsets_buf.get());
+    struct store_msg_buffer_offset_extra sfo_extra = {.offsets = offsets, .i = 0};
+    int r = bnc->fresh_message_tree.iterate<struct store_msg_buffer_offset_extra, store_msg_buffer_offset>(&sfo_extra);
+    assert_zero(r);
+    r = bnc->stale_message_tree.iterate<struct store_msg_buffer_offset_extra, store_msg_buffer_offset>(&sfo_extra);
+    assert_zero(r);
+    invariant(sfo_extra.i == (int) n);
+    struct toku_msg_buffer_key_msn_cmp_extra extra(cmp, &bnc->msg_buffer);
+    toku::sort<int32_t, const struct toku_msg_buffer_key_msn_cmp_extra, toku_msg_buffer_key_msn_cmp>::
+        mergesort_r(offsets, n, extra);
+
+    // Now all the messages for a key are next to each other in MSN order.
+    // Keep the ones that are not superseded by their successor.
+    int n_dropped = 0;
+    uint32_t n_kept = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (i + 1 < n) {
+            DBT k, v, next_k, next_v;
+            const ft_msg msg = bnc->msg_buffer.get_message(offsets[i], &k, &v);
+            const ft_msg next_msg = bnc->msg_buffer.get_message(offsets[i + 1], &next_k, &next_v);
+            if (msg_supersedes(msg, next_msg)) {
+                if (logical_rows_delta != nullptr) {
+                    *logical_rows_delta += msg.type() == FT_INSERT ? -1 : 1;
+                }
+                n_dropped++;
+                continue;
+            }
+        }
+        offsets[n_kept++] = offsets[i];
+    }
+    if (n_dropped == 0) {
+        return 0;
+    }
+
+    // Re-enqueue the rest in MSN order, which is the order flushes apply
+    // a buffer in.
+    toku::sort<int32_t, message_buffer, msg_buffer_offset_msn_cmp>::
+        mergesort_r(offsets, n_kept, bnc->msg_buffer);
+    NONLEAF_CHILDINFO new_bnc = toku_create_empty_nl();
+    for (uint32_t i = 0; i < n_kept; i++) {
+        DBT k, v;
+        const ft_msg msg = bnc->msg_buffer.get_message(offsets[i], &k, &v);
+        bnc_insert_msg(new_bnc, msg, bnc->msg_buffer.get_freshness(offsets[i]), cmp);
+    }
+    // The flows count bytes at the end of the buffer, which now holds less.
+    const uint64_t new_size = new_bnc->msg_buffer.buffer_size_in_use();
+    new_bnc->flow[0] = bnc->flow[0] < new_size ? bnc->flow[0] : new_size;
+    new_bnc->flow[1] = bnc->flow[1] < new_size - new_bnc->flow[0] ? bnc->flow[1] : new_size - new_bnc->flow[0];
+    toku_ft_status_note_msg_buffer_compaction(n_dropped, bnc->msg_buffer.buffer_size_in_use() - new_size);
+    destroy_nonleaf_childinfo(bnc);
+    set_BNC(node, childnum, new_bnc);
+    return n_dropped;
+}
+
+static void ft_nonleaf_msg_once_to_child(const toku::comparator &cmp, FTNODE node, int target_childnum, const ft_msg &msg, bool is_fresh, size_t flow_deltas[], int64_t *logical_rows_delta)
 // Previously we had passive aggressive promotion, but that causes a lot of I/O a the checkpoint.  So now we are just putting it in the buffer here.
 // Also we don't worry about the node getting overfull here.  It's the caller's problem.
 {
     unsigned int childnum = (target_childnum >= 0
                              ? target_childnum
                              : toku_ftnode_which_child(node, msg.kdbt(), cmp));
+    const size_t old_size = BNC(node, childnum)->msg_buffer.buffer_size_in_use();
     ft_append_msg_to_child_buffer(cmp, node, childnum, msg, is_fresh);
     NONLEAF_CHILDINFO bnc = BNC(node, childnum);
     bnc->flow[0] += flow_deltas[0];
     bnc->flow[1] += flow_deltas[1];
+
+    const uint64_t threshold = toku_ft_get_msg_buffer_compaction_threshold();
+    if (threshold > 0 &&
+        old_size / threshold != bnc->msg_buffer.buffer_size_in_use() / threshold) {
+        bnc_compact(cmp, node, childnum, logical_rows_delta);
+    }
 }
 
 // TODO: Remove me, I'm boring.
@@ -1779,6 +2127,12 @@ int toku_ftnode_which_child(FTNODE node, const DBT *k, const toku::comparator &c
     // a funny case of no pivots
     if (node->n_children <= 1) return 0;
 
+    int lower_bound;
+    if (node->pivotkeys.eytzinger_lower_bound(cmp, k, &lower_bound) ||
+        node->pivotkeys.memcmp_lower_bound(cmp, k, &lower_bound)) {
+        return lower_bound;
+    }
+
     DBT pivot;
 
     // check the last key to optimize seq insertions
@@ -1841,12 +2195,23 @@ ft_nonleaf_msg_all(const toku::comparator &cmp, FTNODE node, const ft_msg &msg,
 //  The re_array[i] gets set to the reactivity of any modified child i.         (And there may be several such children.)
 {
     for (int i = 0; i < node->n_children; i++) {
-        ft_nonleaf_msg_once_to_child(cmp, node, i, msg, is_fresh, flow_deltas);
+        ft_nonleaf_msg_once_to_child(cmp, node, i, msg, is_fresh, flow_deltas, nullptr);
     }
 }
 
 static void
-ft_nonleaf_put_msg(const toku::comparator &cmp, FTNODE node, int target_childnum, const ft_msg &msg, bool is_fresh, size_t flow_deltas[])
+ft_nonleaf_msg_range(const toku::comparator &cmp, FTNODE node, const ft_msg &msg, bool is_fresh, size_t flow_deltas[])
+// Effect: Put the message into every child whose key range intersects [msg.kdbt(), msg.vdbt()].
+{
+    const int lo = toku_ftnode_which_child(node, msg.kdbt(), cmp);
+    const int hi = toku_ftnode_which_child(node, msg.vdbt(), cmp);
+    for (int i = lo; i <= hi; i++) {
+        ft_nonleaf_msg_once_to_child(cmp, node, i, msg, is_fresh, flow_deltas, nullptr);
+    }
+}
+
+static void
+ft_nonleaf_put_msg(const toku::comparator &cmp, FTNODE node, int target_childnum, const ft_msg &msg, bool is_fresh, size_t flow_deltas[], int64_t *logical_rows_delta)
 // Effect: Put the message into a nonleaf node.  We may put it into a child, possibly causing the child to become reactive.
 //  We don't do the splitting and merging.  That's up to the caller after doing all the puts it wants to do.
 //  The re_array[i] gets set to the reactivity of any modified child i.         (And there may be several such children.)
@@ -1864,9 +2229,11 @@ ft_nonleaf_put_msg(const toku::comparator &cmp, FTNODE node, int target_childnum
     node->max_msn_applied_to_node_on_disk = msg_msn;
 
     if (ft_msg_type_applies_once(msg.type())) {
-        ft_nonleaf_msg_once_to_child(cmp, node, target_childnum, msg, is_fresh, flow_deltas);
+        ft_nonleaf_msg_once_to_child(cmp, node, target_childnum, msg, is_fresh, flow_deltas, logical_rows_delta);
     } else if (ft_msg_type_applies_all(msg.type())) {
         ft_nonleaf_msg_all(cmp, node, msg, is_fresh, flow_deltas);
+    } else if (ft_msg_type_applies_range(msg.type())) {
+        ft_nonleaf_msg_range(cmp, node, msg, is_fresh, flow_deltas);
     } else {
         paranoid_invariant(ft_msg_type_does_nothing(msg.type()));
     }
@@ -2059,7 +2426,8 @@ void toku_ftnode_put_msg(
             target_childnum,
             msg,
             is_fresh,
-            flow_deltas);
+            flow_deltas,
+            logical_rows_delta);
     }
 }
 
@@ -2141,6 +2509,25 @@ void toku_ft_leaf_apply_msg(
                 toku_ft_status_note_msn_discard();
             }
         }
+    } else if (ft_msg_type_applies_range(msg.type())) {
+        const int lo = toku_ftnode_which_child(node, msg.kdbt(), cmp);
+        const int hi = toku_ftnode_which_child(node, msg.vdbt(), cmp);
+        for (int childnum = lo; childnum <= hi; childnum++) {
+            if (msg.msn().msn > BLB(node, childnum)->max_msn_applied.msn) {
+                BLB(node, childnum)->max_msn_applied = msg.msn();
+                toku_ft_bn_apply_msg(
+                    cmp,
+                    update_fun,
+                    BLB(node, childnum),
+                    msg,
+                    gc_info,
+                    workdone,
+                    stats_to_update,
+                    logical_rows_delta);
+            } else {
+                toku_ft_status_note_msn_discard();
+            }
+        }
     } else if (!ft_msg_type_does_nothing(msg.type())) {
         invariant(ft_msg_type_does_nothing(msg.type()));
     }
@@ -42,6 +42,27 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/ft.h"
 #include "ft/msg_buffer.h"
 
+// How ftnode_pivot_keys::memcmp_lower_bound() searches fixed format pivots.
+enum ft_pivot_search_mode {
+    FT_PIVOT_SEARCH_AUTO = 0, // the fastest mode the processor supports
+    FT_PIVOT_SEARCH_GENERIC,  // no fast path, search through the comparator
+    FT_PIVOT_SEARCH_SCALAR,   // binary search with memcmp
+    FT_PIVOT_SEARCH_SSE42,    // compare 8 and 16 byte pivots with SSE4.2
+    FT_PIVOT_SEARCH_AVX2,     // compare 8 and 16 byte pivots with AVX2
+};
+
+// effect: selects how pivots are searched from now on
+// returns: 0 on success, EINVAL if the processor does not support the mode
+int toku_ft_set_pivot_search_mode(enum ft_pivot_search_mode mode);
+
+// returns: the mode pivots are searched with, never FT_PIVOT_SEARCH_AUTO
+enum ft_pivot_search_mode toku_ft_get_pivot_search_mode(void);
+
+// Whether pivots read from disk get an Eytzinger shadow index, see
+// ftnode_pivot_keys::build_eytzinger_index(). Off by default.
+void toku_ft_set_pivot_eytzinger_index(bool enabled);
+bool toku_ft_get_pivot_eytzinger_index(void);
+
 /* Pivot keys.
  * Child 0's keys are <= pivotkeys[0]. 
  * Child 1's keys are <= pivotkeys[1]. 
@@ -100,6 +121,30 @@ public:
     // return: the sum of the keys sizes of each pivot (for serialization)
     size_t serialized_size() const;
 
+    // effect: if cmp compares key to every pivot with memcmp, finds the
+    //         index of the first pivot that is >= key without calling cmp,
+    //         vectorized for 8 and 16 byte keys
+    // returns: true and *lower_bound set to that index (num_pivots() if
+    //          there is none), or false if the pivots are not in fixed
+    //          format or the comparison is not a memcmp
+    bool memcmp_lower_bound(const toku::comparator &cmp, const DBT *key, int *lower_bound) const;
+
+    // effect: builds a shadow index of the pivots laid out in Eytzinger
+    //         (breadth first) order, which eytzinger_lower_bound() searches
+    //         without mispredicted branches. Any change to the pivots drops it.
+    void build_eytzinger_index();
+
+    // effect: if there is an Eytzinger index and cmp compares key to every
+    //         pivot with memcmp, finds the index of the first pivot that is
+    //         >= key through the index
+    // returns: true and *lower_bound set to that index (num_pivots() if
+    //          there is none), or false if the index cannot be used
+    bool eytzinger_lower_bound(const toku::comparator &cmp, const DBT *key, int *lower_bound) const;
+
+    // return: the memory used by the Eytzinger index, which total_size()
+    //         leaves out since it is never serialized
+    size_t eytzinger_index_size() const;
+
 private:
     inline size_t _align4(size_t x) const {
         return roundup_to_multiple(4, x);
@@ -118,6 +163,11 @@ private:
 
     void sanity_check() const;
 
+    void _destroy_eytzinger_index();
+
+    // effect: recomputes _shared_first_byte after the pivots change
+    void _update_shared_first_byte();
+
     void _insert_at_dbt(const DBT *key, int i);
     void _append_dbt(const ftnode_pivot_keys &pivotkeys);
     void _replace_at_dbt(const DBT *key, int i);
@@ -153,33 +203,43 @@ private:
 
     int _num_pivots;
     size_t _total_size;
+
+    // The 8 bytes of each pivot that follow the prefix every pivot shares,
+    // loaded big-endian and zero padded, in Eytzinger order starting at
+    // index 1, or null if there is no index.
+    uint64_t *_eytzinger_prefixes;
+    // The pivot at each position of _eytzinger_prefixes
+    int *_eytzinger_pivots;
+    // The length of the prefix every pivot shares
+    uint32_t _eytzinger_skip;
+
+    // True if the pivots are in fixed format and all start with the same
+    // byte, which is what memcmp magic needs, so that searches do not have
+    // to check every pivot.
+    bool _shared_first_byte;
 };
 
 // TODO: class me up
 struct ftnode {
-    // max_msn_applied that will be written to disk
-    MSN max_msn_applied_to_node_on_disk;
-    unsigned int flags;
-    // Which block number is this node?
-    BLOCKNUM blocknum;
-    // What version of the data structure?
-    int layout_version;
-    // different (<) from layout_version if upgraded from a previous version
-    // (useful for debugging)
-    int layout_version_original;
-    // transient, not serialized to disk, (useful for debugging)
-    int layout_version_read_from_disk;
-    // build_id (svn rev number) of software that wrote this node to disk
-    uint32_t build_id;
+    // What a search reads on its way through the node comes first, so that
+    // it takes as few cache lines as it can.
+
     // height is always >= 0.  0 for leaf, >0 for nonleaf.
     int height;
-    int dirty;
-    uint32_t fullhash;
-
     // for internal nodes, if n_children==fanout+1 then the tree needs to be
     // rebalanced. for leaf nodes, represents number of basement nodes
     int n_children;
+    // array of size n_children, consisting of ftnode partitions
+    // each one is associated with a child  for internal nodes, the ith
+    // partition corresponds to the ith message buffer for leaf nodes, the ith
+    // partition corresponds to the ith basement node
+    struct ftnode_partition *bp;
+    // array of size n_children, the rest of each partition
+    struct ftnode_partition_metadata *bp_meta;
     ftnode_pivot_keys pivotkeys;
+    // max_msn_applied that will be written to disk
+    MSN max_msn_applied_to_node_on_disk;
+    struct ctpair *ct_pair;
 
     // What's the oldest referenced xid that this node knows about? The real
     // oldest referenced xid might be younger, but this is our best estimate.
@@ -190,13 +250,20 @@ struct ftnode {
     // it still works well most of the time, and its readily available on the
     // inject code path.
     TXNID oldest_referenced_xid_known;
-
-    // array of size n_children, consisting of ftnode partitions
-    // each one is associated with a child  for internal nodes, the ith
-    // partition corresponds to the ith message buffer for leaf nodes, the ith
-    // partition corresponds to the ith basement node
-    struct ftnode_partition *bp;
-    struct ctpair *ct_pair;
+    unsigned int flags;
+    // Which block number is this node?
+    BLOCKNUM blocknum;
+    // What version of the data structure?
+    int layout_version;
+    // different (<) from layout_version if upgraded from a previous version
+    // (useful for debugging)
+    int layout_version_original;
+    // transient, not serialized to disk, (useful for debugging)
+    int layout_version_read_from_disk;
+    // build_id (svn rev number) of software that wrote this node to disk
+    uint32_t build_id;
+    int dirty;
+    uint32_t fullhash;
 };
 typedef struct ftnode *FTNODE;
 
@@ -214,13 +281,13 @@ struct ftnode_leaf_basement_node {
 };
 typedef struct ftnode_leaf_basement_node *BASEMENTNODE;
 
-enum pt_state {  // declare this to be packed so that when used below it will only take 1 byte.
+enum pt_state : uint8_t {  // only takes 1 byte in struct ftnode_partition
     PT_INVALID = 0,
     PT_ON_DISK = 1,
     PT_COMPRESSED = 2,
     PT_AVAIL = 3};
 
-enum ftnode_child_tag {
+enum ftnode_child_tag : uint8_t {
     BCT_INVALID = 0,
     BCT_NULL,
     BCT_SUBBLOCK,
@@ -238,17 +305,13 @@ struct ftnode_nonleaf_childinfo {
     marked_off_omt_t fresh_message_tree;
     off_omt_t stale_message_tree;
     uint64_t flow[2];  // current and last checkpoint
+    // set when the cleaner left this buffer's broadcasts pending above a
+    // cold child, cleared by the next message; leaves the buffer out of
+    // the node's cache pressure so the cleaner does not keep picking it
+    bool broadcasts_deferred;
 };
 typedef struct ftnode_nonleaf_childinfo *NONLEAF_CHILDINFO;
     
-typedef struct ftnode_child_pointer {
-    union {
-	struct sub_block *subblock;
-	struct ftnode_nonleaf_childinfo *nonleaf;
-	struct ftnode_leaf_basement_node *leaf;
-    } u;
-    enum ftnode_child_tag tag;
-} FTNODE_CHILD_POINTER;
 
 struct ftnode_disk_data {
     //
@@ -268,14 +331,11 @@ typedef struct ftnode_disk_data *FTNODE_DISK_DATA;
 #define BP_SIZE(node_dd,i) ((node_dd)[i].size)
 
 // a ftnode partition, associated with a child of a node
+//
+// The fields a root-to-leaf search reads are kept in struct ftnode_partition,
+// 16 bytes, so four share a cache line and none straddles one.  The rest are
+// in struct ftnode_partition_metadata, in a parallel array (ftnode::bp_meta).
 struct ftnode_partition {
-    // the following three variables are used for nonleaf nodes
-    // for leaf nodes, they are meaningless
-    BLOCKNUM     blocknum; // blocknum of child 
-
-    // How many bytes worth of work was performed by messages in each buffer.
-    uint64_t     workdone;
-
     //
     // pointer to the partition. Depending on the state, they may be different things
     // if state == PT_INVALID, then the node was just initialized and ptr == NULL
@@ -285,7 +345,13 @@ struct ftnode_partition {
     //         a struct ftnode_nonleaf_childinfo for internal nodes, 
     //         a struct ftnode_leaf_basement_node for leaf nodes
     //
-    struct ftnode_child_pointer ptr;
+    union {
+        struct sub_block *subblock;
+        struct ftnode_nonleaf_childinfo *nonleaf;
+        struct ftnode_leaf_basement_node *leaf;
+    } ptr;
+    // which member of ptr is valid
+    enum ftnode_child_tag tag;
     //
     // at any time, the partitions may be in one of the following three states (stored in pt_state):
     //   PT_INVALID - means that the partition was just initialized
@@ -294,12 +360,30 @@ struct ftnode_partition {
     //   PT_AVAIL - means the partition is decompressed and in memory
     //
     enum pt_state state; // make this an enum to make debugging easier.  
+};
+static_assert(sizeof(struct ftnode_partition) == 16, "ftnode_partition is padded");
+
+// the rest of a ftnode partition (see struct ftnode_partition)
+struct ftnode_partition_metadata {
+    // the following two variables are used for nonleaf nodes
+    // for leaf nodes, they are meaningless
+    BLOCKNUM     blocknum; // blocknum of child 
+
+    // How many bytes worth of work was performed by messages in each buffer.
+    uint64_t     workdone;
 
     // clock count used to for pe_callback to determine if a node should be evicted or not
     // for now, saturating the count at 1
     uint8_t clock_count;
 };
 
+// Allocate zeroed partitions (both arrays) for a node with n_children children.
+void toku_ftnode_alloc_partitions(FTNODE node, int n_children);
+// Resize the partitions of a node to n_children, like realloc().
+void toku_ftnode_realloc_partitions(FTNODE node, int n_children);
+// Free the partitions of a node (not what they point to).
+void toku_ftnode_free_partitions(FTNODE node);
+
 //
 // TODO: Fix all these names
 //       Organize declarations
@@ -476,6 +560,17 @@ void toku_apply_ancestors_messages_to_node(FT_HANDLE t, FTNODE node, ANCESTORS a
                                            const pivot_bounds &bounds,
                                            bool *msgs_applied, int child_to_read);
 
+// Leaves whose ancestors buffer at least this many bytes of messages have
+// all their basement nodes brought up to date in parallel.  0 disables it.
+void toku_ft_set_parallel_apply_threshold(uint64_t bytes);
+uint64_t toku_ft_get_parallel_apply_threshold(void);
+
+// Each time a child buffer grows past a multiple of this many bytes, the
+// inserts and deletes in it that a later message for the same key and
+// XIDS overwrites are dropped.  0 disables it.
+void toku_ft_set_msg_buffer_compaction_threshold(uint64_t bytes);
+uint64_t toku_ft_get_msg_buffer_compaction_threshold(void);
+
 bool toku_ft_leaf_needs_ancestors_messages(FT ft, FTNODE node, ANCESTORS ancestors,
                                            const pivot_bounds &bounds,
                                            MSN *const max_msn_in_path, int child_to_read);
@@ -493,29 +588,27 @@ int toku_ft_search_which_child(const toku::comparator &cmp, FTNODE node, ft_sear
 static inline void set_BNULL(FTNODE node, int i) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    node->bp[i].ptr.tag = BCT_NULL;
+    node->bp[i].tag = BCT_NULL;
 }
 
 static inline bool is_BNULL (FTNODE node, int i) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    return node->bp[i].ptr.tag == BCT_NULL;
+    return node->bp[i].tag == BCT_NULL;
 }
 
 static inline NONLEAF_CHILDINFO BNC(FTNODE node, int i) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    FTNODE_CHILD_POINTER p = node->bp[i].ptr;
-    paranoid_invariant(p.tag==BCT_NONLEAF);
-    return p.u.nonleaf;
+    paranoid_invariant(node->bp[i].tag==BCT_NONLEAF);
+    return node->bp[i].ptr.nonleaf;
 }
 
 static inline void set_BNC(FTNODE node, int i, NONLEAF_CHILDINFO nl) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    FTNODE_CHILD_POINTER *p = &node->bp[i].ptr;
-    p->tag = BCT_NONLEAF;
-    p->u.nonleaf = nl;
+    node->bp[i].tag = BCT_NONLEAF;
+    node->bp[i].ptr.nonleaf = nl;
 }
 
 static inline BASEMENTNODE BLB(FTNODE node, int i) {
@@ -526,40 +619,36 @@ static inline BASEMENTNODE BLB(FTNODE node, int i) {
     // on the values forcibly cast to unsigned ints.
     paranoid_invariant(node->n_children > 0);
     paranoid_invariant((unsigned) i < (unsigned) node->n_children);
-    FTNODE_CHILD_POINTER p = node->bp[i].ptr;
-    paranoid_invariant(p.tag==BCT_LEAF);
-    return p.u.leaf;
+    paranoid_invariant(node->bp[i].tag==BCT_LEAF);
+    return node->bp[i].ptr.leaf;
 }
 
 static inline void set_BLB(FTNODE node, int i, BASEMENTNODE bn) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    FTNODE_CHILD_POINTER *p = &node->bp[i].ptr;
-    p->tag = BCT_LEAF;
-    p->u.leaf = bn;
+    node->bp[i].tag = BCT_LEAF;
+    node->bp[i].ptr.leaf = bn;
 }
 
 static inline struct sub_block *BSB(FTNODE node, int i) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    FTNODE_CHILD_POINTER p = node->bp[i].ptr;
-    paranoid_invariant(p.tag==BCT_SUBBLOCK);
-    return p.u.subblock;
+    paranoid_invariant(node->bp[i].tag==BCT_SUBBLOCK);
+    return node->bp[i].ptr.subblock;
 }
 
 static inline void set_BSB(FTNODE node, int i, struct sub_block *sb) {
     paranoid_invariant(i >= 0);
     paranoid_invariant(i < node->n_children);
-    FTNODE_CHILD_POINTER *p = &node->bp[i].ptr;
-    p->tag = BCT_SUBBLOCK;
-    p->u.subblock = sb;
+    node->bp[i].tag = BCT_SUBBLOCK;
+    node->bp[i].ptr.subblock = sb;
 }
 
 // ftnode partition macros
 // BP stands for ftnode_partition
-#define BP_BLOCKNUM(node,i) ((node)->bp[i].blocknum)
+#define BP_BLOCKNUM(node,i) ((node)->bp_meta[i].blocknum)
 #define BP_STATE(node,i) ((node)->bp[i].state)
-#define BP_WORKDONE(node, i)((node)->bp[i].workdone)
+#define BP_WORKDONE(node, i)((node)->bp_meta[i].workdone)
 
 //
 // macros for managing a node's clock
@@ -571,14 +660,14 @@ static inline void set_BSB(FTNODE node, int i, struct sub_block *sb) {
 // that have a read lock on an internal node may try to touch the clock
 // simultaneously
 //
-#define BP_TOUCH_CLOCK(node, i) ((node)->bp[i].clock_count = 1)
-#define BP_SWEEP_CLOCK(node, i) ((node)->bp[i].clock_count = 0)
-#define BP_SHOULD_EVICT(node, i) ((node)->bp[i].clock_count == 0)
+#define BP_TOUCH_CLOCK(node, i) ((node)->bp_meta[i].clock_count = 1)
+#define BP_SWEEP_CLOCK(node, i) ((node)->bp_meta[i].clock_count = 0)
+#define BP_SHOULD_EVICT(node, i) ((node)->bp_meta[i].clock_count == 0)
 // not crazy about having these two here, one is for the case where we create new
 // nodes, such as in splits and creating new roots, and the other is for when
 // we are deserializing a node and not all bp's are touched
-#define BP_INIT_TOUCHED_CLOCK(node, i) ((node)->bp[i].clock_count = 1)
-#define BP_INIT_UNTOUCHED_CLOCK(node, i) ((node)->bp[i].clock_count = 0)
+#define BP_INIT_TOUCHED_CLOCK(node, i) ((node)->bp_meta[i].clock_count = 1)
+#define BP_INIT_UNTOUCHED_CLOCK(node, i) ((node)->bp_meta[i].clock_count = 0)
 
 // ftnode leaf basementnode macros, 
 #define BLB_MAX_MSN_APPLIED(node,i) (BLB(node,i)->max_msn_applied)
@@ -35,9 +35,15 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 
 #ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
 
+#include <errno.h>
 #include <string>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include "portability/memory.h"
+#include "portability/toku_race_tools.h"
 
 #include "ft/node.h"
 #include "ft/serialize/rbuf.h"
@@ -50,6 +56,10 @@ void ftnode_pivot_keys::create_empty() {
     _fixed_keylen = 0;
     _fixed_keylen_aligned = 0;
     _dbt_keys = nullptr;
+    _eytzinger_prefixes = nullptr;
+    _eytzinger_pivots = nullptr;
+    _eytzinger_skip = 0;
+    _shared_first_byte = false;
 }
 
 void ftnode_pivot_keys::create_from_dbts(const DBT *keys, int n) {
@@ -84,6 +94,7 @@ void ftnode_pivot_keys::create_from_dbts(const DBT *keys, int n) {
             _total_size += size;
         }
     }
+    _update_shared_first_byte();
 
     sanity_check();
 }
@@ -95,6 +106,7 @@ void ftnode_pivot_keys::_create_from_fixed_keys(const char *fixedkeys, size_t fi
     _fixed_keylen_aligned = _align4(fixed_keylen);
     _total_size = _fixed_keylen_aligned * _num_pivots;
     XMEMDUP_N(_fixed_keys, fixedkeys, _total_size);
+    _update_shared_first_byte();
 }
 
 // effect: create pivot keys as a clone of an existing set of pivotkeys
@@ -109,6 +121,7 @@ void ftnode_pivot_keys::create_from_pivot_keys(const ftnode_pivot_keys &pivotkey
 }
 
 void ftnode_pivot_keys::destroy() {
+    _destroy_eytzinger_index();
     if (_dbt_keys != nullptr) {
         for (int i = 0; i < _num_pivots; i++) {
             toku_destroy_dbt(&_dbt_keys[i]);
@@ -124,6 +137,14 @@ void ftnode_pivot_keys::destroy() {
     _fixed_keylen_aligned = 0;
     _num_pivots = 0;
     _total_size = 0;
+    _shared_first_byte = false;
+}
+
+void ftnode_pivot_keys::_update_shared_first_byte() {
+    _shared_first_byte = _fixed_format() && _fixed_keylen > 0;
+    for (int i = 1; _shared_first_byte && i < _num_pivots; i++) {
+        _shared_first_byte = *_fixed_key(i) == *_fixed_key(0);
+    }
 }
 
 void ftnode_pivot_keys::_convert_to_fixed_format() {
@@ -177,6 +198,10 @@ void ftnode_pivot_keys::deserialize_from_rbuf(struct rbuf *rb, int n) {
     _fixed_keys = nullptr;
     _fixed_keylen = 0;
     _dbt_keys = nullptr;
+    _eytzinger_prefixes = nullptr;
+    _eytzinger_pivots = nullptr;
+    _eytzinger_skip = 0;
+    _shared_first_byte = false;
 
     XMALLOC_N_ALIGNED(64, _num_pivots, _dbt_keys);
     bool keys_same_size = true;
@@ -195,6 +220,10 @@ void ftnode_pivot_keys::deserialize_from_rbuf(struct rbuf *rb, int n) {
     if (keys_same_size && _num_pivots > 0) {
         _convert_to_fixed_format();
     }
+    _update_shared_first_byte();
+    if (toku_ft_get_pivot_eytzinger_index()) {
+        build_eytzinger_index();
+    }
 
     sanity_check();
 }
@@ -250,6 +279,7 @@ void ftnode_pivot_keys::_insert_at_fixed(const DBT *key, int i) {
 
 void ftnode_pivot_keys::insert_at(const DBT *key, int i) {
     invariant(i <= _num_pivots); // it's ok to insert at the end, so we check <= n
+    _destroy_eytzinger_index();
 
     // if the new key doesn't have the same size, we can't be in fixed format
     if (_fixed_format() && key->size != _fixed_keylen) {
@@ -262,6 +292,7 @@ void ftnode_pivot_keys::insert_at(const DBT *key, int i) {
         _insert_at_dbt(key, i);
     }
     _num_pivots++;
+    _update_shared_first_byte();
 
     invariant(total_size() > 0);
 }
@@ -294,12 +325,14 @@ void ftnode_pivot_keys::_append_fixed(const ftnode_pivot_keys &pivotkeys) {
 }
 
 void ftnode_pivot_keys::append(const ftnode_pivot_keys &pivotkeys) {
+    _destroy_eytzinger_index();
     if (_fixed_format()) {
         _append_fixed(pivotkeys);
     } else {
         _append_dbt(pivotkeys);
     }
     _num_pivots += pivotkeys._num_pivots;
+    _update_shared_first_byte();
 
     sanity_check();
 }
@@ -320,12 +353,14 @@ void ftnode_pivot_keys::_replace_at_fixed(const DBT *key, int i) {
 }
 
 void ftnode_pivot_keys::replace_at(const DBT *key, int i) {
+    _destroy_eytzinger_index();
     if (i < _num_pivots) {
         if (_fixed_format()) {
             _replace_at_fixed(key, i);
         } else {
             _replace_at_dbt(key, i);
         }
+        _update_shared_first_byte();
     } else {
         invariant(i == _num_pivots); // appending to the end is ok
         insert_at(key, i);
@@ -347,6 +382,7 @@ void ftnode_pivot_keys::_delete_at_dbt(int i) {
 
 void ftnode_pivot_keys::delete_at(int i) {
     invariant(i < _num_pivots);
+    _destroy_eytzinger_index();
 
     if (_fixed_format()) {
         _delete_at_fixed(i);
@@ -355,6 +391,7 @@ void ftnode_pivot_keys::delete_at(int i) {
     }
 
     _num_pivots--;
+    _update_shared_first_byte();
 }
 
 void ftnode_pivot_keys::_split_at_fixed(int i, ftnode_pivot_keys *other) {
@@ -378,6 +415,7 @@ void ftnode_pivot_keys::_split_at_dbt(int i, ftnode_pivot_keys *other) {
 }
 
 void ftnode_pivot_keys::split_at(int i, ftnode_pivot_keys *other) {
+    _destroy_eytzinger_index();
     if (i < _num_pivots) {
         if (_fixed_format()) {
             _split_at_fixed(i, other);
@@ -385,6 +423,7 @@ void ftnode_pivot_keys::split_at(int i, ftnode_pivot_keys *other) {
             _split_at_dbt(i, other);
         }
         _num_pivots = i;
+        _update_shared_first_byte();
     }
 
     sanity_check();
@@ -435,3 +474,429 @@ void ftnode_pivot_keys::sanity_check() const {
         invariant(size == _total_size);
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Searching fixed format pivots with memcmp.
+//
+// When the comparator of a dictionary is a memcmp, either because it is
+// the builtin comparator or because it has memcmp magic that the keys
+// carry, the pivots do not need to go through the comparator at all. For
+// 8 and 16 byte keys, the pivots are loaded as big-endian integers, so that
+// an unsigned integer comparison orders them like memcmp does, and many of
+// them are compared to the key at once with SIMD instructions.
+//
+
+static enum ft_pivot_search_mode pivot_search_mode = FT_PIVOT_SEARCH_AUTO;
+
+static bool pivot_search_mode_supported(enum ft_pivot_search_mode mode) {
+    switch (mode) {
+    case FT_PIVOT_SEARCH_AUTO:
+    case FT_PIVOT_SEARCH_GENERIC:
+    case FT_PIVOT_SEARCH_SCALAR:
+        return true;
+#if defined(__x86_64__)
+    case FT_PIVOT_SEARCH_SSE42:
+        return __builtin_cpu_supports("sse4.2");
+    case FT_PIVOT_SEARCH_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+int toku_ft_set_pivot_search_mode(enum ft_pivot_search_mode mode) {
+    if (!pivot_search_mode_supported(mode)) {
+        return EINVAL;
+    }
+    toku_unsafe_set(&pivot_search_mode, mode);
+    return 0;
+}
+
+enum ft_pivot_search_mode toku_ft_get_pivot_search_mode(void) {
+    enum ft_pivot_search_mode mode = toku_unsafe_fetch(&pivot_search_mode);
+    if (mode == FT_PIVOT_SEARCH_AUTO) {
+        if (pivot_search_mode_supported(FT_PIVOT_SEARCH_AVX2)) {
+            mode = FT_PIVOT_SEARCH_AVX2;
+        } else if (pivot_search_mode_supported(FT_PIVOT_SEARCH_SSE42)) {
+            mode = FT_PIVOT_SEARCH_SSE42;
+        } else {
+            mode = FT_PIVOT_SEARCH_SCALAR;
+        }
+    }
+    return mode;
+}
+
+// the vectorized searches count the pivots less than the key in a window
+// of at most this many pivots, found by a binary search
+static const int PIVOT_SEARCH_WINDOW = 32;
+
+static inline uint64_t load_be64(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+    return __builtin_bswap64(v);
+}
+
+// returns: true if the 16 byte key at p is less than the one made of hi and lo
+static inline bool less_be128(const char *p, uint64_t hi, uint64_t lo) {
+    uint64_t p_hi = load_be64(p);
+    return p_hi < hi || (p_hi == hi && load_be64(p + 8) < lo);
+}
+
+// effect: narrows [*lo, *hi) down to at most PIVOT_SEARCH_WINDOW keys of
+//         length 8 that contain the first key that is not less than key
+static inline void narrow_be64(const char *keys, int *lo, int *hi, uint64_t key) {
+    while (*hi - *lo > PIVOT_SEARCH_WINDOW) {
+        int mi = (*lo + *hi) / 2;
+        if (load_be64(keys + mi * 8) < key) {
+            *lo = mi + 1;
+        } else {
+            *hi = mi;
+        }
+    }
+}
+
+static inline void narrow_be128(const char *keys, int *lo, int *hi, uint64_t key_hi, uint64_t key_lo) {
+    while (*hi - *lo > PIVOT_SEARCH_WINDOW) {
+        int mi = (*lo + *hi) / 2;
+        if (less_be128(keys + mi * 16, key_hi, key_lo)) {
+            *lo = mi + 1;
+        } else {
+            *hi = mi;
+        }
+    }
+}
+
+static int lower_bound_memcmp(const char *keys, size_t stride, size_t keylen, int n,
+                              const void *key, uint32_t size) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mi = (lo + hi) / 2;
+        if (toku_keycompare(keys + mi * stride, keylen, key, size) < 0) {
+            lo = mi + 1;
+        } else {
+            hi = mi;
+        }
+    }
+    return lo;
+}
+
+static int lower_bound_be64_scalar(const char *keys, int n, uint64_t key) {
+    int lo = 0, hi = n;
+    narrow_be64(keys, &lo, &hi, key);
+    int count = 0;
+    for (int i = lo; i < hi; i++) {
+        count += load_be64(keys + i * 8) < key;
+    }
+    return lo + count;
+}
+
+static int lower_bound_be128_scalar(const char *keys, int n, uint64_t key_hi, uint64_t key_lo) {
+    int lo = 0, hi = n;
+    narrow_be128(keys, &lo, &hi, key_hi, key_lo);
+    int count = 0;
+    for (int i = lo; i < hi; i++) {
+        count += less_be128(keys + i * 16, key_hi, key_lo);
+    }
+    return lo + count;
+}
+
+#if defined(__x86_64__)
+
+// The shuffles turn every 8 bytes around to load them big-endian. SSE4.2
+// and AVX2 only compare signed 64 bit integers, so both sides get their
+// sign bit flipped to compare them as unsigned.
+
+__attribute__((__target__("sse4.2")))
+static int lower_bound_be64_sse42(const char *keys, int n, uint64_t key) {
+    int lo = 0, hi = n;
+    narrow_be64(keys, &lo, &hi, key);
+    const __m128i bswap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+    const __m128i k = _mm_set1_epi64x(key ^ INT64_MIN);
+    int count = 0;
+    int i = lo;
+    for (; i + 2 <= hi; i += 2) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * 8));
+        p = _mm_xor_si128(_mm_shuffle_epi8(p, bswap), sign);
+        count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, p))));
+    }
+    for (; i < hi; i++) {
+        count += load_be64(keys + i * 8) < key;
+    }
+    return lo + count;
+}
+
+__attribute__((__target__("sse4.2")))
+static int lower_bound_be128_sse42(const char *keys, int n, uint64_t key_hi, uint64_t key_lo) {
+    int lo = 0, hi = n;
+    narrow_be128(keys, &lo, &hi, key_hi, key_lo);
+    const __m128i bswap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+    const __m128i k = _mm_set_epi64x(key_lo ^ INT64_MIN, key_hi ^ INT64_MIN);
+    int count = 0;
+    for (int i = lo; i < hi; i++) {
+        // lane 0 holds the high half of the pivot, lane 1 the low half
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * 16));
+        p = _mm_xor_si128(_mm_shuffle_epi8(p, bswap), sign);
+        int lt = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, p)));
+        int eq = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(k, p)));
+        count += (lt | (eq & (lt >> 1))) & 1;
+    }
+    return lo + count;
+}
+
+__attribute__((__target__("avx2")))
+static int lower_bound_be64_avx2(const char *keys, int n, uint64_t key) {
+    int lo = 0, hi = n;
+    narrow_be64(keys, &lo, &hi, key);
+    const __m256i bswap = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                          8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i k = _mm256_set1_epi64x(key ^ INT64_MIN);
+    int count = 0;
+    int i = lo;
+    for (; i + 4 <= hi; i += 4) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * 8));
+        p = _mm256_xor_si256(_mm256_shuffle_epi8(p, bswap), sign);
+        count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, p))));
+    }
+    for (; i < hi; i++) {
+        count += load_be64(keys + i * 8) < key;
+    }
+    return lo + count;
+}
+
+__attribute__((__target__("avx2")))
+static int lower_bound_be128_avx2(const char *keys, int n, uint64_t key_hi, uint64_t key_lo) {
+    int lo = 0, hi = n;
+    narrow_be128(keys, &lo, &hi, key_hi, key_lo);
+    const __m256i bswap = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                          8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i k = _mm256_set_epi64x(key_lo ^ INT64_MIN, key_hi ^ INT64_MIN,
+                                        key_lo ^ INT64_MIN, key_hi ^ INT64_MIN);
+    int count = 0;
+    int i = lo;
+    for (; i + 2 <= hi; i += 2) {
+        // even lanes hold the high halves of two pivots, odd lanes the low halves
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * 16));
+        p = _mm256_xor_si256(_mm256_shuffle_epi8(p, bswap), sign);
+        int lt = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, p)));
+        int eq = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(k, p)));
+        count += __builtin_popcount((lt | (eq & (lt >> 1))) & 0x5);
+    }
+    for (; i < hi; i++) {
+        count += less_be128(keys + i * 16, key_hi, key_lo);
+    }
+    return lo + count;
+}
+
+#endif
+
+bool ftnode_pivot_keys::memcmp_lower_bound(const toku::comparator &cmp, const DBT *key, int *lower_bound) const {
+    if (!_fixed_format() || toku_dbt_is_infinite(key)) {
+        return false;
+    }
+    enum ft_pivot_search_mode mode = toku_ft_get_pivot_search_mode();
+    if (mode == FT_PIVOT_SEARCH_GENERIC) {
+        return false;
+    }
+
+    // the comparator falls back to memcmp only for keys that all carry its magic
+    if (cmp.get_compare_func() != toku_builtin_compare_fun) {
+        if (cmp.get_memcmp_magic() == toku::comparator::MEMCMP_MAGIC_NONE ||
+            key->size == 0 || !_shared_first_byte || !cmp.dbt_has_memcmp_magic(key) ||
+            *_fixed_key(0) != *reinterpret_cast<const char *>(key->data)) {
+            return false;
+        }
+    }
+
+    if (_fixed_keylen == 8 && key->size == 8) {
+        uint64_t k = load_be64(static_cast<const char *>(key->data));
+        switch (mode) {
+#if defined(__x86_64__)
+        case FT_PIVOT_SEARCH_AVX2:
+            *lower_bound = lower_bound_be64_avx2(_fixed_keys, _num_pivots, k);
+            return true;
+        case FT_PIVOT_SEARCH_SSE42:
+            *lower_bound = lower_bound_be64_sse42(_fixed_keys, _num_pivots, k);
+            return true;
+#endif
+        default:
+            *lower_bound = lower_bound_be64_scalar(_fixed_keys, _num_pivots, k);
+            return true;
+        }
+    } else if (_fixed_keylen == 16 && key->size == 16) {
+        uint64_t k_hi = load_be64(static_cast<const char *>(key->data));
+        uint64_t k_lo = load_be64(static_cast<const char *>(key->data) + 8);
+        switch (mode) {
+#if defined(__x86_64__)
+        case FT_PIVOT_SEARCH_AVX2:
+            *lower_bound = lower_bound_be128_avx2(_fixed_keys, _num_pivots, k_hi, k_lo);
+            return true;
+        case FT_PIVOT_SEARCH_SSE42:
+            *lower_bound = lower_bound_be128_sse42(_fixed_keys, _num_pivots, k_hi, k_lo);
+            return true;
+#endif
+        default:
+            *lower_bound = lower_bound_be128_scalar(_fixed_keys, _num_pivots, k_hi, k_lo);
+            return true;
+        }
+    }
+    *lower_bound = lower_bound_memcmp(_fixed_keys, _fixed_keylen_aligned, _fixed_keylen,
+                                      _num_pivots, key->data, key->size);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Eytzinger shadow index.
+//
+// A binary search over the pivots touches a new cache line at almost every
+// step and branches on comparisons it cannot predict. The shadow index keeps
+// 8 bytes of each pivot in the order of a breadth first walk of the implicit
+// search tree, so the first levels of every search share cache lines, the
+// next levels can be prefetched, and a step of the search is a comparison
+// and a shift. The 8 bytes are the ones that follow the prefix all pivots
+// share, which is compared once per search. Only when the key's 8 bytes
+// match those of the pivot the search lands on does it go back to
+// comparing whole keys.
+//
+
+static bool pivot_eytzinger_index = false;
+
+void toku_ft_set_pivot_eytzinger_index(bool enabled) {
+    toku_unsafe_set(&pivot_eytzinger_index, enabled);
+}
+
+bool toku_ft_get_pivot_eytzinger_index(void) {
+    return toku_unsafe_fetch(&pivot_eytzinger_index);
+}
+
+// returns: the 8 bytes of a key after the first skip bytes as a big-endian
+//          integer, zero padded, so that among keys that share their first
+//          skip bytes a smaller integer means a smaller key in memcmp order
+static inline uint64_t load_be64_prefix(const void *data, uint32_t size, uint32_t skip) {
+    char buf[8] = { 0 };
+    size -= skip;
+    memcpy(buf, static_cast<const char *>(data) + skip, size < sizeof buf ? size : sizeof buf);
+    return load_be64(buf);
+}
+
+// effect: fills the subtree of the Eytzinger index rooted at k with the
+//         pivots starting at *next_pivot, in order
+static void fill_eytzinger_index(const ftnode_pivot_keys &pivots, uint32_t skip,
+                                 uint64_t *prefixes, int *indexes, int k, int *next_pivot) {
+    if (k <= pivots.num_pivots()) {
+        fill_eytzinger_index(pivots, skip, prefixes, indexes, 2 * k, next_pivot);
+        DBT pivot = pivots.get_pivot(*next_pivot);
+        prefixes[k] = load_be64_prefix(pivot.data, pivot.size, skip);
+        indexes[k] = (*next_pivot)++;
+        fill_eytzinger_index(pivots, skip, prefixes, indexes, 2 * k + 1, next_pivot);
+    }
+}
+
+void ftnode_pivot_keys::build_eytzinger_index() {
+    _destroy_eytzinger_index();
+    if (_num_pivots == 0) {
+        return;
+    }
+
+    // the pivots are sorted, so the prefix the first and the last one
+    // share is the prefix all of them share
+    DBT first = get_pivot(0);
+    DBT last = get_pivot(_num_pivots - 1);
+    uint32_t skip = 0;
+    while (skip < first.size && skip < last.size &&
+           static_cast<const char *>(first.data)[skip] == static_cast<const char *>(last.data)[skip]) {
+        skip++;
+    }
+    _eytzinger_skip = skip;
+
+    // index 0 is unused, so that the children of k are 2k and 2k + 1 and
+    // its 8 descendants 3 levels down fill one cache line
+    XMALLOC_N_ALIGNED(64, _num_pivots + 1, _eytzinger_prefixes);
+    XMALLOC_N(_num_pivots + 1, _eytzinger_pivots);
+    _eytzinger_prefixes[0] = 0;
+    _eytzinger_pivots[0] = _num_pivots;
+    int next_pivot = 0;
+    fill_eytzinger_index(*this, skip, _eytzinger_prefixes, _eytzinger_pivots, 1, &next_pivot);
+    invariant(next_pivot == _num_pivots);
+}
+
+void ftnode_pivot_keys::_destroy_eytzinger_index() {
+    if (_eytzinger_prefixes != nullptr) {
+        toku_free(_eytzinger_prefixes);
+        _eytzinger_prefixes = nullptr;
+    }
+    if (_eytzinger_pivots != nullptr) {
+        toku_free(_eytzinger_pivots);
+        _eytzinger_pivots = nullptr;
+    }
+    _eytzinger_skip = 0;
+}
+
+size_t ftnode_pivot_keys::eytzinger_index_size() const {
+    if (_eytzinger_prefixes == nullptr) {
+        return 0;
+    }
+    return (_num_pivots + 1) * (sizeof(*_eytzinger_prefixes) + sizeof(*_eytzinger_pivots));
+}
+
+bool ftnode_pivot_keys::eytzinger_lower_bound(const toku::comparator &cmp, const DBT *key, int *lower_bound) const {
+    if (_eytzinger_prefixes == nullptr || toku_dbt_is_infinite(key)) {
+        return false;
+    }
+
+    // the comparator falls back to memcmp only for keys that all carry its magic
+    DBT first = get_pivot(0);
+    if (cmp.get_compare_func() != toku_builtin_compare_fun) {
+        if (cmp.get_memcmp_magic() == toku::comparator::MEMCMP_MAGIC_NONE ||
+            key->size == 0 || !cmp.dbt_has_memcmp_magic(key) ||
+            _eytzinger_skip == 0 || !cmp.dbt_has_memcmp_magic(&first)) {
+            return false;
+        }
+    }
+
+    // a key that does not share the pivots' prefix is smaller or bigger
+    // than all of them
+    const uint32_t skip = _eytzinger_skip;
+    int c = toku_keycompare(key->data, key->size < skip ? key->size : skip, first.data, skip);
+    if (c != 0) {
+        *lower_bound = c < 0 ? 0 : _num_pivots;
+        return true;
+    }
+
+    // descend to a leaf of the implicit tree, going right past every
+    // prefix that is less than the key's
+    const uint64_t prefix = load_be64_prefix(key->data, key->size, skip);
+    const size_t n = _num_pivots;
+    size_t k = 1;
+    while (k <= n) {
+        __builtin_prefetch(_eytzinger_prefixes + 8 * k);
+        k = 2 * k + (_eytzinger_prefixes[k] < prefix);
+    }
+    // the last left turn was at the first prefix that is not less than the
+    // key's, and shifting out the right turns after it leaves its position
+    k >>= __builtin_ffsl(~k);
+    int lo = _eytzinger_pivots[k];
+
+    // a pivot with a smaller prefix is smaller than the key and one with a
+    // bigger prefix is bigger, so only equal prefixes need whole keys compared
+    if (k != 0 && _eytzinger_prefixes[k] == prefix) {
+        int hi = _num_pivots;
+        while (lo < hi) {
+            int mi = (lo + hi) / 2;
+            DBT pivot = get_pivot(mi);
+            if (toku_keycompare(pivot.data, pivot.size, key->data, key->size) < 0) {
+                lo = mi + 1;
+            } else {
+                hi = mi;
+            }
+        }
+    }
+    *lower_bound = lo;
+    return true;
+}
@@ -62,6 +62,7 @@ initialize_ftnode(FTNODE node, BLOCKNUM blocknum)
     node->blocknum = blocknum;
     node->dirty = 0;
     node->bp = NULL;
+    node->bp_meta = NULL;
     // <CER> Can we use this initialization as a correctness assert in
     // a later function?
     node->layout_version_read_from_disk = 0;
@@ -123,7 +124,7 @@ read_node_info(FTNODE node, struct rbuf *rb, int version)
 void
 allocate_and_read_partition_offsets(FTNODE node, struct rbuf *rb, FTNODE_DISK_DATA *ndd)
 {
-    XMALLOC_N(node->n_children, node->bp);
+    toku_ftnode_alloc_partitions(node, node->n_children);
     // TODO: Fix this to use xmalloc_n
     XMALLOC_N(node->n_children, *ndd);
     // Read the partition locations.
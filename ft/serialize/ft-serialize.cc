@@ -330,6 +330,15 @@ int deserialize_ft_versioned(int fd, struct rbuf *rb, FT *ftp, uint32_t version)
     }
     ft->in_memory_logical_rows = on_disk_logical_rows;
 
+    uint32_t value_log_threshold;
+    value_log_threshold = 0;
+    uint64_t value_log_tail;
+    value_log_tail = 0;
+    if (ft->layout_version_read_from_disk >= FT_LAYOUT_VERSION_31) {
+        value_log_threshold = rbuf_int(rb);
+        value_log_tail = rbuf_ulonglong(rb);
+    }
+
     (void) rbuf_int(rb); //Read in checksum and ignore (already verified).
     if (rb->ndone != rb->size) {
         fprintf(stderr, "Header size did not match contents.\n");
@@ -365,7 +374,9 @@ int deserialize_ft_versioned(int fd, struct rbuf *rb, FT *ftp, uint32_t version)
             .count_of_optimize_in_progress_read_from_disk = count_of_optimize_in_progress,
             .msn_at_start_of_last_completed_optimize = msn_at_start_of_last_completed_optimize,
             .on_disk_stats = on_disk_stats,
-            .on_disk_logical_rows = on_disk_logical_rows
+            .on_disk_logical_rows = on_disk_logical_rows,
+            .value_log_threshold = value_log_threshold,
+            .value_log_tail = value_log_tail
         };
         XMEMDUP(ft->h, &h);
     }
@@ -415,6 +426,11 @@ static size_t serialize_ft_min_size(uint32_t version) {
     size_t size = 0;
 
     switch (version) {
+        case FT_LAYOUT_VERSION_31:
+            size += sizeof(uint32_t);  // value_log_threshold in ft
+            size += sizeof(uint64_t);  // value_log_tail in ft
+            // fallthrough
+        case FT_LAYOUT_VERSION_30:
         case FT_LAYOUT_VERSION_29:
             size += sizeof(uint64_t);  // logrows in ft
             // fallthrough
@@ -848,6 +864,8 @@ void toku_serialize_ft_to_wbuf (
     wbuf_MSN(wbuf, h->max_msn_in_ft);
     wbuf_int(wbuf, h->fanout);
     wbuf_ulonglong(wbuf, h->on_disk_logical_rows);
+    wbuf_int(wbuf, h->value_log_threshold);
+    wbuf_ulonglong(wbuf, h->value_log_tail);
     uint32_t checksum = toku_x1764_finish(&wbuf->checksum);
     wbuf_int(wbuf, checksum);
     lazy_assert(wbuf->ndone == wbuf->size);
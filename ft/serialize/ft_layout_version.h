@@ -69,6 +69,8 @@ enum ft_layout_version_e {
     FT_LAYOUT_VERSION_27 = 27, // serialize message trees with nonleaf buffers to avoid key, msn sort on deserialize
     FT_LAYOUT_VERSION_28 = 28, // Add fanout to ft_header
     FT_LAYOUT_VERSION_29 = 29, // Add logrows to ft_header
+    FT_LAYOUT_VERSION_30 = 30, // Add enq_deleterange log entry
+    FT_LAYOUT_VERSION_31 = 31, // Add value_log_threshold and value_log_tail to ft_header
     FT_NEXT_VERSION,           // the version after the current version
     FT_LAYOUT_VERSION   = FT_NEXT_VERSION-1, // A hack so I don't have to change this line.
     FT_LAYOUT_MIN_SUPPORTED_VERSION = FT_LAYOUT_VERSION_13, // Minimum version supported
@@ -49,6 +49,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/compress.h"
 #include "ft/serialize/ft_node-serialize.h"
 #include "ft/serialize/sub_block.h"
+#include "ft/serialize/victim_cache.h"
 #include "util/sort.h"
 #include "util/threadpool.h"
 #include "util/status.h"
@@ -778,7 +779,7 @@ ftnode_header_size (FTNODE node)
     long retval = 0;
     int n_children = node->n_children;
     retval += sizeof(*node);
-    retval += (n_children)*(sizeof(node->bp[0]));
+    retval += (n_children)*(sizeof(node->bp[0]) + sizeof(node->bp_meta[0]));
     retval += node->pivotkeys.total_size();
     return retval;
 }
@@ -838,7 +839,9 @@ int toku_serialize_ftnode_to(int fd,
     toku_ft_status_update_flush_reason(
         node, n_uncompressed_bytes, n_to_write, io_time, for_checkpoint);
 
-    toku_free(compressed_buf);
+    if (!toku_victim_cache_put(ft, blocknum, reinterpret_cast<uint8_t *>(compressed_buf), n_to_write)) {
+        toku_free(compressed_buf);
+    }
     node->dirty = 0;  // See #1957.   Must set the node to be clean after
                       // serializing it so that it doesn't get written again on
                       // the next checkpoint or eviction.
@@ -1038,6 +1041,7 @@ NONLEAF_CHILDINFO toku_create_empty_nl(void) {
     cn->stale_message_tree.create_no_array();
     cn->broadcast_list.create_no_array();
     memset(cn->flow, 0, sizeof cn->flow);
+    cn->broadcasts_deferred = false;
     return cn;
 }
 
@@ -1052,6 +1056,7 @@ NONLEAF_CHILDINFO toku_clone_nl(NONLEAF_CHILDINFO orig_childinfo) {
     cn->broadcast_list.create_no_array();
     cn->broadcast_list.clone(orig_childinfo->broadcast_list);
     memset(cn->flow, 0, sizeof cn->flow);
+    cn->broadcasts_deferred = orig_childinfo->broadcasts_deferred;
     return cn;
 }
 
@@ -1089,6 +1094,98 @@ void read_block_from_fd_into_rbuf(
     assert((DISKOFF)rlen <= size_aligned);
 }
 
+// A run of blocks read by one pread for a batched prefetch is cut short
+// once it reaches this size, unless it holds a single block.
+static const DISKOFF prefetch_max_read_size = 8 * 1024 * 1024;
+
+int toku_ftnode_prefetch_read_blocks(int fd,
+                                     FT ft,
+                                     int n,
+                                     BLOCKNUM *blocknums,
+                                     ftnode_fetch_extra **bfes,
+                                     uint8_t **bufs) {
+    DISKOFF *XMALLOC_N(n, offsets);
+    DISKOFF *XMALLOC_N(n, sizes);
+    int *XMALLOC_N(n, order);
+    int n_blocks = 0;
+    for (int i = 0; i < n; i++) {
+        ft->blocktable.translate_blocknum_to_offset_size(blocknums[i], &offsets[i], &sizes[i]);
+        if (offsets[i] < 0 || sizes[i] <= 0) {
+            continue;
+        }
+        // insertion sort by offset, batches are small
+        int j = n_blocks++;
+        for (; j > 0 && offsets[order[j - 1]] > offsets[i]; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    // split the blocks into runs, each read by one pread
+    int *XMALLOC_N(n, run_first);
+    struct toku_os_pread_req *XMALLOC_N(n, reqs);
+    int n_bufs = 0;
+    DISKOFF total_size = 0;
+    for (int first = 0; first < n_blocks; ) {
+        // extend the run while the next block starts where the previous
+        // one ends, up to the block allocator's alignment
+        const DISKOFF start = offsets[order[first]];
+        DISKOFF end = start + sizes[order[first]];
+        int last = first;
+        while (last + 1 < n_blocks) {
+            const int next = order[last + 1];
+            if (offsets[next] > (DISKOFF) roundup_to_multiple(BlockAllocator::BLOCK_ALLOCATOR_ALIGNMENT, end) ||
+                offsets[next] + sizes[next] - start > prefetch_max_read_size) {
+                break;
+            }
+            end = offsets[next] + sizes[next];
+            last++;
+        }
+
+        const DISKOFF size_aligned = roundup_to_multiple(512, end - start);
+        uint8_t *XMALLOC_N_ALIGNED(512, size_aligned, raw_block);
+        bufs[n_bufs] = raw_block;
+        run_first[n_bufs] = first;
+        reqs[n_bufs] = { raw_block, (size_t) size_aligned, start, 0 };
+        n_bufs++;
+        total_size += end - start;
+        if (last > first) {
+            FT_STATUS_INC(FT_PREFETCH_COALESCED_READS, 1);
+            FT_STATUS_INC(FT_PREFETCH_COALESCED_NODES, last - first + 1);
+        }
+        first = last + 1;
+    }
+
+    // read all the runs at once
+    tokutime_t t0 = toku_time_now();
+    toku_os_pread_batch(fd, n_bufs, reqs);
+    tokutime_t t1 = toku_time_now();
+
+    for (int b = 0; b < n_bufs; b++) {
+        const int first = run_first[b];
+        const int last = b + 1 < n_bufs ? run_first[b + 1] - 1 : n_blocks - 1;
+        const DISKOFF start = offsets[order[first]];
+        const DISKOFF end = offsets[order[last]] + sizes[order[last]];
+        assert(reqs[b].bytes_read >= end - start);
+        assert(reqs[b].bytes_read <= (ssize_t) reqs[b].count);
+        for (int k = first; k <= last; k++) {
+            const int i = order[k];
+            bfes[i]->prefetched_block = bufs[b] + (offsets[i] - start);
+            bfes[i]->prefetched_offset = offsets[i];
+            bfes[i]->prefetched_size = sizes[i];
+            // charge each node its share of the time spent reading
+            bfes[i]->io_time = (t1 - t0) * sizes[i] / total_size;
+        }
+    }
+
+    toku_free(run_first);
+    toku_free(reqs);
+    toku_free(offsets);
+    toku_free(sizes);
+    toku_free(order);
+    return n_bufs;
+}
+
 static const int read_header_heuristic_max = 32*1024;
 
 #ifndef MIN
@@ -1111,7 +1208,9 @@ static void read_ftnode_header_from_fd_into_rbuf_if_small_enough(int fd, BLOCKNU
     } else {
         read_size = roundup_to_multiple(512, MAX(header_size, MIN(read_header_heuristic_max, size)));
     }
-    uint8_t *XMALLOC_N_ALIGNED(512, roundup_to_multiple(512, size), raw_block);
+    // a stale header size can exceed the block size; the buffer must hold the whole read
+    const DISKOFF size_aligned = roundup_to_multiple(512, size);
+    uint8_t *XMALLOC_N_ALIGNED(512, MAX(read_size, size_aligned), raw_block);
     rbuf_init(rb, raw_block, read_size);
 
     // read the block
@@ -1568,6 +1667,7 @@ static FTNODE alloc_ftnode_for_deserialize(uint32_t fullhash, BLOCKNUM blocknum)
     node->dirty = 0;
     node->oldest_referenced_xid_known = TXNID_NONE;
     node->bp = nullptr;
+    node->bp_meta = nullptr;
     node->ct_pair = nullptr;
     return node; 
 }
@@ -1700,7 +1800,7 @@ static int deserialize_ftnode_header_from_rbuf_if_small_enough(
         goto cleanup;
     }
 
-    XMALLOC_N(node->n_children, node->bp);
+    toku_ftnode_alloc_partitions(node, node->n_children);
     XMALLOC_N(node->n_children, *ndd);
     // read the partition locations
     for (int i=0; i<node->n_children; i++) {
@@ -1866,7 +1966,7 @@ cleanup:
     if (r != 0) {
         if (node) {
             toku_free(*ndd);
-            toku_free(node->bp);
+            toku_ftnode_free_partitions(node);
             toku_free(node);
         }
     }
@@ -1913,7 +2013,7 @@ static int deserialize_and_upgrade_internal_node(FTNODE node,
     node->pivotkeys.deserialize_from_rbuf(rb, node->n_children - 1);
 
     // Create space for the child node buffers (a.k.a. partitions).
-    XMALLOC_N(node->n_children, node->bp);
+    toku_ftnode_alloc_partitions(node, node->n_children);
 
     // Set the child blocknums.
     for (int i = 0; i < node->n_children; ++i) {
@@ -2038,7 +2138,7 @@ deserialize_and_upgrade_leaf_node(FTNODE node,
     // Set number of children to 1, since we will only have one
     // basement node.
     node->n_children = 1;
-    XMALLOC_N(node->n_children, node->bp);
+    toku_ftnode_alloc_partitions(node, node->n_children);
     node->pivotkeys.create_empty();
 
     // Create one basement node to contain all the leaf entries by
@@ -2362,7 +2462,7 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
     node->layout_version_original = rbuf_int(rb);
     node->build_id = rbuf_int(rb);
     node->n_children = rbuf_int(rb);
-    XMALLOC_N(node->n_children, node->bp);
+    toku_ftnode_alloc_partitions(node, node->n_children);
     XMALLOC_N(node->n_children, *ndd);
     // read the partition locations
     for (int i=0; i<node->n_children; i++) {
@@ -2558,7 +2658,7 @@ int
 toku_deserialize_bp_from_disk(FTNODE node, FTNODE_DISK_DATA ndd, int childnum, int fd, ftnode_fetch_extra *bfe) {
     int r = 0;
     assert(BP_STATE(node,childnum) == PT_ON_DISK);
-    assert(node->bp[childnum].ptr.tag == BCT_NULL);
+    assert(node->bp[childnum].tag == BCT_NULL);
     
     //
     // setup the partition
@@ -2587,13 +2687,18 @@ toku_deserialize_bp_from_disk(FTNODE node, FTNODE_DISK_DATA ndd, int childnum, i
     rbuf_init(&rb, pad_at_beginning+raw_block, curr_size);
     tokutime_t t0 = toku_time_now();
 
-    // read the block
-    assert(0==((unsigned long long)raw_block)%512); // for O_DIRECT
-    assert(0==(padded_size)%512);
-    assert(0==(node_offset+curr_offset-pad_at_beginning)%512);
-    ssize_t rlen = toku_os_pread(fd, raw_block, padded_size, node_offset+curr_offset-pad_at_beginning);
-    assert((DISKOFF)rlen >= pad_at_beginning + curr_size); // we read in at least enough to get what we wanted
-    assert((DISKOFF)rlen <= padded_size);                  // we didn't read in too much.
+    // read the block, from the victim cache if the node's image is there
+    ssize_t rlen;
+    if (toku_victim_cache_read(bfe->ft, node->blocknum, curr_offset, curr_size, pad_at_beginning + raw_block)) {
+        rlen = curr_size;
+    } else {
+        assert(0==((unsigned long long)raw_block)%512); // for O_DIRECT
+        assert(0==(padded_size)%512);
+        assert(0==(node_offset+curr_offset-pad_at_beginning)%512);
+        rlen = toku_os_pread(fd, raw_block, padded_size, node_offset+curr_offset-pad_at_beginning);
+        assert((DISKOFF)rlen >= pad_at_beginning + curr_size); // we read in at least enough to get what we wanted
+        assert((DISKOFF)rlen <= padded_size);                  // we didn't read in too much.
+    }
 
     tokutime_t t1 = toku_time_now();
 
@@ -2724,10 +2829,61 @@ static int deserialize_ftnode_from_fd(int fd,
 
     bfe->bytes_read = rb.size;
     bfe->io_time = t1 - t0;
+    if (r != 0 || !toku_victim_cache_put(bfe->ft, blocknum, rb.buf, rb.size)) {
+        toku_free(rb.buf);
+    }
+    return r;
+}
+
+// Effect: Deserialize the node from its image in the victim cache, if it is
+//  there. Returns -1 if it is not.
+static int deserialize_ftnode_from_victim_cache(int fd,
+                                                BLOCKNUM blocknum,
+                                                uint32_t fullhash,
+                                                FTNODE *ftnode,
+                                                FTNODE_DISK_DATA *ndd,
+                                                ftnode_fetch_extra *bfe) {
+    struct rbuf rb = RBUF_INITIALIZER;
+    if (!toku_victim_cache_get(bfe->ft, blocknum, &rb)) {
+        return -1;
+    }
+    int r = deserialize_ftnode_from_rbuf(
+        ftnode, ndd, blocknum, fullhash, bfe, nullptr, &rb, fd);
+    if (r != 0) {
+        // go to disk instead
+        toku_victim_cache_remove(bfe->ft, blocknum);
+    }
+    bfe->bytes_read = rb.size;
+    bfe->io_time = 0;
     toku_free(rb.buf);
     return r;
 }
 
+// Effect: Deserialize the node from the block a batched prefetch read for
+//  it, if there is one. Returns -1 if there is not.
+static int deserialize_ftnode_from_prefetched_block(int fd,
+                                                    BLOCKNUM blocknum,
+                                                    uint32_t fullhash,
+                                                    FTNODE *ftnode,
+                                                    FTNODE_DISK_DATA *ndd,
+                                                    ftnode_fetch_extra *bfe) {
+    if (bfe->prefetched_block == nullptr) {
+        return -1;
+    }
+    DISKOFF offset, size;
+    bfe->ft->blocktable.translate_blocknum_to_offset_size(blocknum, &offset, &size);
+    if (offset != bfe->prefetched_offset || size != bfe->prefetched_size) {
+        return -1;
+    }
+    // the block belongs to the prefetch, so the rbuf must not be freed
+    struct rbuf rb;
+    rbuf_init(&rb, bfe->prefetched_block, size);
+    int r = deserialize_ftnode_from_rbuf(
+        ftnode, ndd, blocknum, fullhash, bfe, nullptr, &rb, fd);
+    bfe->bytes_read = size;
+    return r;
+}
+
 // Effect: Read a node in.  If possible, read just the header.
 //         Perform version upgrade if necessary.
 int toku_deserialize_ftnode_from(int fd,
@@ -2742,7 +2898,19 @@ int toku_deserialize_ftnode_from(int fd,
     // each function below takes the appropriate io/decompression/deserialize
     // statistics
 
-    if (!bfe->read_all_partitions) {
+    r = deserialize_ftnode_from_prefetched_block(
+        fd, blocknum, fullhash, ftnode, ndd, bfe);
+    if (r == 0) {
+        return r;
+    }
+    r = deserialize_ftnode_from_victim_cache(
+        fd, blocknum, fullhash, ftnode, ndd, bfe);
+    if (r == 0) {
+        return r;
+    }
+    // while the victim cache is in use, read whole nodes so that their
+    // images can be cached
+    if (!bfe->read_all_partitions && toku_victim_cache_get_size_limit() == 0) {
         read_ftnode_header_from_fd_into_rbuf_if_small_enough(
             fd, blocknum, bfe->ft, &rb, bfe);
         r = deserialize_ftnode_header_from_rbuf_if_small_enough(
@@ -2953,8 +3121,7 @@ deserialize_rollback_log_from_rbuf (BLOCKNUM blocknum, ROLLBACK_LOG_NODE *log_p,
     lazy_assert(!memcmp(magic, "tokuroll", 8));
 
     result->layout_version    = rbuf_int(rb);
-    lazy_assert((FT_LAYOUT_VERSION_25 <= result->layout_version && result->layout_version <= FT_LAYOUT_VERSION_27) ||
-                (result->layout_version == FT_LAYOUT_VERSION));
+    lazy_assert(FT_LAYOUT_VERSION_25 <= result->layout_version && result->layout_version <= FT_LAYOUT_VERSION);
     result->layout_version_original = rbuf_int(rb);
     result->layout_version_read_from_disk = result->layout_version;
     result->build_id = rbuf_int(rb);
@@ -3014,7 +3181,7 @@ deserialize_rollback_log_from_rbuf_versioned (uint32_t version, BLOCKNUM blocknu
                                               struct rbuf *rb) {
     int r = 0;
     ROLLBACK_LOG_NODE rollback_log_node = NULL;
-    invariant((FT_LAYOUT_VERSION_25 <= version && version <= FT_LAYOUT_VERSION_27) || version == FT_LAYOUT_VERSION);
+    invariant(FT_LAYOUT_VERSION_25 <= version && version <= FT_LAYOUT_VERSION);
     r = deserialize_rollback_log_from_rbuf(blocknum, &rollback_log_node, rb);
     if (r==0) {
         *log = rollback_log_node;
@@ -3115,8 +3282,7 @@ static int decompress_from_raw_block_into_rbuf_versioned(uint32_t version, uint8
     // This function exists solely to accommodate future changes in compression.
     int r = 0;
     if ((version == FT_LAYOUT_VERSION_13 || version == FT_LAYOUT_VERSION_14) ||
-        (FT_LAYOUT_VERSION_25 <= version && version <= FT_LAYOUT_VERSION_27) ||
-        version == FT_LAYOUT_VERSION) {
+        (FT_LAYOUT_VERSION_25 <= version && version <= FT_LAYOUT_VERSION)) {
         r = decompress_from_raw_block_into_rbuf(raw_block, raw_block_size, rb, blocknum);
     } else {
         abort();
@@ -91,6 +91,18 @@ int toku_deserialize_ftnode_from(int fd,
                                  FTNODE *node,
                                  FTNODE_DISK_DATA *ndd,
                                  ftnode_fetch_extra *bfe);
+// Effect: Reads the blocks of n nodes that a batched prefetch is about to
+//  fetch, with one pread for each run of blocks that are next to each other
+//  on disk, all of them in flight at once when io_uring is in use, and
+//  points the bfe of each node at its block.
+// Returns: the number of buffers read into, at most n, which are stored in
+//  bufs and must be freed once the nodes have been fetched.
+int toku_ftnode_prefetch_read_blocks(int fd,
+                                     FT ft,
+                                     int n,
+                                     BLOCKNUM *blocknums,
+                                     ftnode_fetch_extra **bfes,
+                                     uint8_t **bufs);
 
 void toku_serialize_set_parallel(bool);
 
@@ -0,0 +1,274 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "portability/memory.h"
+#include "portability/toku_assert.h"
+#include "portability/toku_atomic.h"
+#include "portability/toku_portability.h"
+#include "portability/toku_race_tools.h"
+
+#include "ft/serialize/value_log.h"
+#include "util/x1764.h"
+
+static const mode_t value_log_file_mode = S_IRUSR+S_IWUSR+S_IRGRP+S_IWGRP+S_IROTH+S_IWOTH;
+
+// Records are neither 512 byte aligned nor sized, so the value log does
+// not use toku_os_full_pwrite() and toku_os_pread(), which require that.
+// A full disk is waited out the way toku_os_full_pwrite() waits it out.
+static void value_log_full_pwrite(int fd, const void *buf, size_t len, uint64_t off) {
+    const char *p = static_cast<const char *>(buf);
+    while (len > 0) {
+        ssize_t r = pwrite(fd, p, len, off);
+        if (r > 0) {
+            p += r;
+            len -= r;
+            off += r;
+        } else {
+            toku_os_handle_write_error(fd, len, r);
+        }
+    }
+}
+
+static ssize_t value_log_full_pread(int fd, void *buf, size_t len, uint64_t off) {
+    char *p = static_cast<char *>(buf);
+    size_t done = 0;
+    while (done < len) {
+        ssize_t r = pread(fd, p + done, len - done, off + done);
+        if (r < 0) {
+            if (get_maybe_error_errno() == EINTR) {
+                continue;
+            }
+            return r;
+        }
+        if (r == 0) {
+            break;
+        }
+        done += r;
+    }
+    return done;
+}
+
+// Effect: Makes sure buf can hold size bytes and sets its size.
+static void value_log_dbt_resize(DBT *buf, uint32_t size) {
+    paranoid_invariant(buf->flags == DB_DBT_REALLOC);
+    if (buf->ulen < size) {
+        buf->data = toku_xrealloc(buf->data, size);
+        buf->ulen = size;
+    }
+    buf->size = size;
+}
+
+char *value_log::fname_of(const char *dictionary_fname) {
+    const size_t len = strlen(dictionary_fname) + sizeof ".vlog";
+    char *XMALLOC_N(len, fname);
+    snprintf(fname, len, "%s.vlog", dictionary_fname);
+    return fname;
+}
+
+int value_log::rename_with_dictionary(const char *old_dictionary_fname, const char *new_dictionary_fname) {
+    char *old_fname = fname_of(old_dictionary_fname);
+    char *new_fname = fname_of(new_dictionary_fname);
+    int r = 0;
+    if (toku_os_rename(old_fname, new_fname) != 0) {
+        r = get_error_errno();
+        if (r == ENOENT) {
+            r = 0;
+        }
+    }
+    toku_free(new_fname);
+    toku_free(old_fname);
+    return r;
+}
+
+int value_log::unlink_with_dictionary(const char *dictionary_fname) {
+    char *fname = fname_of(dictionary_fname);
+    int r = 0;
+    if (unlink(fname) != 0) {
+        r = get_error_errno();
+        if (r == ENOENT) {
+            r = 0;
+        }
+    }
+    toku_free(fname);
+    return r;
+}
+
+int value_log::open(const char *fname, bool create) {
+    const int flags = O_RDWR | O_BINARY | (create ? O_CREAT : 0);
+    m_fd = toku_os_open(fname, flags, value_log_file_mode, *tokudb_file_data_key);
+    if (m_fd < 0) {
+        return get_error_errno();
+    }
+    int64_t size;
+    int r = toku_os_get_file_size(m_fd, &size);
+    if (r != 0) {
+        r = get_error_errno();
+        toku_os_close(m_fd);
+        return r;
+    }
+    // Anything after the last checkpoint may be a torn append.  Leave it
+    // be: no checkpointed reference points there, and recovery appends
+    // what it needs again after it.
+    m_end = size;
+    m_reclaimed = 0;
+    m_unlink_fname = nullptr;
+    return 0;
+}
+
+void value_log::close(void) {
+    int r = toku_os_close(m_fd);
+    assert_zero(r);
+    if (m_unlink_fname != nullptr) {
+        r = unlink(m_unlink_fname);
+        assert_zero(r);
+        toku_free(m_unlink_fname);
+        m_unlink_fname = nullptr;
+    }
+    m_fd = -1;
+}
+
+void value_log::unlink_on_close(const char *fname) {
+    toku_free(m_unlink_fname);
+    m_unlink_fname = toku_xstrdup(fname);
+}
+
+uint64_t value_log::append(const void *val, uint32_t vallen) {
+    const uint64_t size = record_size(vallen);
+    char *XMALLOC_N(size, record);
+    memcpy(record, &vallen, sizeof vallen);
+    memcpy(record + sizeof vallen, val, vallen);
+    const uint32_t checksum = toku_x1764_memory(val, vallen);
+    memcpy(record + sizeof vallen + vallen, &checksum, sizeof checksum);
+
+    // claim the space first so appends can write concurrently
+    const uint64_t offset = toku_sync_fetch_and_add(&m_end, size);
+    value_log_full_pwrite(m_fd, record, size, offset);
+    toku_free(record);
+    return offset;
+}
+
+int value_log::read(uint64_t offset, uint32_t vallen, DBT *buf, void **val) const {
+    const uint64_t size = record_size(vallen);
+    value_log_dbt_resize(buf, size);
+    char *record = static_cast<char *>(buf->data);
+    ssize_t r = value_log_full_pread(m_fd, record, size, offset);
+    if (r != static_cast<ssize_t>(size)) {
+        return TOKUDB_BAD_CHECKSUM;
+    }
+    uint32_t stored_len, stored_checksum;
+    memcpy(&stored_len, record, sizeof stored_len);
+    memcpy(&stored_checksum, record + sizeof stored_len + vallen, sizeof stored_checksum);
+    if (stored_len != vallen ||
+        stored_checksum != toku_x1764_memory(record + sizeof stored_len, vallen)) {
+        return TOKUDB_BAD_CHECKSUM;
+    }
+    *val = record + sizeof stored_len;
+    return 0;
+}
+
+void value_log::fsync(void) {
+    toku_file_fsync(m_fd);
+}
+
+void value_log::reclaim(uint64_t tail) {
+    if (tail <= m_reclaimed) {
+        return;
+    }
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+    // Offsets are never reused, so keep the size and punch out the range.
+    // File systems that cannot punch holes just keep the space.
+    (void) fallocate(m_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, m_reclaimed, tail - m_reclaimed);
+#endif
+    m_reclaimed = tail;
+}
+
+uint64_t value_log::end(void) const {
+    return toku_unsafe_fetch(&m_end);
+}
+
+void value_log::encode(const DBT *val, uint32_t threshold, DBT *stored) {
+    if (val->size <= threshold) {
+        value_log_dbt_resize(stored, 1 + val->size);
+        char *p = static_cast<char *>(stored->data);
+        p[0] = VALUE_INLINE;
+        memcpy(p + 1, val->data, val->size);
+    } else {
+        const uint64_t offset = append(val->data, val->size);
+        value_log_dbt_resize(stored, REF_SIZE);
+        char *p = static_cast<char *>(stored->data);
+        p[0] = VALUE_REF;
+        memcpy(p + 1, &offset, sizeof offset);
+        memcpy(p + 1 + sizeof offset, &val->size, sizeof val->size);
+    }
+}
+
+bool value_log::decode_ref(const void *stored, uint32_t storedlen, uint64_t *offset, uint32_t *vallen) {
+    const char *p = static_cast<const char *>(stored);
+    if (storedlen != REF_SIZE || p[0] != VALUE_REF) {
+        return false;
+    }
+    memcpy(offset, p + 1, sizeof *offset);
+    memcpy(vallen, p + 1 + sizeof *offset, sizeof *vallen);
+    return true;
+}
+
+int value_log::decode(uint32_t *vallen, void **val, DBT *buf) const {
+    if (*vallen == 0) {
+        // nothing was stored, as for a deleted row
+        return 0;
+    }
+    uint64_t ref_offset;
+    uint32_t ref_vallen;
+    if (decode_ref(*val, *vallen, &ref_offset, &ref_vallen)) {
+        int r = read(ref_offset, ref_vallen, buf, val);
+        if (r == 0) {
+            *vallen = ref_vallen;
+        }
+        return r;
+    }
+    paranoid_invariant(static_cast<const char *>(*val)[0] == VALUE_INLINE);
+    *val = static_cast<char *>(*val) + 1;
+    *vallen -= 1;
+    return 0;
+}
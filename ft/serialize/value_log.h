@@ -0,0 +1,150 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+
+#pragma once
+
+#include "portability/toku_portability.h"
+
+#include "util/dbt.h"
+
+// A dictionary's value log: an append-only file next to the dictionary that
+// holds the values too large to keep inline in leafentries.  A dictionary
+// created with a value log threshold stores every value with a tag byte in
+// front: values no longer than the threshold follow the tag inline, larger
+// ones are appended to the value log and the leafentry holds a reference
+// (offset and length) to them instead.  Leafentries stay small, so leaves
+// hold more rows, and flushes and merges copy references, not values.
+//
+// Each record in the file is the value's length, the value, and an x1764
+// checksum of the value.  Records that are no longer referenced are
+// garbage; toku_ft_get_value_log_garbage() measures it and
+// toku_ft_value_log_gc() moves the live records off the oldest part of the
+// log so that part can be given back to the file system.
+//
+// Appends are not synced.  The FT syncs the value log before it writes a
+// checkpoint's header, and recovery rebuilds anything newer from the
+// recovery log, which holds the values themselves.
+class value_log {
+public:
+    // what the tag byte in front of a stored value says follows it
+    enum {
+        VALUE_INLINE = 0,
+        VALUE_REF = 1,
+    };
+    // a tag, then a reference: the offset and length of a value
+    static const uint32_t REF_SIZE = 1 + sizeof(uint64_t) + sizeof(uint32_t);
+    // a record holds its value's length, the value, then a checksum
+    static uint64_t record_size(uint32_t vallen) {
+        return sizeof(uint32_t) + vallen + sizeof(uint32_t);
+    }
+
+    // Returns: the name of the value log of the dictionary file
+    //  dictionary_fname, which the caller frees with toku_free().
+    static char *fname_of(const char *dictionary_fname);
+
+    // Effect: Renames the value log of the dictionary file
+    //  old_dictionary_fname, if it has one, to go with new_dictionary_fname.
+    // Returns: 0 on success, an errno otherwise.
+    static int rename_with_dictionary(const char *old_dictionary_fname, const char *new_dictionary_fname);
+
+    // Effect: Deletes the value log of the dictionary file dictionary_fname,
+    //  if it has one.
+    // Returns: 0 on success, an errno otherwise.
+    static int unlink_with_dictionary(const char *dictionary_fname);
+
+    // Effect: Opens the value log at fname.  If create is set, the file is
+    //  created if it does not exist; only a new dictionary does that.
+    // Returns: 0 on success, ENOENT if the file does not exist and create
+    //  is not set, another errno otherwise.
+    int open(const char *fname, bool create);
+
+    // Effect: Closes the value log, deleting the file if
+    //  unlink_on_close() was called.
+    void close(void);
+
+    // Effect: Deletes the file, which is now at fname, when the value log
+    //  is closed.  Called when the dictionary's file is going away.
+    void unlink_on_close(const char *fname);
+
+    // Effect: Appends a record holding val to the log.
+    // Returns: the offset of the record, for a reference.
+    uint64_t append(const void *val, uint32_t vallen);
+
+    // Effect: Reads the record at offset, whose value must be vallen bytes
+    //  long, into buf, growing it as needed, and points *val at the value.
+    //  buf must be initialized with DB_DBT_REALLOC.
+    // Returns: 0 on success, TOKUDB_BAD_CHECKSUM if the record does not
+    //  hold a value of that length and checksum.
+    int read(uint64_t offset, uint32_t vallen, DBT *buf, void **val) const;
+
+    // Effect: Makes every record appended so far durable.
+    void fsync(void);
+
+    // Effect: Gives back to the file system the space of the log below
+    //  offset tail, which no checkpointed reference points into anymore.
+    void reclaim(uint64_t tail);
+
+    // Returns: the offset just past the last record.
+    uint64_t end(void) const;
+
+    // Effect: Encodes val in the stored form into stored, growing its
+    //  buffer as needed, and appends val to the log if it is longer than
+    //  threshold.  stored must be initialized with DB_DBT_REALLOC.
+    void encode(const DBT *val, uint32_t threshold, DBT *stored);
+
+    // Effect: Points *val and *vallen at the user's value for a stored
+    //  value, reading it into buf if the stored value is a reference.
+    //  buf must be initialized with DB_DBT_REALLOC.
+    // Returns: 0 on success, or the error from read().
+    int decode(uint32_t *vallen, void **val, DBT *buf) const;
+
+    // Effect: If a stored value is a reference, sets *offset and *vallen
+    //  to what it refers to.
+    // Returns: true if it is a reference.
+    static bool decode_ref(const void *stored, uint32_t storedlen, uint64_t *offset, uint32_t *vallen);
+
+private:
+    int m_fd;
+    // the file to delete on close, or null
+    char *m_unlink_fname;
+    // the offset just past the last record, bumped atomically by append()
+    uint64_t m_end;
+    // the log below this has been given back to the file system
+    uint64_t m_reclaimed;
+};
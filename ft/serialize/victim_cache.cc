@@ -0,0 +1,306 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "portability/memory.h"
+#include "portability/toku_assert.h"
+#include "portability/toku_portability.h"
+#include "portability/toku_pthread.h"
+#include "portability/toku_race_tools.h"
+
+#include "ft/ft-internal.h"
+#include "ft/serialize/victim_cache.h"
+
+toku_instr_key *victim_cache_mutex_key;
+
+struct victim_cache_entry {
+    FT ft;
+    BLOCKNUM blocknum;
+    // where the image is on disk, it is only returned while the
+    // block translation of blocknum still matches
+    DISKOFF offset;
+    DISKOFF size;
+    uint8_t *image;
+    struct victim_cache_entry *hash_next;
+    // doubly linked list, from the most to the least recently used
+    struct victim_cache_entry *lru_prev;
+    struct victim_cache_entry *lru_next;
+};
+
+static const uint32_t victim_cache_num_buckets = 1 << 16;
+
+// all of these are protected by vc_mutex
+static toku_mutex_t vc_mutex;
+static struct victim_cache_entry **vc_buckets; // allocated when a budget is first set
+static struct victim_cache_entry *vc_lru_head;
+static struct victim_cache_entry *vc_lru_tail;
+static uint64_t vc_size;
+static uint64_t vc_size_limit;
+
+void toku_victim_cache_init(void) {
+    toku_mutex_init(*victim_cache_mutex_key, &vc_mutex, nullptr);
+    vc_buckets = nullptr;
+    vc_lru_head = nullptr;
+    vc_lru_tail = nullptr;
+    vc_size = 0;
+    vc_size_limit = 0;
+}
+
+static uint32_t victim_cache_bucket(FT ft, BLOCKNUM blocknum) {
+    uint64_t h = (reinterpret_cast<uintptr_t>(ft) >> 4) * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t) blocknum.b * 0xC2B2AE3D27D4EB4FULL;
+    return (uint32_t) (h >> 32) & (victim_cache_num_buckets - 1);
+}
+
+// Returns the link that points at the entry of blocknum, or at the end of
+// its hash chain if there is none.
+static struct victim_cache_entry **victim_cache_find_locked(FT ft, BLOCKNUM blocknum) {
+    struct victim_cache_entry **link = &vc_buckets[victim_cache_bucket(ft, blocknum)];
+    while (*link != nullptr && ((*link)->ft != ft || (*link)->blocknum.b != blocknum.b)) {
+        link = &(*link)->hash_next;
+    }
+    return link;
+}
+
+static void victim_cache_lru_unlink_locked(struct victim_cache_entry *e) {
+    if (e->lru_prev) {
+        e->lru_prev->lru_next = e->lru_next;
+    } else {
+        vc_lru_head = e->lru_next;
+    }
+    if (e->lru_next) {
+        e->lru_next->lru_prev = e->lru_prev;
+    } else {
+        vc_lru_tail = e->lru_prev;
+    }
+    e->lru_prev = e->lru_next = nullptr;
+}
+
+static void victim_cache_lru_push_front_locked(struct victim_cache_entry *e) {
+    e->lru_prev = nullptr;
+    e->lru_next = vc_lru_head;
+    if (vc_lru_head) {
+        vc_lru_head->lru_prev = e;
+    } else {
+        vc_lru_tail = e;
+    }
+    vc_lru_head = e;
+}
+
+static void victim_cache_remove_locked(struct victim_cache_entry **link) {
+    struct victim_cache_entry *e = *link;
+    *link = e->hash_next;
+    victim_cache_lru_unlink_locked(e);
+    vc_size -= e->size;
+    toku_free(e->image);
+    toku_free(e);
+}
+
+static void victim_cache_shrink_locked(void) {
+    while (vc_size > vc_size_limit) {
+        struct victim_cache_entry *e = vc_lru_tail;
+        victim_cache_remove_locked(victim_cache_find_locked(e->ft, e->blocknum));
+    }
+}
+
+void toku_victim_cache_destroy(void) {
+    if (vc_buckets) {
+        vc_size_limit = 0;
+        victim_cache_shrink_locked();
+        toku_free(vc_buckets);
+        vc_buckets = nullptr;
+    }
+    toku_mutex_destroy(&vc_mutex);
+}
+
+void toku_victim_cache_set_size_limit(uint64_t size_limit) {
+    toku_mutex_lock(&vc_mutex);
+    if (vc_buckets == nullptr && size_limit > 0) {
+        struct victim_cache_entry **XCALLOC_N(victim_cache_num_buckets, buckets);
+        toku_unsafe_set(&vc_buckets, buckets);
+    }
+    toku_unsafe_set(&vc_size_limit, size_limit);
+    if (vc_buckets) {
+        victim_cache_shrink_locked();
+    }
+    toku_mutex_unlock(&vc_mutex);
+}
+
+uint64_t toku_victim_cache_get_size_limit(void) {
+    return toku_unsafe_fetch(&vc_size_limit);
+}
+
+uint64_t toku_victim_cache_get_size(void) {
+    return toku_unsafe_fetch(&vc_size);
+}
+
+// The cache is only touched once a budget was set, so that nodes are read
+// and written without taking vc_mutex by default.
+static bool victim_cache_in_use(void) {
+    return toku_unsafe_fetch(&vc_buckets) != nullptr;
+}
+
+bool toku_victim_cache_put(FT ft, BLOCKNUM blocknum, uint8_t *image, DISKOFF size) {
+    if (!victim_cache_in_use()) {
+        return false;
+    }
+    DISKOFF offset, disk_size;
+    ft->blocktable.translate_blocknum_to_offset_size(blocknum, &offset, &disk_size);
+
+    bool stored = false;
+    toku_mutex_lock(&vc_mutex);
+    struct victim_cache_entry **link = victim_cache_find_locked(ft, blocknum);
+    if (*link != nullptr) {
+        victim_cache_remove_locked(link);
+    }
+    if (disk_size == size && (uint64_t) size <= vc_size_limit) {
+        struct victim_cache_entry *XMALLOC(e);
+        e->ft = ft;
+        e->blocknum = blocknum;
+        e->offset = offset;
+        e->size = size;
+        e->image = image;
+        e->hash_next = *link;
+        *link = e;
+        victim_cache_lru_push_front_locked(e);
+        vc_size += size;
+        victim_cache_shrink_locked();
+        stored = true;
+    }
+    toku_mutex_unlock(&vc_mutex);
+    return stored;
+}
+
+void toku_victim_cache_note_evicted(FT ft, BLOCKNUM blocknum) {
+    if (!victim_cache_in_use()) {
+        return;
+    }
+    toku_mutex_lock(&vc_mutex);
+    struct victim_cache_entry *e = *victim_cache_find_locked(ft, blocknum);
+    if (e != nullptr) {
+        victim_cache_lru_unlink_locked(e);
+        victim_cache_lru_push_front_locked(e);
+    }
+    toku_mutex_unlock(&vc_mutex);
+}
+
+// Returns the entry of blocknum if it holds the current image of the
+// node, dropping it if it does not.
+static struct victim_cache_entry *victim_cache_lookup_locked(FT ft, BLOCKNUM blocknum, DISKOFF offset, DISKOFF size) {
+    struct victim_cache_entry **link = victim_cache_find_locked(ft, blocknum);
+    struct victim_cache_entry *e = *link;
+    if (e != nullptr && (e->offset != offset || e->size != size)) {
+        victim_cache_remove_locked(link);
+        e = nullptr;
+    }
+    if (e != nullptr) {
+        FT_STATUS_INC(FT_VICTIM_CACHE_HITS, 1);
+    } else {
+        FT_STATUS_INC(FT_VICTIM_CACHE_MISSES, 1);
+    }
+    return e;
+}
+
+bool toku_victim_cache_get(FT ft, BLOCKNUM blocknum, struct rbuf *rb) {
+    if (!victim_cache_in_use()) {
+        return false;
+    }
+    DISKOFF offset, size;
+    ft->blocktable.translate_blocknum_to_offset_size(blocknum, &offset, &size);
+
+    uint8_t *copy = nullptr;
+    toku_mutex_lock(&vc_mutex);
+    struct victim_cache_entry *e = victim_cache_lookup_locked(ft, blocknum, offset, size);
+    if (e != nullptr) {
+        XMALLOC_N_ALIGNED(512, roundup_to_multiple(512, size), copy);
+        memcpy(copy, e->image, size);
+    }
+    toku_mutex_unlock(&vc_mutex);
+
+    if (copy == nullptr) {
+        return false;
+    }
+    rbuf_init(rb, copy, size);
+    return true;
+}
+
+bool toku_victim_cache_read(FT ft, BLOCKNUM blocknum, uint32_t start, uint32_t len, void *buf) {
+    if (!victim_cache_in_use()) {
+        return false;
+    }
+    DISKOFF offset, size;
+    ft->blocktable.translate_blocknum_to_offset_size(blocknum, &offset, &size);
+
+    bool found = false;
+    toku_mutex_lock(&vc_mutex);
+    struct victim_cache_entry *e = victim_cache_lookup_locked(ft, blocknum, offset, size);
+    if (e != nullptr) {
+        invariant((DISKOFF) start + len <= e->size);
+        memcpy(buf, e->image + start, len);
+        found = true;
+    }
+    toku_mutex_unlock(&vc_mutex);
+    return found;
+}
+
+void toku_victim_cache_remove(FT ft, BLOCKNUM blocknum) {
+    if (!victim_cache_in_use()) {
+        return;
+    }
+    toku_mutex_lock(&vc_mutex);
+    struct victim_cache_entry **link = victim_cache_find_locked(ft, blocknum);
+    if (*link != nullptr) {
+        victim_cache_remove_locked(link);
+    }
+    toku_mutex_unlock(&vc_mutex);
+}
+
+void toku_victim_cache_remove_ft(FT ft) {
+    if (!victim_cache_in_use()) {
+        return;
+    }
+    toku_mutex_lock(&vc_mutex);
+    struct victim_cache_entry *e = vc_lru_head;
+    while (e != nullptr) {
+        struct victim_cache_entry *next = e->lru_next;
+        if (e->ft == ft) {
+            victim_cache_remove_locked(victim_cache_find_locked(ft, e->blocknum));
+        }
+        e = next;
+    }
+    toku_mutex_unlock(&vc_mutex);
+}
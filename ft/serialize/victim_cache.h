@@ -0,0 +1,88 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#pragma once
+
+#include "ft/ft.h"
+#include "ft/serialize/block_table.h"
+#include "ft/serialize/rbuf.h"
+
+// The victim cache keeps the compressed on-disk images of FT nodes in
+// memory, so that a node evicted from the cachetable can be read back in
+// without going to disk. Images are stored when a node is written out or
+// read in whole, and the ones of nodes that were just evicted from the
+// cachetable are kept the longest. It has a memory budget of its own,
+// separate from the cachetable's, and keeps nothing while that is 0,
+// which is the default.
+//
+// An image is only returned while the block translation of its node
+// still points at the block it was stored for, and writing a node
+// replaces its image, so the cache never returns stale data.
+
+void toku_victim_cache_init(void);
+void toku_victim_cache_destroy(void);
+
+// Effect: Sets the memory budget in bytes, dropping images to fit it.
+void toku_victim_cache_set_size_limit(uint64_t size_limit);
+uint64_t toku_victim_cache_get_size_limit(void);
+// Returns the number of bytes of images currently cached.
+uint64_t toku_victim_cache_get_size(void);
+
+// Effect: Stores the on-disk image of the node at blocknum, replacing any
+//  older image of it.
+// Returns true if the cache took ownership of image, which must have been
+//  allocated by toku_malloc. Otherwise the caller still owns it.
+bool toku_victim_cache_put(FT ft, BLOCKNUM blocknum, uint8_t *image, DISKOFF size);
+
+// Effect: Marks the image of blocknum, if any, as the most recently used.
+//  Called when the node is evicted from the cachetable.
+void toku_victim_cache_note_evicted(FT ft, BLOCKNUM blocknum);
+
+// Effect: If the image of blocknum is cached, initializes rb with a
+//  malloc'd copy of it, which the caller must free, and returns true.
+bool toku_victim_cache_get(FT ft, BLOCKNUM blocknum, struct rbuf *rb);
+
+// Effect: If the image of blocknum is cached, copies len bytes of it,
+//  starting at offset start, to buf and returns true.
+bool toku_victim_cache_read(FT ft, BLOCKNUM blocknum, uint32_t start, uint32_t len, void *buf);
+
+// Effect: Drops the image of blocknum, if any.
+void toku_victim_cache_remove(FT ft, BLOCKNUM blocknum);
+
+// Effect: Drops every image of ft. Called before ft is freed.
+void toku_victim_cache_remove_ft(FT ft);
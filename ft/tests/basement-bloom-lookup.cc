@@ -0,0 +1,137 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that point lookups return the same answers with basement node
+// key filters as without, and that lookups for absent keys are answered
+// by the filters, both for basement nodes built in memory and for
+// basement nodes read back from disk.
+
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_keys = 20000;
+
+static void lookup_all(FT_HANDLE t) {
+    for (int i = 0; i < n_keys; i++) {
+        char key[100], val[100];
+        snprintf(key, sizeof key, "key%08d", i);
+        snprintf(val, sizeof val, "val%d", i);
+        DBT k;
+        toku_fill_dbt(&k, key, 1 + strlen(key));
+        // only the even keys were inserted
+        struct check_pair pair = {(uint32_t) (1 + strlen(key)), key, (uint32_t) (1 + strlen(val)), val, 0};
+        int r = toku_ft_lookup(t, &k, lookup_checkf, &pair);
+        if (i % 2 == 0) {
+            assert(r == 0);
+            assert(pair.call_count == 1);
+        } else {
+            assert(r == DB_NOTFOUND);
+            assert(pair.call_count == 0);
+        }
+    }
+}
+
+// Look up every key and check that the filters answered at least 90% of
+// the misses, i.e. that they were consulted and are not all false positives.
+static void lookup_all_and_check_filters(FT_HANDLE t) {
+    const uint64_t checks_before = ft_status_value(FT_STATUS_S::FT_BASEMENT_BLOOM_CHECKS);
+    const uint64_t negatives_before = ft_status_value(FT_STATUS_S::FT_BASEMENT_BLOOM_NEGATIVES);
+    lookup_all(t);
+    const uint64_t checks = ft_status_value(FT_STATUS_S::FT_BASEMENT_BLOOM_CHECKS) - checks_before;
+    const uint64_t negatives = ft_status_value(FT_STATUS_S::FT_BASEMENT_BLOOM_NEGATIVES) - negatives_before;
+    if (verbose) {
+        printf("%" PRIu64 " checks, %" PRIu64 " negatives\n", checks, negatives);
+    }
+    assert(checks >= (uint64_t) n_keys);
+    assert(negatives <= (uint64_t) n_keys / 2);
+    assert(negatives * 10 >= (uint64_t) n_keys / 2 * 9);
+}
+
+static void test_basement_bloom(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+
+    toku_ft_set_basement_bloom_bits_per_key(10);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 1, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    for (int i = 0; i < n_keys; i += 2) {
+        char key[100], val[100];
+        snprintf(key, sizeof key, "key%08d", i);
+        snprintf(val, sizeof val, "val%d", i);
+        DBT k, v;
+        toku_ft_insert(t, toku_fill_dbt(&k, key, 1 + strlen(key)), toku_fill_dbt(&v, val, 1 + strlen(val)), null_txn);
+    }
+
+    // basement nodes built by inserts and splits
+    lookup_all_and_check_filters(t);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+
+    // basement nodes read from disk
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 0, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    lookup_all_and_check_filters(t);
+
+    // with filters turned off the lookups give the same answers and
+    // nothing consults the filters
+    toku_ft_set_basement_bloom_bits_per_key(0);
+    const uint64_t checks_before = ft_status_value(FT_STATUS_S::FT_BASEMENT_BLOOM_CHECKS);
+    lookup_all(t);
+    assert(ft_status_value(FT_STATUS_S::FT_BASEMENT_BLOOM_CHECKS) == checks_before);
+
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_basement_bloom();
+    return 0;
+}
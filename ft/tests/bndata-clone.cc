@@ -0,0 +1,247 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+// Verify that a cloned basement node shares its memory with the original
+// and keeps seeing the rows it was cloned with while the original goes on
+// taking inserts, overwrites (enough to move its mempool) and deletes, and
+// that either side can be destroyed first.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+#include "bndata.h"
+
+typedef std::vector<std::pair<std::string, std::string>> rows;
+
+static void
+le_add_to_bn(bn_data *bn, uint32_t idx, const std::string &key, const std::string &val) {
+    LEAFENTRY r = nullptr;
+    void *maybe_free = nullptr;
+    bn->get_space_for_insert(idx, key.data(), key.size(), LE_CLEAN_MEMSIZE(val.size()), &r, &maybe_free);
+    if (maybe_free) {
+        toku_free(maybe_free);
+    }
+    r->type = LE_CLEAN;
+    r->u.clean.vallen = val.size();
+    memcpy(r->u.clean.val, val.data(), val.size());
+}
+
+static void
+le_overwrite(bn_data *bn, uint32_t idx, const std::string &val) {
+    LEAFENTRY old_le;
+    uint32_t keylen;
+    void *key;
+    int r = bn->fetch_klpair(idx, &old_le, &keylen, &key);
+    assert_zero(r);
+    LEAFENTRY new_le = nullptr;
+    void *maybe_free = nullptr;
+    bn->get_space_for_overwrite(idx, key, keylen, keylen, leafentry_memsize(old_le),
+                                LE_CLEAN_MEMSIZE(val.size()), &new_le, &maybe_free);
+    if (maybe_free) {
+        toku_free(maybe_free);
+    }
+    new_le->type = LE_CLEAN;
+    new_le->u.clean.vallen = val.size();
+    memcpy(new_le->u.clean.val, val.data(), val.size());
+}
+
+static void
+le_delete(bn_data *bn, uint32_t idx) {
+    LEAFENTRY le;
+    uint32_t keylen;
+    void *key;
+    int r = bn->fetch_klpair(idx, &le, &keylen, &key);
+    assert_zero(r);
+    bn->delete_leafentry(idx, keylen, leafentry_memsize(le));
+}
+
+static std::string key_of(uint32_t i) {
+    char key[16];
+    snprintf(key, sizeof key, "%015u", 10 * i);
+    return key;
+}
+
+static void check_rows(bn_data *bn, const rows &expected) {
+    assert(bn->num_klpairs() == expected.size());
+    for (uint32_t i = 0; i < expected.size(); i++) {
+        LEAFENTRY le;
+        uint32_t keylen;
+        void *key;
+        int r = bn->fetch_klpair(i, &le, &keylen, &key);
+        assert_zero(r);
+        assert(std::string(static_cast<char *>(key), keylen) == expected[i].first);
+        assert(le->type == LE_CLEAN);
+        assert(std::string(reinterpret_cast<char *>(le->u.clean.val), le->u.clean.vallen) == expected[i].second);
+    }
+}
+
+// Serialize bn the way a checkpoint writes a cloned node, read it back,
+// and check the rows.
+static void check_serialized_rows(bn_data *bn, const rows &expected) {
+    const uint32_t size = bn_data::HEADER_LENGTH + bn->get_disk_size();
+    char *XMALLOC_N(size, buf);
+    struct wbuf wb;
+    wbuf_init(&wb, buf, size);
+    bn->serialize_to_wbuf(&wb);
+    assert(wb.ndone == size);
+
+    bn_data copy;
+    struct rbuf rb;
+    rbuf_init(&rb, (unsigned char *) buf, size);
+    copy.deserialize_from_rbuf(bn->num_klpairs(), &rb, size, FT_LAYOUT_VERSION);
+    check_rows(&copy, expected);
+    copy.destroy();
+    toku_free(buf);
+}
+
+static void fill(bn_data *bn, rows *expected, uint32_t n) {
+    bn->initialize_empty();
+    for (uint32_t i = 0; i < n; i++) {
+        expected->push_back(std::make_pair(key_of(i), "val" + std::to_string(i)));
+        le_add_to_bn(bn, i, expected->back().first, expected->back().second);
+    }
+}
+
+static void test_clone_then_change_original(uint32_t n) {
+    bn_data bn;
+    rows expected;
+    fill(&bn, &expected, n);
+
+    bn_data clone;
+    clone.clone(&bn);
+    const rows cloned = expected;
+    check_rows(&clone, cloned);
+    // nothing was copied
+    assert(clone.get_shared_memory_size() > 0);
+    assert(bn.get_shared_memory_size() > 0);
+    for (uint32_t i = 0; i < n; i++) {
+        LEAFENTRY le, clone_le;
+        int r = bn.fetch_le(i, &le);
+        assert_zero(r);
+        r = clone.fetch_le(i, &clone_le);
+        assert_zero(r);
+        assert(le == clone_le);
+    }
+
+    // appends
+    for (uint32_t i = n; i < n + n / 2; i++) {
+        expected.push_back(std::make_pair(key_of(i), "appended" + std::to_string(i)));
+        le_add_to_bn(&bn, i, expected.back().first, expected.back().second);
+    }
+    check_rows(&clone, cloned);
+    // overwrites, enough to make the original move its leafentries
+    for (uint32_t round = 0; round < 4; round++) {
+        for (uint32_t i = 0; i < expected.size(); i += 2) {
+            expected[i].second = "overwritten " + std::to_string(round) + " " + std::to_string(i);
+            le_overwrite(&bn, i, expected[i].second);
+        }
+        check_rows(&clone, cloned);
+    }
+    // inserts in the middle
+    for (uint32_t i = 1; i < n; i += 5) {
+        const uint32_t idx = i + i / 5;
+        expected.insert(expected.begin() + idx, std::make_pair(key_of(i - 1) + "x", "inserted" + std::to_string(i)));
+        le_add_to_bn(&bn, idx, expected[idx].first, expected[idx].second);
+    }
+    check_rows(&clone, cloned);
+    // deletes
+    for (uint32_t i = 0; i < expected.size(); i += 3) {
+        le_delete(&bn, i);
+        expected.erase(expected.begin() + i);
+    }
+    check_rows(&bn, expected);
+    check_rows(&clone, cloned);
+    check_serialized_rows(&clone, cloned);
+
+    // once the clone is gone, the original keeps its memory to itself
+    clone.destroy();
+    assert(bn.get_shared_memory_size() == 0);
+    le_overwrite(&bn, 0, "after the clone");
+    expected[0].second = "after the clone";
+    check_rows(&bn, expected);
+    check_serialized_rows(&bn, expected);
+    bn.verify_mempool();
+    bn.destroy();
+}
+
+static void test_destroy_original_first(uint32_t n) {
+    bn_data bn;
+    rows expected;
+    fill(&bn, &expected, n);
+
+    bn_data clone;
+    clone.clone(&bn);
+    le_overwrite(&bn, 0, "not in the clone");
+    bn.destroy();
+
+    check_rows(&clone, expected);
+    assert(clone.get_shared_memory_size() == 0);
+    // the clone can be changed too
+    for (uint32_t i = 0; i < n; i++) {
+        expected[i].second = "changed in the clone";
+        le_overwrite(&clone, i, expected[i].second);
+    }
+    le_delete(&clone, 0);
+    expected.erase(expected.begin());
+    check_rows(&clone, expected);
+    check_serialized_rows(&clone, expected);
+    clone.destroy();
+}
+
+static void test_empty(void) {
+    bn_data bn;
+    bn.initialize_empty();
+    bn_data clone;
+    clone.clone(&bn);
+    le_add_to_bn(&bn, 0, "key", "val");
+    assert(clone.num_klpairs() == 0);
+    check_serialized_rows(&clone, rows());
+    clone.destroy();
+    bn.destroy();
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_clone_then_change_original(10);
+    test_clone_then_change_original(1000);
+    test_destroy_original_first(1000);
+    test_empty();
+    return 0;
+}
@@ -0,0 +1,135 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+#include "test.h"
+#include "cachetable-test.h"
+#include "cachetable/checkpoint.h"
+
+//
+// Verify that a paced checkpoint spreads the write-out of its dirty pairs
+// over the time it is given, that it stops pacing when asked to hurry, and
+// that a checkpoint of only clean pairs is not paced at all.
+//
+
+static const int n_pairs = 10;
+
+static bool hurry_up(void) {
+    return true;
+}
+
+static void
+dirty_pairs(CACHEFILE f1) {
+    for (int i = 0; i < n_pairs; i++) {
+        void* v;
+        CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+        int r = toku_cachetable_get_and_pin(f1, make_blocknum(i), i, &v, wc, def_fetch, def_pf_req_callback, def_pf_callback, true, NULL);
+        assert_zero(r);
+        r = toku_test_cachetable_unpin(f1, make_blocknum(i), i, CACHETABLE_DIRTY, make_pair_attr(8));
+        assert_zero(r);
+    }
+}
+
+static uint64_t
+paced_checkpoint(CACHETABLE ct, uint64_t usec, bool (*hurry)(void), bool *paced) {
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    uint64_t t0 = toku_current_time_microsec();
+    toku_cachetable_begin_checkpoint(cp, NULL);
+    *paced = toku_cachetable_pace_checkpoint(cp, usec, hurry);
+    toku_cachetable_end_checkpoint(cp, NULL, NULL, NULL);
+    return toku_current_time_microsec() - t0;
+}
+
+static void
+cachetable_test (void) {
+    const int test_limit = 1000;
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+    create_dummy_functions(f1);
+
+    // only scheduled checkpoints of a paced cachetable are paced
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    assert(!toku_get_checkpoint_paced(ct));
+    toku_set_checkpoint_period(ct, 60);
+    assert(toku_cachetable_get_paced_checkpoint_period(cp) == 0);
+    toku_set_checkpoint_paced(ct, true);
+    assert(toku_get_checkpoint_paced(ct));
+    assert(toku_cachetable_get_paced_checkpoint_period(cp) == 60);
+    toku_set_checkpoint_period(ct, 0);
+
+    // the last dirty pair is due one second after the write-out began
+    dirty_pairs(f1);
+    bool paced;
+    uint64_t elapsed = paced_checkpoint(ct, 1000000, nullptr, &paced);
+    assert(paced);
+    assert(elapsed >= 900000);
+    uint64_t rate, sleep_usec;
+    toku_cachetable_get_checkpoint_pace(ct, &rate, &sleep_usec);
+    assert(rate == n_pairs * 8);
+    assert(sleep_usec > 0);
+
+    // hurrying writes everything out right away
+    dirty_pairs(f1);
+    elapsed = paced_checkpoint(ct, 60 * 1000000, hurry_up, &paced);
+    assert(paced);
+    assert(elapsed < 30 * 1000000);
+    uint64_t sleep_usec_after;
+    toku_cachetable_get_checkpoint_pace(ct, &rate, &sleep_usec_after);
+    assert(sleep_usec_after == sleep_usec);
+
+    // every pair is clean now, so there is nothing to spread out
+    elapsed = paced_checkpoint(ct, 60 * 1000000, nullptr, &paced);
+    assert(!paced);
+    assert(elapsed < 30 * 1000000);
+    toku_cachetable_get_checkpoint_pace(ct, &rate, &sleep_usec_after);
+    assert(sleep_usec_after == sleep_usec);
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    cachetable_test();
+    return 0;
+}
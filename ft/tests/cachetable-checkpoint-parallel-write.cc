@@ -0,0 +1,161 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+#include "test.h"
+#include "cachetable-test.h"
+#include "cachetable/checkpoint.h"
+
+//
+// Verify that end_checkpoint hands cloned PAIRs to the checkpoint pool,
+// never has more of them in flight than the write depth, and that the
+// write-out progress shows up in the checkpoint status.
+//
+
+static const int n_pairs = 16;
+static const uint32_t write_depth = 4;
+
+static int flushes_running;
+static int max_flushes_running;
+static int clone_flushes;
+
+static void
+clone_callback(void* UU(value_data), void** cloned_value_data, long* clone_size, PAIR_ATTR* new_attr, bool UU(for_checkpoint), void* UU(write_extraargs))
+{
+    *cloned_value_data = (void *)1;
+    *clone_size = 8;
+    new_attr->is_valid = false;
+}
+
+static void
+flush (
+    CACHEFILE f __attribute__((__unused__)),
+    int UU(fd),
+    CACHEKEY k  __attribute__((__unused__)),
+    void *v     __attribute__((__unused__)),
+    void** UU(dd),
+    void *e     __attribute__((__unused__)),
+    PAIR_ATTR s      __attribute__((__unused__)),
+    PAIR_ATTR* new_size      __attribute__((__unused__)),
+    bool w      __attribute__((__unused__)),
+    bool keep   __attribute__((__unused__)),
+    bool c      __attribute__((__unused__)),
+    bool is_clone
+    )
+{
+    if (is_clone) {
+        int running = toku_sync_add_and_fetch(&flushes_running, 1);
+        int old_max;
+        while (running > (old_max = max_flushes_running) &&
+               !toku_sync_bool_compare_and_swap(&max_flushes_running, old_max, running)) {
+        }
+        usleep(50*1000);
+        toku_sync_fetch_and_sub(&flushes_running, 1);
+        toku_sync_fetch_and_add(&clone_flushes, 1);
+    }
+}
+
+static void
+get_write_progress(CACHETABLE ct, uint64_t *pending, uint64_t *processed, uint64_t *writing) {
+    CHECKPOINT_STATUS_S cp_stat;
+    toku_checkpoint_get_status(ct, &cp_stat);
+    *pending = cp_stat.status[CHECKPOINT_STATUS_S::CP_WRITE_OUT_PENDING].value.num;
+    *processed = cp_stat.status[CHECKPOINT_STATUS_S::CP_WRITE_OUT_PROCESSED].value.num;
+    *writing = cp_stat.status[CHECKPOINT_STATUS_S::CP_WRITE_OUT_WRITING].value.num;
+}
+
+static void
+checkpoint_dirty_pairs(CACHETABLE ct, CACHEFILE f1) {
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    wc.flush_callback = flush;
+    wc.clone_callback = clone_callback;
+    for (int i = 0; i < n_pairs; i++) {
+        void* v;
+        int r = toku_cachetable_get_and_pin(f1, make_blocknum(i), i, &v, wc, def_fetch, def_pf_req_callback, def_pf_callback, true, NULL);
+        assert_zero(r);
+        r = toku_test_cachetable_unpin(f1, make_blocknum(i), i, CACHETABLE_DIRTY, make_pair_attr(8));
+        assert_zero(r);
+    }
+    max_flushes_running = 0;
+    clone_flushes = 0;
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    toku_cachetable_begin_checkpoint(cp, NULL);
+    toku_cachetable_end_checkpoint(cp, NULL, NULL, NULL);
+    assert(clone_flushes == n_pairs);
+    assert(flushes_running == 0);
+
+    uint64_t pending, processed, writing;
+    get_write_progress(ct, &pending, &processed, &writing);
+    assert(pending == (uint64_t) n_pairs);
+    assert(processed == (uint64_t) n_pairs);
+    assert(writing == 0);
+}
+
+static void
+cachetable_test (void) {
+    const int test_limit = 1000;
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_create_ex(&ct, test_limit, 0, 0, write_depth, false, ZERO_LSN, nullptr);
+    assert(toku_get_checkpoint_write_depth(ct) == 2 * write_depth);
+    toku_set_checkpoint_write_depth(ct, write_depth);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+    create_dummy_functions(f1);
+
+    // the clones are written by several threads of the pool at once
+    checkpoint_dirty_pairs(ct, f1);
+    assert(max_flushes_running > 1);
+    assert(max_flushes_running <= (int) write_depth);
+
+    // a depth of 0 writes every pair on the checkpoint thread
+    toku_set_checkpoint_write_depth(ct, 0);
+    checkpoint_dirty_pairs(ct, f1);
+    assert(max_flushes_running == 1);
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    cachetable_test();
+    return 0;
+}
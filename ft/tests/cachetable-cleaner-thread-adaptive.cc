@@ -0,0 +1,139 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+#include "test.h"
+
+//
+// This test verifies that an adaptive cleaner cleans nodes on several
+// threads when a lot of the cachetable is buffered messages, and that it
+// does nothing when no messages are buffered.
+//
+
+static const int n_pairs = 16;
+static CACHEFILE f1;
+static int cleanings;
+static int cleaners_running;
+static int max_cleaners_running;
+
+static int
+adaptive_cleaner_callback(
+    void* UU(ftnode_pv),
+    BLOCKNUM blocknum,
+    uint32_t fullhash,
+    void* UU(extraargs)
+    )
+{
+    int running = toku_sync_add_and_fetch(&cleaners_running, 1);
+    int old_max;
+    while (running > (old_max = max_cleaners_running) &&
+           !toku_sync_bool_compare_and_swap(&max_cleaners_running, old_max, running)) {
+    }
+    usleep(100000);
+    toku_sync_fetch_and_sub(&cleaners_running, 1);
+    toku_sync_fetch_and_add(&cleanings, 1);
+    PAIR_ATTR attr = make_pair_attr(8);
+    attr.cache_pressure_size = 0;
+    return toku_test_cachetable_unpin(f1, blocknum, fullhash, CACHETABLE_CLEAN, attr);
+}
+
+static void
+run_test (void) {
+    const int test_limit = 1000;
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    assert(!toku_get_cleaner_adaptive(ct));
+    toku_set_cleaner_adaptive(ct, true);
+    toku_set_cleaner_max_threads(ct, 4);
+    assert(toku_get_cleaner_adaptive(ct));
+    assert(toku_get_cleaner_max_threads(ct) == 4);
+
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    // nothing is buffered, so the cleaner stays idle
+    r = toku_cleaner_thread_for_test(ct);
+    assert_zero(r);
+    assert(cachetable_status_value(ct, CACHETABLE_STATUS_S::CT_CLEANER_ADAPTIVE_IDLE) == 1);
+    assert(cleanings == 0);
+
+    // far more than 5% of the cachetable is buffered, so the cleaner runs
+    // on every thread it may use, each doing 4 times the cleaner iterations
+    for (int i = 0; i < n_pairs; ++i) {
+        void* v;
+        CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+        wc.cleaner_callback = adaptive_cleaner_callback;
+        r = toku_cachetable_get_and_pin(f1, make_blocknum(i+1), i+1, &v,
+                                        wc,
+                                        def_fetch,
+                                        def_pf_req_callback,
+                                        def_pf_callback,
+                                        true,
+                                        NULL);
+        assert_zero(r);
+        PAIR_ATTR attr = make_pair_attr(8);
+        attr.cache_pressure_size = 100;
+        r = toku_test_cachetable_unpin(f1, make_blocknum(i+1), i+1, CACHETABLE_CLEAN, attr);
+        assert_zero(r);
+    }
+    r = toku_cleaner_thread_for_test(ct);
+    assert_zero(r);
+    assert(cachetable_status_value(ct, CACHETABLE_STATUS_S::CT_CLEANER_ADAPTIVE_THREADS) == 4);
+    assert(cachetable_status_value(ct, CACHETABLE_STATUS_S::CT_CLEANER_ADAPTIVE_ITERATIONS) == 4);
+    assert(cleanings == n_pairs);
+    assert(max_cleaners_running > 1);
+    assert(max_cleaners_running <= 4);
+
+    // everything was cleaned, so the next run is idle again
+    r = toku_cleaner_thread_for_test(ct);
+    assert_zero(r);
+    assert(cachetable_status_value(ct, CACHETABLE_STATUS_S::CT_CLEANER_ADAPTIVE_IDLE) == 2);
+    assert(cachetable_status_value(ct, CACHETABLE_STATUS_S::CT_CLEANER_ADAPTIVE_THREADS) == 0);
+    assert(cleanings == n_pairs);
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+  default_parse_args(argc, argv);
+  run_test();
+  return 0;
+}
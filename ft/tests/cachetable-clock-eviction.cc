@@ -91,7 +91,10 @@ cachetable_test (void) {
     num_entries = 0;
     int r;
     CACHETABLE ct;
+    // the expected evictions follow the order of a single clock
+    toku_cachetable_set_evictor_shards(1);
     toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    toku_cachetable_set_evictor_shards(0);
     const char *fname1 = TOKU_TEST_FILENAME;
     unlink(fname1);
     CACHEFILE f1;
@@ -134,7 +134,10 @@ cachetable_test (void) {
     const int test_limit = 16;
     int r;
     CACHETABLE ct;
+    // the expected evictions follow the order of a single clock
+    toku_cachetable_set_evictor_shards(1);
     toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    toku_cachetable_set_evictor_shards(0);
     const char *fname1 = TOKU_TEST_FILENAME;
     unlink(fname1);
     CACHEFILE f1;
@@ -149,7 +149,10 @@ cachetable_test (void) {
     const int test_limit = 20;
     int r;
     CACHETABLE ct;
+    // the expected evictions follow the order of a single clock
+    toku_cachetable_set_evictor_shards(1);
     toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    toku_cachetable_set_evictor_shards(0);
     evictor_test_helpers::set_hysteresis_limits(&ct->ev, test_limit, 100*test_limit);
     evictor_test_helpers::disable_ev_thread(&ct->ev);
     const char *fname1 = TOKU_TEST_FILENAME;
@@ -145,13 +145,13 @@ void evictor_unit_test::verify_ev_counts() {
         .is_valid = true
     };
 
-    m_ev.add_pair_attr(attr);
+    m_ev.add_pair_attr(attr, 0);
     assert(m_ev.m_size_current == 1);
     assert(read_partitioned_counter(m_ev.m_size_nonleaf) == 2);
     assert(read_partitioned_counter(m_ev.m_size_leaf) == 3);
     assert(read_partitioned_counter(m_ev.m_size_rollback) == 4);
     assert(read_partitioned_counter(m_ev.m_size_cachepressure) == 5);
-    m_ev.remove_pair_attr(attr);
+    m_ev.remove_pair_attr(attr, 0);
     assert(m_ev.m_size_current == 0);
     assert(read_partitioned_counter(m_ev.m_size_leaf) == 0);
     assert(read_partitioned_counter(m_ev.m_size_nonleaf) == 0);
@@ -166,7 +166,7 @@ void evictor_unit_test::verify_ev_counts() {
         .cache_pressure_size = 6,
         .is_valid = true
     };
-    m_ev.change_pair_attr(attr, other_attr);
+    m_ev.change_pair_attr(attr, other_attr, 0);
     assert(m_ev.m_size_current == 1);
     assert(read_partitioned_counter(m_ev.m_size_leaf) == 1);
     assert(read_partitioned_counter(m_ev.m_size_nonleaf) == 1);
@@ -0,0 +1,108 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+//
+// Verify that with a sharded evictor, every shard runs its own clock and
+// evicts PAIRs, and that the clocks stay consistent with the hash table.
+//
+
+static const uint32_t num_shards = 4;
+
+static uint64_t shard_evictions(CACHETABLE ct, uint32_t shard) {
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(ct_test_status.status[CACHETABLE_STATUS_S::CT_EVICTOR_SHARDS].value.num == num_shards);
+    return ct_test_status.status[CACHETABLE_STATUS_S::CT_EVICTOR_SHARD_0_EVICTIONS + shard].value.num;
+}
+
+static void
+run_test (void) {
+    const int test_limit = 16*8;
+    const int n_pairs = 400;
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_set_evictor_shards(num_shards);
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    toku_cachetable_set_evictor_shards(0);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    for (int i = 0; i < n_pairs; i++) {
+        void* v;
+        CACHEKEY key = make_blocknum(i);
+        uint32_t fullhash = toku_cachetable_hash(f1, key);
+        r = toku_cachetable_get_and_pin(f1, key, fullhash, &v, wc, def_fetch, def_pf_req_callback, def_pf_callback, false, NULL);
+        assert_zero(r);
+        r = toku_test_cachetable_unpin(f1, key, fullhash, CACHETABLE_CLEAN, make_pair_attr(8));
+        assert_zero(r);
+    }
+
+    // give the shard threads some time to catch up
+    bool all_evicted = false;
+    for (int t = 0; t < 20 && !all_evicted; t++) {
+        all_evicted = true;
+        for (uint32_t i = 0; i < num_shards; i++) {
+            if (shard_evictions(ct, i) == 0) {
+                all_evicted = false;
+            }
+        }
+        if (!all_evicted) {
+            usleep(500*1000);
+        }
+    }
+    assert(all_evicted);
+    for (uint32_t i = num_shards; i < 8; i++) {
+        assert(shard_evictions(ct, i) == 0);
+    }
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+  default_parse_args(argc, argv);
+  run_test();
+  return 0;
+}
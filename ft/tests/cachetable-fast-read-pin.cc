@@ -0,0 +1,156 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+//
+// Verify that read pins of a resident PAIR take the lock-free path, and
+// that write pins, partial fetches and a disabled fast path do not.
+//
+
+CACHETABLE ct;
+
+static uint64_t fast_pins(void) {
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    return ct_test_status.status[CACHETABLE_STATUS_S::CT_PIN_FAST_PATH].value.num;
+}
+
+static uint64_t slow_pins(void) {
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    return ct_test_status.status[CACHETABLE_STATUS_S::CT_PIN_SLOW_PATH].value.num;
+}
+
+static bool pf_req_calls;
+static bool true_pf_req_callback(void* UU(ftnode_pv), void* UU(read_extraargs)) {
+    if (pf_req_calls) {
+        return false;
+    }
+    pf_req_calls = true;
+    return true;
+}
+
+static void
+read_pin(CACHEFILE f1, CACHETABLE_PARTIAL_FETCH_REQUIRED_CALLBACK pf_req_callback) {
+    void* v1;
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    int r = toku_cachetable_get_and_pin(f1, make_blocknum(1), 1, &v1, wc, def_fetch, pf_req_callback, def_pf_callback, false, NULL);
+    assert_zero(r);
+}
+
+static void
+unpin(CACHEFILE f1) {
+    int r = toku_test_cachetable_unpin(f1, make_blocknum(1), 1, CACHETABLE_CLEAN, make_pair_attr(8));
+    assert_zero(r);
+}
+
+static void
+run_test (void) {
+    const int test_limit = 12;
+    int r;
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+    assert(toku_get_enable_optimistic_pair_lookup(ct));
+
+    // the first pin fetches the PAIR
+    uint64_t fast = fast_pins();
+    uint64_t slow = slow_pins();
+    read_pin(f1, def_pf_req_callback);
+    assert(fast_pins() == fast);
+    assert(slow_pins() == slow + 1);
+
+    // the PAIR is resident and read locked, further read pins are fast
+    read_pin(f1, def_pf_req_callback);
+    read_pin(f1, def_pf_req_callback);
+    assert(fast_pins() == fast + 2);
+    assert(slow_pins() == slow + 1);
+    unpin(f1);
+    unpin(f1);
+    unpin(f1);
+
+    // still fast once all pins are released
+    read_pin(f1, def_pf_req_callback);
+    assert(fast_pins() == fast + 3);
+    unpin(f1);
+
+    // a partial fetch requires the slow path
+    pf_req_calls = false;
+    read_pin(f1, true_pf_req_callback);
+    assert(pf_req_calls);
+    assert(fast_pins() == fast + 3);
+    assert(slow_pins() == slow + 2);
+    unpin(f1);
+
+    // a write lock closes the fast path until the next slow read pin
+    void* v1;
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    r = toku_cachetable_get_and_pin(f1, make_blocknum(1), 1, &v1, wc, def_fetch, def_pf_req_callback, def_pf_callback, true, NULL);
+    assert_zero(r);
+    unpin(f1);
+    assert(slow_pins() == slow + 3);
+    read_pin(f1, def_pf_req_callback);
+    unpin(f1);
+    assert(fast_pins() == fast + 3);
+    assert(slow_pins() == slow + 4);
+    read_pin(f1, def_pf_req_callback);
+    unpin(f1);
+    assert(fast_pins() == fast + 4);
+
+    // nothing is fast when the fast path is disabled
+    toku_set_enable_optimistic_pair_lookup(ct, false);
+    read_pin(f1, def_pf_req_callback);
+    unpin(f1);
+    assert(fast_pins() == fast + 4);
+    assert(slow_pins() == slow + 5);
+    toku_set_enable_optimistic_pair_lookup(ct, true);
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+  default_parse_args(argc, argv);
+  run_test();
+  return 0;
+}
@@ -0,0 +1,144 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+//
+// Verify that a cachetable in NUMA mode keeps a clock shard per node,
+// assigns PAIRs to the node of the thread that creates them, and counts
+// the size, pins and misses of each node.
+//
+
+static uint64_t status_value(CACHETABLE ct, int row) {
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    return ct_test_status.status[row].value.num;
+}
+
+static uint64_t node_value(CACHETABLE ct, uint32_t node, int row) {
+    return status_value(ct, CACHETABLE_STATUS_S::CT_NUMA_NODE_0_SIZE + 4 * node + row);
+}
+
+static void
+run_test (void) {
+    const int test_limit = 256;
+    const int n_pairs = 100;
+    int r;
+
+    // keep this thread, and so every PAIR it creates, on node 0
+    r = toku_os_numa_bind_thread(0);
+    assert(r == 0 || r == ENOSYS);
+
+    CACHETABLE ct;
+    r = toku_cachetable_create_ex(&ct, test_limit, 0, 0, 0, true, ZERO_LSN, nullptr);
+    assert_zero(r);
+    uint32_t num_nodes = toku_os_numa_num_nodes();
+    assert(num_nodes >= 1);
+    assert(status_value(ct, CACHETABLE_STATUS_S::CT_NUMA_NODES) == num_nodes);
+    uint32_t num_shards = status_value(ct, CACHETABLE_STATUS_S::CT_EVICTOR_SHARDS);
+    assert(num_shards >= num_nodes || num_shards == 8);
+
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    // the PAIRs fit, so each one is missed once and pinned twice
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < n_pairs; i++) {
+            void* v;
+            CACHEKEY key = make_blocknum(i);
+            uint32_t fullhash = toku_cachetable_hash(f1, key);
+            r = toku_cachetable_get_and_pin(f1, key, fullhash, &v, wc, def_fetch, def_pf_req_callback, def_pf_callback, false, NULL);
+            assert_zero(r);
+            r = toku_test_cachetable_unpin(f1, key, fullhash, CACHETABLE_CLEAN, make_pair_attr(1));
+            assert_zero(r);
+        }
+    }
+    uint64_t pins = 0, remote_pins = 0, misses = 0;
+    for (uint32_t i = 0; i < 8; i++) {
+        if (i >= num_shards) {
+            assert(node_value(ct, i, 0) == 0);
+            assert(node_value(ct, i, 1) == 0);
+        }
+        pins += node_value(ct, i, 1);
+        remote_pins += node_value(ct, i, 2);
+        misses += node_value(ct, i, 3);
+    }
+    assert(pins == 2 * n_pairs);
+    assert(misses == n_pairs);
+    assert(node_value(ct, 0, 1) == 2 * n_pairs);
+    assert(node_value(ct, 0, 0) == n_pairs);
+    assert(remote_pins == 0);
+
+    // growing the PAIRs past the limit makes the node evict
+    for (int i = 0; i < n_pairs; i++) {
+        void* v;
+        CACHEKEY key = make_blocknum(i);
+        uint32_t fullhash = toku_cachetable_hash(f1, key);
+        r = toku_cachetable_get_and_pin(f1, key, fullhash, &v, wc, def_fetch, def_pf_req_callback, def_pf_callback, false, NULL);
+        assert_zero(r);
+        r = toku_test_cachetable_unpin(f1, key, fullhash, CACHETABLE_CLEAN, make_pair_attr(8));
+        assert_zero(r);
+    }
+    long size_current = 0, size_limit = 0;
+    for (int t = 0; t < 20; t++) {
+        ct->ev.get_state(&size_current, &size_limit);
+        if (size_current <= size_limit) {
+            break;
+        }
+        ct->ev.signal_eviction_thread();
+        usleep(100*1000);
+    }
+    assert(size_current <= size_limit);
+    assert(status_value(ct, CACHETABLE_STATUS_S::CT_EVICTOR_SHARD_0_EVICTIONS) > 0);
+    assert(node_value(ct, 0, 0) > 0);
+    assert(node_value(ct, 0, 0) <= (uint64_t) size_current);
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+  default_parse_args(argc, argv);
+  run_test();
+  return 0;
+}
@@ -0,0 +1,168 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// verify that a batch prefetch fetches the pairs that are not in the
+// cachetable in key order after one call to the read callback, partially
+// fetches the ones that are, and calls the done callback once at the end.
+
+#include "test.h"
+
+static int read_calls = 0;
+static int fetch_calls = 0;
+static int pf_calls = 0;
+static int done_calls = 0;
+static int64_t last_fetched = -1;
+
+static int
+fetch (CACHEFILE f        __attribute__((__unused__)),
+       PAIR UU(p),
+       int UU(fd),
+       CACHEKEY k,
+       uint32_t fullhash __attribute__((__unused__)),
+       void **value,
+       void** UU(dd),
+       PAIR_ATTR *sizep,
+       int  *dirtyp,
+       void *extraargs
+       ) {
+    // the read callback came first, and the pairs come in key order
+    assert(read_calls == 1);
+    assert(k.b > last_fetched);
+    assert(*(int64_t *) extraargs == k.b);
+    last_fetched = k.b;
+    fetch_calls++;
+
+    *value = 0;
+    *sizep = make_pair_attr(1);
+    *dirtyp = 0;
+    return 0;
+}
+
+static bool
+pf_req_callback(void* UU(ftnode_pv), void* read_extraargs) {
+    return *(int64_t *) read_extraargs == 7;
+}
+
+static int
+pf_callback(void* UU(ftnode_pv), void* UU(dd), void* read_extraargs, int UU(fd), PAIR_ATTR* sizep) {
+    assert(*(int64_t *) read_extraargs == 7);
+    pf_calls++;
+    *sizep = make_pair_attr(1);
+    return 0;
+}
+
+static void
+read_callback(int UU(fd), int n, CACHEKEY *keys, void **read_extraargs, void *batch_extra) {
+    assert(*(int *) batch_extra == 42);
+    assert(n == 3);
+    assert(keys[0].b == 3 && keys[1].b == 5 && keys[2].b == 9);
+    for (int i = 0; i < n; i++) {
+        assert(*(int64_t *) read_extraargs[i] == keys[i].b);
+    }
+    read_calls++;
+}
+
+static void
+done_callback(void *batch_extra) {
+    assert(*(int *) batch_extra == 42);
+    assert(fetch_calls == 3);
+    assert(pf_calls == 1);
+    toku_sync_fetch_and_add(&done_calls, 1);
+}
+
+static void cachetable_prefetch_batch_test (void) {
+    const int test_limit = 100;
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+
+    // put 7 in the cachetable
+    void *v;
+    r = toku_cachetable_get_and_pin(f1, make_blocknum(7), toku_cachetable_hash(f1, make_blocknum(7)), &v, wc, def_fetch, def_pf_req_callback, def_pf_callback, true, NULL);
+    assert(r == 0);
+    r = toku_test_cachetable_unpin(f1, make_blocknum(7), toku_cachetable_hash(f1, make_blocknum(7)), CACHETABLE_CLEAN, make_pair_attr(1));
+    assert(r == 0);
+
+    // 3 comes twice, and only the first one is prefetched
+    const int n = 5;
+    int64_t ks[n] = { 5, 3, 7, 9, 3 };
+    CACHEKEY keys[n];
+    uint32_t fullhashes[n];
+    void *extraargs[n];
+    bool doing_prefetch[n];
+    for (int i = 0; i < n; i++) {
+        keys[i] = make_blocknum(ks[i]);
+        fullhashes[i] = toku_cachetable_hash(f1, keys[i]);
+        extraargs[i] = &ks[i];
+    }
+    int batch_extra = 42;
+    r = toku_cachefile_prefetch_batch(f1, n, keys, fullhashes, wc, fetch, pf_req_callback, pf_callback,
+                                      read_callback, done_callback, extraargs, &batch_extra, doing_prefetch);
+    assert(r == 0);
+    assert(doing_prefetch[0] && doing_prefetch[2] && doing_prefetch[3]);
+    assert(doing_prefetch[1] != doing_prefetch[4]);
+
+    // closing the cachefile waits for the prefetch
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    assert(done_calls == 1);
+    assert(read_calls == 1);
+    assert(fetch_calls == 3);
+    assert(pf_calls == 1);
+
+    // a batch that starts nothing is done right away
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+    r = toku_cachefile_prefetch_batch(f1, 0, keys, fullhashes, wc, fetch, pf_req_callback, pf_callback,
+                                      read_callback, done_callback, extraargs, &batch_extra, doing_prefetch);
+    assert(r == 0);
+    assert(done_calls == 2);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    cachetable_prefetch_batch_test();
+    return 0;
+}
@@ -0,0 +1,160 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+//
+// Verify that with the 2Q replacement policy, pins of a new PAIR do not
+// keep it in the cachetable, that a PAIR read back in after its eviction
+// becomes hot, and that a scan does not evict hot PAIRs that are still
+// being used.
+//
+
+static const int n_keys = 400;
+static int fetches[n_keys];
+
+static int
+fetch (CACHEFILE f        __attribute__((__unused__)),
+       PAIR UU(p),
+       int UU(fd),
+       CACHEKEY k,
+       uint32_t fullhash __attribute__((__unused__)),
+       void **value,
+       void** UU(dd),
+       PAIR_ATTR *sizep,
+       int  *dirtyp,
+       void *extraargs    __attribute__((__unused__))
+       ) {
+    fetches[k.b]++;
+    *dirtyp = 0;
+    *value = NULL;
+    *sizep = make_pair_attr(1);
+    return 0;
+}
+
+static void pin_and_unpin(CACHEFILE f, int64_t k) {
+    void *v;
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    int r = toku_cachetable_get_and_pin(f, make_blocknum(k), k, &v, wc, fetch, def_pf_req_callback, def_pf_callback, true, NULL);
+    assert_zero(r);
+    r = toku_test_cachetable_unpin(f, make_blocknum(k), k, CACHETABLE_CLEAN, make_pair_attr(1));
+    assert_zero(r);
+}
+
+static void wait_for_eviction(CACHETABLE ct) {
+    long size_current, size_limit;
+    for (int i = 0; i < 1000; i++) {
+        ct->ev.get_state(&size_current, &size_limit);
+        if (size_current <= size_limit) {
+            break;
+        }
+        ct->ev.signal_eviction_thread();
+        usleep(10000);
+    }
+}
+
+static uint64_t ghost_hits(CACHETABLE ct) {
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    return ct_test_status.status[CACHETABLE_STATUS_S::CT_EVICTOR_GHOST_HITS].value.num;
+}
+
+static void
+cachetable_test (void) {
+    const int test_limit = 8;
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_set_evictor_shards(1);
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    toku_cachetable_set_evictor_shards(0);
+    assert(toku_get_replacement_policy(ct) == TOKU_CACHETABLE_POLICY_CLOCK);
+    toku_set_replacement_policy(ct, TOKU_CACHETABLE_POLICY_2Q);
+    assert(toku_get_replacement_policy(ct) == TOKU_CACHETABLE_POLICY_2Q);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    // pinning new PAIRs over and over does not make them hot,
+    // so a scan evicts them
+    for (int i = 0; i < 100; i++) {
+        pin_and_unpin(f1, 1);
+        pin_and_unpin(f1, 2);
+    }
+    for (int k = 100; k < 200; k++) {
+        pin_and_unpin(f1, k);
+    }
+    wait_for_eviction(ct);
+    assert(ghost_hits(ct) == 0);
+
+    // reading them back in while the ghost list remembers them makes them hot
+    for (int i = 0; i < 20; i++) {
+        pin_and_unpin(f1, 1);
+        pin_and_unpin(f1, 2);
+    }
+    assert(fetches[1] == 2);
+    assert(fetches[2] == 2);
+    assert(ghost_hits(ct) == 2);
+
+    // a scan that is more than ten times the size of the cachetable
+    // does not evict hot PAIRs that are still in use
+    for (int k = 200; k < n_keys; k++) {
+        pin_and_unpin(f1, k);
+        if (k % 8 == 0) {
+            pin_and_unpin(f1, 1);
+            pin_and_unpin(f1, 2);
+        }
+    }
+    wait_for_eviction(ct);
+    assert(fetches[1] == 2);
+    assert(fetches[2] == 2);
+    for (int k = 100; k < n_keys; k++) {
+        assert(fetches[k] == 1);
+    }
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    cachetable_test();
+    return 0;
+}
@@ -0,0 +1,264 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that a range delete removes exactly the rows in its inclusive
+// range, both when it reaches the leaves through the message buffers and
+// after the tree is closed and reopened, that rows inserted after it
+// survive, and that it commits and aborts with the transaction that sent it.
+
+#include "cachetable/checkpoint.h"
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 10000;
+
+static void fill_key(char *key, size_t keysize, int i) {
+    snprintf(key, keysize, "%08d", i);
+}
+
+static void insert_row(FT_HANDLE t, int i, const char *val, TOKUTXN txn) {
+    char key[16];
+    fill_key(key, sizeof key, i);
+    DBT k, v;
+    toku_ft_insert(t, toku_fill_dbt(&k, key, 1 + strlen(key)), toku_fill_dbt(&v, val, 1 + strlen(val)), txn);
+}
+
+// Deletes the rows from lo through hi, both included.  A suffix makes a
+// bound fall strictly between two rows.
+static void delete_rows(FT_HANDLE t, int lo, const char *lo_suffix, int hi, const char *hi_suffix, TOKUTXN txn) {
+    char min_key[16], max_key[16];
+    snprintf(min_key, sizeof min_key, "%08d%s", lo, lo_suffix);
+    snprintf(max_key, sizeof max_key, "%08d%s", hi, hi_suffix);
+    DBT min_dbt, max_dbt;
+    toku_ft_delete_range(t,
+                         toku_fill_dbt(&min_dbt, min_key, 1 + strlen(min_key)),
+                         toku_fill_dbt(&max_dbt, max_key, 1 + strlen(max_key)),
+                         txn);
+}
+
+static int scanned;
+
+static int
+count_row(uint32_t UU(keylen), const void *key, uint32_t UU(vallen), const void *UU(val), void *UU(extra), bool lock_only) {
+    if (lock_only || key == nullptr) {
+        return 0;
+    }
+    scanned++;
+    return 0;
+}
+
+static int scan_rows(FT_HANDLE t) {
+    FT_CURSOR cursor;
+    int r = toku_ft_cursor(t, &cursor, null_txn, false, false);
+    assert(r == 0);
+    scanned = 0;
+    for (r = toku_ft_cursor_first(cursor, count_row, nullptr); r == 0;
+         r = toku_ft_cursor_next(cursor, count_row, nullptr)) {
+    }
+    assert(r == DB_NOTFOUND);
+    toku_ft_cursor_close(cursor);
+    return scanned;
+}
+
+static bool row_is_deleted(int i) {
+    return (i >= 1001 && i <= 1500) ||  // bounds between rows
+        (i >= 3000 && i <= 6999) ||     // bounds on rows
+        (i >= 9000 && i <= 9005);       // a few rows of one leaf
+}
+
+static bool row_is_reinserted(int i) {
+    return i == 4000 || i == 6999;
+}
+
+static void check_rows(FT_HANDLE t) {
+    int expected = 0;
+    for (int i = 0; i < n_rows; i++) {
+        char key[16];
+        fill_key(key, sizeof key, i);
+        if (row_is_reinserted(i)) {
+            ft_lookup_and_check_nodup(t, key, "again");
+            expected++;
+        } else if (row_is_deleted(i)) {
+            ft_lookup_and_fail_nodup(t, key);
+        } else {
+            ft_lookup_and_check_nodup(t, key, "val");
+            expected++;
+        }
+    }
+    assert(scan_rows(t) == expected);
+
+    // every leaf has had its messages applied, so the logical row count
+    // is exact
+    struct ftstat64_s s;
+    toku_ft_handle_stat64(t, null_txn, &s);
+    if (verbose) {
+        printf("%" PRIu64 " logical rows, %d expected\n", s.nkeys, expected);
+    }
+    assert(s.nkeys == (uint64_t) expected);
+}
+
+static void test_delete_range(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    toku_os_recursive_delete(fname);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 1, &t, 32 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+
+    // enough rows for the root to split, so the range deletes are buffered
+    for (int i = 0; i < n_rows; i++) {
+        insert_row(t, i, "val", null_txn);
+    }
+    delete_rows(t, 1000, "a", 1500, "a", null_txn);
+    delete_rows(t, 3000, "", 6999, "", null_txn);
+    delete_rows(t, 9000, "", 9005, "", null_txn);
+    insert_row(t, 4000, "again", null_txn);
+    insert_row(t, 6999, "again", null_txn);
+    r = toku_verify_ft(t);
+    assert(r == 0);
+
+    // read the buffered messages back from disk
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 0, &t, 32 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    r = toku_verify_ft(t);
+    assert(r == 0);
+
+    check_rows(t);
+
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+static void test_delete_range_txn(const char *logdir) {
+    int r;
+
+    TOKULOGGER logger = NULL;
+    r = toku_logger_create(&logger);
+    assert(r == 0);
+    r = toku_logger_open(logdir, logger);
+    assert(r == 0);
+    CACHETABLE ct = NULL;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, logger);
+    toku_logger_set_cachetable(logger, ct);
+    r = toku_logger_open_rollback(logger, ct, true);
+    assert(r == 0);
+
+    TOKUTXN txn = NULL;
+    r = toku_txn_begin_txn(NULL, NULL, &txn, logger, TXN_SNAPSHOT_NONE, false);
+    assert(r == 0);
+    FT_HANDLE t = NULL;
+    r = toku_open_ft_handle("ftfile", 1, &t, 4 * 1024, 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    for (int i = 0; i < 1000; i++) {
+        insert_row(t, i, "val", txn);
+    }
+    r = toku_txn_commit_txn(txn, true, NULL, NULL);
+    assert(r == 0);
+    toku_txn_close_txn(txn);
+
+    // an aborted range delete leaves every row in place
+    r = toku_txn_begin_txn(NULL, NULL, &txn, logger, TXN_SNAPSHOT_NONE, false);
+    assert(r == 0);
+    delete_rows(t, 200, "", 599, "", txn);
+    r = toku_txn_abort_txn(txn, NULL, NULL);
+    assert(r == 0);
+    toku_txn_close_txn(txn);
+    assert(scan_rows(t) == 1000);
+
+    // a committed one removes its range
+    r = toku_txn_begin_txn(NULL, NULL, &txn, logger, TXN_SNAPSHOT_NONE, false);
+    assert(r == 0);
+    delete_rows(t, 200, "", 599, "", txn);
+    r = toku_txn_commit_txn(txn, true, NULL, NULL);
+    assert(r == 0);
+    toku_txn_close_txn(txn);
+    for (int i = 0; i < 1000; i++) {
+        char key[16];
+        fill_key(key, sizeof key, i);
+        if (i >= 200 && i <= 599) {
+            ft_lookup_and_fail_nodup(t, key);
+        } else {
+            ft_lookup_and_check_nodup(t, key, "val");
+        }
+    }
+    assert(scan_rows(t) == 600);
+    r = toku_verify_ft(t);
+    assert(r == 0);
+
+    r = toku_close_ft_handle_nolsn(t, NULL);
+    assert(r == 0);
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    r = toku_checkpoint(cp, logger, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
+    assert(r == 0);
+    toku_logger_close_rollback(logger);
+    r = toku_checkpoint(cp, logger, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
+    assert(r == 0);
+    toku_logger_shutdown(logger);
+    r = toku_logger_close(&logger);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_delete_range();
+
+    char logdir[TOKU_PATH_MAX+1];
+    toku_path_join(logdir, 2, TOKU_TEST_FILENAME, "logdir");
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+    int r = toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU);
+    assert_zero(r);
+    r = toku_os_mkdir(logdir, S_IRWXU);
+    assert_zero(r);
+    r = chdir(logdir);
+    assert_zero(r);
+    test_delete_range_txn(".");
+    return 0;
+}
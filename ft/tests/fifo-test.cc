@@ -121,6 +121,58 @@ test_enqueue(int n) {
     msg_buffer.destroy();
 }
 
+// Messages must stay where they were enqueued, also across chunks and
+// for messages bigger than a chunk, and clones must keep their offsets.
+static void
+test_stable_offsets(int n) {
+    message_buffer msg_buffer;
+    msg_buffer.create();
+
+    int32_t *XMALLOC_N(n, offsets);
+    const void **XMALLOC_N(n, keys);
+    for (int i = 0; i < n; i++) {
+        // every 64th message is bigger than a chunk
+        int thekeylen = 8;
+        int thevallen = (i % 64 == 63) ? (2 << 20) + i : (i % 1000) + 1;
+        char *thekey = buildkey(thekeylen);
+        memcpy(thekey, &i, sizeof i);
+        char *theval = buildval(thevallen);
+        DBT k, v;
+        ft_msg msg(toku_fill_dbt(&k, thekey, thekeylen), toku_fill_dbt(&v, theval, thevallen),
+                   FT_INSERT, next_dummymsn(), toku_xids_get_root_xids());
+        msg_buffer.enqueue(msg, i % 2 == 0, &offsets[i]);
+        DBT key;
+        msg_buffer.get_message_key_msn(offsets[i], &key, nullptr);
+        keys[i] = key.data;
+        toku_free(thekey);
+        toku_free(theval);
+    }
+    assert(msg_buffer.num_entries() == n);
+
+    message_buffer clone;
+    clone.clone(&msg_buffer);
+    assert(clone.equals(&msg_buffer));
+    assert(msg_buffer.equals(&clone));
+    for (int i = 0; i < n; i++) {
+        int thevallen = (i % 64 == 63) ? (2 << 20) + i : (i % 1000) + 1;
+        DBT key, val, clone_key, clone_val;
+        ft_msg msg = msg_buffer.get_message(offsets[i], &key, &val);
+        assert(key.data == keys[i]);
+        assert(memcmp(key.data, &i, sizeof i) == 0);
+        assert((int) val.size == thevallen);
+        assert(msg_buffer.get_freshness(offsets[i]) == (i % 2 == 0));
+        ft_msg clone_msg = clone.get_message(offsets[i], &clone_key, &clone_val);
+        assert(clone_key.size == key.size && memcmp(clone_key.data, key.data, key.size) == 0);
+        assert(clone_val.size == val.size && memcmp(clone_val.data, val.data, val.size) == 0);
+        assert(clone_msg.msn().msn == msg.msn().msn);
+    }
+    clone.destroy();
+
+    toku_free(offsets);
+    toku_free(keys);
+    msg_buffer.destroy();
+}
+
 int
 test_main(int argc, const char *argv[]) {
     default_parse_args(argc, argv);
@@ -128,6 +180,7 @@ test_main(int argc, const char *argv[]) {
     test_create();
     test_enqueue(4);
     test_enqueue(512);
+    test_stable_offsets(4096);
     
     return 0;
 }
@@ -343,7 +343,7 @@ static void test_prefetching(void) {
     uint64_t key1 = 100;
     uint64_t key2 = 200;
 
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     DBT pivotkeys[2];
     toku_fill_dbt(&pivotkeys[0], &key1, sizeof(key1));
     toku_fill_dbt(&pivotkeys[1], &key2, sizeof(key2));
@@ -248,7 +248,7 @@ static void test_serialize_nonleaf(void) {
     sn.n_children = 2;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(2, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, 2);
     DBT pivotkey;
     sn.pivotkeys.create_from_dbts(toku_fill_dbt(&pivotkey, "hello", 6), 1);
     BP_BLOCKNUM(&sn, 0).b = 30;
@@ -386,7 +386,7 @@ static void test_serialize_leaf(void) {
     sn.n_children = 2;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     DBT pivotkey;
     sn.pivotkeys.create_from_dbts(toku_fill_dbt(&pivotkey, "b", 2), 1);
     BP_STATE(&sn, 0) = PT_AVAIL;
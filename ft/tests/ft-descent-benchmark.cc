@@ -0,0 +1,228 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+// Time point lookups that descend a warm, multi-level tree, and count the
+// cache misses they take.  The counts come from perf_event_open(2) when the
+// kernel lets us have them; otherwise run the benchmark under
+// "perf stat -e cache-misses,L1-dcache-load-misses" and divide by the
+// number of lookups it prints (the lookups dominate the run).
+//
+// usage: ft-descent-benchmark [-v] [n_rows] [n_lookups]
+
+#include "test.h"
+
+#include <sys/time.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "ft/ft-cachetable-wrappers.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const uint32_t nodesize = 64 * 1024;
+static const uint32_t basementnodesize = 4 * 1024;
+
+struct counter {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+    int fd;
+};
+
+static struct counter counters[] = {
+    { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1 },
+    { "L1-dcache-load-misses", PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), -1 },
+    { "dTLB-load-misses", PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), -1 },
+};
+static const int n_counters = sizeof counters / sizeof counters[0];
+
+static void open_counters(void) {
+    for (int i = 0; i < n_counters; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = counters[i].type;
+        attr.config = counters[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        counters[i].fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+}
+
+static void start_counters(void) {
+    for (int i = 0; i < n_counters; i++) {
+        if (counters[i].fd >= 0) {
+            ioctl(counters[i].fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters[i].fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static void stop_counters(void) {
+    for (int i = 0; i < n_counters; i++) {
+        if (counters[i].fd >= 0) {
+            ioctl(counters[i].fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+static void report_counters(uint64_t n_lookups) {
+    for (int i = 0; i < n_counters; i++) {
+        uint64_t count;
+        if (counters[i].fd >= 0 && read(counters[i].fd, &count, sizeof count) == sizeof count) {
+            printf("  %-22s %8.2f per lookup\n", counters[i].name, (double) count / n_lookups);
+        } else {
+            printf("  %-22s %8s (no access to perf events)\n", counters[i].name, "n/a");
+        }
+    }
+}
+
+static void close_counters(void) {
+    for (int i = 0; i < n_counters; i++) {
+        if (counters[i].fd >= 0) {
+            close(counters[i].fd);
+            counters[i].fd = -1;
+        }
+    }
+}
+
+static double elapsed(struct timeval *start, struct timeval *end) {
+    return (end->tv_sec - start->tv_sec) * 1e6 + (end->tv_usec - start->tv_usec);
+}
+
+static void fill_key(uint64_t *key, DBT *k, uint64_t i) {
+    // big-endian, so the rows go in key order
+    *key = __builtin_bswap64(i);
+    toku_fill_dbt(k, key, sizeof *key);
+}
+
+static int
+found_row(uint32_t UU(keylen), const void *key, uint32_t vallen, const void *UU(val), void *extra, bool lock_only) {
+    if (lock_only) {
+        return 0;
+    }
+    invariant_notnull(key);
+    invariant(vallen == sizeof(uint64_t));
+    (*static_cast<uint64_t *>(extra))++;
+    return 0;
+}
+
+// Look up n_lookups random rows, which must all be there.
+static void lookups(FT_HANDLE t, uint64_t n_rows, uint64_t n_lookups) {
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < n_lookups; i++) {
+        uint64_t key;
+        DBT k;
+        fill_key(&key, &k, random() % n_rows);
+        int r = toku_ft_lookup(t, &k, found_row, &found);
+        invariant_zero(r);
+    }
+    invariant(found == n_lookups);
+}
+
+static int
+height_of(FT_HANDLE t) {
+    FTNODE root;
+    ftnode_fetch_extra bfe;
+    bfe.create_for_min_read(t->ft);
+    CACHEKEY root_key;
+    uint32_t fullhash;
+    toku_calculate_root_offset_pointer(t->ft, &root_key, &fullhash);
+    toku_pin_ftnode(t->ft, root_key, fullhash, &bfe, PL_READ, &root, true);
+    int height = root->height;
+    toku_unpin_ftnode(t->ft, root);
+    return height;
+}
+
+static void run_benchmark(uint64_t n_rows, uint64_t n_lookups) {
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    FT_HANDLE t;
+    int r = toku_open_ft_handle(fname, 1, &t, nodesize, basementnodesize, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    invariant_zero(r);
+
+    for (uint64_t i = 0; i < n_rows; i++) {
+        uint64_t key;
+        DBT k, v;
+        fill_key(&key, &k, i);
+        toku_ft_insert(t, &k, toku_fill_dbt(&v, &i, sizeof i), null_txn);
+    }
+    // apply the messages still above the leaves, and bring every node in
+    lookups(t, n_rows, n_rows);
+
+    struct timeval start, end;
+    open_counters();
+    gettimeofday(&start, nullptr);
+    start_counters();
+    lookups(t, n_rows, n_lookups);
+    stop_counters();
+    gettimeofday(&end, nullptr);
+
+    printf("%" PRIu64 " rows, height %d, %" PRIu64 " lookups: %.1f ns per lookup\n",
+           n_rows, height_of(t), n_lookups, 1000 * elapsed(&start, &end) / n_lookups);
+    report_counters(n_lookups);
+    close_counters();
+
+    r = toku_close_ft_handle_nolsn(t, 0);
+    invariant_zero(r);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    uint64_t n_rows = 1000000;
+    uint64_t n_lookups = 1000000;
+    int i = 1;
+    if (i < argc && strcmp(argv[i], "-v") == 0) {
+        verbose++;
+        i++;
+    }
+    if (i < argc) {
+        n_rows = strtoull(argv[i++], nullptr, 10);
+    }
+    if (i < argc) {
+        n_lookups = strtoull(argv[i++], nullptr, 10);
+    }
+    run_benchmark(n_rows, n_lookups);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that a cursor scan of a tree that is not in memory sees every row
+// when the leaves are prefetched in batches, and that leaves that are next
+// to each other on disk get read together.
+
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 100000;
+
+static int scanned;
+
+static int
+check_row(uint32_t keylen, const void *key, uint32_t vallen, const void *val, void *UU(extra), bool lock_only) {
+    // called with no key past the last row
+    if (lock_only || key == nullptr) {
+        return 0;
+    }
+    int k = toku_htonl(*(const int *) key);
+    assert(keylen == sizeof(int) && vallen == sizeof(int));
+    assert(k == scanned);
+    assert(*(const int *) val == k);
+    scanned++;
+    return 0;
+}
+
+static void
+test_prefetch_batch (void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 1, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    for (int i = 0; i < n_rows; i++) {
+        int k = toku_htonl(i);
+        DBT key, val;
+        toku_ft_insert(t, toku_fill_dbt(&key, &k, sizeof k), toku_fill_dbt(&val, &i, sizeof i), null_txn);
+    }
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+
+    // scan the tree from disk
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 0, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    uint64_t coalesced_before = ft_status_value(FT_STATUS_S::FT_PREFETCH_COALESCED_READS);
+    FT_CURSOR cursor;
+    r = toku_ft_cursor(t, &cursor, null_txn, false, false);
+    assert(r == 0);
+    // prefetching needs the cursor to know the range it scans
+    DBT neg_infinity, pos_infinity;
+    toku_ft_cursor_set_range_lock(cursor, toku_init_dbt(&neg_infinity), toku_init_dbt(&pos_infinity), true, true, 0);
+    toku_ft_cursor_set_prefetching(cursor);
+    for (r = toku_ft_cursor_first(cursor, check_row, nullptr); r == 0;
+         r = toku_ft_cursor_next(cursor, check_row, nullptr)) {
+    }
+    assert(r == DB_NOTFOUND);
+    assert(scanned == n_rows);
+    if (verbose) {
+        printf("coalesced reads %" PRIu64 "\n", ft_status_value(FT_STATUS_S::FT_PREFETCH_COALESCED_READS) - coalesced_before);
+    }
+    assert(ft_status_value(FT_STATUS_S::FT_PREFETCH_COALESCED_READS) > coalesced_before);
+    toku_ft_cursor_close(cursor);
+
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_prefetch_batch();
+    return 0;
+}
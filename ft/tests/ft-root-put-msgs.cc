@@ -0,0 +1,165 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that rows inserted in batches through toku_ft_root_put_msgs end
+// up in the tree as if inserted one at a time, that a later row for the
+// same key in a batch wins, and that a batch pins the root far fewer
+// times than it has rows.
+
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 50000;
+static const int batch_size = 1000;
+
+// Insert row rows[i] with value prefixes[i]<row>, all in one batch.
+static void insert_batch(FT_HANDLE t, const int *rows, const char *const *prefixes, int n) {
+    char *keybufs, *valbufs;
+    XMALLOC_N(n * 16, keybufs);
+    XMALLOC_N(n * 16, valbufs);
+    DBT *keys, *vals;
+    XMALLOC_N(n, keys);
+    XMALLOC_N(n, vals);
+    for (int i = 0; i < n; i++) {
+        char *key = &keybufs[i * 16];
+        char *val = &valbufs[i * 16];
+        snprintf(key, 16, "%08d", rows[i]);
+        snprintf(val, 16, "%s%d", prefixes[i], rows[i]);
+        toku_fill_dbt(&keys[i], key, 1 + strlen(key));
+        toku_fill_dbt(&vals[i], val, 1 + strlen(val));
+    }
+    toku_ft_maybe_insert_batch(t, n, keys, vals, null_txn, false, ZERO_LSN, false, FT_INSERT);
+    toku_free(keys);
+    toku_free(vals);
+    toku_free(keybufs);
+    toku_free(valbufs);
+}
+
+static void check_rows(FT_HANDLE t, const char *even_prefix, const char *odd_prefix) {
+    for (int i = 0; i < n_rows; i++) {
+        char key[16], val[16];
+        snprintf(key, sizeof key, "%08d", i);
+        snprintf(val, sizeof val, "%s%d", i % 2 == 0 ? even_prefix : odd_prefix, i);
+        ft_lookup_and_check_nodup(t, key, val);
+    }
+}
+
+static void test_root_put_msgs(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 1, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+
+    // every row once, in shuffled batches
+    int *rows;
+    XMALLOC_N(n_rows, rows);
+    for (int i = 0; i < n_rows; i++) {
+        rows[i] = i;
+    }
+    for (int i = n_rows - 1; i > 0; i--) {
+        int j = random() % (i + 1);
+        int tmp = rows[i];
+        rows[i] = rows[j];
+        rows[j] = tmp;
+    }
+    const uint64_t pins_before = ft_status_value(FT_STATUS_S::FT_PRO_NUM_ROOT_BATCH_PINS);
+    const uint64_t injected_before = ft_status_value(FT_STATUS_S::FT_PRO_NUM_ROOT_BATCH_INJECT);
+    const char *prefixes[2 * batch_size];
+    for (int i = 0; i < n_rows; i += batch_size) {
+        for (int j = 0; j < batch_size; j++) {
+            prefixes[j] = "val";
+        }
+        insert_batch(t, &rows[i], prefixes, batch_size);
+    }
+    const uint64_t pins = ft_status_value(FT_STATUS_S::FT_PRO_NUM_ROOT_BATCH_PINS) - pins_before;
+    const uint64_t injected = ft_status_value(FT_STATUS_S::FT_PRO_NUM_ROOT_BATCH_INJECT) - injected_before;
+    if (verbose) {
+        printf("%" PRIu64 " messages, %" PRIu64 " root pins\n", injected, pins);
+    }
+    assert(injected == (uint64_t) n_rows);
+    assert(pins >= (uint64_t) n_rows / batch_size);
+    assert(pins * 10 < injected);
+    check_rows(t, "val", "val");
+
+    // each odd row twice in the same batch: the later one wins
+    for (int i = 0; i < n_rows; i += batch_size) {
+        int batch[batch_size];
+        int n = 0;
+        for (int j = i + 1; j < i + batch_size; j += 2) {
+            batch[n] = j;
+            prefixes[n] = "old";
+            n++;
+        }
+        for (int j = 0; j < batch_size / 2; j++) {
+            batch[n] = batch[j];
+            prefixes[n] = "new";
+            n++;
+        }
+        insert_batch(t, batch, prefixes, n);
+    }
+    check_rows(t, "val", "new");
+
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+
+    // and the same after a round trip through disk
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 0, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    check_rows(t, "val", "new");
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+    toku_free(rows);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_root_put_msgs();
+    return 0;
+}
@@ -97,7 +97,7 @@ static void test_serialize_leaf(int valsize,
     sn->n_children = 8;
     sn->dirty = 1;
     sn->oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(sn->n_children, sn->bp);
+    toku_ftnode_alloc_partitions(sn, sn->n_children);
     sn->pivotkeys.create_empty();
     for (int i = 0; i < sn->n_children; ++i) {
         BP_STATE(sn, i) = PT_AVAIL;
@@ -267,7 +267,7 @@ static void test_serialize_nonleaf(int valsize,
     sn.n_children = 8;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     sn.pivotkeys.create_empty();
     for (int i = 0; i < sn.n_children; ++i) {
         BP_BLOCKNUM(&sn, i).b = 30 + (i * 5);
@@ -240,7 +240,7 @@ static void test_serialize_leaf_check_msn(enum ftnode_verify_type bft,
     sn.n_children = 2;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     DBT pivotkey;
     sn.pivotkeys.create_from_dbts(toku_fill_dbt(&pivotkey, "b", 2), 1);
     BP_STATE(&sn, 0) = PT_AVAIL;
@@ -384,7 +384,7 @@ static void test_serialize_leaf_with_large_pivots(enum ftnode_verify_type bft,
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
 
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     sn.pivotkeys.create_empty();
     for (int i = 0; i < sn.n_children; ++i) {
         BP_STATE(&sn, i) = PT_AVAIL;
@@ -541,7 +541,7 @@ static void test_serialize_leaf_with_many_rows(enum ftnode_verify_type bft,
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
 
-    XMALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     sn.pivotkeys.create_empty();
     for (int i = 0; i < sn.n_children; ++i) {
         BP_STATE(&sn, i) = PT_AVAIL;
@@ -696,7 +696,7 @@ static void test_serialize_leaf_with_large_rows(enum ftnode_verify_type bft,
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
 
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     sn.pivotkeys.create_empty();
     for (int i = 0; i < sn.n_children; ++i) {
         BP_STATE(&sn, i) = PT_AVAIL;
@@ -847,7 +847,7 @@ static void test_serialize_leaf_with_empty_basement_nodes(
     sn.n_children = 7;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     DBT pivotkeys[6];
     toku_fill_dbt(&pivotkeys[0], "A", 2);
     toku_fill_dbt(&pivotkeys[1], "a", 2);
@@ -991,7 +991,7 @@ static void test_serialize_leaf_with_multiple_empty_basement_nodes(
     sn.n_children = 4;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(sn.n_children, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, sn.n_children);
     DBT pivotkeys[3];
     toku_fill_dbt(&pivotkeys[0], "A", 2);
     toku_fill_dbt(&pivotkeys[1], "A", 2);
@@ -1102,7 +1102,7 @@ static void test_serialize_nonleaf(enum ftnode_verify_type bft, bool do_clone) {
     sn.n_children = 2;
     sn.dirty = 1;
     sn.oldest_referenced_xid_known = TXNID_NONE;
-    MALLOC_N(2, sn.bp);
+    toku_ftnode_alloc_partitions(&sn, 2);
     DBT pivotkey;
     sn.pivotkeys.create_from_dbts(toku_fill_dbt(&pivotkey, "hello", 6), 1);
     BP_BLOCKNUM(&sn, 0).b = 30;
@@ -0,0 +1,96 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that with a victim cache, nodes evicted from a small cachetable
+// are read back in from memory, and that their contents are intact.
+
+#include "test.h"
+
+#include "ft/serialize/victim_cache.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 20000;
+
+static void
+test_victim_cache (void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+
+    toku_victim_cache_set_size_limit(64 * 1024 * 1024);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 256 * 1024, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 1, &t, 16 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+
+    for (int i = 0; i < n_rows; i++) {
+        char key[100], val[100];
+        snprintf(key, sizeof key, "%08d", i);
+        snprintf(val, sizeof val, "val%d", i);
+        DBT k, v;
+        toku_ft_insert(t, toku_fill_dbt(&k, key, 1 + strlen(key)), toku_fill_dbt(&v, val, 1 + strlen(val)), null_txn);
+    }
+    assert(toku_victim_cache_get_size() > 0);
+
+    uint64_t hits_before = ft_status_value(FT_STATUS_S::FT_VICTIM_CACHE_HITS);
+    for (int i = 0; i < n_rows; i++) {
+        char key[100], val[100];
+        snprintf(key, sizeof key, "%08d", i);
+        snprintf(val, sizeof val, "val%d", i);
+        ft_lookup_and_check_nodup(t, key, val);
+    }
+    assert(ft_status_value(FT_STATUS_S::FT_VICTIM_CACHE_HITS) > hits_before);
+
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+    // freeing the FT dropped its images
+    assert(toku_victim_cache_get_size() == 0);
+
+    toku_victim_cache_set_size_limit(0);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_victim_cache();
+    return 0;
+}
@@ -0,0 +1,146 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that in lazy broadcast mode the cleaner leaves a broadcast update
+// pending above leaves that are not in memory, instead of reading and
+// rewriting them, and that reads and the hot flusher still see and apply
+// the update.
+
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 10000;
+
+static int
+update_fun(DB *UU(db), const DBT *UU(key), const DBT *old_val, const DBT *extra,
+           void (*set_val)(const DBT *new_val, void *set_extra), void *set_extra) {
+    if (old_val != nullptr) {
+        set_val(extra, set_extra);
+    }
+    return 0;
+}
+
+static void check_rows(FT_HANDLE t, const char *val) {
+    for (int i = 0; i < n_rows; i++) {
+        char key[16];
+        snprintf(key, sizeof key, "%08d", i);
+        ft_lookup_and_check_nodup(t, key, val);
+    }
+}
+
+static void open_tree(const char *fname, CACHETABLE *ct, FT_HANDLE *t) {
+    toku_cachetable_create(ct, 0, ZERO_LSN, nullptr);
+    // only the explicit runs below clean
+    toku_set_cleaner_period(*ct, 0);
+    toku_set_cleaner_iterations(*ct, 10);
+    // the update function has to be set before the handle is opened
+    toku_ft_handle_create(t);
+    toku_ft_handle_set_nodesize(*t, 32 * 1024);
+    toku_ft_handle_set_basementnodesize(*t, 4 * 1024);
+    toku_ft_set_bt_compare(*t, toku_builtin_compare_fun);
+    toku_ft_set_update(*t, update_fun);
+    int r = toku_ft_handle_open(*t, fname, 1, 0, *ct, null_txn);
+    assert(r == 0);
+}
+
+static void close_tree(CACHETABLE *ct, FT_HANDLE t) {
+    int r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(ct);
+}
+
+static void test_lazy_broadcast(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    open_tree(fname, &ct, &t);
+    // enough rows for the root to split
+    for (int i = 0; i < n_rows; i++) {
+        char key[16];
+        snprintf(key, sizeof key, "%08d", i);
+        DBT k, v;
+        toku_ft_insert(t, toku_fill_dbt(&k, key, 1 + strlen(key)), toku_fill_dbt(&v, "old", 4), null_txn);
+    }
+    close_tree(&ct, t);
+
+    // after a reopen the leaves are on disk
+    open_tree(fname, &ct, &t);
+    toku_ft_set_lazy_broadcast(true);
+    DBT extra;
+    toku_fill_dbt(&extra, "new", 4);
+    toku_ft_maybe_update_broadcast(t, &extra, null_txn, false, ZERO_LSN, false, false);
+
+    const uint64_t deferred_before = flusher_status_value(FT_FLUSHER_STATUS_S::FT_FLUSHER_CLEANER_BROADCASTS_DEFERRED);
+    const uint64_t dirtied_before = flusher_status_value(FT_FLUSHER_STATUS_S::FT_FLUSHER_CLEANER_NODES_DIRTIED);
+    for (int i = 0; i < 10; i++) {
+        r = toku_cleaner_thread_for_test(ct);
+        assert(r == 0);
+    }
+    // once deferred, the root no longer looks worth cleaning
+    assert(flusher_status_value(FT_FLUSHER_STATUS_S::FT_FLUSHER_CLEANER_BROADCASTS_DEFERRED) == deferred_before + 1);
+    assert(flusher_status_value(FT_FLUSHER_STATUS_S::FT_FLUSHER_CLEANER_NODES_DIRTIED) == dirtied_before);
+
+    // reads apply the pending update
+    check_rows(t, "new");
+
+    // the hot flusher takes it down to the leaves
+    uint64_t loops_run;
+    r = toku_ft_hot_optimize(t, nullptr, nullptr, nullptr, nullptr, &loops_run);
+    assert(r == 0);
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    close_tree(&ct, t);
+    toku_ft_set_lazy_broadcast(false);
+
+    open_tree(fname, &ct, &t);
+    check_rows(t, "new");
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    close_tree(&ct, t);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_lazy_broadcast();
+    return 0;
+}
@@ -104,7 +104,7 @@ public:
         sn.n_children = 2;
         sn.dirty = 1;
         sn.oldest_referenced_xid_known = TXNID_NONE;
-        MALLOC_N(sn.n_children, sn.bp);
+        toku_ftnode_alloc_partitions(&sn, sn.n_children);
         DBT pivotkey;
         sn.pivotkeys.create_from_dbts(toku_fill_dbt(&pivotkey, "b", 2), 1);
         BP_STATE(&sn,0) = PT_AVAIL;
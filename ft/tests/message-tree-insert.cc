@@ -0,0 +1,128 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that the fresh and stale message trees of a child buffer stay
+// sorted by (key, msn) whatever order the messages are enqueued in,
+// including the appends at the end of a tree that skip the search.
+
+#include "test.h"
+
+static toku::comparator cmp;
+
+struct check_sorted_extra {
+    message_buffer *msg_buffer;
+    bool have_prev;
+    DBT prev_key;
+    MSN prev_msn;
+    uint32_t count;
+};
+
+static int check_sorted(const int32_t &offset, const uint32_t UU(idx), struct check_sorted_extra *const extra) {
+    DBT key;
+    MSN msn;
+    extra->msg_buffer->get_message_key_msn(offset, &key, &msn);
+    if (extra->have_prev) {
+        int c = cmp(&extra->prev_key, &key);
+        assert(c < 0 || (c == 0 && extra->prev_msn.msn < msn.msn));
+    }
+    extra->have_prev = true;
+    extra->prev_key = key;
+    extra->prev_msn = msn;
+    extra->count++;
+    return 0;
+}
+
+template<typename message_tree_t>
+static uint32_t check_tree(message_tree_t &tree, message_buffer *msg_buffer) {
+    struct check_sorted_extra extra = { .msg_buffer = msg_buffer, .have_prev = false, .prev_key = {}, .prev_msn = ZERO_MSN, .count = 0 };
+    int r = tree.template iterate<struct check_sorted_extra, check_sorted>(&extra);
+    assert_zero(r);
+    assert(extra.count == tree.size());
+    return extra.count;
+}
+
+enum key_order { ASCENDING, DESCENDING, RANDOM, REPEATED };
+
+static int key_for(enum key_order order, int i, int n) {
+    switch (order) {
+    case ASCENDING:
+        return i;
+    case DESCENDING:
+        return n - i;
+    case RANDOM:
+        return random() % n;
+    case REPEATED:
+        return i / 8;
+    }
+    abort();
+}
+
+static void test_insert_order(enum key_order order) {
+    const int n = 1000;
+    XIDS xids_0 = toku_xids_get_root_xids();
+    NONLEAF_CHILDINFO bnc = toku_create_empty_nl();
+    uint64_t msn = MIN_MSN.msn;
+    int n_fresh = 0, n_stale = 0;
+    for (int i = 0; i < n; i++) {
+        char key[16];
+        snprintf(key, sizeof key, "%08d", key_for(order, i, n));
+        const bool is_fresh = (i % 3) != 0;
+        toku_bnc_insert_msg(bnc, key, strlen(key) + 1, "v", 2, FT_INSERT, (MSN) { .msn = ++msn }, xids_0, is_fresh, cmp);
+        if (is_fresh) {
+            n_fresh++;
+        } else {
+            n_stale++;
+        }
+    }
+    assert(check_tree(bnc->fresh_message_tree, &bnc->msg_buffer) == (uint32_t) n_fresh);
+    assert(check_tree(bnc->stale_message_tree, &bnc->msg_buffer) == (uint32_t) n_stale);
+    destroy_nonleaf_childinfo(bnc);
+    toku_xids_destroy(&xids_0);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    cmp.create(toku_builtin_compare_fun, nullptr);
+    test_insert_order(ASCENDING);
+    test_insert_order(DESCENDING);
+    test_insert_order(RANDOM);
+    test_insert_order(REPEATED);
+    cmp.destroy();
+    return 0;
+}
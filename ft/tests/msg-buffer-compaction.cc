@@ -0,0 +1,170 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that child buffers that keep receiving inserts and deletes for
+// the same few keys get compacted, and that the tree still reads back the
+// last value written to each key and counts its rows correctly.
+
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 10000;
+static const int n_hot_rows = 20;
+static const int n_rounds = 200;
+// Messages for the leftmost and rightmost leaves skip the buffers, so
+// hammer rows in the middle of the tree.
+static const int first_hot_row = n_rows / 2;
+
+static void insert_row(FT_HANDLE t, int i, const char *prefix, int round) {
+    char key[16], val[16];
+    snprintf(key, sizeof key, "%08d", i);
+    snprintf(val, sizeof val, "%s%d", prefix, round);
+    DBT k, v;
+    toku_ft_insert(t, toku_fill_dbt(&k, key, 1 + strlen(key)), toku_fill_dbt(&v, val, 1 + strlen(val)), null_txn);
+}
+
+static void delete_row(FT_HANDLE t, int i) {
+    char key[16];
+    snprintf(key, sizeof key, "%08d", i);
+    DBT k;
+    toku_ft_delete(t, toku_fill_dbt(&k, key, 1 + strlen(key)), null_txn);
+}
+
+static int scanned;
+
+static int
+count_row(uint32_t UU(keylen), const void *key, uint32_t UU(vallen), const void *UU(val), void *UU(extra), bool lock_only) {
+    if (lock_only || key == nullptr) {
+        return 0;
+    }
+    scanned++;
+    return 0;
+}
+
+static void test_msg_buffer_compaction(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    unlink(fname);
+
+    const uint64_t old_threshold = toku_ft_get_msg_buffer_compaction_threshold();
+    toku_ft_set_msg_buffer_compaction_threshold(4096);
+
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 1, &t, 32 * 1024, 4 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+
+    // enough rows for the root to split, so later messages are buffered
+    for (int i = 0; i < n_rows; i++) {
+        insert_row(t, i, "val", 0);
+    }
+
+    // keep overwriting some rows, and delete and re-insert the next ones
+    const uint64_t compactions_before = ft_status_value(FT_STATUS_S::FT_MSG_BUFFER_COMPACTIONS);
+    const uint64_t dropped_before = ft_status_value(FT_STATUS_S::FT_MSG_BUFFER_COMPACTED_MSGS);
+    for (int round = 1; round <= n_rounds; round++) {
+        for (int i = first_hot_row; i < first_hot_row + n_hot_rows; i++) {
+            insert_row(t, i, "hot", round);
+        }
+        for (int i = first_hot_row + n_hot_rows; i < first_hot_row + 2 * n_hot_rows; i++) {
+            if (round % 2 == 0) {
+                insert_row(t, i, "back", round);
+            } else {
+                delete_row(t, i);
+            }
+        }
+    }
+    // the last round deletes the rows past the hot ones
+    for (int i = first_hot_row + n_hot_rows; i < first_hot_row + 2 * n_hot_rows; i++) {
+        delete_row(t, i);
+    }
+    const uint64_t compactions = ft_status_value(FT_STATUS_S::FT_MSG_BUFFER_COMPACTIONS) - compactions_before;
+    const uint64_t dropped = ft_status_value(FT_STATUS_S::FT_MSG_BUFFER_COMPACTED_MSGS) - dropped_before;
+    if (verbose) {
+        printf("%" PRIu64 " compactions dropped %" PRIu64 " messages\n", compactions, dropped);
+    }
+    assert(compactions > 0);
+    assert(dropped > 0);
+
+    for (int i = 0; i < n_rows; i++) {
+        char key[16], val[16];
+        snprintf(key, sizeof key, "%08d", i);
+        if (i >= first_hot_row && i < first_hot_row + n_hot_rows) {
+            snprintf(val, sizeof val, "hot%d", n_rounds);
+            ft_lookup_and_check_nodup(t, key, val);
+        } else if (i >= first_hot_row && i < first_hot_row + 2 * n_hot_rows) {
+            ft_lookup_and_fail_nodup(t, key);
+        } else {
+            ft_lookup_and_check_nodup(t, key, "val0");
+        }
+    }
+
+    // once every leaf has had its messages applied, the logical row count
+    // is exact, dropped messages included
+    FT_CURSOR cursor;
+    r = toku_ft_cursor(t, &cursor, null_txn, false, false);
+    assert(r == 0);
+    for (r = toku_ft_cursor_first(cursor, count_row, nullptr); r == 0;
+         r = toku_ft_cursor_next(cursor, count_row, nullptr)) {
+    }
+    assert(r == DB_NOTFOUND);
+    toku_ft_cursor_close(cursor);
+    assert(scanned == n_rows - n_hot_rows);
+    struct ftstat64_s s;
+    toku_ft_handle_stat64(t, null_txn, &s);
+    if (verbose) {
+        printf("%" PRIu64 " logical rows\n", s.nkeys);
+    }
+    assert(s.nkeys == (uint64_t) (n_rows - n_hot_rows));
+
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+    toku_ft_set_msg_buffer_compaction_threshold(old_threshold);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_msg_buffer_compaction();
+    return 0;
+}
@@ -233,6 +233,19 @@ insert_same_message_to_bns(
     }
 }
 
+// Applying messages from ancestors counts the rows they add to a basement
+// node, and an update whose random key happens to match a key already in
+// the leaf counts as an overwrite. Give the count back to the ft, as
+// evicting the basement would, before the leaf is freed.
+static void
+forget_logical_rows_delta(FT_HANDLE t, FTNODE leaf)
+{
+    for (int i = 0; i < leaf->n_children; ++i) {
+        toku_ft_adjust_logical_row_count(t->ft, -BLB_LRD(leaf, i));
+        BLB_LRD(leaf, i) = 0;
+    }
+}
+
 struct orthopush_flush_update_fun_extra {
     DBT new_val;
     int *num_applications;
@@ -800,6 +813,7 @@ flush_to_leaf(FT_HANDLE t, bool make_leaf_up_to_date, bool use_flush) {
         toku_free(child_messages[i]);
         toku_free(key_pointers[i]);
     }
+    forget_logical_rows_delta(t, child);
     toku_ftnode_free(&child);
     toku_free(parent_messages);
     toku_free(key_pointers);
@@ -997,6 +1011,7 @@ flush_to_leaf_with_keyrange(FT_HANDLE t, bool make_leaf_up_to_date) {
         toku_free(key_pointers[i]);
     }
     toku_free(ubi.data);
+    forget_logical_rows_delta(t, child);
     toku_ftnode_free(&child);
     toku_free(parent_messages);
     toku_free(key_pointers);
@@ -1207,6 +1222,7 @@ compare_apply_and_flush(FT_HANDLE t, bool make_leaf_up_to_date) {
         toku_free(key_pointers[i]);
         toku_free(child_messages[i]);
     }
+    forget_logical_rows_delta(t, child2);
     toku_ftnode_free(&child1);
     toku_ftnode_free(&child2);
     toku_free(parent_messages);
@@ -1286,6 +1302,28 @@ test_main (int argc, const char *argv[]) {
         compare_apply_and_flush(t, true);
     }
 
+    // Do it again, applying messages to every basement node in parallel.
+    const uint64_t old_threshold = toku_ft_get_parallel_apply_threshold();
+    toku_ft_set_parallel_apply_threshold(1);
+    FT_STATUS_S ft_stat;
+    toku_ft_get_status(&ft_stat);
+    const uint64_t parallel_before = read_partitioned_counter(ft_stat.status[FT_STATUS_S::FT_ANCESTORS_APPLIED_PARALLEL].value.parcount);
+    for (int i = 0; i < 3; ++i) {
+        flush_to_leaf(t, false, false);
+        flush_to_leaf(t, false, true);
+        flush_to_leaf(t, true, false);
+        flush_to_leaf(t, true, true);
+    }
+    for (int i = 0; i < 10; ++i) {
+        flush_to_leaf_with_keyrange(t, false);
+        flush_to_leaf_with_keyrange(t, true);
+        compare_apply_and_flush(t, false);
+        compare_apply_and_flush(t, true);
+    }
+    toku_ft_get_status(&ft_stat);
+    assert(read_partitioned_counter(ft_stat.status[FT_STATUS_S::FT_ANCESTORS_APPLIED_PARALLEL].value.parcount) > parallel_before);
+    toku_ft_set_parallel_apply_threshold(old_threshold);
+
     r = toku_close_ft_handle_nolsn(t, 0);          assert(r==0);
     toku_cachetable_close(&ct);
 
@@ -0,0 +1,381 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+#include <sys/time.h>
+
+#include "ft/node.h"
+#include "ft/serialize/rbuf.h"
+#include "ft/serialize/wbuf.h"
+
+// Check that every pivot search mode, and the Eytzinger index, find the
+// same child as a search through the comparator, then time each of them.
+
+static const uint8_t test_magic = 0x42;
+
+// a comparator that is not a memcmp, so memcmp_lower_bound() may only
+// take its fast path for keys that carry test_magic
+static int reverse_unless_magic_cmp(DB *UU(db), const DBT *a, const DBT *b) {
+    return -toku_builtin_compare_fun(nullptr, a, b);
+}
+
+static void fill_key(char *buf, size_t keylen, uint64_t v, bool magic) {
+    for (size_t i = 0; i < keylen; i++) {
+        buf[keylen - 1 - i] = (i < 8) ? static_cast<char>(v >> (8 * i)) : 0;
+    }
+    if (magic) {
+        buf[0] = test_magic;
+    }
+}
+
+// returns: the first pivot that is not less than key, found through the comparator
+static int reference_lower_bound(const toku::comparator &cmp, const ftnode_pivot_keys &pivots, const DBT *key) {
+    int i = 0;
+    for (; i < pivots.num_pivots(); i++) {
+        DBT pivot = pivots.get_pivot(i);
+        if (cmp(&pivot, key) >= 0) {
+            break;
+        }
+    }
+    return i;
+}
+
+// returns: the same as reference_lower_bound(), with the binary search
+//          the tree falls back to
+static int comparator_lower_bound(const toku::comparator &cmp, const ftnode_pivot_keys &pivots, const DBT *key) {
+    int lo = 0, hi = pivots.num_pivots();
+    while (lo < hi) {
+        int mi = (lo + hi) / 2;
+        DBT pivot = pivots.get_pivot(mi);
+        if (cmp(&pivot, key) < 0) {
+            lo = mi + 1;
+        } else {
+            hi = mi;
+        }
+    }
+    return lo;
+}
+
+static void make_pivots(ftnode_pivot_keys *pivots, size_t keylen, int n, bool magic) {
+    DBT *keys;
+    XMALLOC_N(n, keys);
+    char *buf;
+    XMALLOC_N(keylen * n, buf);
+    for (int i = 0; i < n; i++) {
+        // leave gaps between pivots so the searched keys can land between them
+        fill_key(&buf[i * keylen], keylen, (static_cast<uint64_t>(i) + 1) << 33 | 0x80, magic);
+        toku_fill_dbt(&keys[i], &buf[i * keylen], keylen);
+    }
+    pivots->create_from_dbts(keys, n);
+    toku_free(buf);
+    toku_free(keys);
+}
+
+static const enum ft_pivot_search_mode modes[] = {
+    FT_PIVOT_SEARCH_GENERIC, FT_PIVOT_SEARCH_SCALAR, FT_PIVOT_SEARCH_SSE42, FT_PIVOT_SEARCH_AVX2
+};
+static const char *mode_names[] = { "generic", "scalar", "sse4.2", "avx2" };
+
+static void test_matches_reference(const toku::comparator &cmp, size_t keylen, int n, bool magic) {
+    ftnode_pivot_keys pivots;
+    make_pivots(&pivots, keylen, n, magic);
+
+    char keybuf[32];
+    for (enum ft_pivot_search_mode mode : modes) {
+        if (toku_ft_set_pivot_search_mode(mode) != 0) {
+            continue;
+        }
+        for (int i = 0; i < 4 * n + 8; i++) {
+            // probe every pivot, just below and just above it, and past both ends
+            uint64_t v = (static_cast<uint64_t>(i / 4) << 33 | 0x80) + (i % 4) - 1;
+            fill_key(keybuf, keylen, v, magic);
+            DBT key;
+            toku_fill_dbt(&key, keybuf, keylen);
+            int expected = reference_lower_bound(cmp, pivots, &key);
+            invariant(comparator_lower_bound(cmp, pivots, &key) == expected);
+            int lower_bound;
+            if (pivots.memcmp_lower_bound(cmp, &key, &lower_bound)) {
+                invariant(mode != FT_PIVOT_SEARCH_GENERIC);
+                invariant(lower_bound == expected);
+            } else {
+                invariant(mode == FT_PIVOT_SEARCH_GENERIC);
+            }
+
+            // a key of another length goes through the scalar memcmp search
+            DBT shorter;
+            toku_fill_dbt(&shorter, keybuf, keylen - 1);
+            if (pivots.memcmp_lower_bound(cmp, &shorter, &lower_bound)) {
+                invariant(lower_bound == reference_lower_bound(cmp, pivots, &shorter));
+            }
+        }
+    }
+    invariant_zero(toku_ft_set_pivot_search_mode(FT_PIVOT_SEARCH_AUTO));
+    pivots.destroy();
+}
+
+static int keycompare_qsort(const void *a, const void *b) {
+    const DBT *x = static_cast<const DBT *>(a), *y = static_cast<const DBT *>(b);
+    return toku_keycompare(x->data, x->size, y->data, y->size);
+}
+
+// effect: checks eytzinger_lower_bound() against the comparator for keys of
+//         many lengths, most of them sharing their first 8 bytes with others
+static void test_eytzinger_matches_reference(const toku::comparator &cmp, int n, bool magic) {
+    DBT *keys;
+    XMALLOC_N(n, keys);
+    char *buf;
+    XMALLOC_N(n * 24, buf);
+    int nkeys = 0;
+    for (int i = 0; i < n; i++) {
+        char *key = &buf[i * 24];
+        uint32_t size = 1 + random() % 24;
+        for (uint32_t j = 0; j < size; j++) {
+            key[j] = "ab\0"[random() % 3];
+        }
+        if (magic) {
+            key[0] = test_magic;
+        }
+        toku_fill_dbt(&keys[nkeys++], key, size);
+    }
+    qsort(keys, nkeys, sizeof keys[0], keycompare_qsort);
+    int unique = 0;
+    for (int i = 0; i < nkeys; i++) {
+        if (unique == 0 || keycompare_qsort(&keys[unique - 1], &keys[i]) != 0) {
+            keys[unique++] = keys[i];
+        }
+    }
+
+    // serialize and deserialize the pivots so that they get their index
+    ftnode_pivot_keys pivots;
+    pivots.create_from_dbts(keys, unique);
+    struct wbuf wb;
+    char *wbuf_data;
+    XMALLOC_N(pivots.serialized_size() + 5 * unique, wbuf_data);
+    wbuf_init(&wb, wbuf_data, pivots.serialized_size() + 5 * unique);
+    pivots.serialize_to_wbuf(&wb);
+    pivots.destroy();
+    toku_ft_set_pivot_eytzinger_index(true);
+    struct rbuf rb;
+    rbuf_init(&rb, (unsigned char *) wbuf_data, wb.ndone);
+    pivots.deserialize_from_rbuf(&rb, unique);
+    toku_ft_set_pivot_eytzinger_index(false);
+    invariant(pivots.eytzinger_index_size() > 0);
+
+    char probe[32];
+    for (int i = 0; i < 4 * unique + 100; i++) {
+        DBT key;
+        if (i < 4 * unique) {
+            // each pivot, then shortened, then extended with the smallest
+            // and the biggest byte
+            const DBT *pivot = &keys[i / 4];
+            memcpy(probe, pivot->data, pivot->size);
+            uint32_t size = pivot->size;
+            switch (i % 4) {
+            case 1: size = size > 1 ? size - 1 : size; break;
+            case 2: probe[size++] = 0; break;
+            case 3: probe[size++] = (char) 0xff; break;
+            }
+            toku_fill_dbt(&key, probe, size);
+        } else {
+            uint32_t size = 1 + random() % 24;
+            for (uint32_t j = 0; j < size; j++) {
+                probe[j] = "ab\0"[random() % 3];
+            }
+            if (magic) {
+                probe[0] = test_magic;
+            }
+            toku_fill_dbt(&key, probe, size);
+        }
+        int lower_bound;
+        invariant(pivots.eytzinger_lower_bound(cmp, &key, &lower_bound));
+        invariant(lower_bound == reference_lower_bound(cmp, pivots, &key));
+    }
+
+    // a comparator with magic can not use the index for keys without it
+    if (magic) {
+        probe[0] = test_magic + 1;
+        DBT key;
+        toku_fill_dbt(&key, probe, 1);
+        int lower_bound;
+        invariant(!pivots.eytzinger_lower_bound(cmp, &key, &lower_bound));
+    }
+
+    // changing the pivots drops the index
+    pivots.delete_at(0);
+    invariant(pivots.eytzinger_index_size() == 0);
+    int lower_bound;
+    invariant(!pivots.eytzinger_lower_bound(cmp, &keys[0], &lower_bound));
+
+    pivots.destroy();
+    toku_free(wbuf_data);
+    toku_free(buf);
+    toku_free(keys);
+}
+
+static void test_correctness(void) {
+    toku::comparator builtin_cmp, magic_cmp;
+    builtin_cmp.create(toku_builtin_compare_fun, nullptr);
+    magic_cmp.create(reverse_unless_magic_cmp, nullptr, test_magic);
+
+    for (size_t keylen : { 8, 12, 16 }) {
+        for (int n : { 1, 2, 3, 7, 31, 32, 33, 100, 255 }) {
+            test_matches_reference(builtin_cmp, keylen, n, false);
+            test_matches_reference(magic_cmp, keylen, n, true);
+        }
+    }
+
+    for (int n : { 1, 2, 3, 15, 16, 17, 100, 1000 }) {
+        test_eytzinger_matches_reference(builtin_cmp, n, false);
+        test_eytzinger_matches_reference(magic_cmp, n, true);
+    }
+
+    // without the magic, the comparator has to be used
+    ftnode_pivot_keys pivots;
+    make_pivots(&pivots, 8, 16, false);
+    char keybuf[8];
+    fill_key(keybuf, 8, 1, false);
+    DBT key;
+    toku_fill_dbt(&key, keybuf, 8);
+    int lower_bound;
+    invariant(!pivots.memcmp_lower_bound(magic_cmp, &key, &lower_bound));
+    pivots.destroy();
+
+    // nor once any pivot loses the magic, until it gets it back
+    make_pivots(&pivots, 8, 16, true);
+    fill_key(keybuf, 8, 1, true);
+    invariant(pivots.memcmp_lower_bound(magic_cmp, &key, &lower_bound));
+    char pivotbuf[8];
+    DBT pivot;
+    fill_key(pivotbuf, 8, 9ULL << 33, false);
+    pivots.replace_at(toku_fill_dbt(&pivot, pivotbuf, 8), 8);
+    invariant(!pivots.memcmp_lower_bound(magic_cmp, &key, &lower_bound));
+    fill_key(pivotbuf, 8, 9ULL << 33, true);
+    pivots.replace_at(&pivot, 8);
+    invariant(pivots.memcmp_lower_bound(magic_cmp, &key, &lower_bound));
+    pivots.delete_at(8);
+    pivots.insert_at(toku_fill_dbt(&pivot, pivotbuf, 8), 8);
+    invariant(pivots.memcmp_lower_bound(magic_cmp, &key, &lower_bound));
+    pivots.destroy();
+
+    builtin_cmp.destroy();
+    magic_cmp.destroy();
+}
+
+static double now_usec(void) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+static void benchmark(size_t keylen, int n, int searches) {
+    toku::comparator cmp;
+    cmp.create(toku_builtin_compare_fun, nullptr);
+    ftnode_pivot_keys pivots;
+    make_pivots(&pivots, keylen, n, false);
+
+    const int nkeys = 1024;
+    char *keybufs;
+    XMALLOC_N(nkeys * keylen, keybufs);
+    DBT keys[nkeys];
+    for (int i = 0; i < nkeys; i++) {
+        fill_key(&keybufs[i * keylen], keylen, (static_cast<uint64_t>(random()) % (n + 1)) << 33, false);
+        toku_fill_dbt(&keys[i], &keybufs[i * keylen], keylen);
+    }
+
+    for (int m = 0; m < (int) (sizeof modes / sizeof modes[0]); m++) {
+        if (toku_ft_set_pivot_search_mode(modes[m]) != 0) {
+            continue;
+        }
+        long sum = 0;
+        double t0 = now_usec();
+        for (int i = 0; i < searches; i++) {
+            const DBT *key = &keys[i % nkeys];
+            int lower_bound;
+            if (!pivots.memcmp_lower_bound(cmp, key, &lower_bound)) {
+                lower_bound = comparator_lower_bound(cmp, pivots, key);
+            }
+            sum += lower_bound;
+        }
+        double t1 = now_usec();
+        if (verbose) {
+            printf("keylen %2zu pivots %4d %-8s %6.1f ns/search (%ld)\n",
+                   keylen, n, mode_names[m], (t1 - t0) * 1000.0 / searches, sum);
+        }
+    }
+    invariant_zero(toku_ft_set_pivot_search_mode(FT_PIVOT_SEARCH_AUTO));
+
+    pivots.build_eytzinger_index();
+    long sum = 0;
+    double t0 = now_usec();
+    for (int i = 0; i < searches; i++) {
+        int lower_bound;
+        invariant(pivots.eytzinger_lower_bound(cmp, &keys[i % nkeys], &lower_bound));
+        sum += lower_bound;
+    }
+    double t1 = now_usec();
+    if (verbose) {
+        printf("keylen %2zu pivots %4d %-8s %6.1f ns/search (%ld)\n",
+               keylen, n, "eytzinger", (t1 - t0) * 1000.0 / searches, sum);
+    }
+
+    toku_free(keybufs);
+    pivots.destroy();
+    cmp.destroy();
+}
+
+int test_main(int argc, const char *argv[]) {
+    int searches = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose++;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            verbose = 0;
+        } else {
+            searches = atoi(argv[i]);
+        }
+    }
+    invariant(toku_ft_set_pivot_search_mode((enum ft_pivot_search_mode) 100) == EINVAL);
+    test_correctness();
+    for (size_t keylen : { 8, 16 }) {
+        for (int n : { 16, 128, 1024 }) {
+            benchmark(keylen, n, searches);
+        }
+    }
+    return 0;
+}
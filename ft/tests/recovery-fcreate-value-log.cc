@@ -0,0 +1,116 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+
+// Verify that replaying fcreate gives the dictionary the value log
+// threshold it was created with, and starts it over with an empty value log.
+
+#include "test.h"
+
+#include "toku_os.h"
+#include "cachetable/checkpoint.h"
+
+#include "test-ft-txns.h"
+
+static const char *iname = "foo.ft_handle";
+static const uint32_t threshold = 1024;
+
+static void test_fcreate_value_log(void) {
+    TOKULOGGER logger;
+    CACHETABLE ct;
+    test_setup(TOKU_TEST_FILENAME, &logger, &ct);
+
+    int r;
+    TXNID_PAIR one = {.parent_id64 = (TXNID)1, TXNID_NONE};
+    BYTESTRING bs_iname = { (uint32_t) strlen(iname), (char *) iname };
+    FILENUM filenum = {42};
+
+    toku_log_xbegin(logger, NULL, false, one, TXNID_PAIR_NONE);
+    toku_log_fcreate(logger, NULL, true, NULL, one, filenum, bs_iname, 0777, 0,
+                     0, 0, TOKU_DEFAULT_COMPRESSION_METHOD, threshold);
+    toku_log_xcommit(logger, NULL, true, NULL, one);
+
+    toku_logger_close_rollback(logger);
+
+    toku_cachetable_close(&ct);
+    // "Crash"
+    r = toku_logger_close(&logger);
+    CKERR(r);
+    ct = NULL;
+    logger = NULL;
+
+    // leave a value log behind from an earlier incarnation of the dictionary
+    char vlog_fname[TOKU_PATH_MAX + 1];
+    snprintf(vlog_fname, sizeof vlog_fname, "%s/%s.vlog", TOKU_TEST_FILENAME, iname);
+    int fd = open(vlog_fname, O_WRONLY | O_CREAT | O_BINARY, S_IRWXU);
+    assert(fd >= 0);
+    char stale[100];
+    memset(stale, 0xa5, sizeof stale);
+    r = write(fd, stale, sizeof stale);
+    assert(r == (int) sizeof stale);
+    r = close(fd);
+    CKERR(r);
+
+    // "Recover"
+    test_setup_and_recover(TOKU_TEST_FILENAME, &logger, &ct);
+    shutdown_after_recovery(&logger, &ct);
+
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    toku_cachetable_set_env_dir(ct, TOKU_TEST_FILENAME);
+    FT_HANDLE t;
+    toku_ft_handle_create(&t);
+    r = toku_ft_handle_open(t, iname, 0, 0, ct, nullptr);
+    CKERR(r);
+    uint32_t recovered_threshold;
+    toku_ft_handle_get_value_log_threshold(t, &recovered_threshold);
+    assert(recovered_threshold == threshold);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    CKERR(r);
+    toku_cachetable_close(&ct);
+
+    toku_struct_stat st;
+    r = toku_stat(vlog_fname, &st, toku_uninstrumented);
+    CKERR(r);
+    assert(st.st_size == 0);
+}
+
+int test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_fcreate_value_log();
+    return 0;
+}
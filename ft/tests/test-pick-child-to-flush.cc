@@ -195,8 +195,8 @@ doit (void) {
     toku_ftnode_assert_fully_in_memory(node);
     assert(node->n_children == 2);
     assert(!node->dirty);
-    assert(toku_bnc_n_entries(node->bp[0].ptr.u.nonleaf) > 0);
-    assert(toku_bnc_n_entries(node->bp[1].ptr.u.nonleaf) > 0);
+    assert(toku_bnc_n_entries(node->bp[0].ptr.nonleaf) > 0);
+    assert(toku_bnc_n_entries(node->bp[1].ptr.nonleaf) > 0);
 
     struct flusher_advice fa;
     flusher_advice_init(
@@ -220,8 +220,8 @@ doit (void) {
     assert(node->n_children == 2);
     // child 0 should have empty buffer because it flushed
     // child 1 should still have message in buffer
-    assert(toku_bnc_n_entries(node->bp[0].ptr.u.nonleaf) == 0);
-    assert(toku_bnc_n_entries(node->bp[1].ptr.u.nonleaf) > 0);
+    assert(toku_bnc_n_entries(node->bp[0].ptr.nonleaf) == 0);
+    assert(toku_bnc_n_entries(node->bp[1].ptr.nonleaf) > 0);
     toku_unpin_ftnode(t->ft, node);
     r = toku_checkpoint(cp, NULL, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
     assert_zero(r);    
@@ -237,8 +237,8 @@ doit (void) {
     toku_ftnode_assert_fully_in_memory(node);
     assert(node->n_children == 2);
     // both buffers should be empty now
-    assert(toku_bnc_n_entries(node->bp[0].ptr.u.nonleaf) == 0);
-    assert(toku_bnc_n_entries(node->bp[1].ptr.u.nonleaf) == 0);
+    assert(toku_bnc_n_entries(node->bp[0].ptr.nonleaf) == 0);
+    assert(toku_bnc_n_entries(node->bp[1].ptr.nonleaf) == 0);
     // now let's do a flush with an empty buffer, make sure it is ok
     toku_unpin_ftnode(t->ft, node);
     r = toku_checkpoint(cp, NULL, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
@@ -255,8 +255,8 @@ doit (void) {
     toku_ftnode_assert_fully_in_memory(node);
     assert(node->n_children == 2);
     // both buffers should be empty now
-    assert(toku_bnc_n_entries(node->bp[0].ptr.u.nonleaf) == 0);
-    assert(toku_bnc_n_entries(node->bp[1].ptr.u.nonleaf) == 0);
+    assert(toku_bnc_n_entries(node->bp[0].ptr.nonleaf) == 0);
+    assert(toku_bnc_n_entries(node->bp[1].ptr.nonleaf) == 0);
     toku_unpin_ftnode(t->ft, node);
 
     // now let's start a flush from the root, that always recursively flushes    
@@ -54,6 +54,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/cachetable/cachetable-internal.h"
 #include "ft/cursor.h"
 #include "ft/ft.h"
+#include "ft/ft-flusher.h"
 #include "ft/ft-ops.h"
 #include "ft/serialize/ft-serialize.h"
 #include "ft/serialize/ft_node-serialize.h"
@@ -158,6 +159,38 @@ ft_lookup_and_fail_nodup (FT_HANDLE t, char *keystring)
     assert(pair.call_count==0);
 }
 
+// Current values of engine status rows, for tests that check a counter,
+// e.g. ft_status_value(FT_STATUS_S::FT_VICTIM_CACHE_HITS).
+static inline uint64_t
+status_row_value(const TOKU_ENGINE_STATUS_ROW_S &row)
+{
+    return row.type == PARCOUNT ? read_partitioned_counter(row.value.parcount) : row.value.num;
+}
+
+static UU() uint64_t
+ft_status_value(int row)
+{
+    FT_STATUS_S status;
+    toku_ft_get_status(&status);
+    return status_row_value(status.status[row]);
+}
+
+static UU() uint64_t
+flusher_status_value(int row)
+{
+    FT_FLUSHER_STATUS_S status;
+    toku_ft_flusher_get_status(&status);
+    return status_row_value(status.status[row]);
+}
+
+static UU() uint64_t
+cachetable_status_value(CACHETABLE ct, int row)
+{
+    CACHETABLE_STATUS_S status;
+    toku_cachetable_get_status(ct, &status);
+    return status_row_value(status.status[row]);
+}
+
 static UU() void fake_ydb_lock(void) {
 }
 
@@ -114,7 +114,7 @@ setup_ftnode_partitions(struct ftnode *node, int n_children, const MSN msn, size
 {
     node->n_children = n_children;
     node->max_msn_applied_to_node_on_disk = msn;
-    MALLOC_N(node->n_children, node->bp);
+    toku_ftnode_alloc_partitions(node, node->n_children);
     for (int bn = 0; bn < node->n_children; ++bn) {
         BP_STATE(node, bn) = PT_AVAIL;
         set_BLB(node, bn, toku_create_empty_bn());
@@ -0,0 +1,306 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that a dictionary with a value log keeps its large values in the
+// value log, reads them back through lookups, cursors and a reopen, counts
+// overwritten values as value log garbage, and that value log garbage
+// collection moves the live values so the old part of the log can go.
+// Also verify that opening fails cleanly when the value log cannot be
+// opened, and when the handle has an update function.
+
+#include "test.h"
+
+#include <sys/stat.h>
+
+#include "cachetable/checkpoint.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int n_rows = 2000;
+static const uint32_t threshold = 256;
+static const uint32_t large_vallen = 4000;
+
+// even rows have small values, odd rows large ones
+static uint32_t vallen_of(int i) {
+    return (i % 2 == 0) ? 32 : large_vallen;
+}
+
+static void fill_val(char *val, int i, int round) {
+    for (uint32_t j = 0; j < vallen_of(i); j++) {
+        val[j] = 'a' + (i + j + round) % 26;
+    }
+}
+
+static void fill_key(char *key, size_t keysize, DBT *k, int i) {
+    snprintf(key, keysize, "%08d", i);
+    toku_fill_dbt(k, key, 1 + strlen(key));
+}
+
+static void insert_row(FT_HANDLE t, int i, int round) {
+    char key[16], val[large_vallen];
+    DBT k, v;
+    fill_key(key, sizeof key, &k, i);
+    fill_val(val, i, round);
+    toku_ft_insert(t, &k, toku_fill_dbt(&v, val, vallen_of(i)), null_txn);
+}
+
+struct check_extra {
+    int i;
+    int round;
+    bool found;
+};
+
+static int
+check_val(uint32_t UU(keylen), const void *key, uint32_t vallen, const void *val, void *extra, bool lock_only) {
+    if (lock_only || key == nullptr) {
+        return 0;
+    }
+    struct check_extra *CAST_FROM_VOIDP(e, extra);
+    char expected[large_vallen];
+    fill_val(expected, e->i, e->round);
+    assert(vallen == vallen_of(e->i));
+    assert(memcmp(val, expected, vallen) == 0);
+    e->found = true;
+    return 0;
+}
+
+// every row's value, through lookups and a cursor scan
+static void check_rows(FT_HANDLE t, int odd_round) {
+    for (int i = 0; i < n_rows; i++) {
+        char key[16];
+        DBT k;
+        fill_key(key, sizeof key, &k, i);
+        struct check_extra e = { i, (i % 2 == 0) ? 0 : odd_round, false };
+        int r = toku_ft_lookup(t, &k, check_val, &e);
+        assert(r == 0);
+        assert(e.found);
+    }
+
+    FT_CURSOR cursor;
+    int r = toku_ft_cursor(t, &cursor, null_txn, false, false);
+    assert(r == 0);
+    int i = 0;
+    struct check_extra e = { i, 0, false };
+    for (r = toku_ft_cursor_first(cursor, check_val, &e); r == 0;
+         r = toku_ft_cursor_next(cursor, check_val, &e)) {
+        assert(e.found);
+        i++;
+        e = { i, (i % 2 == 0) ? 0 : odd_round, false };
+    }
+    assert(r == DB_NOTFOUND);
+    assert(i == n_rows);
+    toku_ft_cursor_close(cursor);
+}
+
+static void checkpoint(CACHETABLE ct) {
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    int r = toku_checkpoint(cp, NULL, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
+    assert(r == 0);
+}
+
+static void value_log_garbage(FT_HANDLE t, uint64_t *total, uint64_t *used) {
+    toku_ft_get_value_log_garbage(t->ft, total, used);
+    if (verbose) {
+        printf("value log: %" PRIu64 " bytes, %" PRIu64 " in use\n", *total, *used);
+    }
+}
+
+static void test_value_log(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    char vlog_fname[TOKU_PATH_MAX + 1];
+    snprintf(vlog_fname, sizeof vlog_fname, "%s.vlog", fname);
+    unlink(fname);
+    unlink(vlog_fname);
+
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    FT_HANDLE t;
+    toku_ft_handle_create(&t);
+    toku_ft_handle_set_value_log_threshold(t, threshold);
+    r = toku_ft_handle_open(t, fname, 1, 0, ct, null_txn);
+    assert(r == 0);
+
+    for (int i = 0; i < n_rows; i++) {
+        insert_row(t, i, 0);
+    }
+    check_rows(t, 0);
+
+    // only the large values went to the value log
+    const uint64_t live_size = (n_rows / 2) * value_log::record_size(large_vallen);
+    toku_struct_stat st;
+    r = toku_stat(vlog_fname, &st, toku_uninstrumented);
+    assert(r == 0);
+    assert((uint64_t) st.st_size == live_size);
+
+    // nothing is garbage yet
+    checkpoint(ct);
+    uint64_t total, used;
+    value_log_garbage(t, &total, &used);
+    assert(total == live_size);
+    assert(used == live_size);
+
+    // overwriting the large values leaves their old records behind
+    for (int i = 1; i < n_rows; i += 2) {
+        insert_row(t, i, 1);
+    }
+    checkpoint(ct);
+    value_log_garbage(t, &total, &used);
+    assert(total == 2 * live_size);
+    assert(used == live_size);
+    check_rows(t, 1);
+
+    // collecting the whole log moves the live values past it
+    r = toku_ft_value_log_gc(t, UINT64_MAX);
+    assert(r == 0);
+    check_rows(t, 1);
+    checkpoint(ct);
+    value_log_garbage(t, &total, &used);
+    assert(total == live_size);
+    assert(used == live_size);
+
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+
+    // the threshold and the tail are in the header
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    r = toku_open_ft_handle(fname, 0, &t, 4 * 1024 * 1024, 128 * 1024, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+    uint32_t t_threshold;
+    toku_ft_handle_get_value_log_threshold(t, &t_threshold);
+    assert(t_threshold == threshold);
+    check_rows(t, 1);
+    value_log_garbage(t, &total, &used);
+    assert(total == live_size);
+    assert(used == live_size);
+    r = toku_verify_ft(t);
+    assert(r == 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+static int
+update_fun(DB *UU(db), const DBT *UU(key), const DBT *UU(old_val), const DBT *extra,
+           void (*set_val)(const DBT *new_val, void *set_extra), void *set_extra) {
+    set_val(extra, set_extra);
+    return 0;
+}
+
+static void test_open_errors(void) {
+    int r;
+    const char *fname = TOKU_TEST_FILENAME;
+    char vlog_fname[TOKU_PATH_MAX + 1];
+    snprintf(vlog_fname, sizeof vlog_fname, "%s.vlog", fname);
+    unlink(fname);
+    unlink(vlog_fname);
+
+    // a directory where the value log should go
+    r = toku_os_mkdir(vlog_fname, S_IRWXU);
+    assert(r == 0);
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    FT_HANDLE t;
+    toku_ft_handle_create(&t);
+    toku_ft_handle_set_value_log_threshold(t, threshold);
+    r = toku_ft_handle_open(t, fname, 1, 0, ct, null_txn);
+    assert(r != 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    r = rmdir(vlog_fname);
+    assert(r == 0);
+    unlink(fname);
+
+    // an existing dictionary whose value log is gone fails to open,
+    // instead of starting over with an empty one
+    toku_ft_handle_create(&t);
+    toku_ft_handle_set_value_log_threshold(t, threshold);
+    r = toku_ft_handle_open(t, fname, 1, 0, ct, null_txn);
+    assert(r == 0);
+    insert_row(t, 1, 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+    char moved_fname[TOKU_PATH_MAX + 1];
+    snprintf(moved_fname, sizeof moved_fname, "%s.moved", fname);
+    r = value_log::rename_with_dictionary(fname, moved_fname);
+    assert(r == 0);
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    toku_ft_handle_create(&t);
+    r = toku_ft_handle_open(t, fname, 0, 0, ct, null_txn);
+    assert(r == ENOENT);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+
+    // it opens again once the value log is back next to it
+    r = value_log::rename_with_dictionary(moved_fname, fname);
+    assert(r == 0);
+    toku_ft_handle_create(&t);
+    r = toku_ft_handle_open(t, fname, 0, 0, ct, null_txn);
+    assert(r == 0);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    unlink(fname);
+    r = value_log::unlink_with_dictionary(fname);
+    assert(r == 0);
+
+    // a dictionary without a value log has nothing to rename or delete
+    r = value_log::rename_with_dictionary(fname, moved_fname);
+    assert(r == 0);
+    r = value_log::unlink_with_dictionary(fname);
+    assert(r == 0);
+
+    // update functions would see the stored values
+    toku_ft_handle_create(&t);
+    toku_ft_handle_set_value_log_threshold(t, threshold);
+    toku_ft_set_update(t, update_fun);
+    r = toku_ft_handle_open(t, fname, 1, 0, ct, null_txn);
+    assert(r == EINVAL);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_value_log();
+    test_open_errors();
+    return 0;
+}
@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/log_header.h"
 #include "ft/logger/log-internal.h"
 #include "ft/txn/rollback-apply.h"
+#include "ft/serialize/value_log.h"
 #include "ft/txn/xids.h"
 
 // functionality provided by roll.c is exposed by an autogenerated
@@ -237,6 +238,11 @@ int toku_rollback_frename(BYTESTRING old_iname,
     if (!old_exist && !new_exist)
         assert(txn->for_recovery);
 
+    // the value log, if there is one, follows the dictionary back
+    if (value_log::rename_with_dictionary(new_iname_full.get(),
+                                          old_iname_full.get()) != 0)
+        return 1;
+
     CACHEFILE cf;
     int r = toku_cachefile_of_iname_in_env(cachetable, new_iname.data, &cf);
     if (r != ENOENT) {
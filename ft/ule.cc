@@ -738,6 +738,11 @@ static int64_t msg_modify_ule(ULE ule, const ft_msg &msg) {
     case FT_DELETE_ANY:
         retval = ule_apply_delete(ule, xids);
         break;
+    case FT_DELETE_RANGE:
+        // A range delete is not counted against the logical row count
+        // when it is injected, so each row it removes is counted here.
+        retval = ule_apply_delete(ule, xids) - 1;
+        break;
     case FT_ABORT_ANY:
     case FT_ABORT_BROADCAST_TXN:
         retval = ule_apply_abort(ule, xids);
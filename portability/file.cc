@@ -50,6 +50,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "memory.h"
 #include "toku_time.h"
 #include "toku_path.h"
+#include "toku_io_uring.h"
 #include <portability/toku_atomic.h>
 
 toku_instr_key *tokudb_file_data_key;
@@ -138,6 +139,10 @@ try_again_after_handling_write_error(int fd, size_t len, ssize_t r_write) {
     errno = errno_write;
 }
 
+void toku_os_handle_write_error(int fd, size_t len, ssize_t r_write) {
+    try_again_after_handling_write_error(fd, len, r_write);
+}
+
 static ssize_t (*t_write)(int, const void *, size_t);
 static ssize_t (*t_full_write)(int, const void *, size_t);
 static ssize_t (*t_pwrite)(int, const void *, size_t, off_t);
@@ -195,6 +200,34 @@ void toku_set_func_pread (ssize_t (*pread_fun)(int, void *, size_t, off_t)) {
     t_pread = pread_fun;
 }
 
+void toku_os_set_io_uring(bool enabled) {
+    toku_uring_set_enabled(enabled);
+}
+
+bool toku_os_io_uring_in_use(void) {
+    return toku_uring_enabled();
+}
+
+// Effect: Does a read or a write through io_uring, if it is in use.
+// Returns: false if it is not. Otherwise true, with what pread or pwrite
+//  would have returned in *r, and errno set like they set it.
+static bool uring_rw(int fd, bool is_write, void *buf, size_t len, off_t off, ssize_t *r) {
+    if (!toku_uring_enabled()) {
+        return false;
+    }
+    struct toku_uring_req req = { fd, is_write, buf, len, off, 0 };
+    if (!toku_uring_run(&req, 1)) {
+        return false;
+    }
+    if (req.result < 0) {
+        errno = -req.result;
+        *r = -1;
+    } else {
+        *r = req.result;
+    }
+    return true;
+}
+
 int toku_os_delete_with_source_location(const char *name,
                                         const char *src_file,
                                         uint src_line) {
@@ -256,7 +289,7 @@ void toku_os_full_write_with_source_location(int fd,
         ssize_t r;
         if (t_full_write) {
             r = t_full_write(fd, bp, len);
-        } else {
+        } else if (!uring_rw(fd, true, const_cast<char *>(bp), len, -1, &r)) {
             r = write(fd, bp, len);
         }
         if (r > 0) {
@@ -332,7 +365,7 @@ void toku_os_full_pwrite_with_source_location(int fd,
         ssize_t r;
         if (t_full_pwrite) {
             r = t_full_pwrite(fd, bp, len, off);
-        } else {
+        } else if (!uring_rw(fd, true, const_cast<char *>(bp), len, off, &r)) {
             r = pwrite(fd, bp, len, off);
         }
         if (r > 0) {
@@ -660,7 +693,7 @@ ssize_t inline_toku_os_pread_with_source_location(int fd,
                              src_line);
     if (t_pread) {
         bytes_read = t_pread(fd, buf, count, offset);
-    } else {
+    } else if (!uring_rw(fd, false, buf, count, offset, &bytes_read)) {
         bytes_read = pread(fd, buf, count, offset);
     }
     toku_instr_file_io_end(io_annotation, bytes_read);
@@ -668,6 +701,52 @@ ssize_t inline_toku_os_pread_with_source_location(int fd,
     return bytes_read;
 }
 
+void toku_os_pread_batch(int fd, int n, struct toku_os_pread_req *reqs) {
+    size_t count = 0;
+    for (int i = 0; i < n; i++) {
+        assert(0 == ((long long)reqs[i].buf) % 512);
+        assert(0 == reqs[i].count % 512);
+        assert(0 == reqs[i].offset % 512);
+        count += reqs[i].count;
+    }
+
+    toku_io_instrumentation io_annotation;
+    toku_instr_file_io_begin(io_annotation,
+                             toku_instr_file_op::file_read,
+                             fd,
+                             count,
+                             __FILE__,
+                             __LINE__);
+    bool done = false;
+    if (!t_pread && toku_uring_enabled()) {
+        struct toku_uring_req *XMALLOC_N(n, uring_reqs);
+        for (int i = 0; i < n; i++) {
+            uring_reqs[i] = { fd, false, reqs[i].buf, reqs[i].count, reqs[i].offset, 0 };
+        }
+        done = toku_uring_run(uring_reqs, n);
+        for (int i = 0; done && i < n; i++) {
+            if (uring_reqs[i].result < 0) {
+                errno = -uring_reqs[i].result;
+                reqs[i].bytes_read = -1;
+            } else {
+                reqs[i].bytes_read = uring_reqs[i].result;
+            }
+        }
+        toku_free(uring_reqs);
+    }
+    if (!done) {
+        for (int i = 0; i < n; i++) {
+            reqs[i].bytes_read = t_pread ? t_pread(fd, reqs[i].buf, reqs[i].count, reqs[i].offset)
+                                         : pread(fd, reqs[i].buf, reqs[i].count, reqs[i].offset);
+        }
+    }
+    ssize_t bytes_read = 0;
+    for (int i = 0; i < n; i++) {
+        bytes_read += reqs[i].bytes_read > 0 ? reqs[i].bytes_read : 0;
+    }
+    toku_instr_file_io_end(io_annotation, bytes_read);
+}
+
 void toku_os_recursive_delete(const char *path) {
     char buf[TOKU_PATH_MAX + sizeof("rm -rf ")];
     strcpy(buf, "rm -rf ");
@@ -0,0 +1,111 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+/* Verify that file I/O gives the same results with io_uring enabled, whether
+   or not the kernel lets us use it, including batches larger than a ring.  */
+#include <test.h>
+#include <fcntl.h>
+#include <toku_assert.h>
+#include <memory.h>
+#include <string.h>
+#include <stdio.h>
+#include <portability/toku_path.h>
+
+static const int n_blocks = 100;
+
+int test_main(int argc, char *const argv[]) {
+    int r;
+    toku_os_set_io_uring(true);
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        printf("io_uring %s\n", toku_os_io_uring_in_use() ? "in use" : "not available");
+    }
+
+    unlink(TOKU_TEST_FILENAME);
+    int fd = open(TOKU_TEST_FILENAME, O_RDWR | O_CREAT | O_BINARY, S_IRWXU|S_IRWXG|S_IRWXO);
+    assert(fd>=0);
+
+    // appending writes, then writes at an offset
+    char *XMALLOC_N_ALIGNED(512, 512, buf);
+    for (int i = 0; i < n_blocks / 2; i++) {
+        memset(buf, 'a' + i % 26, 512);
+        toku_os_full_write(fd, buf, 512);
+    }
+    for (int i = n_blocks / 2; i < n_blocks; i++) {
+        memset(buf, 'a' + i % 26, 512);
+        toku_os_full_pwrite(fd, buf, 512, i * 512);
+    }
+    int64_t fsize;
+    r = toku_os_get_file_size(fd, &fsize);
+    assert(r == 0);
+    assert(fsize == n_blocks * 512);
+
+    // single reads
+    for (int i = 0; i < n_blocks; i++) {
+        ssize_t rlen = toku_os_pread(fd, buf, 512, i * 512);
+        assert(rlen == 512);
+        for (int j = 0; j < 512; j++) {
+            assert(buf[j] == 'a' + i % 26);
+        }
+    }
+
+    // a batch of reads, the last of which is past the end of the file
+    struct toku_os_pread_req reqs[n_blocks + 1];
+    for (int i = 0; i <= n_blocks; i++) {
+        char *XMALLOC_N_ALIGNED(512, 512, block);
+        reqs[i].buf = block;
+        reqs[i].count = 512;
+        reqs[i].offset = (n_blocks - i) * 512;
+    }
+    toku_os_pread_batch(fd, n_blocks + 1, reqs);
+    assert(reqs[0].bytes_read == 0);
+    for (int i = 1; i <= n_blocks; i++) {
+        assert(reqs[i].bytes_read == 512);
+        for (int j = 0; j < 512; j++) {
+            assert(((char *) reqs[i].buf)[j] == 'a' + (n_blocks - i) % 26);
+        }
+    }
+    for (int i = 0; i <= n_blocks; i++) {
+        toku_free(reqs[i].buf);
+    }
+
+    toku_free(buf);
+    r = close(fd);
+    assert(r==0);
+    toku_os_set_io_uring(false);
+    return 0;
+}
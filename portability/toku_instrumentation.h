@@ -290,6 +290,7 @@ extern toku_instr_key *loader_fi_lock_mutex_key;
 extern toku_instr_key *loader_out_mutex_key;
 extern toku_instr_key *result_output_condition_lock_mutex_key;
 extern toku_instr_key *block_table_mutex_key;
+extern toku_instr_key *victim_cache_mutex_key;
 extern toku_instr_key *rollback_log_node_cache_mutex_key;
 extern toku_instr_key *txn_lock_mutex_key;
 extern toku_instr_key *txn_state_lock_mutex_key;
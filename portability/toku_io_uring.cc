@@ -0,0 +1,302 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <portability/toku_config.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include "memory.h"
+#include "toku_assert.h"
+#include "toku_io_uring.h"
+#include "toku_portability.h"
+#include "toku_pthread.h"
+#include "toku_race_tools.h"
+
+// io_uring was enabled with toku_uring_set_enabled
+static bool uring_enabled = false;
+// some thread failed to set up a ring, so the kernel does not support
+// io_uring or does not let us use it
+static bool uring_unavailable = false;
+
+bool toku_uring_enabled(void) {
+    return toku_unsafe_fetch(&uring_enabled) && !toku_unsafe_fetch(&uring_unavailable);
+}
+
+void toku_uring_set_enabled(bool enabled) {
+    toku_unsafe_set(&uring_enabled, enabled);
+}
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(HAVE_SYS_SYSCALL_H)
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// how many requests a ring keeps in flight at once
+static const unsigned uring_entries = 64;
+
+struct uring {
+    int fd;
+    bool tried_setup;
+    // whether an offset of -1 means the file's current position
+    bool rw_cur_pos;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+};
+
+static __thread struct uring thread_ring;
+
+// The thread_ring of a thread is torn down by the destructor of this key
+// when the thread exits.
+static pthread_key_t uring_destroy_key;
+static pthread_once_t uring_destroy_key_once = PTHREAD_ONCE_INIT;
+
+static void uring_destroy(struct uring *ring) {
+    if (ring->fd < 0) {
+        return;
+    }
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+    ring->fd = -1;
+}
+
+static void uring_destroy_at_thread_exit(void *ring) {
+    uring_destroy(static_cast<struct uring *>(ring));
+}
+
+static void uring_create_destroy_key(void) {
+    int r = pthread_key_create(&uring_destroy_key, uring_destroy_at_thread_exit);
+    assert_zero(r);
+}
+
+// Effect: Sets up the ring of the calling thread.
+// Returns: 0 on success, otherwise an errno.
+static int uring_setup(struct uring *ring) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof p);
+    int fd = syscall(__NR_io_uring_setup, uring_entries, &p);
+    if (fd < 0) {
+        return errno;
+    }
+
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && ring->cq_ring_size > ring->sq_ring_size) {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->sq_ring = mmap(nullptr, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        goto error_close;
+    }
+    if (single_mmap) {
+        ring->cq_ring = ring->sq_ring;
+        ring->cq_ring_size = ring->sq_ring_size;
+    } else {
+        ring->cq_ring = mmap(nullptr, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            goto error_unmap_sq;
+        }
+    }
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = static_cast<struct io_uring_sqe *>(
+        mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (ring->sqes == MAP_FAILED) {
+        goto error_unmap_cq;
+    }
+
+    {
+        char *sq = static_cast<char *>(ring->sq_ring);
+        char *cq = static_cast<char *>(ring->cq_ring);
+        ring->sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        ring->sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        ring->sq_mask = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        ring->sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        ring->cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        ring->cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        ring->cq_mask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<struct io_uring_cqe *>(cq + p.cq_off.cqes);
+    }
+    ring->rw_cur_pos = (p.features & IORING_FEAT_RW_CUR_POS) != 0;
+    ring->fd = fd;
+
+    pthread_once(&uring_destroy_key_once, uring_create_destroy_key);
+    pthread_setspecific(uring_destroy_key, ring);
+    return 0;
+
+error_unmap_cq:
+    if (!single_mmap) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+error_unmap_sq:
+    munmap(ring->sq_ring, ring->sq_ring_size);
+error_close:
+    int r = errno;
+    close(fd);
+    return r;
+}
+
+// Returns: the ring of the calling thread, set up if need be, or NULL if
+//  io_uring cannot be used.
+static struct uring *uring_get(void) {
+    struct uring *ring = &thread_ring;
+    if (!ring->tried_setup) {
+        ring->tried_setup = true;
+        ring->fd = -1;
+        if (uring_setup(ring) != 0) {
+            toku_unsafe_set(&uring_unavailable, true);
+        }
+    }
+    return ring->fd < 0 ? nullptr : ring;
+}
+
+bool toku_uring_run(struct toku_uring_req *reqs, int n) {
+    if (!toku_uring_enabled()) {
+        return false;
+    }
+    struct uring *ring = uring_get();
+    if (ring == nullptr) {
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        if (reqs[i].off < 0 && !ring->rw_cur_pos) {
+            return false;
+        }
+    }
+
+    // requests can complete out of order, so each one needs an iovec of
+    // its own for as long as it is in flight
+    struct iovec stack_iovs[uring_entries];
+    struct iovec *iovs = stack_iovs;
+    if (n > (int) uring_entries) {
+        XMALLOC_N(n, iovs);
+    }
+    int next = 0;
+    int done = 0;
+    while (done < n) {
+        // fill the submission queue with as many requests as fit
+        unsigned to_submit = 0;
+        unsigned tail = *ring->sq_tail;
+        const unsigned in_flight = next - done;
+        while (next < n && in_flight + to_submit < uring_entries) {
+            const unsigned index = tail & *ring->sq_mask;
+            struct io_uring_sqe *sqe = &ring->sqes[index];
+            struct iovec *iov = &iovs[next];
+            iov->iov_base = reqs[next].buf;
+            iov->iov_len = reqs[next].len;
+            memset(sqe, 0, sizeof *sqe);
+            sqe->opcode = reqs[next].write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->fd = reqs[next].fd;
+            sqe->off = reqs[next].off;
+            sqe->addr = reinterpret_cast<uint64_t>(iov);
+            sqe->len = 1;
+            sqe->user_data = next;
+            ring->sq_array[index] = index;
+            tail++;
+            next++;
+            to_submit++;
+        }
+        __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+        // submit them and wait for at least one completion
+        int r;
+        do {
+            r = syscall(__NR_io_uring_enter, ring->fd, to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0 && done == 0 && next == (int) to_submit) {
+            // the kernel took none of them, so give up on io_uring
+            // and let the caller fall back
+            __atomic_store_n(ring->sq_tail, tail - to_submit, __ATOMIC_RELEASE);
+            toku_unsafe_set(&uring_unavailable, true);
+            if (iovs != stack_iovs) {
+                toku_free(iovs);
+            }
+            return false;
+        }
+        assert(r >= 0);
+        if ((unsigned) r < to_submit) {
+            // the rest get submitted by the next call
+            next -= to_submit - r;
+            __atomic_store_n(ring->sq_tail, tail - (to_submit - r), __ATOMIC_RELEASE);
+        }
+
+        // reap the completions
+        unsigned head = *ring->cq_head;
+        while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            reqs[cqe->user_data].result = cqe->res;
+            head++;
+            done++;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+    if (iovs != stack_iovs) {
+        toku_free(iovs);
+    }
+    return true;
+}
+
+#else
+
+bool toku_uring_run(struct toku_uring_req *UU(reqs), int UU(n)) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#pragma once
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+// An io_uring backend for file I/O, used by the toku_os_* wrappers in
+// file.cc when it is enabled with toku_os_set_io_uring and the kernel
+// supports it. Each thread gets a ring of its own the first time it does
+// I/O through it, so that several requests can be in flight at once
+// without a thread per request. When io_uring cannot be used, the
+// functions below return false without doing anything, and the caller
+// falls back to the usual system calls.
+
+struct toku_uring_req {
+    int fd;
+    bool write;
+    void *buf;
+    size_t len;
+    off_t off;      // -1 means the file's current position, for writes
+    ssize_t result; // bytes transferred, or -errno
+};
+
+// Returns: true if io_uring is enabled and has not failed to set up a ring.
+bool toku_uring_enabled(void);
+
+void toku_uring_set_enabled(bool enabled);
+
+// Effect: Submits the n requests and waits for all of them to complete.
+// Returns: false if io_uring could not be used, in which case none of the
+//  requests were run.
+bool toku_uring_run(struct toku_uring_req *reqs, int n);
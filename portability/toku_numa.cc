@@ -0,0 +1,153 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <portability/toku_config.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "toku_os.h"
+
+// The NUMA topology is read from sysfs rather than through libnuma, so
+// that it costs no extra dependency. Machines without it have node 0 only.
+
+#if defined(__linux__)
+
+// the most NUMA nodes we keep track of
+static const int NUMA_MAX_NODES = 64;
+
+static int numa_num_nodes = 1;
+static uint8_t numa_node_of_cpu[CPU_SETSIZE];
+static cpu_set_t numa_node_cpus[NUMA_MAX_NODES];
+static pthread_once_t numa_topology_once = PTHREAD_ONCE_INIT;
+
+// Adds the processors of a sysfs cpu list such as "0-3,8-11" to set.
+static void numa_parse_cpulist(char *list, cpu_set_t *set) {
+    char *p = list;
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, set);
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+}
+
+static void numa_read_topology(void) {
+    int max_node = 0;
+    for (int node = 0; node < NUMA_MAX_NODES; node++) {
+        CPU_ZERO(&numa_node_cpus[node]);
+        char path[64];
+        snprintf(path, sizeof path, "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *f = fopen(path, "r");
+        if (f == nullptr) {
+            continue;
+        }
+        char list[4096];
+        if (fgets(list, sizeof list, f) != nullptr) {
+            numa_parse_cpulist(list, &numa_node_cpus[node]);
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &numa_node_cpus[node])) {
+                    numa_node_of_cpu[cpu] = node;
+                }
+            }
+            max_node = node;
+        }
+        fclose(f);
+    }
+    numa_num_nodes = max_node + 1;
+}
+
+int toku_os_numa_num_nodes(void) {
+    pthread_once(&numa_topology_once, numa_read_topology);
+    return numa_num_nodes;
+}
+
+int toku_os_numa_current_node(void) {
+    pthread_once(&numa_topology_once, numa_read_topology);
+#if defined(HAVE_SCHED_GETCPU)
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        return numa_node_of_cpu[cpu];
+    }
+#endif
+    return 0;
+}
+
+int toku_os_numa_bind_thread(int node) {
+    pthread_once(&numa_topology_once, numa_read_topology);
+    if (node < 0 || node >= numa_num_nodes || CPU_COUNT(&numa_node_cpus[node]) == 0) {
+        return EINVAL;
+    }
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP)
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &numa_node_cpus[node]);
+#else
+    return ENOSYS;
+#endif
+}
+
+#else
+
+int toku_os_numa_num_nodes(void) {
+    return 1;
+}
+
+int toku_os_numa_current_node(void) {
+    return 0;
+}
+
+int toku_os_numa_bind_thread(int node) {
+    return node == 0 ? 0 : EINVAL;
+}
+
+#endif
@@ -56,6 +56,16 @@ int toku_os_get_number_processors(void);
 // Returns: the number of active processors in the system
 int toku_os_get_number_active_processors(void);
 
+// Returns: the number of NUMA nodes in the system, 1 if it has no NUMA information
+int toku_os_numa_num_nodes(void);
+
+// Returns: the NUMA node of the processor the calling thread runs on
+int toku_os_numa_current_node(void);
+
+// Restricts the calling thread to the processors of the given NUMA node
+// Returns: 0 on success
+int toku_os_numa_bind_thread(int node);
+
 // Returns: the system page size (in bytes)
 int toku_os_get_pagesize(void);
 
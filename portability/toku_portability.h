@@ -264,6 +264,29 @@ size_t os_malloc_usable_size(const void *p) __attribute__((__visibility__("defau
 // full_pwrite and full_write performs a pwrite, and checks errors.  It doesn't return unless all the data was written. */
 void toku_os_full_pwrite (int fd, const void *buf, size_t len, toku_off_t off) __attribute__((__visibility__("default")));
 void toku_os_full_write (int fd, const void *buf, size_t len) __attribute__((__visibility__("default")));
+// Effect: Handles a failed write of len bytes to fd the way full_pwrite and
+//  full_write do, so that the caller can try the write again: waits out
+//  ENOSPC, reports EINTR, and asserts on any other error.
+// Requires: r_write < 0 and errno is still set from the write.
+void toku_os_handle_write_error (int fd, size_t len, ssize_t r_write) __attribute__((__visibility__("default")));
+
+// Effect: Makes the reads and writes below go through io_uring when the kernel
+//  supports it, or back to ordinary system calls. Off by default.
+void toku_os_set_io_uring(bool enabled) __attribute__((__visibility__("default")));
+// Returns: true if io_uring is enabled and usable.
+bool toku_os_io_uring_in_use(void) __attribute__((__visibility__("default")));
+
+// A read for toku_os_pread_batch.
+struct toku_os_pread_req {
+    void *buf;
+    size_t count;
+    toku_off_t offset;
+    ssize_t bytes_read; // set by toku_os_pread_batch, -1 on error
+};
+
+// Effect: Performs n preads of fd, with all of them in flight at once when
+//  io_uring is in use. Each has the same requirements as toku_os_pread.
+void toku_os_pread_batch(int fd, int n, struct toku_os_pread_req *reqs) __attribute__((__visibility__("default")));
 
 // os_write returns 0 on success, otherwise an errno.
 ssize_t toku_os_pwrite (int fd, const void *buf, size_t len, toku_off_t off) __attribute__((__visibility__("default")));
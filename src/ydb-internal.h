@@ -101,6 +101,7 @@ struct __toku_db_env_internal {
     unsigned long client_pool_threads;
     unsigned long cachetable_pool_threads;
     unsigned long checkpoint_pool_threads;
+    bool cachetable_numa;
     CACHETABLE cachetable;
     TOKULOGGER logger;
     toku::locktree_manager ltm;
@@ -986,6 +986,7 @@ env_open(DB_ENV * env, const char *home, uint32_t flags, int mode) {
                                    env->i->client_pool_threads,
                                    env->i->cachetable_pool_threads,
                                    env->i->checkpoint_pool_threads,
+                                   env->i->cachetable_numa,
                                    ZERO_LSN, env->i->logger);
         if (r != 0) {
             r = toku_ydb_do_error(env, r, "Cant create a cachetable\n");
@@ -1298,6 +1299,16 @@ env_set_checkpoint_pool_threads(DB_ENV * env, uint32_t threads) {
     return 0;
 }
 
+static int
+env_set_cachetable_numa(DB_ENV * env, bool numa) {
+    HANDLE_PANICKED_ENV(env);
+    if (env_opened(env)) {
+        return EINVAL;
+    }
+    env->i->cachetable_numa = numa;
+    return 0;
+}
+
 static void
 env_set_check_thp(DB_ENV * env, bool new_val) {
     assert(env);
@@ -1825,6 +1836,24 @@ env_checkpointing_get_period(DB_ENV * env, uint32_t *seconds) {
     return r;
 }
 
+static int
+env_checkpointing_set_paced(DB_ENV * env, bool paced) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else toku_set_checkpoint_paced(env->i->cachetable, paced);
+    return r;
+}
+
+static int
+env_checkpointing_get_paced(DB_ENV * env, bool *paced) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else *paced = toku_get_checkpoint_paced(env->i->cachetable);
+    return r;
+}
+
 static int
 env_cleaner_get_period(DB_ENV * env, uint32_t *seconds) {
     HANDLE_PANICKED_ENV(env);
@@ -1845,6 +1874,42 @@ env_cleaner_get_iterations(DB_ENV * env, uint32_t *iterations) {
     return r;
 }
 
+static int
+env_cleaner_set_adaptive(DB_ENV * env, bool adaptive) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else toku_set_cleaner_adaptive(env->i->cachetable, adaptive);
+    return r;
+}
+
+static int
+env_cleaner_get_adaptive(DB_ENV * env, bool *adaptive) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else *adaptive = toku_get_cleaner_adaptive(env->i->cachetable);
+    return r;
+}
+
+static int
+env_cleaner_set_max_threads(DB_ENV * env, uint32_t max_threads) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env) || max_threads == 0) r = EINVAL;
+    else toku_set_cleaner_max_threads(env->i->cachetable, max_threads);
+    return r;
+}
+
+static int
+env_cleaner_get_max_threads(DB_ENV * env, uint32_t *max_threads) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else *max_threads = toku_get_cleaner_max_threads(env->i->cachetable);
+    return r;
+}
+
 static int
 env_evictor_set_enable_partial_eviction(DB_ENV* env, bool enabled) {
     HANDLE_PANICKED_ENV(env);
@@ -1863,6 +1928,25 @@ env_evictor_get_enable_partial_eviction(DB_ENV* env, bool *enabled) {
     return r;
 }
 
+static int
+env_evictor_set_replacement_policy(DB_ENV* env, toku_cachetable_policy policy) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else if (policy != TOKU_CACHETABLE_POLICY_CLOCK && policy != TOKU_CACHETABLE_POLICY_2Q) r = EINVAL;
+    else toku_set_replacement_policy(env->i->cachetable, policy);
+    return r;
+}
+
+static int
+env_evictor_get_replacement_policy(DB_ENV* env, toku_cachetable_policy *policy) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else *policy = toku_get_replacement_policy(env->i->cachetable);
+    return r;
+}
+
 static int
 env_checkpointing_postpone(DB_ENV * env) {
     HANDLE_PANICKED_ENV(env);
@@ -2845,16 +2929,25 @@ toku_env_create(DB_ENV ** envp, uint32_t flags) {
     USENV(set_data_dir);
     USENV(checkpointing_set_period);
     USENV(checkpointing_get_period);
+    USENV(checkpointing_set_paced);
+    USENV(checkpointing_get_paced);
     USENV(cleaner_set_period);
     USENV(cleaner_get_period);
     USENV(cleaner_set_iterations);
     USENV(cleaner_get_iterations);
+    USENV(cleaner_set_adaptive);
+    USENV(cleaner_get_adaptive);
+    USENV(cleaner_set_max_threads);
+    USENV(cleaner_get_max_threads);
     USENV(evictor_set_enable_partial_eviction);
     USENV(evictor_get_enable_partial_eviction);
+    USENV(evictor_set_replacement_policy);
+    USENV(evictor_get_replacement_policy);
     USENV(set_cachesize);
     USENV(set_client_pool_threads);
     USENV(set_cachetable_pool_threads);
     USENV(set_checkpoint_pool_threads);
+    USENV(set_cachetable_numa);
 #if DB_VERSION_MAJOR == 4 && DB_VERSION_MINOR >= 3
     USENV(get_cachesize);
 #endif
@@ -47,6 +47,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <ft/ft-flusher.h>
 #include <ft/logger/recover.h>
 #include <ft/loader/loader.h>
+#include <ft/serialize/victim_cache.h>
 
 #include "ydb_env_func.h"
 
@@ -68,6 +69,14 @@ void db_env_set_compress_buffers_before_eviction (bool compress_buffers) {
     toku_ft_set_compress_buffers_before_eviction(compress_buffers);
 }
 
+void db_env_set_victim_cache_size (uint64_t size) {
+    toku_victim_cache_set_size_limit(size);
+}
+
+void db_env_set_io_uring (bool io_uring_on) {
+    toku_os_set_io_uring(io_uring_on);
+}
+
 void db_env_set_func_fsync (int (*fsync_function)(int)) {
     toku_set_func_fsync(fsync_function);
 }
@@ -629,12 +629,21 @@ do_put_multiple(DB_TXN *txn, uint32_t num_dbs, DB *db_array[], DBT_ARRAY keys[],
                 toku_indexer_update_estimate(indexer);
             }
             if (do_put) {
+                int flags = 0;
+                if (remaining_flags != nullptr) {
+                    flags = remaining_flags[which_db];
+                    invariant(!(flags & DB_NOOVERWRITE_NO_ERROR));
+                }
+                if (flags == 0 && keys[which_db].size > 1) {
+                    // No uniqueness checks, so all of this db's rows can
+                    // go through the root together.
+                    TOKUTXN ttxn = txn ? db_txn_struct_i(txn)->tokutxn : nullptr;
+                    toku_ft_maybe_insert_batch(db->i->ft_handle, keys[which_db].size,
+                                               keys[which_db].dbts, vals[which_db].dbts,
+                                               ttxn, false, ZERO_LSN, false, FT_INSERT);
+                    continue;
+                }
                 for (uint32_t i = 0; i < keys[which_db].size; i++) {
-                    int flags = 0;
-                    if (remaining_flags != nullptr) {
-                        flags = remaining_flags[which_db];
-                        invariant(!(flags & DB_NOOVERWRITE_NO_ERROR));
-                    }
                     r = db_put(db, txn, &keys[which_db].dbts[i], &vals[which_db].dbts[i], flags, false);
                     if (r != 0) {
                         goto done;
@@ -240,13 +240,13 @@ static int countNodes(NMC *level){
 }
 
 static int * countMessages(NMC *level){
-    int *counts=new int[16];
-    for(int i=0;i<16;i++){
+    int *counts=new int[17];
+    for(int i=0;i<17;i++){
         counts[i]=0;
     }
     NMC *ptr=level;
     while(ptr!=NULL){
-        for(int i=0;i<16;i++){
+        for(int i=0;i<17;i++){
             counts[i]+=ptr->count[i];
         }
         ptr=ptr->nextNode;
@@ -268,7 +268,7 @@ static NMC * getLast(NMC *level){
  */
 static int  printLevelSTDout(int *count){
     int isEmpty=0;
-    for(int j=0;j<16;j++){
+    for(int j=0;j<17;j++){
         if(count[j]>0){
             cout <<count[j]<<" ";
             isEmpty++;
@@ -285,6 +285,7 @@ static int  printLevelSTDout(int *count){
                 case FT_OPTIMIZE_FOR_UPGRADE: cout <<"OPTIMIZE_FOR_UPGRADE(s) ";  break;
                 case FT_UPDATE:   cout <<"UPDATE(s) ";  break;
                 case FT_UPDATE_BROADCAST_ALL: cout <<"UPDATE_BROADCAST_ALL(s) ";  break;
+                case FT_DELETE_RANGE: cout <<"DELETE_RANGE(s) ";  break;
             }
 
         }
@@ -297,7 +298,7 @@ static int  printLevelSTDout(int *count){
  */
 static int  printNodeMessagesToSTDout(NMC *ptr){
     cout <<"\nNode :"<<ptr->id<<" has :";
-        for(int j=0;j<16;j++){
+        for(int j=0;j<17;j++){
         if(ptr->count[j]>0){
             cout <<ptr->count[j]<<" ";
             switch (j)   {
@@ -313,6 +314,7 @@ static int  printNodeMessagesToSTDout(NMC *ptr){
                 case FT_OPTIMIZE_FOR_UPGRADE: cout <<"OPTIMIZE_FOR_UPGRADE(s) ";  break;
                 case FT_UPDATE:   cout <<"UPDATE(s) ";  break;
                 case FT_UPDATE_BROADCAST_ALL: cout <<"UPDATE_BROADCAST_ALL(s) ";  break;
+                case FT_DELETE_RANGE: cout <<"DELETE_RANGE(s) ";  break;
             }
         }
     }
@@ -362,8 +364,8 @@ static void  countMessagesInFT(int fd, BLOCKNUM blocknum, FT ft,NMC *msgs[]){
         last=last->nextNode;
     }
     last->id=blocknum.b;
-    last->count=new int[16];
-    for(int i=0;i<16;i++){
+    last->count=new int[17];
+    for(int i=0;i<17;i++){
         last->count[i]=0;
     }
     last->clean=0;
@@ -375,8 +377,8 @@ static void  countMessagesInFT(int fd, BLOCKNUM blocknum, FT ft,NMC *msgs[]){
     }
     for(int i=0;i<n->n_children;i++){
         NONLEAF_CHILDINFO bnc = BNC(n, i);
-        if (n->height==1 && n->bp[i].ptr.tag==BCT_NULL){
-            cout <<n->bp[i].ptr.tag;
+        if (n->height==1 && n->bp[i].tag==BCT_NULL){
+            cout <<static_cast<int>(n->bp[i].tag);
         }
         auto dump_fn=[&](const ft_msg &msg, bool UU(is_fresh)) {
             enum ft_msg_type type = (enum ft_msg_type) msg.type();
@@ -482,6 +484,7 @@ static void dump_node(int fd, BLOCKNUM blocknum, FT ft) {
                             case FT_OPTIMIZE_FOR_UPGRADE: printf("OPTIMIZE_FOR_UPGRADE"); goto ok;
                             case FT_UPDATE:   printf("UPDATE"); goto ok;
                             case FT_UPDATE_BROADCAST_ALL: printf("UPDATE_BROADCAST_ALL"); goto ok;
+                            case FT_DELETE_RANGE: printf("DELETE_RANGE"); goto ok;
                         }
                         printf("HUH?");
 ok:
@@ -924,7 +927,7 @@ static void writeJson(NMC *msgs[],int height,const char *name){
                 mytree <<"{\"ID\":\""<< ptr->id<<"\",";
                 if(ptr->clean!=0){
                     mytree <<"\"Messages\":[";
-                    for(int j=0;j<16;j++)
+                    for(int j=0;j<17;j++)
                         {
                         mytree <<"{";
                         switch (j)   {
@@ -940,9 +943,10 @@ static void writeJson(NMC *msgs[],int height,const char *name){
                             case FT_OPTIMIZE_FOR_UPGRADE: mytree <<"\"OPTIMIZE_FOR_UPGRADE\":\""<<ptr->count[j]<<"\"";break;
                             case FT_UPDATE:   mytree <<"\"UPDATE\":\""<<ptr->count[j]<<"\""; break;
                             case FT_UPDATE_BROADCAST_ALL: mytree <<"\"UPDATE_BROADCAST_ALL\":\""<<ptr->count[j]<<"\""; break;
+                            case FT_DELETE_RANGE: mytree <<"\"DELETE_RANGE\":\""<<ptr->count[j]<<"\""; break;
                         }
                         mytree <<"}";
-                        if(j<15)mytree<<",";
+                        if(j<16)mytree<<",";
                     }
 
                     mytree <<"]}";
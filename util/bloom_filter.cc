@@ -0,0 +1,163 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <string.h>
+
+#include "portability/memory.h"
+#include "portability/toku_assert.h"
+
+#include "util/bloom_filter.h"
+
+namespace toku {
+
+void bloom_filter::create(uint32_t capacity, uint32_t bits_per_key) {
+    paranoid_invariant(bits_per_key > 0);
+    _capacity = capacity;
+    _bits_per_key = bits_per_key;
+    _num_keys = 0;
+
+    // k = ln(2) * m/n minimizes the false positive rate, and more than a
+    // dozen probes buys nothing at the sizes we use.
+    _num_probes = (bits_per_key * 69 + 50) / 100;
+    if (_num_probes < 1) {
+        _num_probes = 1;
+    } else if (_num_probes > 12) {
+        _num_probes = 12;
+    }
+
+    const uint64_t bits = static_cast<uint64_t>(capacity) * bits_per_key;
+    _num_blocks = (bits + BLOCK_BITS - 1) / BLOCK_BITS;
+    if (_num_blocks == 0) {
+        _num_blocks = 1;
+    }
+    XMALLOC_N_ALIGNED(64, _num_blocks * BLOCK_WORDS, _blocks);
+    memset(_blocks, 0, _num_blocks * BLOCK_WORDS * sizeof(*_blocks));
+}
+
+void bloom_filter::clone(const bloom_filter &orig) {
+    _num_blocks = orig._num_blocks;
+    _num_probes = orig._num_probes;
+    _bits_per_key = orig._bits_per_key;
+    _num_keys = orig._num_keys;
+    _capacity = orig._capacity;
+    XMALLOC_N_ALIGNED(64, _num_blocks * BLOCK_WORDS, _blocks);
+    memcpy(_blocks, orig._blocks, _num_blocks * BLOCK_WORDS * sizeof(*_blocks));
+}
+
+void bloom_filter::destroy(void) {
+    toku_free(_blocks);
+    _blocks = nullptr;
+    _num_blocks = 0;
+    _num_keys = 0;
+    _capacity = 0;
+}
+
+size_t bloom_filter::memory_size(void) const {
+    return _num_blocks * BLOCK_WORDS * sizeof(*_blocks);
+}
+
+// MurmurHash64A.  The filter needs a well mixed 64 bit value: the high
+// half picks the block and the low half seeds the probes.
+uint64_t bloom_filter::hash(const void *key, uint32_t keylen) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t h = 0x8445d61a4e774912ULL ^ (keylen * m);
+
+    const unsigned char *data = static_cast<const unsigned char *>(key);
+    const unsigned char *end = data + (keylen & ~7U);
+    for (; data != end; data += 8) {
+        uint64_t k;
+        memcpy(&k, data, sizeof k);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (keylen & 7) {
+    case 7: h ^= static_cast<uint64_t>(data[6]) << 48; // fall through
+    case 6: h ^= static_cast<uint64_t>(data[5]) << 40; // fall through
+    case 5: h ^= static_cast<uint64_t>(data[4]) << 32; // fall through
+    case 4: h ^= static_cast<uint64_t>(data[3]) << 24; // fall through
+    case 3: h ^= static_cast<uint64_t>(data[2]) << 16; // fall through
+    case 2: h ^= static_cast<uint64_t>(data[1]) << 8;  // fall through
+    case 1: h ^= static_cast<uint64_t>(data[0]);
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+uint64_t *bloom_filter::block_for(uint64_t h) const {
+    const uint64_t b = ((h >> 32) * _num_blocks) >> 32;
+    return &_blocks[b * BLOCK_WORDS];
+}
+
+void bloom_filter::add(const void *key, uint32_t keylen) {
+    const uint64_t h = hash(key, keylen);
+    uint64_t *block = block_for(h);
+    uint32_t probe = static_cast<uint32_t>(h);
+    const uint32_t delta = (probe >> 17) | (probe << 15) | 1;
+    for (uint32_t i = 0; i < _num_probes; i++) {
+        const uint32_t bit = probe % BLOCK_BITS;
+        block[bit / 64] |= 1ULL << (bit % 64);
+        probe += delta;
+    }
+    _num_keys++;
+}
+
+bool bloom_filter::may_contain(const void *key, uint32_t keylen) const {
+    const uint64_t h = hash(key, keylen);
+    const uint64_t *block = block_for(h);
+    uint32_t probe = static_cast<uint32_t>(h);
+    const uint32_t delta = (probe >> 17) | (probe << 15) | 1;
+    for (uint32_t i = 0; i < _num_probes; i++) {
+        const uint32_t bit = probe % BLOCK_BITS;
+        if ((block[bit / 64] & (1ULL << (bit % 64))) == 0) {
+            return false;
+        }
+        probe += delta;
+    }
+    return true;
+}
+
+} // namespace toku
@@ -0,0 +1,111 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace toku {
+
+/*
+ * A bloom_filter answers "might this key be in the set?" with no false
+ * negatives and a false positive rate that depends on the number of bits
+ * spent per key.
+ *
+ * The filter is blocked: every key hashes to a single 64 byte block and
+ * all of its probe bits live in that block, so a lookup touches one cache
+ * line no matter how many probes are used.  Keys are hashed as plain bytes,
+ * so a filter is only meaningful for sets whose equality is byte equality.
+ */
+class bloom_filter {
+public:
+    bloom_filter() :
+        _blocks(nullptr), _num_blocks(0), _num_probes(0),
+        _bits_per_key(0), _num_keys(0), _capacity(0) {
+    }
+
+    // Effect: Create an empty filter sized for capacity keys at
+    //         bits_per_key bits each.
+    // Requires: bits_per_key > 0
+    void create(uint32_t capacity, uint32_t bits_per_key);
+
+    // Effect: Create this filter as a copy of orig.
+    void clone(const bloom_filter &orig);
+
+    void destroy(void);
+
+    // Effect: Add a key to the set.
+    //         Adding more than capacity() keys is allowed but raises the
+    //         false positive rate; callers should rebuild past that point.
+    void add(const void *key, uint32_t keylen);
+
+    // Returns: false if the key was certainly never added,
+    //          true if it may have been.
+    bool may_contain(const void *key, uint32_t keylen) const;
+
+    // Returns: the number of keys added since create()
+    uint32_t num_keys(void) const { return _num_keys; }
+
+    // Returns: the number of keys the filter was sized for
+    uint32_t capacity(void) const { return _capacity; }
+
+    uint32_t bits_per_key(void) const { return _bits_per_key; }
+
+    // Returns: the number of bytes of heap used by the filter
+    size_t memory_size(void) const;
+
+    static uint64_t hash(const void *key, uint32_t keylen);
+
+private:
+    static const uint32_t BLOCK_WORDS = 8;
+    static const uint32_t BLOCK_BITS = BLOCK_WORDS * 64;
+
+    uint64_t *block_for(uint64_t h) const;
+
+    uint64_t *_blocks;
+    uint32_t _num_blocks;
+    uint32_t _num_probes;
+    uint32_t _bits_per_key;
+    uint32_t _num_keys;
+    uint32_t _capacity;
+
+    friend class bloom_filter_unit_test;
+};
+
+} // namespace toku
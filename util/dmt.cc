@@ -98,11 +98,21 @@ void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::create_from_sorted_memory_of_fix
 }
 
 template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
-void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::clone(const dmt &src) {
+void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::clone(dmt &src) {
     *this = src;
     toku_mempool_clone(&src.mp, &this->mp);
 }
 
+template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
+void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::unshare(void) {
+    toku_mempool_unshare(&this->mp);
+}
+
+template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
+size_t dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::shared_memory_size(void) const {
+    return toku_mempool_is_shared(&this->mp) ? toku_mempool_get_size(&this->mp) : 0;
+}
+
 template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
 void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::clear(void) {
     this->is_array = true;
@@ -116,8 +126,9 @@ void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::clear(void) {
 
 template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
 void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::destroy(void) {
-    this->clear();
+    // Destroy the mempool first so clear() does not reset memory still shared with a clone.
     toku_mempool_destroy(&this->mp);
+    this->clear();
 }
 
 template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
@@ -171,6 +182,8 @@ int dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::insert_at(const dmtwriter_t &valu
     }
     // Is a tree.
     paranoid_invariant(!is_array);
+    // Appending to an array leaves what a clone sees alone, but tree nodes are updated in place.
+    this->unshare();
     if (!same_size) {
         this->values_same_size = false;
         this->value_length = 0;
@@ -350,6 +363,7 @@ int dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::delete_at(const uint32_t idx) {
         this->convert_from_array_to_tree();
     }
     paranoid_invariant(!is_array);
+    this->unshare();
 
     subtree *rebalance_subtree = nullptr;
     this->delete_internal(&this->d.t.root, idx, nullptr, &rebalance_subtree);
@@ -451,6 +465,7 @@ template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
 template<typename iterate_extra_t,
          int (*f)(const uint32_t, dmtdata_t *, const uint32_t, iterate_extra_t *const)>
 void dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::iterate_ptr(iterate_extra_t *const iterate_extra) {
+    this->unshare();
     if (this->is_array) {
         this->iterate_ptr_internal_array<iterate_extra_t, f>(0, this->size(), iterate_extra);
     } else {
@@ -485,6 +500,18 @@ int dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::find_zero(const dmtcmp_t &extra,
     return r;
 }
 
+template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
+template<typename dmtcmp_t,
+         int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
+int dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::find_zero_fixed(const dmtcmp_t &extra, uint32_t *const value_len, dmtdataout_t *const value, uint32_t *const idxp) const {
+    if (!this->is_array) {
+        return this->find_zero<dmtcmp_t, h>(extra, value_len, value, idxp);
+    }
+    uint32_t tmp_index;
+    uint32_t *const child_idxp = (idxp != nullptr) ? idxp : &tmp_index;
+    return this->find_internal_zero_array_branchless<dmtcmp_t, h>(extra, value_len, value, child_idxp);
+}
+
 template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
 template<typename dmtcmp_t,
          int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
@@ -972,6 +999,52 @@ int dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::find_internal_zero(const subtree
     }
 }
 
+template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
+template<typename dmtcmp_t,
+         int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
+int dmt<dmtdata_t, dmtdataout_t, dmtwriter_t>::find_internal_zero_array_branchless(const dmtcmp_t &extra, uint32_t *const value_len, dmtdataout_t *const value, uint32_t *const idxp) const {
+    paranoid_invariant_notnull(idxp);
+    const uint32_t num_values = this->d.a.num_values;
+    if (num_values == 0) {
+        *idxp = 0;
+        return DB_NOTFOUND;
+    }
+    // Every value is value_length bytes at a fixed stride from the start of
+    // the mempool, so compute probe addresses directly.
+    const char *const values = reinterpret_cast<const char *>(get_array_value(0));
+    const size_t stride = align(this->value_length);
+    // The first value with h >= 0 is in [base, base + len], where
+    // base + len means past every value in the range.
+    uint32_t base = 0;
+    uint32_t len = num_values;
+    while (len > 1) {
+        const uint32_t half = len / 2;
+        const uint32_t next_half = (len - half) / 2;
+        // whichever way this probe goes, the next one is one of these
+        __builtin_prefetch(values + (base + next_half) * stride);
+        __builtin_prefetch(values + (base + half + next_half) * stride);
+        const dmtdata_t *const v = reinterpret_cast<const dmtdata_t *>(values + (base + half) * stride);
+        const int hv = h(this->value_length, *v, extra);
+        base += (hv < 0) ? half : 0;
+        len -= half;
+    }
+    int hv = h(this->value_length, *get_array_value(base), extra);
+    if (hv < 0) {
+        base++;
+        if (base == num_values) {
+            *idxp = num_values;
+            return DB_NOTFOUND;
+        }
+        hv = h(this->value_length, *get_array_value(base), extra);
+    }
+    *idxp = base;
+    if (hv != 0) {
+        return DB_NOTFOUND;
+    }
+    copyout(value_len, value, this->value_length, get_array_value(base));
+    return 0;
+}
+
 template<typename dmtdata_t, typename dmtdataout_t, typename dmtwriter_t>
 template<typename dmtcmp_t,
          int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
@@ -215,10 +215,23 @@ public:
      * Effect: Creates a copy of an dmt.
      *  Creates this as the clone.
      *  Each element is copied directly.  If they are pointers, the underlying data is not duplicated.
-     * Performance: O(memory) (essentially a memdup)
-     *  The underlying structures are memcpy'd.  Only the values themselves are copied (shallow copy)
+     *  The clone shares src's memory copy-on-write: whichever of the two first modifies
+     *  its values in place takes a private copy then (see ::unshare()).
+     * Performance: O(1)
      */
-    void clone(const dmt &src);
+    void clone(dmt &src);
+
+    /**
+     * Effect: Makes sure no clone shares this dmt's memory, so that values returned
+     *  by fetch() may be modified in place.
+     * Performance: O(memory) if the memory is still shared, O(1) otherwise
+     */
+    void unshare(void);
+
+    /**
+     * Effect: Return how much of memory_size() is shared with a clone.
+     */
+    size_t shared_memory_size(void) const;
 
     /**
      * Effect: Set the tree to be empty.
@@ -391,6 +404,22 @@ public:
              int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
     int find_zero(const dmtcmp_t &extra, uint32_t *const value_size, dmtdataout_t *const value, uint32_t *const idxp) const;
 
+    /**
+     * Effect:  Same as find_zero.
+     *  If this dmt is in array form (all values the same length), the values
+     *  are searched without branching on the result of h: every search makes
+     *  the same number of probes, and both candidates for the next probe are
+     *  prefetched while the current one is compared.
+     *  Otherwise this is find_zero.
+     * Rationale:
+     *  A large basement node with fixed length keys is an array much bigger
+     *  than the cache, where the search stalls on a cache miss and a
+     *  mispredicted branch at every level.
+     */
+    template<typename dmtcmp_t,
+             int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
+    int find_zero_fixed(const dmtcmp_t &extra, uint32_t *const value_size, dmtdataout_t *const value, uint32_t *const idxp) const;
+
     /**
      *   Effect:
      *    If direction >0 then find the smallest i such that h(V_i,extra)>0.
@@ -638,6 +667,10 @@ private:
              int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
     int find_internal_zero_array(const dmtcmp_t &extra, uint32_t *const value_len, dmtdataout_t *const value, uint32_t *const idxp) const;
 
+    template<typename dmtcmp_t,
+             int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
+    int find_internal_zero_array_branchless(const dmtcmp_t &extra, uint32_t *const value_len, dmtdataout_t *const value, uint32_t *const idxp) const;
+
     template<typename dmtcmp_t,
              int (*h)(const uint32_t, const dmtdata_t &, const dmtcmp_t &)>
     int find_internal_zero(const subtree &subtree, const dmtcmp_t &extra, uint32_t *const value_len, dmtdataout_t *const value, uint32_t *const idxp) const;
@@ -37,6 +37,8 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
 
 #include <toku_assert.h>
+#include <portability/toku_atomic.h>
+#include <portability/toku_race_tools.h>
 
 #include <util/context.h>
 #include <util/frwlock.h>
@@ -62,6 +64,7 @@ namespace toku {
         m_mutex = mutex;
 
         m_num_readers = 0;
+        m_fast_readers = FAST_PATH_CLOSED;
         m_num_writers = 0;
         m_num_want_write = 0;
         m_num_want_read = 0;
@@ -176,6 +179,7 @@ namespace toku {
 
     bool frwlock::try_write_lock(bool expensive) {
         toku_mutex_assert_locked(m_mutex);
+        this->close_fast_path();
         if (m_num_readers > 0 || m_num_writers > 0 ||
             m_num_signaled_readers > 0 || m_num_want_write > 0) {
             return false;
@@ -229,6 +233,7 @@ namespace toku {
             --m_num_signaled_readers;
         }
         ++m_num_readers;
+        this->maybe_open_fast_path();
 #if defined(TOKU_MYSQL_WITH_PFS)
         /* Instrumentation end */
         toku_instr_rwlock_rdlock_wait_end(rwlock_instr, 0);
@@ -244,9 +249,64 @@ namespace toku {
         // No writers are waiting.
         // Grant the read lock.
         ++m_num_readers;
+        this->maybe_open_fast_path();
         return true;
     }
 
+    bool frwlock::try_read_lock_fast(void) {
+        uint32_t n = toku_unsafe_fetch(&m_fast_readers);
+        while (!(n & FAST_PATH_CLOSED)) {
+            uint32_t old = toku_sync_val_compare_and_swap(&m_fast_readers, n, n + 1);
+            if (old == n) {
+                return true;
+            }
+            n = old;
+        }
+        return false;
+    }
+
+    bool frwlock::try_read_unlock_fast(void) {
+        uint32_t n = toku_unsafe_fetch(&m_fast_readers);
+        while (!(n & FAST_PATH_CLOSED) && n > 0) {
+            uint32_t old = toku_sync_val_compare_and_swap(&m_fast_readers, n, n - 1);
+            if (old == n) {
+                return true;
+            }
+            n = old;
+        }
+        return false;
+    }
+
+    void frwlock::close_fast_path(void) {
+        toku_mutex_assert_locked(m_mutex);
+        uint32_t n = toku_unsafe_fetch(&m_fast_readers);
+        while (n != FAST_PATH_CLOSED) {
+            paranoid_invariant(!(n & FAST_PATH_CLOSED));
+            uint32_t old = toku_sync_val_compare_and_swap(&m_fast_readers, n, FAST_PATH_CLOSED);
+            if (old == n) {
+                // the fast readers are ordinary readers from now on
+                m_num_readers += n;
+                break;
+            }
+            n = old;
+        }
+    }
+
+    // The fast path is only reopened by a reader that got the lock through
+    // m_mutex, so a writer never has to reopen it on the way out, and a
+    // PAIR that is never read again stays closed.
+    void frwlock::maybe_open_fast_path(void) {
+        if (m_num_writers == 0 && m_num_want_write == 0 &&
+            toku_unsafe_fetch(&m_fast_readers) == FAST_PATH_CLOSED) {
+            toku_sync_bool_compare_and_swap(&m_fast_readers, FAST_PATH_CLOSED, 0);
+        }
+    }
+
+    uint32_t frwlock::fast_readers(void) const {
+        uint32_t n = toku_unsafe_fetch(&m_fast_readers);
+        return (n & FAST_PATH_CLOSED) ? 0 : n;
+    }
+
     void frwlock::maybe_signal_next_writer(void) {
         if (m_num_want_write > 0 && m_num_signaled_readers == 0 &&
             m_num_readers == 0) {
@@ -264,8 +324,14 @@ namespace toku {
 #endif
         toku_mutex_assert_locked(m_mutex);
         paranoid_invariant(m_num_writers == 0);
-        paranoid_invariant(m_num_readers > 0);
-        --m_num_readers;
+        if (m_num_readers > 0) {
+            --m_num_readers;
+        } else {
+            // every remaining reader came in through the fast path, and
+            // the fast path cannot close while we hold m_mutex
+            bool released = this->try_read_unlock_fast();
+            invariant(released);
+        }
         this->maybe_signal_next_writer();
     }
 
@@ -322,8 +388,8 @@ namespace toku {
 
     uint32_t frwlock::users(void) const {
         toku_mutex_assert_locked(m_mutex);
-        return m_num_readers + m_num_writers + m_num_want_read +
-               m_num_want_write;
+        return m_num_readers + this->fast_readers() + m_num_writers +
+               m_num_want_read + m_num_want_write;
     }
     uint32_t frwlock::blocked_users(void) const {
         toku_mutex_assert_locked(m_mutex);
@@ -341,7 +407,7 @@ namespace toku {
     }
     uint32_t frwlock::readers(void) const {
         toku_mutex_assert_locked(m_mutex);
-        return m_num_readers;
+        return m_num_readers + this->fast_readers();
     }
     uint32_t frwlock::blocked_readers(void) const {
         toku_mutex_assert_locked(m_mutex);
@@ -50,6 +50,8 @@ namespace toku {
 
     class frwlock {
        public:
+        static const uint32_t FAST_PATH_CLOSED = 1U << 31;
+
         void init(toku_mutex_t *const mutex
 #if defined(TOKU_MYSQL_WITH_PFS)
                   ,
@@ -70,6 +72,20 @@ namespace toku {
         // returns true if acquiring a read lock will be expensive
         bool read_lock_is_expensive(void);
 
+        // Lock-free read path. A fast reader is counted in m_fast_readers
+        // without holding m_mutex, and is only admitted while no writer
+        // holds or wants the lock. Any writer closes the fast path and folds
+        // the fast readers into m_num_readers, so from then on they are
+        // ordinary readers and must be released with read_unlock().
+        // Readers are interchangeable: try_read_unlock_fast() may release
+        // any read lock, and read_unlock() may release a fast one.
+        bool try_read_lock_fast(void);
+        // returns false if the caller must release its read lock with
+        // read_unlock() while holding m_mutex
+        bool try_read_unlock_fast(void);
+        // Prerequisite: Holds m_mutex.
+        void close_fast_path(void);
+
         uint32_t users(void) const;
         uint32_t blocked_users(void) const;
         uint32_t writers(void) const;
@@ -88,10 +104,15 @@ namespace toku {
         toku_cond_t *deq_item(void);
         void maybe_signal_or_broadcast_next(void);
         void maybe_signal_next_writer(void);
+        void maybe_open_fast_path(void);
+        uint32_t fast_readers(void) const;
 
         toku_mutex_t *m_mutex;
 
         uint32_t m_num_readers;
+        // count of readers admitted by try_read_lock_fast, or
+        // FAST_PATH_CLOSED if the fast path is closed
+        uint32_t m_fast_readers;
         uint32_t m_num_writers;
         uint32_t m_num_want_write;
         uint32_t m_num_want_read;
@@ -39,6 +39,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <memory.h>
 
 #include <portability/toku_config.h>
+#include <portability/toku_os.h>
 #include <portability/toku_time.h>
 #include <toku_pthread.h>
 
@@ -54,6 +55,7 @@ struct todo {
 
 struct kid {
     struct kibbutz *k;
+    int numa_node; // the NUMA node the worker runs on, -1 if it may run anywhere
 };
 
 struct kibbutz {
@@ -78,7 +80,7 @@ toku_instr_key *kibbutz_mutex_key;
 toku_instr_key *kibbutz_k_cond_key;
 toku_instr_key *kibbutz_thread_key;
 
-int toku_kibbutz_create(int n_workers, KIBBUTZ *kb_ret) {
+static int kibbutz_create(int n_workers, bool numa, KIBBUTZ *kb_ret) {
     int r = 0;
     *kb_ret = NULL;
     KIBBUTZ XCALLOC(k);
@@ -95,8 +97,10 @@ int toku_kibbutz_create(int n_workers, KIBBUTZ *kb_ret) {
     k->total_execution_time = 0;
     XMALLOC_N(n_workers, k->workers);
     XMALLOC_N(n_workers, k->ids);
+    int num_nodes = numa ? toku_os_numa_num_nodes() : 0;
     for (int i = 0; i < n_workers; i++) {
         k->ids[i].k = k;
+        k->ids[i].numa_node = numa ? i % num_nodes : -1;
         r = toku_pthread_create(*kibbutz_thread_key,
                                 &k->workers[i],
                                 nullptr,
@@ -114,6 +118,14 @@ int toku_kibbutz_create(int n_workers, KIBBUTZ *kb_ret) {
     return r;
 }
 
+int toku_kibbutz_create(int n_workers, KIBBUTZ *kb_ret) {
+    return kibbutz_create(n_workers, false, kb_ret);
+}
+
+int toku_kibbutz_create_numa(int n_workers, KIBBUTZ *kb_ret) {
+    return kibbutz_create(n_workers, true, kb_ret);
+}
+
 static void klock (KIBBUTZ k) {
     toku_mutex_lock(&k->mutex);
 }
@@ -136,6 +148,9 @@ static void ksignal (KIBBUTZ k) {
 static void *work_on_kibbutz (void *kidv) {
     struct kid *CAST_FROM_VOIDP(kid, kidv);
     KIBBUTZ k = kid->k;
+    if (kid->numa_node >= 0) {
+        (void) toku_os_numa_bind_thread(kid->numa_node);
+    }
     klock(k);
     while (1) {
         while (k->tail) {
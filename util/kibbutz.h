@@ -48,6 +48,11 @@ typedef struct kibbutz *KIBBUTZ;
 //
 int toku_kibbutz_create (int n_workers, KIBBUTZ *kb);
 //
+// create a kibbutz whose workers are spread round-robin over the NUMA
+// nodes of the machine, each worker running only on the processors of its node
+//
+int toku_kibbutz_create_numa (int n_workers, KIBBUTZ *kb);
+//
 // enqueue a workitem in the kibbutz. When the kibbutz is to work on this workitem,
 // it calls f(extra). 
 // At any time, the kibbutz is operating on at most n_workers jobs. 
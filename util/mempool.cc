@@ -39,6 +39,8 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <string.h>
 #include <memory.h>
 #include <toku_assert.h>
+#include <portability/toku_atomic.h>
+#include <portability/toku_race_tools.h>
 #include "mempool.h"
 
 /* Contract:
@@ -51,8 +53,22 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
  *
  * Note, toku_mempool_init() does not allocate the memory because sometimes the caller will already have
  * the memory allocated and will assign the pre-allocated memory to the mempool.
+ *
+ * Mempools made by toku_mempool_clone() share their memory, counted by share_count, and the last
+ * one to let go of it frees it.
  */
 
+// Let go of the memory of a mempool, freeing it if no other mempool shares it.
+static void mempool_release_base(struct mempool *mp) {
+    if (mp->share_count == nullptr) {
+        toku_free(mp->base);
+    } else if (toku_sync_sub_and_fetch(mp->share_count, 1) == 0) {
+        toku_free(mp->base);
+        toku_free(mp->share_count);
+    }
+    mp->share_count = nullptr;
+}
+
 /* This is a constructor to be used when the memory for the mempool struct has been
  * allocated by the caller, but no memory has yet been allocatd for the data.
  */
@@ -71,6 +87,7 @@ void toku_mempool_init(struct mempool *mp, void *base, size_t free_offset, size_
     mp->size = size;
     mp->free_offset = free_offset;             // address of first available memory
     mp->frag_size = 0;               // byte count of wasted space (formerly used, no longer used or available)
+    mp->share_count = nullptr;
 }
 
 /* allocate memory and construct mempool
@@ -83,6 +100,7 @@ void toku_mempool_construct(struct mempool *mp, size_t data_size) {
         mp->size = mp_size;
         mp->free_offset = 0;
         mp->frag_size = 0;
+        mp->share_count = nullptr;
     }
     else {
         toku_mempool_zero(mp);
@@ -90,6 +108,15 @@ void toku_mempool_construct(struct mempool *mp, size_t data_size) {
 }
 
 void toku_mempool_reset(struct mempool *mp) {
+    if (toku_mempool_is_shared(mp)) {
+        // everything will be written again, so there is nothing to copy
+        size_t size = mp->size;
+        mempool_release_base(mp);
+        mp->base = toku_xmalloc_aligned(64, size);
+    } else if (mp->share_count != nullptr) {
+        toku_free(mp->share_count);
+        mp->share_count = nullptr;
+    }
     mp->free_offset = 0;
     mp->frag_size = 0;
 }
@@ -100,7 +127,7 @@ void toku_mempool_realloc_larger(struct mempool *mp, size_t data_size) {
     size_t mpsize = data_size + (data_size/4);     // allow 1/4 room for expansion (would be wasted if read-only)
     void* newmem = toku_xmalloc_aligned(64, mpsize);   // allocate new buffer for mempool
     memcpy(newmem, mp->base, mp->free_offset);  // Copy old info
-    toku_free(mp->base);
+    mempool_release_base(mp);
     mp->base = newmem;
     mp->size = mpsize;
 }
@@ -109,7 +136,7 @@ void toku_mempool_realloc_larger(struct mempool *mp, size_t data_size) {
 void toku_mempool_destroy(struct mempool *mp) {
     // printf("mempool_destroy %p %p %lu %lu\n", mp, mp->base, mp->size, mp->frag_size);
     if (mp->base)
-        toku_free(mp->base);
+        mempool_release_base(mp);
     toku_mempool_zero(mp);
 }
 
@@ -188,10 +215,36 @@ size_t toku_mempool_footprint(struct mempool *mp) {
     return rval;
 }
 
-void toku_mempool_clone(const struct mempool* orig_mp, struct mempool* new_mp) {
+void toku_mempool_clone(struct mempool* orig_mp, struct mempool* new_mp) {
     new_mp->frag_size = orig_mp->frag_size;
     new_mp->free_offset = orig_mp->free_offset;
-    new_mp->size = orig_mp->free_offset; // only make the cloned mempool store what is needed
-    new_mp->base = toku_xmalloc_aligned(64, new_mp->size);
-    memcpy(new_mp->base, orig_mp->base, new_mp->size);
+    new_mp->size = orig_mp->free_offset; // only make the cloned mempool see what is needed
+    new_mp->base = orig_mp->base;
+    new_mp->share_count = nullptr;
+    if (orig_mp->base != nullptr) {
+        if (orig_mp->share_count == nullptr) {
+            XMALLOC(orig_mp->share_count);
+            *orig_mp->share_count = 1;
+        }
+        (void) toku_sync_add_and_fetch(orig_mp->share_count, 1);
+        new_mp->share_count = orig_mp->share_count;
+    }
+}
+
+bool toku_mempool_is_shared(const struct mempool *mp) {
+    // only the owner of mp takes new shares of its memory, so a count of
+    // one cannot go back up behind the owner's back
+    return mp->share_count != nullptr && toku_unsafe_fetch(mp->share_count) > 1;
+}
+
+void toku_mempool_unshare(struct mempool *mp) {
+    if (toku_mempool_is_shared(mp)) {
+        void *newmem = toku_xmalloc_aligned(64, mp->size);
+        memcpy(newmem, mp->base, mp->free_offset);
+        mempool_release_base(mp);
+        mp->base = newmem;
+    } else if (mp->share_count != nullptr) {
+        toku_free(mp->share_count);
+        mp->share_count = nullptr;
+    }
 }
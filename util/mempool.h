@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
    must be relocated by the application to a new memory pool. */
 
 #include <stddef.h>
+#include <stdint.h>
 
 struct mempool;
 
@@ -54,6 +55,7 @@ struct mempool {
     size_t free_offset;      /* the offset of the memory pool free space */
     size_t size;             /* the size of the memory */
     size_t frag_size;        /* the size of the fragmented memory */
+    uint32_t *share_count;   /* if not null, how many mempools share base (see toku_mempool_clone) */
 };
 
 /* This is a constructor to be used when the memory for the mempool struct has been
@@ -126,4 +128,15 @@ static inline int toku_mempool_inrange(struct mempool *mp, void *vp, size_t size
 /* get memory footprint */
 size_t toku_mempool_footprint(struct mempool *mp);
 
-void toku_mempool_clone(const struct mempool* orig_mp, struct mempool* new_mp);
+/* make new_mp a copy-on-write clone of orig_mp.  the two share the memory
+   allocated so far, which neither may write again until it has called
+   toku_mempool_unshare().  new memory allocated from orig_mp lies past
+   what new_mp sees, so orig_mp may keep allocating without unsharing. */
+void toku_mempool_clone(struct mempool* orig_mp, struct mempool* new_mp);
+
+/* true if another mempool still shares this mempool's memory */
+bool toku_mempool_is_shared(const struct mempool *mp);
+
+/* give this mempool a private copy of its memory if another mempool still
+   shares it, so that allocated memory may be written again */
+void toku_mempool_unshare(struct mempool *mp);
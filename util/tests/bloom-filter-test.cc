@@ -0,0 +1,168 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <stdio.h>
+#include <string.h>
+
+#include "portability/toku_assert.h"
+
+#include "util/bloom_filter.h"
+
+namespace toku {
+
+class bloom_filter_unit_test {
+private:
+    static void fill_key(char *buf, size_t size, int i) {
+        snprintf(buf, size, "key-%d", i);
+    }
+
+    void test_create(uint32_t capacity, uint32_t bits_per_key) {
+        bloom_filter filter;
+        filter.create(capacity, bits_per_key);
+        invariant(filter.capacity() == capacity);
+        invariant(filter.bits_per_key() == bits_per_key);
+        invariant(filter.num_keys() == 0);
+        invariant(filter._num_blocks > 0);
+        invariant(filter._num_probes > 0);
+        invariant(filter.memory_size() * 8 >= (size_t) capacity * bits_per_key);
+
+        // nothing is in an empty filter
+        for (int i = 0; i < 1000; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            invariant(!filter.may_contain(key, strlen(key)));
+        }
+        filter.destroy();
+    }
+
+    // No false negatives ever, including after the filter has taken
+    // more keys than it was sized for.
+    void test_no_false_negatives(uint32_t capacity, int n) {
+        bloom_filter filter;
+        filter.create(capacity, 10);
+        for (int i = 0; i < n; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            filter.add(key, strlen(key));
+        }
+        invariant(filter.num_keys() == (uint32_t) n);
+        for (int i = 0; i < n; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            invariant(filter.may_contain(key, strlen(key)));
+        }
+        // keys of every length from 0 through 17 exercise each tail case
+        char buf[17];
+        memset(buf, 'x', sizeof buf);
+        for (uint32_t len = 0; len <= sizeof buf; len++) {
+            filter.add(buf, len);
+        }
+        for (uint32_t len = 0; len <= sizeof buf; len++) {
+            invariant(filter.may_contain(buf, len));
+        }
+        filter.destroy();
+    }
+
+    void test_false_positive_rate(void) {
+        const int n = 10000;
+        bloom_filter filter;
+        filter.create(n, 10);
+        for (int i = 0; i < n; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            filter.add(key, strlen(key));
+        }
+        int false_positives = 0;
+        const int probes = 100000;
+        for (int i = n; i < n + probes; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            if (filter.may_contain(key, strlen(key))) {
+                false_positives++;
+            }
+        }
+        // 10 bits per key is about 1% for an ideal filter; blocking
+        // costs a little, so allow up to 2%.
+        invariant(false_positives < probes / 50);
+        filter.destroy();
+    }
+
+    void test_clone(void) {
+        bloom_filter filter;
+        filter.create(100, 8);
+        for (int i = 0; i < 100; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            filter.add(key, strlen(key));
+        }
+        bloom_filter copy;
+        copy.clone(filter);
+        invariant(copy.num_keys() == filter.num_keys());
+        invariant(copy.capacity() == filter.capacity());
+        invariant(copy.memory_size() == filter.memory_size());
+        invariant(memcmp(copy._blocks, filter._blocks, filter.memory_size()) == 0);
+        filter.destroy();
+        for (int i = 0; i < 100; i++) {
+            char key[32];
+            fill_key(key, sizeof key, i);
+            invariant(copy.may_contain(key, strlen(key)));
+        }
+        copy.destroy();
+    }
+
+public:
+    void test(void) {
+        test_create(0, 10);
+        test_create(1, 1);
+        test_create(1000, 10);
+        test_create(100000, 16);
+        test_no_false_negatives(0, 100);
+        test_no_false_negatives(1000, 1000);
+        test_no_false_negatives(1000, 5000);
+        test_false_positive_rate();
+        test_clone();
+    }
+};
+
+} // namespace toku
+
+int main(void) {
+    toku::bloom_filter_unit_test test;
+    test.test();
+    return 0;
+}
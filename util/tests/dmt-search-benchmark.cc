@@ -0,0 +1,230 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+#include <sys/time.h>
+
+#include <db.h>
+
+#include "util/dmt.h"
+
+// Check that find_zero_fixed() finds what find_zero() finds, in array and
+// in tree form, then time both on a dmt laid out like a basement node with
+// 1M fixed length keys.
+
+// Laid out like a basement node's klpair: leafentry offset, then the key.
+struct kv {
+    uint32_t offset;
+    uint8_t key[0];
+};
+
+namespace toku {
+class kv_writer {
+    public:
+        size_t get_size(void) const {
+            return sizeof(kv) + keylen;
+        }
+        void write_to(kv *const dest) const {
+            dest->offset = offset;
+            memcpy(dest->key, keyp, keylen);
+        }
+
+        kv_writer(uint32_t _keylen, uint32_t _offset, const void *_keyp)
+            : keylen(_keylen), offset(_offset), keyp(_keyp) {}
+        kv_writer(const uint32_t kv_len, kv *const src)
+            : keylen(kv_len - sizeof(kv)), offset(src->offset), keyp(src->key) {}
+    private:
+        const uint32_t keylen;
+        const uint32_t offset;
+        const void *keyp;
+};
+}
+
+typedef toku::dmt<kv, kv *, toku::kv_writer> kv_dmt_t;
+
+struct probe {
+    const void *key;
+    uint32_t keylen;
+};
+
+// memcmp order, shorter keys first on a tie, like toku_builtin_compare_fun
+static int kv_heaviside(const uint32_t kv_len, const kv &v, const probe &p) {
+    const uint32_t keylen = kv_len - sizeof(kv);
+    const int c = memcmp(v.key, p.key, keylen < p.keylen ? keylen : p.keylen);
+    if (c != 0) {
+        return c;
+    }
+    return keylen < p.keylen ? -1 : (keylen > p.keylen ? 1 : 0);
+}
+
+// big-endian, zero padded to keylen, so memcmp order is numeric order
+static void fill_key(uint8_t *buf, uint32_t keylen, uint64_t v) {
+    for (uint32_t i = 0; i < keylen; i++) {
+        buf[keylen - 1 - i] = (i < 8) ? static_cast<uint8_t>(v >> (8 * i)) : 0;
+    }
+}
+
+// effect: creates an array form dmt holding the keys 2, 4, ..., 2n
+static void make_dmt(kv_dmt_t *d, uint32_t keylen, uint32_t n) {
+    const uint32_t kv_len = sizeof(kv) + keylen;
+    uint8_t *buf;
+    XMALLOC_N(static_cast<size_t>(kv_len) * n, buf);
+    for (uint32_t i = 0; i < n; i++) {
+        kv *v = reinterpret_cast<kv *>(&buf[static_cast<size_t>(i) * kv_len]);
+        v->offset = i;
+        fill_key(v->key, keylen, 2 * (static_cast<uint64_t>(i) + 1));
+    }
+    d->create_from_sorted_memory_of_fixed_size_elements(buf, n, kv_len * n, kv_len);
+    toku_free(buf);
+}
+
+static void check_same(const kv_dmt_t &d, uint32_t keylen, uint64_t key_value) {
+    uint8_t keybuf[32];
+    fill_key(keybuf, keylen, key_value);
+    const probe p = { keybuf, keylen };
+    uint32_t len = 0, fixed_len = 0, idx = UINT32_MAX, fixed_idx = UINT32_MAX;
+    kv *v = nullptr, *fixed_v = nullptr;
+    int r = d.find_zero<probe, kv_heaviside>(p, &len, &v, &idx);
+    int fixed_r = d.find_zero_fixed<probe, kv_heaviside>(p, &fixed_len, &fixed_v, &fixed_idx);
+    invariant(fixed_r == r);
+    invariant(fixed_idx == idx);
+    if (r == 0) {
+        invariant(fixed_len == len);
+        invariant(fixed_v == v);
+    } else {
+        invariant(r == DB_NOTFOUND);
+    }
+    // without the optional outputs
+    fixed_r = d.find_zero_fixed<probe, kv_heaviside>(p, nullptr, nullptr, nullptr);
+    invariant(fixed_r == r);
+}
+
+static void test_correctness(void) {
+    for (uint32_t keylen : { 8, 12, 16 }) {
+        for (uint32_t n : { 0, 1, 2, 3, 7, 16, 17, 100, 1000 }) {
+            kv_dmt_t d;
+            make_dmt(&d, keylen, n);
+            // every key, every gap, and past both ends
+            for (uint64_t k = 0; k <= 2 * n + 2; k++) {
+                check_same(d, keylen, k);
+            }
+            if (n > 0) {
+                // a key of another length turns the dmt into a tree, where
+                // find_zero_fixed() has to fall back to find_zero()
+                uint8_t keybuf[32];
+                fill_key(keybuf, keylen + 1, 2 * n + 1);
+                int r = d.insert_at(toku::kv_writer(keylen + 1, n, keybuf), n);
+                invariant_zero(r);
+                invariant(!d.value_length_is_fixed());
+                for (uint64_t k = 0; k <= 2 * n + 2; k++) {
+                    check_same(d, keylen, k);
+                }
+            }
+            d.destroy();
+        }
+    }
+}
+
+static double now_usec(void) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+template<int (*search)(const kv_dmt_t &, const probe &, uint32_t *)>
+static void time_search(const char *name, const kv_dmt_t &d, uint32_t keylen, const uint8_t *keys, int nkeys, int searches) {
+    long sum = 0;
+    const double t0 = now_usec();
+    for (int i = 0; i < searches; i++) {
+        const probe p = { &keys[static_cast<size_t>(i % nkeys) * keylen], keylen };
+        uint32_t idx;
+        invariant(search(d, p, &idx) == 0);
+        sum += idx;
+    }
+    const double t1 = now_usec();
+    if (verbose) {
+        printf("keylen %2u entries %7u %-10s %6.1f ns/search (%ld)\n",
+               keylen, d.size(), name, (t1 - t0) * 1000.0 / searches, sum);
+    }
+}
+
+static int search_find_zero(const kv_dmt_t &d, const probe &p, uint32_t *idx) {
+    return d.find_zero<probe, kv_heaviside>(p, nullptr, nullptr, idx);
+}
+
+static int search_find_zero_fixed(const kv_dmt_t &d, const probe &p, uint32_t *idx) {
+    return d.find_zero_fixed<probe, kv_heaviside>(p, nullptr, nullptr, idx);
+}
+
+static void benchmark(uint32_t keylen, uint32_t n, int searches) {
+    kv_dmt_t d;
+    make_dmt(&d, keylen, n);
+
+    // random keys that are all present, so every search goes to the bottom
+    const int nkeys = 1 << 16;
+    uint8_t *keys;
+    XMALLOC_N(static_cast<size_t>(nkeys) * keylen, keys);
+    for (int i = 0; i < nkeys; i++) {
+        fill_key(&keys[static_cast<size_t>(i) * keylen], keylen, 2 * (static_cast<uint64_t>(random() % n) + 1));
+    }
+
+    time_search<search_find_zero>("find_zero", d, keylen, keys, nkeys, searches);
+    time_search<search_find_zero_fixed>("branchless", d, keylen, keys, nkeys, searches);
+
+    toku_free(keys);
+    d.destroy();
+}
+
+int test_main(int argc, const char *argv[]) {
+    int searches = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose++;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            verbose = 0;
+        } else {
+            searches = atoi(argv[i]);
+        }
+    }
+    test_correctness();
+    for (uint32_t keylen : { 8, 16 }) {
+        benchmark(keylen, 1 << 20, searches);
+    }
+    return 0;
+}
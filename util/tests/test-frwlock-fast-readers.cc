@@ -0,0 +1,150 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// check the lock-free read path of frwlock: it only opens after a read lock
+// taken under the mutex, writers close it, and fast readers keep a writer
+// out until they are gone.
+
+#include <toku_portability.h>
+#include <toku_assert.h>
+#include <portability/toku_pthread.h>
+#include <util/frwlock.h>
+
+// We need to manually intialize partitioned counters so that the
+// ones automatically incremented by the frwlock get handled properly.
+#include <util/partitioned_counter.h>
+
+toku_mutex_t mutex;
+toku::frwlock w;
+
+static uint32_t users(void) {
+    toku_mutex_lock(&mutex);
+    uint32_t n = w.users();
+    toku_mutex_unlock(&mutex);
+    return n;
+}
+
+static void *do_write(void *arg) {
+    toku_mutex_lock(&mutex);
+    w.write_lock(false);
+    w.write_unlock();
+    toku_mutex_unlock(&mutex);
+    return arg;
+}
+
+static void test_fast_readers(void) {
+    toku_mutex_init(toku_uninstrumented, &mutex, nullptr);
+    w.init(&mutex);
+
+    // closed until someone takes a read lock the regular way
+    assert(!w.try_read_lock_fast());
+    toku_mutex_lock(&mutex);
+    w.read_lock();
+    toku_mutex_unlock(&mutex);
+    assert(w.try_read_lock_fast());
+    assert(w.try_read_lock_fast());
+    assert(users() == 3);
+
+    // readers are interchangeable
+    assert(w.try_read_unlock_fast());
+    toku_mutex_lock(&mutex);
+    w.read_unlock();
+    w.read_unlock();
+    assert(w.users() == 0);
+    toku_mutex_unlock(&mutex);
+    assert(!w.try_read_unlock_fast());
+
+    // a writer closes the path, and it stays closed after the writer leaves
+    toku_mutex_lock(&mutex);
+    w.write_lock(false);
+    toku_mutex_unlock(&mutex);
+    assert(!w.try_read_lock_fast());
+    toku_mutex_lock(&mutex);
+    w.write_unlock();
+    toku_mutex_unlock(&mutex);
+    assert(!w.try_read_lock_fast());
+
+    // a waiting writer turns fast readers into regular readers, and
+    // gets the lock once they release it
+    toku_mutex_lock(&mutex);
+    w.read_lock();
+    w.read_unlock();
+    toku_mutex_unlock(&mutex);
+    assert(w.try_read_lock_fast());
+    toku_pthread_t tid;
+    int r = toku_pthread_create(
+        toku_uninstrumented, &tid, nullptr, do_write, nullptr);
+    assert_zero(r);
+    while (users() < 2) {
+        sleep(1);
+    }
+    assert(!w.try_read_lock_fast());
+    assert(!w.try_read_unlock_fast());
+    toku_mutex_lock(&mutex);
+    w.read_unlock();
+    toku_mutex_unlock(&mutex);
+    void *ret;
+    r = toku_pthread_join(tid, &ret);
+    assert_zero(r);
+    assert(users() == 0);
+
+    // close_fast_path folds fast readers into the regular count
+    toku_mutex_lock(&mutex);
+    w.read_lock();
+    toku_mutex_unlock(&mutex);
+    assert(w.try_read_lock_fast());
+    toku_mutex_lock(&mutex);
+    w.close_fast_path();
+    assert(w.readers() == 2);
+    w.read_unlock();
+    w.read_unlock();
+    toku_mutex_unlock(&mutex);
+    assert(users() == 0);
+
+    w.deinit();
+    toku_mutex_destroy(&mutex);
+}
+
+int main (int UU(argc), const char* UU(argv[])) {
+    partitioned_counters_init();
+    toku_context_status_init();
+    test_fast_readers();
+    toku_context_status_destroy();
+    partitioned_counters_destroy();
+    return 0;
+}